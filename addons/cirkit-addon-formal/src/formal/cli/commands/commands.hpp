@@ -28,6 +28,7 @@
 #ifndef CLI_FORMAL_COMMANDS_HPP
 #define CLI_FORMAL_COMMANDS_HPP
 
+#include <formal/cli/commands/satcec.hpp>
 #include <formal/cli/commands/satnpn.hpp>
 #include <formal/cli/commands/unate.hpp>
 
@@ -35,6 +36,7 @@
     cli.set_category( "Reverse engineering" ); \
     ADD_COMMAND( satnpn );                     \
     cli.set_category( "Verification" );        \
+    ADD_COMMAND( satcec );                     \
     ADD_COMMAND( unate );
 
 #endif
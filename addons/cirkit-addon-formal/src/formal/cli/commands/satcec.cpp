@@ -0,0 +1,144 @@
+/* CirKit: A circuit toolkit
+ * Copyright (C) 2009-2015  University of Bremen
+ * Copyright (C) 2015-2016  EPFL
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "satcec.hpp"
+
+#include <boost/format.hpp>
+
+#include <core/utils/program_options.hpp>
+#include <classical/cli/stores.hpp>
+#include <classical/utils/counterexample.hpp>
+#include <formal/verification/sat_cec.hpp>
+
+using namespace boost::program_options;
+
+namespace cirkit
+{
+
+/******************************************************************************
+ * Types                                                                      *
+ ******************************************************************************/
+
+/******************************************************************************
+ * Private functions                                                          *
+ ******************************************************************************/
+
+/******************************************************************************
+ * Public functions                                                           *
+ ******************************************************************************/
+
+satcec_command::satcec_command( const environment::ptr& env )
+  : cirkit_command( env, "Combinational equivalence checking with SAT sweeping" )
+{
+  opts.add_options()
+    ( "circuit1",  value_with_default( &circ1 ),     "store-ID of circuit1" )
+    ( "circuit2",  value_with_default( &circ2 ),     "store-ID of circuit2" )
+    ( "sim_words", value_with_default( &sim_words ), "number of 64-bit words for random simulation" )
+    ( "seed",      value_with_default( &seed ),      "seed for random simulation" )
+    ;
+
+  if ( env->has_store<counterexample_t>() )
+  {
+    add_new_option();
+  }
+  be_verbose();
+}
+
+command::rules_t satcec_command::validity_rules() const
+{
+  return {
+    {[&]() { return circ1 < env->store<aig_graph>().size(); }, "store-ID of circuit1 is invalid" },
+    {[&]() { return circ2 < env->store<aig_graph>().size(); }, "store-ID of circuit2 is invalid" },
+    {[&]() { return sim_words > 0u; }, "at least one simulation word is required" }
+  };
+}
+
+bool satcec_command::execute()
+{
+  auto& aigs = env->store<aig_graph>();
+
+  const auto settings = make_settings();
+  settings->set( "sim_words", sim_words );
+  settings->set( "seed", seed );
+
+  const auto cex_result = sat_cec( aigs[circ1], aigs[circ2], settings, statistics );
+
+  std::cout << boost::format( "[i] run-time (total):  %.2f secs\n"
+                              "[i] run-time (miter):  %.2f secs\n"
+                              "[i] run-time (sim):    %.2f secs\n"
+                              "[i] run-time (refine): %.2f secs\n"
+                              "[i] run-time (SAT):    %.2f secs\n"
+                              "[i] run-time (output): %.2f secs\n"
+                              "[i] memory (miter):    %.2f KB\n"
+                              "[i] memory (sim):      %.2f KB\n"
+                              "[i] memory (classes):  %.2f KB\n"
+                              "[i] SAT calls:         %d (%d proved, %d disproved)" ) %
+                   statistics->get<double>( "runtime" ) %
+                   statistics->get<double>( "miter_runtime" ) %
+                   statistics->get<double>( "sim_runtime" ) %
+                   statistics->get<double>( "refine_runtime" ) %
+                   statistics->get<double>( "sat_runtime" ) %
+                   statistics->get<double>( "output_runtime" ) %
+                   ( statistics->get<unsigned long>( "miter_memory" ) / 1024.0 ) %
+                   ( statistics->get<unsigned long>( "sim_memory" ) / 1024.0 ) %
+                   ( statistics->get<unsigned long>( "class_memory" ) / 1024.0 ) %
+                   statistics->get<unsigned long>( "sat_calls" ) %
+                   statistics->get<unsigned long>( "proved" ) %
+                   statistics->get<unsigned long>( "disproved" )
+            << std::endl;
+
+  if ( (bool)cex_result )
+  {
+    if ( env->has_store<counterexample_t>() )
+    {
+      auto& cex = env->store<counterexample_t>();
+      extend_if_new( cex );
+      cex.current() = *cex_result;
+    }
+    std::cout << "[i] counterexample: " << *cex_result << std::endl;
+  }
+  else
+  {
+    std::cout << "[i] functionally equivalent: no counterexample" << std::endl;
+  }
+
+  return true;
+}
+
+command::log_opt_t satcec_command::log() const
+{
+  return log_opt_t({
+      {"runtime", statistics->get<double>( "runtime" )},
+      {"miter_runtime", statistics->get<double>( "miter_runtime" )},
+      {"sim_runtime", statistics->get<double>( "sim_runtime" )},
+      {"refine_runtime", statistics->get<double>( "refine_runtime" )},
+      {"sat_runtime", statistics->get<double>( "sat_runtime" )},
+      {"output_runtime", statistics->get<double>( "output_runtime" )},
+      {"sat_calls", static_cast<int>( statistics->get<unsigned long>( "sat_calls" ) )},
+      {"proved", static_cast<int>( statistics->get<unsigned long>( "proved" ) )},
+      {"disproved", static_cast<int>( statistics->get<unsigned long>( "disproved" ) )}
+    });
+}
+
+}
+
+// Local Variables:
+// c-basic-offset: 2
+// eval: (c-set-offset 'substatement-open 0)
+// eval: (c-set-offset 'innamespace 0)
+// End:
@@ -79,7 +79,12 @@ unate_command::unate_command( const environment::ptr& env )
                                                                            "1: via mapped based CNFization\n"
                                                                            "2: Split outputs first\n"
                                                                            "3: Split outputs first (parallel)\n"
-                                                                           "4: Split inputs first (parallel)\n" )
+                                                                           "4: Split inputs first (parallel)\n"
+                                                                           "5: Incremental per output cone\n"
+                                                                           "6: Incremental per output cone (parallel)\n" )
+    ( "sim_words",  value_with_default( &sim_words ),                      "Number of 64-bit words for random simulation pre-pass (only with approaches 5 and 6)" )
+    ( "cut_cnf,c",                                                         "Use cut-based CNF instead of Tseytin encoding (only with approach 0)" )
+    ( "cut_size",   value_with_default( &cut_size ),                       "Maximum cut size for cut-based CNF (2 to 6)" )
     ( "skiplist,s",                                                        "Compute skip list to skip functional support checks (only with approach 1)" )
     ( "matrix,m",   value( &matrixname )->implicit_value( std::string() ), "Prints unateness matrix:\n"
                                                                            "  rows: POs, columns: PIs\n"
@@ -97,6 +102,9 @@ bool unate_command::execute()
   const auto settings = make_settings();
   settings->set( "progress", is_set( "progress" ) );
   settings->set( "skiplist", is_set( "skiplist" ) );
+  settings->set( "sim_words", sim_words );
+  settings->set( "cut_cnf", is_set( "cut_cnf" ) );
+  settings->set( "cut_size", cut_size );
 
   if ( is_set( "print" ) )
   {
@@ -130,6 +138,12 @@ bool unate_command::execute()
   case 4u:
     u = unateness_split_inputs_parallel( aig(), settings, statistics );
     break;
+  case 5u:
+    u = unateness_incremental( aig(), settings, statistics );
+    break;
+  case 6u:
+    u = unateness_incremental_parallel( aig(), settings, statistics );
+    break;
   }
 
   info().unateness = u;
@@ -156,10 +170,22 @@ bool unate_command::execute()
   std::cout << boost::format( "[i] run-time (total): %.2f secs" ) % statistics->get<double>( "runtime" ) << std::endl
             << boost::format( "[i] run-time (wall): %.2f secs" ) % statistics->get<double>( "runtime_wall" ) << std::endl;
 
-  if ( approach == 1u )
+  if ( approach == 0u && is_set( "cut_cnf" ) )
+  {
+    std::cout << boost::format( "[i] clauses (cuts):    %d" ) % statistics->get<unsigned>( "cnf_clauses" ) << std::endl
+              << boost::format( "[i] clauses (Tseytin): %d" ) % statistics->get<unsigned>( "tseytin_clauses" ) << std::endl;
+  }
+  else if ( approach == 1u )
   {
     std::cout << boost::format( "[i] run-time (SAT):   %.2f secs" ) % statistics->get<double>( "sat_runtime" ) << std::endl;
   }
+  else if ( approach == 5u || approach == 6u )
+  {
+    std::cout << boost::format( "[i] run-time (sim):   %.2f secs" ) % statistics->get<double>( "sim_runtime" ) << std::endl
+              << boost::format( "[i] run-time (SAT):   %.2f secs" ) % statistics->get<double>( "sat_runtime" ) << std::endl
+              << boost::format( "[i] SAT calls:        %d" ) % statistics->get<unsigned long>( "sat_calls" ) << std::endl
+              << boost::format( "[i] binate (sim):     %d" ) % statistics->get<unsigned long>( "sim_decided" ) << std::endl;
+  }
 
   return true;
 }
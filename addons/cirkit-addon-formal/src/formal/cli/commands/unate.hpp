@@ -46,6 +46,8 @@ public:
 
 private:
   unsigned    approach = 4u;
+  unsigned    sim_words = 4u;
+  unsigned    cut_size  = 4u;
   std::string matrixname;
 };
 
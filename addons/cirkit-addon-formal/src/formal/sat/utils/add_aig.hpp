@@ -28,14 +28,15 @@
 #ifndef ADD_AIG_HPP
 #define ADD_AIG_HPP
 
-#include <boost/graph/depth_first_search.hpp>
-#include <boost/range/algorithm.hpp>
+#include <cassert>
+#include <map>
+#include <vector>
+
 #include <boost/range/algorithm_ext/iota.hpp>
 
 #include <core/utils/range_utils.hpp>
 
 #include <classical/aig.hpp>
-#include <classical/utils/aig_dfs.hpp>
 #include <classical/utils/aig_utils.hpp>
 
 #include <formal/sat/sat_solver.hpp>
@@ -44,118 +45,224 @@
 namespace cirkit
 {
 
+/**
+ * @brief Incremental Tseytin encoder for AIGs
+ *
+ * Node variables are kept in a vector indexed by the AIG node and the
+ * transitive fanin is traversed iteratively, such that encoding is linear
+ * in the size of the cone.  Only the cones of requested functions are
+ * encoded, further cones can be appended to the same solver later and
+ * share all nodes that have been encoded before.  Input variables are
+ * allocated consecutively starting from sid.
+ */
 template<class S>
-class add_aig_visitor : public aig_dfs_visitor
+class aig_cnf_encoder
 {
 public:
-  add_aig_visitor( const aig_graph& aig, S& solver, int& sid, const std::vector<int>& piids, std::map<aig_node, int>& node_var_map, bool blocking_vars, std::map<aig_node, int>& blocking_var_map )
-    : aig_dfs_visitor( aig ),
-      solver( solver ),
+  aig_cnf_encoder( S& solver, const aig_graph& aig, int sid = 1, bool blocking_vars = false )
+    : solver( solver ),
+      aig( aig ),
+      info( aig_info( aig ) ),
+      complement( boost::get( boost::edge_complement, aig ) ),
       cur_var( sid ),
-      piids( piids ),
-      node_var_map( node_var_map ),
       blocking_vars( blocking_vars ),
-      blocking_var_map( blocking_var_map )
+      node_vars( boost::num_vertices( aig ), 0 ),
+      piids( info.inputs.size() )
   {
+    for ( const auto& input : index( info.inputs ) )
+    {
+      node_vars[input.value] = piids[input.index] = cur_var++;
+    }
+
+    if ( blocking_vars )
+    {
+      blocking_node_vars.resize( boost::num_vertices( aig ), 0 );
+    }
   }
 
-  void finish_input( const aig_node& node, const std::string& name, const aig_graph& aig )
+  /* returns a literal for f and encodes its transitive fanin if necessary */
+  int encode( const aig_function& f )
   {
-    unsigned pos = std::distance( graph_info.inputs.begin(), boost::find( graph_info.inputs, node ) );
-    node_var_map[node] = piids[pos];
+    const auto var = encode_node( f.node );
+    return f.complemented ? -var : var;
   }
 
-  void finish_constant( const aig_node& node, const aig_graph& aig )
+  /* returns a variable for output index; as in add_aig, complemented outputs get a fresh variable */
+  int encode_output( unsigned output )
   {
-    node_var_map[node] = cur_var;
-    add_clause( solver )( {-cur_var} );
-    cur_var++;
+    const auto& f = info.outputs[output].first;
+    const auto var = encode_node( f.node );
+
+    if ( f.complemented )
+    {
+      const auto new_output = cur_var++;
+      not_equals( solver, var, new_output );
+      return new_output;
+    }
+    else
+    {
+      return var;
+    }
   }
 
-  void finish_aig_node( const aig_node& node, const aig_function& left, const aig_function& right, const aig_graph& aig )
+  std::vector<int> encode_outputs( const std::vector<unsigned>& outputs )
   {
-    node_var_map[node] = cur_var;
-    int a = node_var_map[left.node];
-    int b = node_var_map[right.node];
-    assert( node != left.node );
-    assert( node != right.node );
-    assert( cur_var != a );
-    assert( cur_var != b );
+    std::vector<int> poids( outputs.size() );
+    for ( const auto& output : index( outputs ) )
+    {
+      poids[output.index] = encode_output( output.value );
+    }
+    return poids;
+  }
 
-    if ( blocking_vars )
+  inline int next_var() const { return cur_var; }
+  inline const std::vector<int>& input_vars() const { return piids; }
+  inline int node_var( const aig_node& node ) const { return node_vars[node]; }
+  inline unsigned num_encoded_gates() const { return num_gates; }
+
+  inline int blocking_var( const aig_node& node ) const { return blocking_node_vars[node]; }
+  inline void set_blocking_var( const aig_node& node, int var ) { assert( blocking_vars ); blocking_node_vars[node] = var; }
+
+  std::map<aig_node, int> node_var_map() const
+  {
+    std::map<aig_node, int> m;
+    for ( auto n = 0u; n < node_vars.size(); ++n )
     {
-      if ( blocking_var_map.find( node ) == blocking_var_map.end() )
-      {
-        blocking_var_map[node] = cur_var + 1u;
-      }
-      blocking_and( solver, blocking_var_map[node], left.complemented ? -a : a, right.complemented ? -b : b, cur_var );
-      cur_var += 2u;
+      if ( node_vars[n] ) { m.insert( m.end(), {n, node_vars[n]} ); }
     }
-    else
+    return m;
+  }
+
+  std::map<aig_node, int> blocking_var_map() const
+  {
+    std::map<aig_node, int> m;
+    for ( auto n = 0u; n < blocking_node_vars.size(); ++n )
     {
-      logic_and( solver, left.complemented ? -a : a, right.complemented ? -b : b, cur_var );
-      cur_var++;
+      if ( blocking_node_vars[n] ) { m.insert( m.end(), {n, blocking_node_vars[n]} ); }
     }
+    return m;
   }
 
-public:
-  S& solver;
-  int& cur_var;
-  const std::vector<int>& piids;
-  std::map<aig_node, int>& node_var_map;
-  bool blocking_vars;
-  std::map<aig_node, int>& blocking_var_map;
+private:
+  int encode_node( const aig_node& node )
+  {
+    if ( node_vars[node] ) { return node_vars[node]; }
+
+    stack.push_back( node );
+    while ( !stack.empty() )
+    {
+      const auto n = stack.back();
+
+      if ( node_vars[n] ) { stack.pop_back(); continue; }
+
+      /* constant (inputs are assigned in the constructor) */
+      if ( !boost::out_degree( n, aig ) )
+      {
+        assert( n == info.constant );
+        node_vars[n] = cur_var;
+        add_clause( solver )( {-cur_var} );
+        cur_var++;
+        stack.pop_back();
+        continue;
+      }
+
+      auto it = boost::out_edges( n, aig ).first;
+      const auto e0 = *it++;
+      const auto e1 = *it;
+      const auto c0 = boost::target( e0, aig );
+      const auto c1 = boost::target( e1, aig );
+
+      if ( !node_vars[c0] ) { stack.push_back( c0 ); continue; }
+      if ( !node_vars[c1] ) { stack.push_back( c1 ); continue; }
+
+      const auto a = complement[e0] ? -node_vars[c0] : node_vars[c0];
+      const auto b = complement[e1] ? -node_vars[c1] : node_vars[c1];
+
+      node_vars[n] = cur_var;
+      if ( blocking_vars )
+      {
+        if ( !blocking_node_vars[n] )
+        {
+          blocking_node_vars[n] = cur_var + 1;
+        }
+        blocking_and( solver, blocking_node_vars[n], a, b, cur_var );
+        cur_var += 2;
+      }
+      else
+      {
+        logic_and( solver, a, b, cur_var );
+        cur_var++;
+      }
+      ++num_gates;
+      stack.pop_back();
+    }
+
+    return node_vars[node];
+  }
+
+private:
+  using complement_map_t = typename boost::property_map<aig_graph, boost::edge_complement_t>::const_type;
+
+  S&                     solver;
+  const aig_graph&       aig;
+  const aig_graph_info&  info;
+  complement_map_t       complement;
+  int                    cur_var;
+  bool                   blocking_vars;
+  std::vector<int>       node_vars;
+  std::vector<int>       blocking_node_vars;
+  std::vector<int>       piids;
+  std::vector<aig_node>  stack;
+  unsigned               num_gates = 0u;
 };
 
+/**
+ * Encodes the transitive fanin of the given outputs, poids[i] corresponds
+ * to outputs[i].  Variables for all inputs are allocated, as in add_aig.
+ */
 template<class S>
-int add_aig( S& solver, const aig_graph& aig, int sid, std::vector<int>& piids, std::vector<int>& poids,
-             properties::ptr settings = properties::ptr(),
-             properties::ptr statistics = properties::ptr() )
+int add_aig_cone( S& solver, const aig_graph& aig, int sid, const std::vector<unsigned>& outputs, std::vector<int>& piids, std::vector<int>& poids,
+                  properties::ptr settings = properties::ptr(),
+                  properties::ptr statistics = properties::ptr() )
 {
   /* Settings */
   auto blocking_vars = get( settings, "blocking_vars", false );
   auto blocking_var_map = get( statistics, "blocking_var_map", std::map<aig_node, int>() );
 
-  const auto& graph_info = aig_info( aig );
-  std::map<aig_node, int> node_var_map;
-  std::map<aig_node, boost::default_color_type> colors;
-
-  piids.resize( graph_info.inputs.size() );
-  poids.resize( graph_info.outputs.size() );
-
-  boost::iota( piids, sid );
-  sid += piids.size();
-
-  for ( const auto& output : index( graph_info.outputs ) )
+  aig_cnf_encoder<S> encoder( solver, aig, sid, blocking_vars );
+  if ( blocking_vars )
   {
-    auto node = output.value.first.node;
-    auto complement = output.value.first.complemented;
-
-    add_aig_visitor<S> visitor( aig, solver, sid, piids, node_var_map, blocking_vars, blocking_var_map );
-    boost::depth_first_visit( aig, node, visitor, boost::make_assoc_property_map( colors ) );
-
-    if ( complement )
-    {
-      int new_output = poids[output.index] = sid++;
-      not_equals( solver, node_var_map[node], new_output );
-    }
-    else
+    for ( const auto& p : blocking_var_map )
     {
-      poids[output.index] = node_var_map[node];
+      encoder.set_blocking_var( p.first, p.second );
     }
   }
 
+  piids = encoder.input_vars();
+  poids = encoder.encode_outputs( outputs );
+
   if ( statistics )
   {
-    statistics->set( "node_var_map", node_var_map );
+    statistics->set( "node_var_map", encoder.node_var_map() );
+    statistics->set( "encoded_gates", encoder.num_encoded_gates() );
 
     if ( blocking_vars )
     {
-      statistics->set( "blocking_var_map", blocking_var_map );
+      statistics->set( "blocking_var_map", encoder.blocking_var_map() );
     }
   }
 
-  return sid;
+  return encoder.next_var();
+}
+
+template<class S>
+int add_aig( S& solver, const aig_graph& aig, int sid, std::vector<int>& piids, std::vector<int>& poids,
+             properties::ptr settings = properties::ptr(),
+             properties::ptr statistics = properties::ptr() )
+{
+  std::vector<unsigned> outputs( aig_info( aig ).outputs.size() );
+  boost::iota( outputs, 0u );
+  return add_aig_cone( solver, aig, sid, outputs, piids, poids, settings, statistics );
 }
 
 }
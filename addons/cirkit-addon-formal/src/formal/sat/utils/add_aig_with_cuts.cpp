@@ -0,0 +1,291 @@
+/* CirKit: A circuit toolkit
+ * Copyright (C) 2009-2015  University of Bremen
+ * Copyright (C) 2015-2016  EPFL
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "add_aig_with_cuts.hpp"
+
+#include <algorithm>
+
+#include <boost/graph/topological_sort.hpp>
+#include <boost/range/algorithm.hpp>
+#include <boost/range/iterator_range.hpp>
+
+namespace cirkit
+{
+
+/******************************************************************************
+ * Types                                                                      *
+ ******************************************************************************/
+
+struct cut_cnf_cut
+{
+  unsigned char size = 0u;
+  aig_node      leaves[6];
+  uint64_t      function = 0ul;
+  unsigned      cost = 0u;
+  float         flow = 0.0f;
+};
+
+/******************************************************************************
+ * Private functions                                                          *
+ ******************************************************************************/
+
+inline uint64_t cut_cnf_var( unsigned i )
+{
+  static const uint64_t vars[] = { 0xaaaaaaaaaaaaaaaaul, 0xccccccccccccccccul, 0xf0f0f0f0f0f0f0f0ul,
+                                   0xff00ff00ff00ff00ul, 0xffff0000ffff0000ul, 0xffffffff00000000ul };
+  return vars[i];
+}
+
+cut_cnf_cut trivial_cut( const aig_node& node, const aig_node& constant )
+{
+  cut_cnf_cut cut;
+  if ( node != constant )
+  {
+    cut.size = 1u;
+    cut.leaves[0] = node;
+    cut.function = cut_cnf_var( 0u );
+  }
+  return cut;
+}
+
+/* merges two sorted leaf sets, returns false if the result has more than k leaves */
+bool merge_leaves( const cut_cnf_cut& a, const cut_cnf_cut& b, unsigned k, cut_cnf_cut& cut )
+{
+  auto i = 0u, j = 0u, s = 0u;
+  while ( i < a.size || j < b.size )
+  {
+    if ( s == k ) { return false; }
+    if ( j == b.size || ( i < a.size && a.leaves[i] < b.leaves[j] ) )
+    {
+      cut.leaves[s++] = a.leaves[i++];
+    }
+    else if ( i == a.size || b.leaves[j] < a.leaves[i] )
+    {
+      cut.leaves[s++] = b.leaves[j++];
+    }
+    else
+    {
+      cut.leaves[s++] = a.leaves[i++];
+      ++j;
+    }
+  }
+  cut.size = s;
+  return true;
+}
+
+/* expresses the function of sub over the leaves of cut */
+uint64_t expand_function( const cut_cnf_cut& sub, const cut_cnf_cut& cut )
+{
+  unsigned pos[6];
+  for ( auto i = 0u, j = 0u; i < sub.size; ++i )
+  {
+    while ( cut.leaves[j] != sub.leaves[i] ) { ++j; }
+    pos[i] = j;
+  }
+
+  uint64_t function = 0ul;
+  for ( auto m = 0u; m < 64u; ++m )
+  {
+    auto index = 0u;
+    for ( auto i = 0u; i < sub.size; ++i )
+    {
+      index |= ( ( m >> pos[i] ) & 1u ) << i;
+    }
+    function |= ( ( sub.function >> index ) & 1ul ) << m;
+  }
+  return function;
+}
+
+bool cut_dominates( const cut_cnf_cut& a, const cut_cnf_cut& b )
+{
+  return a.size <= b.size && std::includes( b.leaves, b.leaves + b.size, a.leaves, a.leaves + a.size );
+}
+
+/******************************************************************************
+ * Public functions                                                           *
+ ******************************************************************************/
+
+aig_cut_cnf_mapping compute_aig_cut_cnf_mapping( const aig_graph& aig, cnf_manager& manager,
+                                                 const properties::ptr& settings,
+                                                 const properties::ptr& statistics )
+{
+  /* settings */
+  /* at least the cut of the two fanins must fit and be kept */
+  const auto cut_size        = std::max( std::min( get( settings, "cut_size", 4u ), 6u ), 2u );
+  const auto priority_cuts   = std::max( get( settings, "priority_cuts", 8u ), 1u );
+  const auto area_iterations = std::max( get( settings, "area_iterations", 2u ), 1u );
+
+  /* timer */
+  properties_timer t( statistics );
+
+  const auto& info = aig_info( aig );
+  const auto complement = boost::get( boost::edge_complement, aig );
+  const auto n = boost::num_vertices( aig );
+
+  std::vector<aig_node> topsort( n );
+  boost::topological_sort( aig, topsort.begin() );
+
+  /* fanout based reference estimation */
+  std::vector<float> refs( n, 0.0f );
+  for ( const auto& node : topsort )
+  {
+    for ( const auto& child : boost::make_iterator_range( boost::adjacent_vertices( node, aig ) ) )
+    {
+      refs[child] += 1.0f;
+    }
+  }
+  for ( const auto& output : info.outputs )
+  {
+    refs[output.first.node] += 1.0f;
+  }
+
+  std::vector<std::vector<cut_cnf_cut>> cuts( n );
+  std::vector<float> flows( n, 0.0f );
+  std::vector<unsigned> mapped_refs( n );
+  std::vector<aig_node> stack;
+
+  aig_cut_cnf_mapping mapping;
+
+  for ( auto round = 0u; round < area_iterations; ++round )
+  {
+    for ( const auto& node : topsort )
+    {
+      auto& node_cuts = cuts[node];
+      node_cuts.clear();
+
+      if ( !boost::out_degree( node, aig ) ) { continue; }
+
+      auto it = boost::out_edges( node, aig ).first;
+      const auto e0 = *it++;
+      const auto e1 = *it;
+      const auto c0 = boost::target( e0, aig );
+      const auto c1 = boost::target( e1, aig );
+
+      auto cuts0 = cuts[c0]; cuts0.push_back( trivial_cut( c0, info.constant ) );
+      auto cuts1 = cuts[c1]; cuts1.push_back( trivial_cut( c1, info.constant ) );
+
+      cut_cnf_cut cut;
+      for ( const auto& a : cuts0 )
+      {
+        for ( const auto& b : cuts1 )
+        {
+          if ( !merge_leaves( a, b, cut_size, cut ) ) { continue; }
+
+          if ( boost::find_if( node_cuts, [&cut]( const cut_cnf_cut& other ) { return cut_dominates( other, cut ); } ) != node_cuts.end() ) { continue; }
+          node_cuts.erase( std::remove_if( node_cuts.begin(), node_cuts.end(), [&cut]( const cut_cnf_cut& other ) { return cut_dominates( cut, other ); } ), node_cuts.end() );
+
+          const auto f0 = expand_function( a, cut );
+          const auto f1 = expand_function( b, cut );
+          cut.function = ( complement[e0] ? ~f0 : f0 ) & ( complement[e1] ? ~f1 : f1 );
+
+          cut.cost = manager.compute( tt( 64u, cut.function ) )->size();
+
+          cut.flow = cut.cost;
+          for ( auto i = 0u; i < cut.size; ++i )
+          {
+            cut.flow += flows[cut.leaves[i]] / std::max( refs[cut.leaves[i]], 1.0f );
+          }
+
+          node_cuts.push_back( cut );
+        }
+      }
+
+      std::sort( node_cuts.begin(), node_cuts.end(), []( const cut_cnf_cut& a, const cut_cnf_cut& b ) {
+          return a.flow < b.flow || ( a.flow == b.flow && a.size < b.size ); } );
+      if ( node_cuts.size() > priority_cuts )
+      {
+        node_cuts.resize( priority_cuts );
+      }
+
+      flows[node] = node_cuts.front().flow;
+    }
+
+    /* derive mapping from the outputs */
+    boost::fill( mapped_refs, 0u );
+    mapping.and_nodes = 0u;
+    for ( const auto& output : info.outputs )
+    {
+      stack.push_back( output.first.node );
+    }
+    while ( !stack.empty() )
+    {
+      const auto node = stack.back(); stack.pop_back();
+      if ( mapped_refs[node]++ || cuts[node].empty() ) { continue; }
+
+      const auto& best = cuts[node].front();
+      for ( auto i = 0u; i < best.size; ++i )
+      {
+        stack.push_back( best.leaves[i] );
+      }
+    }
+
+    /* blend estimated and actual references for the next round */
+    for ( const auto& node : topsort )
+    {
+      refs[node] = ( refs[node] + 2.0f * std::max( mapped_refs[node], 1u ) ) / 3.0f;
+    }
+  }
+
+  /* count AND gates in the cones of the outputs */
+  std::vector<bool> visited( n, false );
+  for ( const auto& output : info.outputs )
+  {
+    stack.push_back( output.first.node );
+  }
+  while ( !stack.empty() )
+  {
+    const auto node = stack.back(); stack.pop_back();
+    if ( visited[node] ) { continue; }
+    visited[node] = true;
+    if ( boost::out_degree( node, aig ) )
+    {
+      ++mapping.and_nodes;
+      for ( const auto& child : boost::make_iterator_range( boost::adjacent_vertices( node, aig ) ) )
+      {
+        stack.push_back( child );
+      }
+    }
+  }
+
+  /* collect selected cuts in topological order */
+  for ( const auto& node : topsort )
+  {
+    if ( !mapped_refs[node] || cuts[node].empty() ) { continue; }
+
+    const auto& best = cuts[node].front();
+    mapping.roots.push_back( node );
+    mapping.leaves.push_back( std::vector<aig_node>( best.leaves, best.leaves + best.size ) );
+    mapping.functions.push_back( best.function );
+  }
+
+  if ( statistics )
+  {
+    statistics->set( "mapped_nodes", static_cast<unsigned>( mapping.roots.size() ) );
+    statistics->set( "and_nodes", mapping.and_nodes );
+  }
+
+  return mapping;
+}
+
+}
+
+// Local Variables:
+// c-basic-offset: 2
+// eval: (c-set-offset 'substatement-open 0)
+// eval: (c-set-offset 'innamespace 0)
+// End:
@@ -0,0 +1,197 @@
+/* CirKit: A circuit toolkit
+ * Copyright (C) 2009-2015  University of Bremen
+ * Copyright (C) 2015-2016  EPFL
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file add_aig_with_cuts.hpp
+ *
+ * @brief Adds clauses from an AIG based on a cut mapping
+ *
+ * The AIG is mapped into k-feasible cuts with area flow, where the area of a
+ * cut is the number of clauses in the irredundant CNF of its function as
+ * computed by the cnf_manager.  Each selected cut then contributes one
+ * variable and its CNF cover, instead of one variable and three clauses per
+ * AND gate as in add_aig.
+ *
+ * @author Mathias Soeken
+ * @since  2.3
+ */
+
+#ifndef ADD_AIG_WITH_CUTS_HPP
+#define ADD_AIG_WITH_CUTS_HPP
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <boost/range/algorithm_ext/iota.hpp>
+
+#include <core/properties.hpp>
+#include <core/utils/range_utils.hpp>
+#include <core/utils/timer.hpp>
+
+#include <classical/aig.hpp>
+#include <classical/utils/aig_utils.hpp>
+#include <classical/utils/cnf_manager.hpp>
+
+#include <formal/sat/sat_solver.hpp>
+#include <formal/sat/operations/logic.hpp>
+
+namespace cirkit
+{
+
+/* selected cuts in topological order, leaves are inputs, the constant, or earlier roots */
+struct aig_cut_cnf_mapping
+{
+  std::vector<aig_node>              roots;
+  std::vector<std::vector<aig_node>> leaves;
+  std::vector<uint64_t>              functions; /* over leaves, replicated to 6 variables */
+
+  unsigned                           and_nodes = 0u; /* AND gates in the cones of all outputs */
+};
+
+/**
+ * Settings:
+ *   cut_size        (unsigned) : maximum cut size, between 2 and 6 (default: 4)
+ *   priority_cuts   (unsigned) : number of cuts kept per node, at least 1 (default: 8)
+ *   area_iterations (unsigned) : mapping rounds with refined reference estimation (default: 2)
+ */
+aig_cut_cnf_mapping compute_aig_cut_cnf_mapping( const aig_graph& aig, cnf_manager& manager,
+                                                 const properties::ptr& settings = properties::ptr(),
+                                                 const properties::ptr& statistics = properties::ptr() );
+
+/**
+ * Same interface as add_aig.
+ *
+ * Settings: see compute_aig_cut_cnf_mapping and
+ *   cnf_manager (std::shared_ptr<cnf_manager>) : to share covers among calls (default: new manager)
+ *
+ * Statistics:
+ *   clauses, vars            : size of the generated CNF
+ *   tseytin_clauses, tseytin_vars : size of the CNF add_aig would generate
+ *   mapped_nodes, and_nodes  : number of selected cuts and AND gates
+ *   runtime, mapping_runtime
+ */
+template<class S>
+int add_aig_with_cuts( S& solver, const aig_graph& aig, int sid, std::vector<int>& piids, std::vector<int>& poids,
+                       properties::ptr settings = properties::ptr(),
+                       properties::ptr statistics = properties::ptr() )
+{
+  /* settings */
+  auto manager = get( settings, "cnf_manager", std::shared_ptr<cnf_manager>() );
+  if ( !manager )
+  {
+    manager = std::make_shared<cnf_manager>();
+  }
+
+  /* timer */
+  properties_timer t( statistics );
+
+  const auto& info = aig_info( aig );
+  const auto start = sid;
+
+  auto mapping_statistics = std::make_shared<properties>();
+  const auto mapping = compute_aig_cut_cnf_mapping( aig, *manager, settings, mapping_statistics );
+
+  std::vector<int> node_vars( boost::num_vertices( aig ), 0 );
+  auto num_clauses = 0u;
+
+  piids.resize( info.inputs.size() );
+  for ( const auto& input : index( info.inputs ) )
+  {
+    node_vars[input.value] = piids[input.index] = sid++;
+  }
+
+  const auto node_var = [&]( const aig_node& node ) {
+    if ( !node_vars[node] )
+    {
+      assert( node == info.constant );
+      node_vars[node] = sid;
+      add_clause( solver )( {-sid} );
+      ++sid;
+      ++num_clauses;
+    }
+    return node_vars[node];
+  };
+
+  std::vector<int> clause;
+  for ( auto i = 0u; i < mapping.roots.size(); ++i )
+  {
+    const auto& leaves = mapping.leaves[i];
+    const auto var = node_vars[mapping.roots[i]] = sid++;
+
+    for ( auto cube : *manager->compute( tt( 64u, mapping.functions[i] ) ) )
+    {
+      clause.clear();
+      for ( auto x = 0u; x < leaves.size(); ++x )
+      {
+        switch ( ( cube >> ( x << 1u ) ) & 3 )
+        {
+        case 1: clause.push_back( node_var( leaves[x] ) ); break;
+        case 2: clause.push_back( -node_var( leaves[x] ) ); break;
+        }
+      }
+      clause.push_back( ( ( cube >> 12u ) & 1 ) ? var : -var );
+      add_clause( solver )( clause );
+      ++num_clauses;
+    }
+  }
+
+  auto complemented_outputs = 0u;
+  poids.resize( info.outputs.size() );
+  for ( const auto& output : index( info.outputs ) )
+  {
+    const auto& f = output.value.first;
+    const auto var = node_var( f.node );
+
+    if ( f.complemented )
+    {
+      const auto new_output = poids[output.index] = sid++;
+      not_equals( solver, var, new_output );
+      num_clauses += 2u;
+      ++complemented_outputs;
+    }
+    else
+    {
+      poids[output.index] = var;
+    }
+  }
+
+  if ( statistics )
+  {
+    const auto constant = node_vars[info.constant] ? 1u : 0u;
+    statistics->set( "clauses", num_clauses );
+    statistics->set( "vars", static_cast<unsigned>( sid - start ) );
+    statistics->set( "tseytin_clauses", 3u * mapping.and_nodes + constant + 2u * complemented_outputs );
+    statistics->set( "tseytin_vars", static_cast<unsigned>( info.inputs.size() ) + mapping.and_nodes + constant + complemented_outputs );
+    statistics->set( "mapped_nodes", static_cast<unsigned>( mapping.roots.size() ) );
+    statistics->set( "and_nodes", mapping.and_nodes );
+    statistics->set( "mapping_runtime", mapping_statistics->get<double>( "runtime" ) );
+  }
+
+  return sid;
+}
+
+}
+
+#endif
+
+// Local Variables:
+// c-basic-offset: 2
+// eval: (c-set-offset 'substatement-open 0)
+// eval: (c-set-offset 'innamespace 0)
+// End:
@@ -0,0 +1,553 @@
+/* CirKit: A circuit toolkit
+ * Copyright (C) 2009-2015  University of Bremen
+ * Copyright (C) 2015-2016  EPFL
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "sat_cec.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+
+#include <boost/format.hpp>
+#include <boost/graph/topological_sort.hpp>
+#include <boost/range/algorithm_ext/iota.hpp>
+
+#include <core/utils/range_utils.hpp>
+#include <core/utils/timer.hpp>
+#include <classical/utils/aig_utils.hpp>
+#include <classical/utils/flat_aig.hpp>
+#include <formal/sat/minisat.hpp>
+#include <formal/sat/sat_solver.hpp>
+#include <formal/sat/operations/logic.hpp>
+
+namespace cirkit
+{
+
+/******************************************************************************
+ * Types                                                                      *
+ ******************************************************************************/
+
+/*
+ * Candidate equivalence classes.  Members of a class are sorted by node
+ * index, the first member is the representative.  The phase of a node is
+ * the value of its first simulation pattern, signatures are compared after
+ * normalizing with respect to the phase.
+ */
+class cec_classes
+{
+public:
+  explicit cec_classes( unsigned size )
+    : class_id( size, -1 ),
+      phase( size )
+  {
+  }
+
+  inline bool has_class( unsigned node ) const { return class_id[node] >= 0; }
+  inline unsigned repr( unsigned node ) const { return classes[class_id[node]].front(); }
+
+  /* splits all classes according to (phase normalized) values of one additional word */
+  void refine( const std::vector<std::uint64_t>& values )
+  {
+    std::vector<std::vector<unsigned>> new_classes;
+    std::vector<unsigned> members;
+
+    for ( auto& cls : classes )
+    {
+      if ( cls.size() < 2u ) { continue; }
+
+      members = cls;
+      std::stable_sort( members.begin(), members.end(), [&]( unsigned a, unsigned b ) { return normalized( values, a ) < normalized( values, b ); } );
+
+      auto first = 0u;
+      while ( first < members.size() )
+      {
+        auto last = first + 1u;
+        const auto key = normalized( values, members[first] );
+        while ( last < members.size() && normalized( values, members[last] ) == key ) { ++last; }
+
+        if ( last - first > 1u )
+        {
+          new_classes.push_back( std::vector<unsigned>( members.begin() + first, members.begin() + last ) );
+          std::sort( new_classes.back().begin(), new_classes.back().end() );
+        }
+        else
+        {
+          class_id[members[first]] = -1;
+        }
+        first = last;
+      }
+    }
+
+    classes.swap( new_classes );
+    update_ids();
+  }
+
+  /* removes a node, which has been merged into its representative */
+  void remove( unsigned node )
+  {
+    auto& cls = classes[class_id[node]];
+    cls.erase( std::find( cls.begin(), cls.end(), node ) );
+    class_id[node] = -1;
+
+    if ( cls.size() == 1u )
+    {
+      class_id[cls.front()] = -1;
+      cls.clear();
+    }
+  }
+
+  void update_ids()
+  {
+    for ( const auto& cls : index( classes ) )
+    {
+      for ( auto n : cls.value )
+      {
+        class_id[n] = cls.index;
+      }
+    }
+  }
+
+  unsigned long memory() const
+  {
+    unsigned long mem = class_id.capacity() * sizeof( int ) + phase.num_blocks() * sizeof( boost::dynamic_bitset<>::block_type );
+    for ( const auto& cls : classes )
+    {
+      mem += cls.capacity() * sizeof( unsigned );
+    }
+    return mem;
+  }
+
+private:
+  inline std::uint64_t normalized( const std::vector<std::uint64_t>& values, unsigned node ) const
+  {
+    return phase[node] ? ~values[node] : values[node];
+  }
+
+public:
+  std::vector<std::vector<unsigned>> classes;
+  std::vector<int>                   class_id;
+  boost::dynamic_bitset<>            phase;
+};
+
+/******************************************************************************
+ * Private functions                                                          *
+ ******************************************************************************/
+
+cec_classes compute_initial_classes( const flat_aig& miter, const std::vector<std::uint64_t>& sims, unsigned num_words )
+{
+  cec_classes cc( miter.size() );
+
+  for ( auto n = 0u; n < miter.size(); ++n )
+  {
+    cc.phase[n] = sims[n * num_words] & 1u;
+  }
+
+  const auto compare = [&]( unsigned a, unsigned b ) {
+    const auto ma = cc.phase[a] ? ~0ull : 0ull;
+    const auto mb = cc.phase[b] ? ~0ull : 0ull;
+    for ( auto w = 0u; w < num_words; ++w )
+    {
+      const auto va = sims[a * num_words + w] ^ ma;
+      const auto vb = sims[b * num_words + w] ^ mb;
+      if ( va != vb ) { return va < vb; }
+    }
+    return false;
+  };
+
+  std::vector<unsigned> order( miter.size() );
+  boost::iota( order, 0u );
+  std::stable_sort( order.begin(), order.end(), compare );
+
+  auto first = 0u;
+  while ( first < order.size() )
+  {
+    auto last = first + 1u;
+    while ( last < order.size() && !compare( order[first], order[last] ) ) { ++last; }
+
+    if ( last - first > 1u )
+    {
+      cc.classes.push_back( std::vector<unsigned>( order.begin() + first, order.begin() + last ) );
+      std::sort( cc.classes.back().begin(), cc.classes.back().end() );
+    }
+    first = last;
+  }
+
+  cc.update_ids();
+  return cc;
+}
+
+/* evaluates all nodes of an AIG under an input pattern */
+boost::dynamic_bitset<> evaluate_aig( const aig_graph& aig, const boost::dynamic_bitset<>& pattern )
+{
+  const auto& info = aig_info( aig );
+
+  boost::dynamic_bitset<> values( boost::num_vertices( aig ) );
+  for ( const auto& input : index( info.inputs ) )
+  {
+    values[input.value] = pattern[input.index];
+  }
+
+  std::vector<aig_node> topsort( boost::num_vertices( aig ) );
+  boost::topological_sort( aig, topsort.begin() );
+
+  for ( const auto& node : topsort )
+  {
+    if ( !boost::out_degree( node, aig ) ) { continue; }
+
+    const auto children = get_children( aig, node );
+    values[node] = ( values[children[0u].node] != children[0u].complemented ) && ( values[children[1u].node] != children[1u].complemented );
+  }
+
+  return values;
+}
+
+/* counterexample format: all internal nodes|outputs|expected_outputs (as in abc_cec) */
+counterexample_t make_counterexample( const aig_graph& circuit, const aig_graph& spec, const boost::dynamic_bitset<>& pattern )
+{
+  const auto& circuit_info = aig_info( circuit );
+  const auto& spec_info = aig_info( spec );
+
+  counterexample_t cex( boost::num_vertices( circuit ) - 1u, circuit_info.outputs.size() );
+
+  /* internal nodes */
+  const auto circuit_values = evaluate_aig( circuit, pattern );
+  for ( const auto& node : boost::make_iterator_range( boost::vertices( circuit ) ) )
+  {
+    if ( node == 0u ) { continue; }
+    cex.in.bits[node - 1u] = circuit_values[node];
+    cex.in.mask[node - 1u] = 1u;
+  }
+
+  /* circuit outputs */
+  for ( const auto& po : index( circuit_info.outputs ) )
+  {
+    cex.out.bits[po.index] = circuit_values[po.value.first.node] != po.value.first.complemented;
+    cex.out.mask[po.index] = 1u;
+  }
+
+  /* spec outputs */
+  const auto spec_values = evaluate_aig( spec, pattern );
+  for ( const auto& po : index( spec_info.outputs ) )
+  {
+    cex.expected_out.bits[po.index] = spec_values[po.value.first.node] != po.value.first.complemented;
+    cex.expected_out.mask[po.index] = 1u;
+  }
+
+  return cex;
+}
+
+/* incremental Tseytin encoding of the miter, proven nodes are mapped to the literal of their representative */
+class cec_encoder
+{
+public:
+  cec_encoder( const flat_aig& miter, minisat_solver& solver )
+    : miter( miter ),
+      solver( solver ),
+      node_lit( miter.size(), 0 )
+  {
+    /* constant */
+    node_lit[0u] = sid++;
+    add_clause( solver )( {-node_lit[0u]} );
+  }
+
+  int lit( unsigned miter_lit )
+  {
+    const auto l = encode( miter_lit >> 1u );
+    return ( miter_lit & 1u ) ? -l : l;
+  }
+
+  inline void merge( unsigned node, int repr_lit )
+  {
+    node_lit[node] = repr_lit;
+  }
+
+  /* reads the input assignment from a model, inputs outside the encoded cones are 0 */
+  boost::dynamic_bitset<> pattern( const boost::dynamic_bitset<>& model ) const
+  {
+    boost::dynamic_bitset<> p( miter.num_pis );
+    for ( auto i = 0u; i < miter.num_pis; ++i )
+    {
+      const auto l = node_lit[i + 1u];
+      p[i] = l != 0 && model[l - 1];
+    }
+    return p;
+  }
+
+private:
+  int encode( unsigned node )
+  {
+    if ( node_lit[node] ) { return node_lit[node]; }
+
+    stack.push_back( node );
+    while ( !stack.empty() )
+    {
+      const auto n = stack.back();
+
+      if ( node_lit[n] ) { stack.pop_back(); continue; }
+
+      if ( !miter.is_and( n ) )
+      {
+        node_lit[n] = sid++;
+        /* makes sure the solver knows the variable when used in assumptions */
+        add_clause( solver )( {node_lit[n], -node_lit[n]} );
+        stack.pop_back();
+        continue;
+      }
+
+      const auto c0 = miter.fanin0[n] >> 1u;
+      const auto c1 = miter.fanin1[n] >> 1u;
+      if ( !node_lit[c0] ) { stack.push_back( c0 ); continue; }
+      if ( !node_lit[c1] ) { stack.push_back( c1 ); continue; }
+
+      const auto a = ( miter.fanin0[n] & 1u ) ? -node_lit[c0] : node_lit[c0];
+      const auto b = ( miter.fanin1[n] & 1u ) ? -node_lit[c1] : node_lit[c1];
+      node_lit[n] = sid++;
+      logic_and( solver, a, b, node_lit[n] );
+      stack.pop_back();
+    }
+
+    return node_lit[node];
+  }
+
+private:
+  const flat_aig&       miter;
+  minisat_solver&       solver;
+  std::vector<int>      node_lit;
+  std::vector<unsigned> stack;
+  int                   sid = 1;
+};
+
+/******************************************************************************
+ * Public functions                                                           *
+ ******************************************************************************/
+
+boost::optional<counterexample_t> sat_cec( const aig_graph& circuit, const aig_graph& spec,
+                                           const properties::ptr& settings,
+                                           const properties::ptr& statistics )
+{
+  /* settings */
+  const auto num_words = get( settings, "sim_words", 8u );
+  const auto seed      = get( settings, "seed",      0u );
+  const auto verbose   = get( settings, "verbose",   false );
+
+  /* timer */
+  properties_timer t( statistics );
+  auto miter_runtime  = 0.0;
+  auto sim_runtime    = 0.0;
+  auto refine_runtime = 0.0;
+  auto sat_runtime    = 0.0;
+  auto output_runtime = 0.0;
+
+  const auto& circuit_info = aig_info( circuit );
+  const auto& spec_info = aig_info( spec );
+  const auto num_inputs = circuit_info.inputs.size();
+  const auto num_outputs = circuit_info.outputs.size();
+  assert( num_inputs == spec_info.inputs.size() );
+  assert( num_outputs == spec_info.outputs.size() );
+
+  /* miter */
+  /* miter with shared inputs */
+  flat_aig miter( num_inputs, true );
+  std::vector<unsigned> circuit_outputs, spec_outputs;
+  {
+    increment_timer t( &miter_runtime );
+    circuit_outputs = miter.add_aig( circuit );
+    spec_outputs    = miter.add_aig( spec );
+  }
+
+  /* random simulation */
+  std::mt19937_64 gen( seed );
+  std::vector<std::uint64_t> sims( miter.size() * num_words );
+  {
+    increment_timer t( &sim_runtime );
+    std::generate( sims.begin() + num_words, sims.begin() + ( num_inputs + 1u ) * num_words, std::ref( gen ) );
+    miter.simulate( sims, num_words );
+  }
+
+  const auto write_statistics = [&]( unsigned long sat_calls, unsigned long proved, unsigned long disproved, const cec_classes* cc, const solver_execution_statistics* stats ) {
+    if ( !statistics ) { return; }
+
+    statistics->set( "miter_runtime",  miter_runtime );
+    statistics->set( "sim_runtime",    sim_runtime );
+    statistics->set( "refine_runtime", refine_runtime );
+    statistics->set( "sat_runtime",    sat_runtime );
+    statistics->set( "output_runtime", output_runtime );
+    statistics->set( "miter_nodes",    miter.size() );
+    statistics->set( "miter_memory",   miter.memory() );
+    statistics->set( "sim_memory",     static_cast<unsigned long>( sims.capacity() * sizeof( std::uint64_t ) ) );
+    statistics->set( "class_memory",   cc ? cc->memory() : 0ul );
+    statistics->set( "sat_calls",      sat_calls );
+    statistics->set( "proved",         proved );
+    statistics->set( "disproved",      disproved );
+    statistics->set( "sat_vars",       stats ? stats->num_vars : 0u );
+    statistics->set( "sat_clauses",    stats ? stats->num_clauses : 0u );
+  };
+
+  /* outputs that already differ in simulation */
+  for ( auto j = 0u; j < num_outputs; ++j )
+  {
+    for ( auto w = 0u; w < num_words; ++w )
+    {
+      const auto word = [&]( unsigned lit ) { return ( lit & 1u ) ? ~sims[( lit >> 1u ) * num_words + w] : sims[( lit >> 1u ) * num_words + w]; };
+      const auto diff = word( circuit_outputs[j] ) ^ word( spec_outputs[j] );
+      if ( !diff ) { continue; }
+
+      auto bit = 0u;
+      while ( !( ( diff >> bit ) & 1u ) ) { ++bit; }
+
+      boost::dynamic_bitset<> pattern( num_inputs );
+      for ( auto i = 0u; i < num_inputs; ++i )
+      {
+        pattern[i] = ( sims[( i + 1u ) * num_words + w] >> bit ) & 1u;
+      }
+
+      if ( verbose )
+      {
+        std::cout << boost::format( "[i] output %d differs in random simulation" ) % j << std::endl;
+      }
+
+      write_statistics( 0ul, 0ul, 0ul, nullptr, nullptr );
+      return make_counterexample( circuit, spec, pattern );
+    }
+  }
+
+  /* candidate equivalence classes */
+  cec_classes cc( 0u );
+  {
+    increment_timer t( &refine_runtime );
+    cc = compute_initial_classes( miter, sims, num_words );
+  }
+  set( statistics, "initial_classes", static_cast<unsigned>( cc.classes.size() ) );
+
+  if ( verbose )
+  {
+    std::cout << boost::format( "[i] miter: %d nodes, %d candidate classes" ) % miter.size() % cc.classes.size() << std::endl;
+  }
+
+  /* SAT sweeping */
+  auto solver = make_solver<minisat_solver>();
+  solver_execution_statistics stats;
+  cec_encoder enc( miter, solver );
+
+  auto sat_calls = 0ul, proved = 0ul, disproved = 0ul;
+  std::vector<std::uint64_t> values( miter.size() );
+
+  /* simulates the counterexample and all its distance-1 neighbors */
+  const auto refine = [&]( const boost::dynamic_bitset<>& model ) {
+    increment_timer t( &refine_runtime );
+
+    const auto pattern = enc.pattern( model );
+    for ( auto i = 0u; i < num_inputs; ++i )
+    {
+      values[i + 1u] = pattern[i] ? ~0ull : 0ull;
+    }
+    for ( auto b = 1u; b < 64u; ++b )
+    {
+      values[1u + gen() % num_inputs] ^= 1ull << b;
+    }
+
+    miter.simulate( values, 1u );
+    cc.refine( values );
+  };
+
+  /* checks whether l1 and l2 can differ */
+  const auto check_diff = [&]( int l1, int l2 ) -> solver_result_t {
+    solver_result_t result;
+
+    {
+      increment_timer t( &sat_runtime );
+      ++sat_calls;
+      result = solve( solver, stats, {l1, -l2} );
+      if ( !result )
+      {
+        ++sat_calls;
+        result = solve( solver, stats, {-l1, l2} );
+      }
+    }
+
+    return result;
+  };
+
+  for ( auto n = 1u; n < miter.size(); ++n )
+  {
+    while ( cc.has_class( n ) )
+    {
+      const auto r = cc.repr( n );
+      if ( r == n ) { break; }
+
+      const auto ln = enc.lit( n << 1u );
+      const auto lr = enc.lit( ( r << 1u ) | ( cc.phase[n] != cc.phase[r] ) );
+
+      const auto result = check_diff( ln, lr );
+      if ( result )
+      {
+        ++disproved;
+        refine( result->first );
+      }
+      else
+      {
+        ++proved;
+        enc.merge( n, lr );
+        cc.remove( n );
+      }
+    }
+  }
+
+  if ( verbose )
+  {
+    std::cout << boost::format( "[i] SAT sweeping: %d proved, %d disproved, %d SAT calls" ) % proved % disproved % sat_calls << std::endl;
+  }
+
+  /* outputs */
+  boost::optional<counterexample_t> cex;
+  {
+    increment_timer t( &output_runtime );
+
+    for ( auto j = 0u; j < num_outputs; ++j )
+    {
+      if ( circuit_outputs[j] == spec_outputs[j] ) { continue; }
+
+      const auto lc = enc.lit( circuit_outputs[j] );
+      const auto ls = enc.lit( spec_outputs[j] );
+      if ( lc == ls ) { continue; }
+
+      const auto result = check_diff( lc, ls );
+      if ( result )
+      {
+        if ( verbose )
+        {
+          std::cout << boost::format( "[i] output %d is not equivalent" ) % j << std::endl;
+        }
+
+        cex = make_counterexample( circuit, spec, enc.pattern( result->first ) );
+        break;
+      }
+    }
+  }
+
+  write_statistics( sat_calls, proved, disproved, &cc, &stats );
+
+  return cex;
+}
+
+}
+
+// Local Variables:
+// c-basic-offset: 2
+// eval: (c-set-offset 'substatement-open 0)
+// eval: (c-set-offset 'innamespace 0)
+// End:
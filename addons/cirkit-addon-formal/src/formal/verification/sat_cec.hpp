@@ -0,0 +1,75 @@
+/* CirKit: A circuit toolkit
+ * Copyright (C) 2009-2015  University of Bremen
+ * Copyright (C) 2015-2016  EPFL
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file sat_cec.hpp
+ *
+ * @brief Combinational equivalence checking based on SAT sweeping
+ *
+ * The miter of both AIGs is built with shared inputs and structural
+ * hashing.  Word-parallel random simulation partitions the miter nodes
+ * into candidate equivalence classes, which are then proven or refuted in
+ * topological order with one incremental SAT solver.  Proven nodes are
+ * merged into their representative, counterexamples are re-simulated to
+ * refine the classes.
+ *
+ * @author Mathias Soeken
+ * @since  2.3
+ */
+
+#ifndef SAT_CEC_HPP
+#define SAT_CEC_HPP
+
+#include <boost/optional.hpp>
+
+#include <core/properties.hpp>
+#include <classical/aig.hpp>
+#include <classical/utils/counterexample.hpp>
+
+namespace cirkit
+{
+
+/**
+ * @brief Checks two AIGs for combinational equivalence without ABC
+ *
+ * Returns a counterexample in the same format as abc_cec, or nothing if
+ * both circuits are equivalent.
+ *
+ * Settings:
+ *   sim_words   (unsigned) : number of 64-bit simulation words per node (default: 8)
+ *   seed        (unsigned) : seed for random simulation (default: 0)
+ *   verbose     (bool)     : print progress information (default: false)
+ *
+ * Statistics:
+ *   runtime, miter_runtime, sim_runtime, refine_runtime, sat_runtime, output_runtime
+ *   miter_memory, sim_memory, class_memory (in bytes)
+ *   miter_nodes, initial_classes, sat_calls, proved, disproved, sat_vars, sat_clauses
+ */
+boost::optional<counterexample_t> sat_cec( const aig_graph& circuit, const aig_graph& spec,
+                                           const properties::ptr& settings = properties::ptr(),
+                                           const properties::ptr& statistics = properties::ptr() );
+
+}
+
+#endif
+
+// Local Variables:
+// c-basic-offset: 2
+// eval: (c-set-offset 'substatement-open 0)
+// eval: (c-set-offset 'innamespace 0)
+// End:
@@ -18,7 +18,9 @@
 
 #include "unate.hpp"
 
+#include <cstdint>
 #include <mutex>
+#include <random>
 
 #include <boost/assign/std/vector.hpp>
 #include <boost/range/algorithm.hpp>
@@ -32,12 +34,14 @@
 #include <classical/functions/strash.hpp>
 #include <classical/io/write_aiger.hpp>
 #include <classical/utils/aig_utils.hpp>
+#include <classical/utils/flat_aig.hpp>
 #include <abc/abc_api.hpp>
 #include <abc/functions/cirkit_to_gia.hpp>
 #include <formal/sat/minisat.hpp>
 #include <formal/sat/sat_solver.hpp>
 #include <formal/sat/operations/logic.hpp>
 #include <formal/sat/utils/add_aig.hpp>
+#include <formal/sat/utils/add_aig_with_cuts.hpp>
 #include <formal/sat/utils/add_aig_with_gia.hpp>
 #include <formal/sat/utils/add_dimacs.hpp>
 
@@ -284,6 +288,233 @@ reset_assumptions:
   return result;
 }
 
+/*
+ * Random simulation of both cofactors for each input.  For each pair (j, i)
+ * two bits are set: the first if some pattern shows that output j rises
+ * with input i, the second if some pattern shows that it falls.  If both
+ * are set, the pair is binate.
+ */
+boost::dynamic_bitset<> unateness_simulation_witnesses( const flat_aig& flat, unsigned num_words, unsigned seed )
+{
+  const auto n = flat.num_pis;
+  const auto m = flat.outputs.size();
+
+  boost::dynamic_bitset<> witnesses( ( m * n ) << 1u );
+  if ( !num_words ) { return witnesses; }
+
+  std::mt19937_64 gen( seed );
+  std::vector<std::uint64_t> base( ( n + 1u ) * num_words );
+  std::generate( base.begin() + num_words, base.end(), std::ref( gen ) );
+
+  std::vector<std::uint64_t> values1( flat.size() * num_words ), values0( flat.size() * num_words );
+
+  const auto word = [num_words]( const std::vector<std::uint64_t>& values, unsigned lit, unsigned w ) {
+    return ( lit & 1u ) ? ~values[( lit >> 1u ) * num_words + w] : values[( lit >> 1u ) * num_words + w];
+  };
+
+  for ( auto i = 0u; i < n; ++i )
+  {
+    std::copy( base.begin(), base.end(), values1.begin() );
+    std::copy( base.begin(), base.end(), values0.begin() );
+    std::fill( values1.begin() + ( i + 1u ) * num_words, values1.begin() + ( i + 2u ) * num_words, ~0ull );
+    std::fill( values0.begin() + ( i + 1u ) * num_words, values0.begin() + ( i + 2u ) * num_words, 0ull );
+
+    flat.simulate( values1, num_words );
+    flat.simulate( values0, num_words );
+
+    for ( auto j = 0u; j < m; ++j )
+    {
+      const auto pos = ( j * n + i ) << 1u;
+      for ( auto w = 0u; w < num_words; ++w )
+      {
+        const auto f1 = word( values1, flat.outputs[j], w );
+        const auto f0 = word( values0, flat.outputs[j], w );
+        if (  f1 & ~f0 ) { witnesses.set( pos ); }
+        if ( ~f1 &  f0 ) { witnesses.set( pos + 1u ); }
+      }
+    }
+  }
+
+  return witnesses;
+}
+
+struct unateness_incremental_statistics
+{
+  double        sat_runtime = 0.0;
+  unsigned long sat_calls   = 0ul;
+  unsigned long sim_decided = 0ul;
+};
+
+/*
+ * One solver for the cone of output j.  The cone is encoded twice, the
+ * copies share the inputs unless the selector of an input is assigned to
+ * true.  Each check selects one input and fixes the outputs by
+ * assumptions.
+ */
+boost::dynamic_bitset<> unateness_incremental_output( const flat_aig& flat, unsigned j, const boost::dynamic_bitset<>& witnesses,
+                                                      unateness_incremental_statistics& ustats )
+{
+  const auto n = flat.num_pis;
+  const auto cone = flat.cone( flat.outputs[j] );
+
+  boost::dynamic_bitset<> result( n << 1u );
+  result.set(); /* independent, unless in the support */
+
+  /* create solver */
+  auto solver = make_solver<minisat_solver>();
+  solver_gen_model( solver, false );
+  solver_execution_statistics stats;
+
+  auto sid = 1;
+  std::vector<int> lit1( flat.size(), 0 ), lit2( flat.size(), 0 ), selectors( n, 0 );
+
+  /* constant */
+  lit1[0u] = lit2[0u] = sid++;
+  add_clause( solver )( {-lit1[0u]} );
+
+  /* inputs: selector = 0 implies equal inputs */
+  for ( auto i = 0u; i < n; ++i )
+  {
+    if ( !cone[i + 1u] ) { continue; }
+
+    lit1[i + 1u] = sid++;
+    lit2[i + 1u] = sid++;
+    selectors[i] = sid++;
+
+    add_clause( solver )( {selectors[i], -lit1[i + 1u], lit2[i + 1u]} );
+    add_clause( solver )( {selectors[i], lit1[i + 1u], -lit2[i + 1u]} );
+  }
+
+  /* gates */
+  const auto lit = []( const std::vector<int>& lits, unsigned l ) { return ( l & 1u ) ? -lits[l >> 1u] : lits[l >> 1u]; };
+  for ( auto g = n + 1u; g < flat.size(); ++g )
+  {
+    if ( !cone[g] ) { continue; }
+
+    lit1[g] = sid++;
+    logic_and( solver, lit( lit1, flat.fanin0[g] ), lit( lit1, flat.fanin1[g] ), lit1[g] );
+    lit2[g] = sid++;
+    logic_and( solver, lit( lit2, flat.fanin0[g] ), lit( lit2, flat.fanin1[g] ), lit2[g] );
+  }
+
+  const auto f1 = lit( lit1, flat.outputs[j] );
+  const auto f2 = lit( lit2, flat.outputs[j] );
+
+  /* assumptions: all selectors are 0 (except the one of the current input) */
+  std::vector<int> assumptions;
+  for ( auto i = 0u; i < n; ++i )
+  {
+    if ( selectors[i] ) { assumptions += -selectors[i]; }
+  }
+  const auto num_selectors = assumptions.size();
+
+  /* check whether f can change from f2 to f1 when input i changes from 0 to 1 */
+  const auto is_sat = [&]( unsigned i, unsigned sel_pos, int o1, int o2 ) {
+    assumptions.resize( num_selectors );
+    assumptions[sel_pos] *= -1;
+    assumptions += lit1[i + 1u],-lit2[i + 1u],o1,o2;
+
+    ++ustats.sat_calls;
+    const auto sresult = solve( solver, stats, assumptions );
+    ustats.sat_runtime += stats.runtime;
+
+    assumptions[sel_pos] *= -1;
+    return sresult != boost::none;
+  };
+
+  auto sel_pos = 0u;
+  for ( auto i = 0u; i < n; ++i )
+  {
+    if ( !selectors[i] ) { continue; }
+
+    const auto wpos = ( j * n + i ) << 1u;
+    const auto rises = witnesses[wpos] || is_sat( i, sel_pos, f1, -f2 );
+    const auto falls = witnesses[wpos + 1u] || is_sat( i, sel_pos, -f1, f2 );
+
+    if ( witnesses[wpos] && witnesses[wpos + 1u] ) { ++ustats.sim_decided; }
+
+    result[i << 1u]          = !rises;
+    result[( i << 1u ) + 1u] = !falls;
+
+    ++sel_pos;
+  }
+
+  return result;
+}
+
+boost::dynamic_bitset<> unateness_incremental_generic( const aig_graph& aig, bool parallel,
+                                                       const properties::ptr& settings,
+                                                       const properties::ptr& statistics )
+{
+  /* settings */
+  const auto num_words = get( settings, "sim_words", 4u );
+  const auto seed      = get( settings, "seed",      0u );
+  const auto progress  = get( settings, "progress",  false );
+
+  /* timer */
+  properties_timer t( statistics );
+  auto sim_runtime = 0.0;
+
+  const flat_aig flat( aig );
+  const auto n = flat.num_pis;
+  const auto m = flat.outputs.size();
+
+  /* simulation pre-pass */
+  boost::dynamic_bitset<> witnesses;
+  {
+    reference_timer t( &sim_runtime );
+    witnesses = unateness_simulation_witnesses( flat, num_words, seed );
+  }
+
+  boost::dynamic_bitset<> result( ( m * n ) << 1u );
+  unateness_incremental_statistics ustats;
+
+  std::mutex result_mutex;
+  const auto thread = [&]( unsigned j ) {
+    unateness_incremental_statistics local;
+    const auto cresult = unateness_incremental_output( flat, j, witnesses, local );
+
+    std::lock_guard<std::mutex> lock( result_mutex );
+    auto pos = ( j * n ) << 1u;
+    for ( auto b = 0u; b < cresult.size(); ++b )
+    {
+      result[pos++] = cresult[b];
+    }
+    ustats.sat_runtime += local.sat_runtime;
+    ustats.sat_calls   += local.sat_calls;
+    ustats.sim_decided += local.sim_decided;
+  };
+
+  if ( parallel )
+  {
+    thread_pool pool;
+
+    for ( auto j = 0u; j < m; ++j )
+    {
+      pool.enqueue( thread, j );
+    }
+  }
+  else
+  {
+    null_stream ns;
+    std::ostream null_out( &ns );
+    boost::progress_display show_progress( m, progress ? std::cout : null_out );
+
+    for ( auto j = 0u; j < m; ++j )
+    {
+      ++show_progress;
+      thread( j );
+    }
+  }
+
+  set( statistics, "sim_runtime", sim_runtime );
+  set( statistics, "sat_runtime", ustats.sat_runtime );
+  set( statistics, "sat_calls",   ustats.sat_calls );
+  set( statistics, "sim_decided", ustats.sim_decided );
+
+  return result;
+}
+
 /******************************************************************************
  * Public functions                                                           *
  ******************************************************************************/
@@ -295,6 +526,7 @@ boost::dynamic_bitset<> unateness_naive( const aig_graph& aig,
   /* settings */
   const auto progress = get( settings, "progress", false );
   const auto verbose  = get( settings, "verbose", false );
+  const auto cut_cnf  = get( settings, "cut_cnf", false );
 
   /* timer */
   properties_timer t( statistics );
@@ -310,8 +542,28 @@ boost::dynamic_bitset<> unateness_naive( const aig_graph& aig,
 
   /* build miter */
   std::vector<int> piids1, piids2, poids1, poids2;
-  sid = add_aig( solver, aig, sid, piids1, poids1 );
-  sid = add_aig( solver, aig, sid, piids2, poids2 );
+  if ( cut_cnf )
+  {
+    auto cnf_settings = std::make_shared<properties>();
+    cnf_settings->set( "cut_size", get( settings, "cut_size", 4u ) );
+    cnf_settings->set( "cnf_manager", std::make_shared<cnf_manager>() );
+    auto cnf_statistics = std::make_shared<properties>();
+
+    /* both copies have the same mapping, so statistics of one copy are doubled */
+    sid = add_aig_with_cuts( solver, aig, sid, piids1, poids1, cnf_settings, cnf_statistics );
+    sid = add_aig_with_cuts( solver, aig, sid, piids2, poids2, cnf_settings );
+
+    if ( statistics )
+    {
+      statistics->set( "cnf_clauses", 2u * cnf_statistics->get<unsigned>( "clauses" ) );
+      statistics->set( "tseytin_clauses", 2u * cnf_statistics->get<unsigned>( "tseytin_clauses" ) );
+    }
+  }
+  else
+  {
+    sid = add_aig( solver, aig, sid, piids1, poids1 );
+    sid = add_aig( solver, aig, sid, piids2, poids2 );
+  }
 
   /* connect inputs */
   const auto n = info.inputs.size();
@@ -509,6 +761,20 @@ boost::dynamic_bitset<> unateness_split_inputs_parallel( const aig_graph& aig,
   return result;
 }
 
+boost::dynamic_bitset<> unateness_incremental( const aig_graph& aig,
+                                               const properties::ptr& settings,
+                                               const properties::ptr& statistics )
+{
+  return unateness_incremental_generic( aig, false, settings, statistics );
+}
+
+boost::dynamic_bitset<> unateness_incremental_parallel( const aig_graph& aig,
+                                                        const properties::ptr& settings,
+                                                        const properties::ptr& statistics )
+{
+  return unateness_incremental_generic( aig, true, settings, statistics );
+}
+
 boost::dynamic_bitset<> unateness( const aig_graph& aig,
                                    const properties::ptr& settings,
                                    const properties::ptr& statistics )
@@ -63,6 +63,23 @@ boost::dynamic_bitset<> unateness_split_inputs_parallel( const aig_graph& aig,
                                                          const properties::ptr& settings = properties::ptr(),
                                                          const properties::ptr& statistics = properties::ptr() );
 
+/**
+ * Uses one incremental solver per output cone.  Both cofactor copies are
+ * encoded once, each input has a selector variable that decouples its two
+ * copies, and all checks are done under assumptions.  A random simulation
+ * pre-pass detects binate pairs before any SAT call.
+ *
+ * Settings: sim_words (default: 4), seed (default: 0), progress
+ * Statistics: runtime, sim_runtime, sat_runtime, sat_calls, sim_decided
+ */
+boost::dynamic_bitset<> unateness_incremental( const aig_graph& aig,
+                                               const properties::ptr& settings = properties::ptr(),
+                                               const properties::ptr& statistics = properties::ptr() );
+
+boost::dynamic_bitset<> unateness_incremental_parallel( const aig_graph& aig,
+                                                        const properties::ptr& settings = properties::ptr(),
+                                                        const properties::ptr& statistics = properties::ptr() );
+
 boost::dynamic_bitset<> unateness( const aig_graph& aig,
                                    const properties::ptr& settings = properties::ptr(),
                                    const properties::ptr& statistics = properties::ptr() );
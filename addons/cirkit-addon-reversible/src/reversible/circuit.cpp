@@ -209,6 +209,24 @@ namespace cirkit
     }
   };
 
+  struct reserve_visitor : public boost::static_visitor<>
+  {
+    explicit reserve_visitor( unsigned _num_gates ) : num_gates( _num_gates ) {}
+
+    void operator()( standard_circuit& circ ) const
+    {
+      circ.gates.reserve( num_gates );
+    }
+
+    void operator()( subcircuit& circ ) const
+    {
+      /* gates are owned by the base circuit */
+    }
+
+  private:
+    unsigned num_gates;
+  };
+
   struct prepend_gate_visitor : public boost::static_visitor<gate&>
   {
     gate& operator()( standard_circuit& circ ) const
@@ -708,6 +726,11 @@ namespace cirkit
     return boost::apply_visitor( append_gate_visitor(), circ );
   }
 
+  void circuit::reserve( unsigned num_gates )
+  {
+    boost::apply_visitor( reserve_visitor( num_gates ), circ );
+  }
+
   gate& circuit::prepend_gate()
   {
     return boost::apply_visitor( prepend_gate_visitor(), circ );
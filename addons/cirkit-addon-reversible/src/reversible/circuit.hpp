@@ -529,6 +529,19 @@ namespace cirkit
      */
     gate& append_gate();
 
+    /**
+     * @brief Reserves storage for gates
+     *
+     * Avoids reallocations when the number of gates is known in advance,
+     * e.g., when reading a large circuit from a file.  Has no effect on
+     * sub-circuits.
+     *
+     * @param num_gates Expected number of gates
+     *
+     * @since  2.3
+     */
+    void reserve( unsigned num_gates );
+
     /**
      * @brief Inserts a gate at the beginning of the circuit
      *
@@ -23,6 +23,8 @@
 
 #include <lscli/rules.hpp>
 
+#include <core/utils/program_options.hpp>
+
 #include <reversible/circuit.hpp>
 #include <reversible/cli/stores.hpp>
 #include <reversible/synthesis/esop_synthesis.hpp>
@@ -51,6 +53,8 @@ esopbs_command::esopbs_command( const environment::ptr& env )
   opts.add_options()
     ( "filename", value( &filename ), "Filename to the ESOP file" )
     ( "mct",                          "No negative controls" )
+    ( "reordering,r", value_with_default( &reordering ), "cube reordering for --mct:\n0: none\n1: weighted\n2: Gray code" )
+    ( "stream,s",     value( &stream ),                   "write gates directly into this RevLib file, the store is not changed" )
     ( "new,n",                        "Create new store entry" )
     ;
   be_verbose();
@@ -63,18 +67,36 @@ command::rules_t esopbs_command::validity_rules() const
 
 bool esopbs_command::execute()
 {
-  auto& circuits = env->store<circuit>();
-
-  if ( circuits.empty() || is_set( "new" ) )
+  auto settings = make_settings();
+  settings->set( "negative_control_lines", !is_set( "mct" ) );
+  switch ( reordering )
   {
-    circuits.extend();
+  case 0u: settings->set( "reordering", cube_reordering_func( no_reordering ) ); break;
+  case 2u: settings->set( "packed_reordering", esop_cube_reordering_func( gray_code_reordering() ) ); break;
+  default: break;
   }
+  if ( is_set( "stream" ) )
+  {
+    /* the gates are only written to the file, the store is not changed */
+    settings->set( "stream_filename", stream );
 
-  auto settings = make_settings();
-  settings->set( "negative_control_lines", !is_set( "mct" ) );
-  esop_synthesis( circuits.current(), filename, settings, statistics );
+    circuit circ;
+    esop_synthesis( circ, filename, settings, statistics );
+  }
+  else
+  {
+    auto& circuits = env->store<circuit>();
+
+    if ( circuits.empty() || is_set( "new" ) )
+    {
+      circuits.extend();
+    }
+
+    esop_synthesis( circuits.current(), filename, settings, statistics );
+  }
 
   std::cout << boost::format( "[i] run-time: %.2f secs" ) % statistics->get<double>( "runtime" ) << std::endl;
+  std::cout << boost::format( "[i] gates:    %d" ) % statistics->get<unsigned>( "gates", 0u ) << std::endl;
 
   return true;
 }
@@ -82,7 +104,8 @@ bool esopbs_command::execute()
 command::log_opt_t esopbs_command::log() const
 {
   return log_opt_t({
-      {"runtime", statistics->get<double>( "runtime" )}
+      {"runtime", statistics->get<double>( "runtime" )},
+      {"gates", statistics->get<unsigned>( "gates", 0u )}
     });
 }
 
@@ -49,6 +49,8 @@ public:
 
 private:
   std::string filename;
+  unsigned    reordering = 1u;
+  std::string stream;
 };
 
 }
@@ -53,6 +53,8 @@ exs_command::exs_command( const environment::ptr& env )
     ( "negative,n",                                            "Allow negative control lines" )
     ( "multiple,m",                                            "Allow multiple target lines (only with SAT)" )
     ( "all_solutions,a",                                       "Extract all solutions (only with BDD)" )
+    ( "portfolio,p",                                           "Solve several depths concurrently (only with SAT)" )
+    ( "threads",             value_with_default( &threads ),   "Number of threads in portfolio mode" )
     ( "new",                                                   "Creates a new circuit" )
     ;
   be_verbose();
@@ -81,6 +83,8 @@ bool exs_command::execute()
   settings->set( "negative",      is_set( "negative" ) );
   settings->set( "multiple",      is_set( "multiple" ) );
   settings->set( "all_solutions", is_set( "all_solutions" ) );
+  settings->set( "portfolio",     is_set( "portfolio" ) );
+  settings->set( "num_threads",   threads );
 
   circuit circ;
   auto result = false;
@@ -49,6 +49,7 @@ public:
 private:
   unsigned mode = 0u;
   unsigned max_depth = 20u;
+  unsigned threads = 4u;
 };
 
 }
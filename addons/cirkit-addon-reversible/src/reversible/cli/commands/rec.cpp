@@ -20,8 +20,11 @@
 
 #include <iostream>
 
+#include <boost/format.hpp>
+
 #include <core/utils/program_options.hpp>
 #include <reversible/cli/stores.hpp>
+#include <reversible/verification/batch_equivalence_check.hpp>
 #include <reversible/verification/xorsat_equivalence_check.hpp>
 
 namespace cirkit
@@ -35,6 +38,20 @@ namespace cirkit
  * Private functions                                                          *
  ******************************************************************************/
 
+std::string batch_status_to_string( batch_equivalence_status status )
+{
+  switch ( status )
+  {
+  case batch_equivalence_status::unchecked:           return "unchecked";
+  case batch_equivalence_status::equivalent:          return "equivalent";
+  case batch_equivalence_status::not_equivalent:      return "not equivalent";
+  case batch_equivalence_status::simulation_mismatch: return "not equivalent (simulation)";
+  case batch_equivalence_status::different_lines:     return "different lines";
+  }
+
+  return std::string();
+}
+
 /******************************************************************************
  * Public functions                                                           *
  ******************************************************************************/
@@ -45,15 +62,33 @@ rec_command::rec_command( const environment::ptr& env )
   opts.add_options()
     ( "id1", value_with_default( &id1 ), "ID of first circuit" )
     ( "id2", value_with_default( &id2 ), "ID of second circuit" )
+    ( "external",                           "write DIMACS file and call cryptominisat4 (for debugging)" )
+    ( "batch",                              "check all other circuits in the store against the circuit with ID id1" )
+    ( "sim_words",   value_with_default( &sim_words ), "64-bit words of random patterns per line in batch mode (0: no simulation)" )
+    ( "threads",     value_with_default( &threads ),   "number of threads in batch mode" )
     ;
   be_verbose();
 }
 
+command::rules_t rec_command::validity_rules() const
+{
+  return {
+    { [this]() { return id1 < env->store<circuit>().size(); }, "id1 is not a valid circuit ID" },
+    { [this]() { return is_set( "batch" ) || id2 < env->store<circuit>().size(); }, "id2 is not a valid circuit ID" }
+  };
+}
+
 bool rec_command::execute()
 {
+  if ( is_set( "batch" ) )
+  {
+    return execute_batch();
+  }
+
   const auto& circuits = env->store<circuit>();
 
   auto settings = make_settings();
+  settings->set( "external", is_set( "external" ) );
   const auto result = xorsat_equivalence_check( circuits[id1], circuits[id2], settings, statistics );
 
   if ( result )
@@ -68,8 +103,58 @@ bool rec_command::execute()
   return true;
 }
 
+bool rec_command::execute_batch()
+{
+  const auto& circuits = env->store<circuit>();
+
+  std::vector<unsigned> ids;
+  std::vector<circuit> candidates;
+  for ( auto i = 0u; i < circuits.size(); ++i )
+  {
+    if ( i != id1 )
+    {
+      ids.push_back( i );
+      candidates.push_back( circuits[i] );
+    }
+  }
+
+  auto settings = make_settings();
+  settings->set( "sim_words", sim_words );
+  settings->set( "num_threads", threads );
+  const auto results = batch_equivalence_check( circuits[id1], candidates, settings, statistics );
+
+  std::cout << boost::format( "[i] reference: %d (%d lines, %d gates)" ) % id1 % circuits[id1].lines() % circuits[id1].num_gates() << std::endl
+            << "    id   lines   gates  result                        runtime" << std::endl;
+
+  num_equivalent = 0u;
+  for ( auto i = 0u; i < results.size(); ++i )
+  {
+    std::cout << boost::format( "  %4d  %6d  %6d  %-28s  %7.2f s" ) % ids[i] % candidates[i].lines() % candidates[i].num_gates()
+                 % batch_status_to_string( results[i].status ) % results[i].runtime << std::endl;
+
+    if ( results[i].equivalent() ) { ++num_equivalent; }
+  }
+
+  std::cout << boost::format( "[i] %d of %d circuits are equivalent, %d refuted by simulation, %d SAT calls" )
+               % num_equivalent % results.size() % statistics->get<unsigned>( "simulation_mismatches" ) % statistics->get<unsigned>( "sat_calls" ) << std::endl
+            << boost::format( "[i] run-time: %.2f secs (simulation: %.2f secs, proofs: %.2f secs)" )
+               % statistics->get<double>( "runtime" ) % statistics->get<double>( "sim_runtime" ) % statistics->get<double>( "proof_runtime" ) << std::endl;
+
+  return true;
+}
+
 command::log_opt_t rec_command::log() const
 {
+  if ( is_set( "batch" ) )
+  {
+    return log_opt_t({
+        {"equivalent", num_equivalent},
+        {"simulation_mismatches", statistics->get<unsigned>( "simulation_mismatches" )},
+        {"sat_calls", statistics->get<unsigned>( "sat_calls" )},
+        {"runtime", statistics->get<double>( "runtime" )}
+      });
+  }
+
   return boost::none;
 }
 
@@ -39,14 +39,23 @@ public:
   rec_command( const environment::ptr& env );
 
 protected:
+  rules_t validity_rules() const;
   bool execute();
 
 public:
   log_opt_t log() const;
 
+private:
+  bool execute_batch();
+
 private:
   unsigned id1 = 0u;
   unsigned id2 = 1u;
+
+  unsigned sim_words = 16u;
+  unsigned threads   = 1u;
+
+  unsigned num_equivalent = 0u;
 };
 
 }
@@ -18,7 +18,13 @@
 
 #include "revsimp.hpp"
 
+#include <iostream>
+
+#include <boost/format.hpp>
+
 #include <lscli/rules.hpp>
+
+#include <core/utils/program_options.hpp>
 #include <reversible/circuit.hpp>
 #include <reversible/cli/stores.hpp>
 #include <reversible/optimization/simplify.hpp>
@@ -41,6 +47,9 @@ namespace cirkit
 revsimp_command::revsimp_command( const environment::ptr& env )
   : cirkit_command( env, "Reversible circuit simplification" )
 {
+  opts.add_options()
+    ( "search_depth,d", value_with_default( &search_depth ), "maximum number of gates that are skipped when looking for a partner gate" )
+    ;
   add_new_option();
 }
 
@@ -54,6 +63,7 @@ bool revsimp_command::execute()
   auto& circuits = env->store<circuit>();
 
   auto settings = make_settings();
+  settings->set( "search_depth", search_depth );
   circuit circ;
   simplify( circ, circuits.current(), settings, statistics );
 
@@ -61,13 +71,18 @@ bool revsimp_command::execute()
   circuits.current() = circ;
 
   print_runtime();
+  std::cout << boost::format( "[i] cancellations: %d, merges: %d" ) % statistics->get<unsigned>( "cancellations" ) % statistics->get<unsigned>( "merges" ) << std::endl;
 
   return true;
 }
 
 command::log_opt_t revsimp_command::log() const
 {
-  return log_opt_t({{"runtime", statistics->get<double>( "runtime" )}});
+  return log_opt_t({
+      {"runtime", statistics->get<double>( "runtime" )},
+      {"cancellations", statistics->get<unsigned>( "cancellations" )},
+      {"merges", statistics->get<unsigned>( "merges" )}
+    });
 }
 
 }
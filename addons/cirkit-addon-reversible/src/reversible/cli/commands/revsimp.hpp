@@ -44,6 +44,9 @@ protected:
 
 public:
   log_opt_t log() const;
+
+private:
+  unsigned search_depth = 32u;
 };
 
 }
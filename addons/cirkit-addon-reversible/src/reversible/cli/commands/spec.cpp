@@ -29,7 +29,6 @@
 #include <reversible/cli/stores.hpp>
 #include <reversible/functions/circuit_to_truth_table.hpp>
 #include <reversible/functions/permutation_to_truth_table.hpp>
-#include <reversible/simulation/simple_simulation.hpp>
 
 using namespace boost::program_options;
 
@@ -62,7 +61,8 @@ command::rules_t spec_command::validity_rules() const
 {
   return {
     { [this]() { return is_set( "circuit" ) != is_set( "permutation" ); }, "either circuit or permutation must be set" },
-    { [this]() { return !is_set( "circuit" ) || env->store<circuit>().current_index() >= 0; }, "no circuit in store" }
+    { [this]() { return !is_set( "circuit" ) || env->store<circuit>().current_index() >= 0; }, "no circuit in store" },
+    { [this]() { return !is_set( "circuit" ) || env->store<circuit>().current().lines() <= 32u; }, "circuit must not have more than 32 lines" }
   };
 }
 
@@ -82,7 +82,7 @@ bool spec_command::execute()
     const auto& circ = circuits.current();
 
     binary_truth_table spec;
-    circuit_to_truth_table( circ, spec, simple_simulation_func() );
+    circuit_to_truth_table( circ, spec );
 
     specs.current() = spec;
   }
@@ -0,0 +1,302 @@
+/* CirKit: A circuit toolkit
+ * Copyright (C) 2009-2015  University of Bremen
+ * Copyright (C) 2015-2016  EPFL
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "dense_truth_table.hpp"
+
+#include <algorithm>
+
+#include <boost/range/iterator_range.hpp>
+
+namespace cirkit
+{
+
+/******************************************************************************
+ * dense_truth_table_iterator                                                 *
+ ******************************************************************************/
+
+dense_truth_table_iterator::dense_truth_table_iterator( const dense_truth_table* table, std::uint64_t row )
+  : table( table ),
+    _row( row )
+{
+  skip_unspecified();
+}
+
+void dense_truth_table_iterator::increment()
+{
+  ++_row;
+  skip_unspecified();
+}
+
+void dense_truth_table_iterator::skip_unspecified()
+{
+  if ( table->is_fully_specified() ) { return; }
+
+  while ( _row < table->num_rows() && !table->is_specified( _row ) )
+  {
+    ++_row;
+  }
+}
+
+transform_cube<boost::optional<bool>>::result_type dense_truth_table_iterator::dereference() const
+{
+  in_cube = number_to_truth_table_cube( _row, table->num_inputs() );
+
+  out_cube.resize( table->num_outputs() );
+  for ( auto j = 0u; j < table->num_outputs(); ++j )
+  {
+    out_cube[j] = table->get( _row, j );
+  }
+
+  const auto& perm = table->permutation();
+  return std::make_pair( std::make_pair( in_cube.cbegin(), in_cube.cend() ),
+                         std::make_pair( boost::make_permutation_iterator( out_cube.cbegin(), perm.begin() ),
+                                         boost::make_permutation_iterator( out_cube.cend(), perm.end() ) ) );
+}
+
+/******************************************************************************
+ * dense_truth_table                                                          *
+ ******************************************************************************/
+
+dense_truth_table::dense_truth_table( unsigned num_inputs, unsigned num_outputs )
+  : _num_inputs( num_inputs ),
+    _num_outputs( num_outputs ),
+    _words_per_row( std::max( 1u, ( num_outputs + 63u ) >> 6u ) ),
+    _values( num_rows() * _words_per_row, 0ull ),
+    _care( num_rows() * _words_per_row, 0ull ),
+    _permutation( num_outputs ),
+    _constants( num_inputs ),
+    _garbage( num_outputs, false )
+{
+  assert( num_inputs < 32u );
+
+  for ( auto i = 0u; i < num_outputs; ++i )
+  {
+    _permutation[i] = i;
+  }
+}
+
+dense_truth_table::dense_truth_table( const std::vector<unsigned>& perm )
+  : dense_truth_table( 0u, 0u )
+{
+  auto n = 0u;
+  while ( ( 1u << n ) < perm.size() ) { ++n; }
+  assert( ( 1u << n ) == perm.size() );
+
+  *this = dense_truth_table( n, n );
+  std::copy( perm.begin(), perm.end(), _values.begin() );
+  _care.clear();
+}
+
+dense_truth_table::dense_truth_table( const binary_truth_table& spec )
+  : dense_truth_table( spec.num_inputs(), spec.num_outputs() )
+{
+  std::vector<unsigned> dc;
+
+  for ( const auto& row : spec )
+  {
+    /* input cube to minterm base and positions of don't cares */
+    std::uint64_t base = 0u;
+    dc.clear();
+
+    auto pos = 0u;
+    for ( const auto& in : boost::make_iterator_range( row.first ) )
+    {
+      const auto bit = _num_inputs - 1u - pos++;
+      if ( !in )
+      {
+        dc.push_back( bit );
+      }
+      else if ( *in )
+      {
+        base |= std::uint64_t( 1u ) << bit;
+      }
+    }
+
+    for ( std::uint64_t sub = 0u; sub < ( std::uint64_t( 1u ) << dc.size() ); ++sub )
+    {
+      auto r = base;
+      for ( auto k = 0u; k < dc.size(); ++k )
+      {
+        if ( ( sub >> k ) & 1u )
+        {
+          r |= std::uint64_t( 1u ) << dc[k];
+        }
+      }
+
+      auto j = 0u;
+      for ( const auto& out : boost::make_iterator_range( row.second ) )
+      {
+        if ( out )
+        {
+          set( r, j, out );
+        }
+        ++j;
+      }
+    }
+  }
+
+  /* drop care plane if everything is specified */
+  auto full = true;
+  for ( std::uint64_t r = 0u; r < num_rows() && full; ++r )
+  {
+    for ( auto k = 0u; k < _words_per_row; ++k )
+    {
+      if ( _care[r * _words_per_row + k] != full_care_word( k ) )
+      {
+        full = false;
+        break;
+      }
+    }
+  }
+
+  if ( full )
+  {
+    _care.clear();
+  }
+
+  set_inputs( spec.inputs() );
+  set_outputs( spec.outputs() );
+  set_constants( spec.constants() );
+  set_garbage( spec.garbage() );
+}
+
+binary_truth_table dense_truth_table::to_truth_table() const
+{
+  binary_truth_table spec;
+
+  for ( const auto& row : *this )
+  {
+    spec.add_entry( cube_type( row.first.first, row.first.second ), cube_type( row.second.first, row.second.second ) );
+  }
+
+  spec.set_inputs( _inputs );
+  spec.set_outputs( _outputs );
+  spec.set_constants( _constants );
+  spec.set_garbage( _garbage );
+
+  return spec;
+}
+
+std::vector<unsigned> dense_truth_table::to_permutation() const
+{
+  assert( is_fully_specified() && _num_inputs == _num_outputs && _words_per_row == 1u );
+
+  return std::vector<unsigned>( _values.begin(), _values.end() );
+}
+
+void dense_truth_table::set_output_word( std::uint64_t row, std::uint64_t value )
+{
+  assert( _words_per_row == 1u );
+
+  _values[row] = value & full_care_word( 0u );
+  if ( !_care.empty() )
+  {
+    _care[row] = full_care_word( 0u );
+  }
+}
+
+boost::optional<bool> dense_truth_table::get( std::uint64_t row, unsigned output ) const
+{
+  const auto index = word_index( row, output );
+  const auto mask  = bit_mask( output );
+
+  if ( !_care.empty() && !( _care[index] & mask ) )
+  {
+    return boost::none;
+  }
+
+  return ( _values[index] & mask ) != 0ull;
+}
+
+void dense_truth_table::set( std::uint64_t row, unsigned output, const boost::optional<bool>& value )
+{
+  const auto index = word_index( row, output );
+  const auto mask  = bit_mask( output );
+
+  if ( !value )
+  {
+    if ( _care.empty() )
+    {
+      _care.resize( _values.size() );
+      for ( auto i = 0u; i < _care.size(); ++i )
+      {
+        _care[i] = full_care_word( i % _words_per_row );
+      }
+    }
+
+    _care[index] &= ~mask;
+    _values[index] &= ~mask;
+    return;
+  }
+
+  if ( !_care.empty() )
+  {
+    _care[index] |= mask;
+  }
+
+  if ( *value )
+  {
+    _values[index] |= mask;
+  }
+  else
+  {
+    _values[index] &= ~mask;
+  }
+}
+
+bool dense_truth_table::is_specified( std::uint64_t row ) const
+{
+  if ( _care.empty() ) { return true; }
+
+  for ( auto k = 0u; k < _words_per_row; ++k )
+  {
+    if ( _care[row * _words_per_row + k] ) { return true; }
+  }
+
+  return false;
+}
+
+std::ostream& operator<<( std::ostream& os, const dense_truth_table& spec )
+{
+  for ( const auto& row : spec )
+  {
+    for ( const auto& in_bit : boost::make_iterator_range( row.first ) )
+    {
+      os << ( in_bit ? ( *in_bit ? "1" : "0" ) : "-" );
+    }
+
+    os << " ";
+
+    for ( const auto& out_bit : boost::make_iterator_range( row.second ) )
+    {
+      os << ( out_bit ? ( *out_bit ? "1" : "0" ) : "-" );
+    }
+
+    os << std::endl;
+  }
+
+  return os;
+}
+
+}
+
+// Local Variables:
+// c-basic-offset: 2
+// eval: (c-set-offset 'substatement-open 0)
+// eval: (c-set-offset 'innamespace 0)
+// End:
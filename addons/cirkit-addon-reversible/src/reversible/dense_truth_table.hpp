@@ -0,0 +1,204 @@
+/* CirKit: A circuit toolkit
+ * Copyright (C) 2009-2015  University of Bremen
+ * Copyright (C) 2015-2016  EPFL
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file dense_truth_table.hpp
+ *
+ * @brief Dense bit-packed truth table representation
+ *
+ * The outputs of all 2^n input assignments are stored in one contiguous
+ * value plane with a fixed number of words per row.  For functions with at
+ * most 64 outputs, a row is a single word, such that a fully specified
+ * reversible function is a plain permutation array.  Incompletely
+ * specified functions have an additional care plane of the same shape.
+ *
+ * The iterator adapter exposes the same row type as binary_truth_table,
+ * such that algorithms can be migrated one at a time.  In contrast to
+ * binary_truth_table, the input and output ranges of a row point into the
+ * iterator and are invalidated when the iterator is advanced.
+ *
+ * @author Mathias Soeken
+ * @since  2.3
+ */
+
+#ifndef DENSE_TRUTH_TABLE_HPP
+#define DENSE_TRUTH_TABLE_HPP
+
+#include <cassert>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <boost/iterator/iterator_facade.hpp>
+#include <boost/optional.hpp>
+
+#include <reversible/circuit.hpp>
+#include <reversible/truth_table.hpp>
+
+namespace cirkit
+{
+
+class dense_truth_table;
+
+/******************************************************************************
+ * dense_truth_table_iterator                                                 *
+ ******************************************************************************/
+
+class dense_truth_table_iterator
+  : public boost::iterator_facade<dense_truth_table_iterator,
+                                  transform_cube<boost::optional<bool>>::result_type,
+                                  boost::forward_traversal_tag,
+                                  transform_cube<boost::optional<bool>>::result_type>
+{
+public:
+  dense_truth_table_iterator() {}
+  dense_truth_table_iterator( const dense_truth_table* table, std::uint64_t row );
+
+  inline std::uint64_t row() const { return _row; }
+
+private:
+  friend class boost::iterator_core_access;
+
+  void increment();
+  bool equal( const dense_truth_table_iterator& other ) const { return _row == other._row; }
+  transform_cube<boost::optional<bool>>::result_type dereference() const;
+
+  void skip_unspecified();
+
+  const dense_truth_table*             table = nullptr;
+  std::uint64_t                        _row  = 0u;
+  mutable binary_truth_table::cube_type in_cube;
+  mutable binary_truth_table::cube_type out_cube;
+};
+
+/******************************************************************************
+ * dense_truth_table                                                          *
+ ******************************************************************************/
+
+class dense_truth_table
+{
+public:
+  using value_type     = boost::optional<bool>;
+  using cube_type      = binary_truth_table::cube_type;
+  using const_iterator = dense_truth_table_iterator;
+
+  dense_truth_table() : dense_truth_table( 0u, 0u ) {}
+
+  /* all outputs are unspecified */
+  dense_truth_table( unsigned num_inputs, unsigned num_outputs );
+
+  /* reversible function, perm[x] is the image of x (first line is the MSB) */
+  explicit dense_truth_table( const std::vector<unsigned>& perm );
+
+  /* inputs with don't cares are expanded */
+  explicit dense_truth_table( const binary_truth_table& spec );
+
+  binary_truth_table to_truth_table() const;
+
+  /* requires a fully specified function with as many inputs as outputs */
+  std::vector<unsigned> to_permutation() const;
+
+  inline unsigned num_inputs() const           { return _num_inputs; }
+  inline unsigned num_outputs() const          { return _num_outputs; }
+  inline std::uint64_t num_rows() const        { return std::uint64_t( 1u ) << _num_inputs; }
+  inline unsigned words_per_row() const        { return _words_per_row; }
+  inline bool is_fully_specified() const       { return _care.empty(); }
+
+  /* the output word of a row, output 0 is the MSB (requires num_outputs() <= 64) */
+  inline std::uint64_t output_word( std::uint64_t row ) const
+  {
+    assert( _words_per_row == 1u );
+    return _values[row];
+  }
+
+  inline std::uint64_t care_word( std::uint64_t row ) const
+  {
+    assert( _words_per_row == 1u );
+    return _care.empty() ? full_care_word( 0u ) : _care[row];
+  }
+
+  void set_output_word( std::uint64_t row, std::uint64_t value );
+
+  boost::optional<bool> get( std::uint64_t row, unsigned output ) const;
+  void set( std::uint64_t row, unsigned output, const boost::optional<bool>& value );
+
+  /* true, if at least one output of the row is specified */
+  bool is_specified( std::uint64_t row ) const;
+
+  /* value and care planes, row-major with words_per_row() words per row */
+  inline const std::vector<std::uint64_t>& values() const { return _values; }
+  inline const std::vector<std::uint64_t>& care() const   { return _care; }
+
+  const_iterator begin() const { return const_iterator( this, 0u ); }
+  const_iterator end() const   { return const_iterator( this, num_rows() ); }
+
+  /* identity, for compatibility with binary_truth_table */
+  inline const std::vector<unsigned>& permutation() const { return _permutation; }
+
+  inline void set_inputs( const std::vector<std::string>& ins )       { _inputs = ins; }
+  inline const std::vector<std::string>& inputs() const               { return _inputs; }
+  inline void set_outputs( const std::vector<std::string>& outs )     { _outputs = outs; }
+  inline const std::vector<std::string>& outputs() const              { return _outputs; }
+  inline void set_constants( const std::vector<constant>& constants ) { _constants = constants; _constants.resize( _num_inputs, constant() ); }
+  inline const std::vector<constant>& constants() const               { return _constants; }
+  inline void set_garbage( const std::vector<bool>& garbage )         { _garbage = garbage; _garbage.resize( _num_outputs, false ); }
+  inline const std::vector<bool>& garbage() const                     { return _garbage; }
+
+private:
+  inline std::uint64_t word_index( std::uint64_t row, unsigned output ) const
+  {
+    return row * _words_per_row + ( ( _num_outputs - 1u - output ) >> 6u );
+  }
+
+  /* mask of valid output bits in the k-th word of a row */
+  inline std::uint64_t full_care_word( unsigned k ) const
+  {
+    const auto bits = _num_outputs - ( k << 6u );
+    return bits >= 64u ? ~0ull : ( ( 1ull << bits ) - 1ull );
+  }
+
+  inline std::uint64_t bit_mask( unsigned output ) const
+  {
+    return 1ull << ( ( _num_outputs - 1u - output ) & 63u );
+  }
+
+  unsigned                   _num_inputs;
+  unsigned                   _num_outputs;
+  unsigned                   _words_per_row;
+  std::vector<std::uint64_t> _values;
+  std::vector<std::uint64_t> _care; /* empty if fully specified */
+
+  std::vector<unsigned>      _permutation;
+  std::vector<std::string>   _inputs;
+  std::vector<std::string>   _outputs;
+  std::vector<constant>      _constants;
+  std::vector<bool>          _garbage;
+};
+
+std::ostream& operator<<( std::ostream& os, const dense_truth_table& spec );
+
+}
+
+#endif
+
+// Local Variables:
+// c-basic-offset: 2
+// eval: (c-set-offset 'substatement-open 0)
+// eval: (c-set-offset 'innamespace 0)
+// End:
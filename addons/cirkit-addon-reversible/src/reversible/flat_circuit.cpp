@@ -0,0 +1,283 @@
+/* CirKit: A circuit toolkit
+ * Copyright (C) 2009-2015  University of Bremen
+ * Copyright (C) 2015-2016  EPFL
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "flat_circuit.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+#include <reversible/gate.hpp>
+#include <reversible/target_tags.hpp>
+
+namespace cirkit
+{
+
+/******************************************************************************
+ * Private functions                                                          *
+ ******************************************************************************/
+
+namespace detail
+{
+
+/* moves the elements in [from, from + count) to [to, to + count) */
+template<typename T>
+inline void move_block( std::vector<T>& v, unsigned from, unsigned to, unsigned count )
+{
+  if ( count == 0u ) { return; }
+
+  if ( to < from )
+  {
+    std::copy( v.begin() + from, v.begin() + from + count, v.begin() + to );
+  }
+  else
+  {
+    std::copy_backward( v.begin() + from, v.begin() + from + count, v.begin() + to + count );
+  }
+}
+
+}
+
+/******************************************************************************
+ * flat_circuit                                                               *
+ ******************************************************************************/
+
+flat_circuit::flat_circuit( unsigned lines, unsigned capacity )
+  : _lines( lines ),
+    kinds( capacity ),
+    control_masks( capacity ),
+    polarity_masks( capacity ),
+    targets1( capacity ),
+    targets2( capacity ),
+    gap_end( capacity )
+{
+  assert( lines <= 64u );
+}
+
+flat_circuit::flat_circuit( const circuit& circ )
+  : flat_circuit( circ.lines(), circ.num_gates() )
+{
+  assert( is_supported( circ ) );
+
+  for ( const auto& g : circ )
+  {
+    flat_gate fg;
+    fg.controls = fg.polarity = 0ull;
+    fg.target2  = 0u;
+
+    for ( const auto& v : g.controls() )
+    {
+      fg.controls |= 1ull << v.line();
+      if ( v.polarity() )
+      {
+        fg.polarity |= 1ull << v.line();
+      }
+    }
+
+    fg.target1 = g.targets().front();
+
+    if ( is_toffoli( g ) )
+    {
+      fg.kind = flat_gate_kind::toffoli;
+    }
+    else
+    {
+      fg.kind    = is_fredkin( g ) ? flat_gate_kind::fredkin : flat_gate_kind::peres;
+      fg.target2 = g.targets()[1u];
+    }
+
+    append_gate( fg );
+  }
+}
+
+bool flat_circuit::is_supported( const circuit& circ )
+{
+  if ( circ.lines() > 64u ) { return false; }
+
+  for ( const auto& g : circ )
+  {
+    if ( !is_toffoli( g ) && !is_fredkin( g ) && !is_peres( g ) )
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+void flat_circuit::to_circuit( circuit& circ ) const
+{
+  if ( circ.lines() == 0u )
+  {
+    circ.set_lines( _lines );
+  }
+
+  for ( auto i = 0u; i < num_gates(); ++i )
+  {
+    const auto fg = (*this)[i];
+
+    auto& g = circ.append_gate();
+    for ( auto l = 0u; l < _lines; ++l )
+    {
+      if ( ( fg.controls >> l ) & 1u )
+      {
+        g.add_control( make_var( l, ( fg.polarity >> l ) & 1u ) );
+      }
+    }
+
+    g.add_target( fg.target1 );
+
+    switch ( fg.kind )
+    {
+    case flat_gate_kind::toffoli:
+      g.set_type( toffoli_tag() );
+      break;
+    case flat_gate_kind::fredkin:
+      g.add_target( fg.target2 );
+      g.set_type( fredkin_tag() );
+      break;
+    case flat_gate_kind::peres:
+      g.add_target( fg.target2 );
+      g.set_type( peres_tag() );
+      break;
+    }
+  }
+}
+
+flat_gate flat_circuit::operator[]( unsigned pos ) const
+{
+  assert( pos < num_gates() );
+
+  const auto p = physical( pos );
+  return {kinds[p], control_masks[p], polarity_masks[p], targets1[p], targets2[p]};
+}
+
+void flat_circuit::set_gate( unsigned pos, const flat_gate& g )
+{
+  assert( pos < num_gates() );
+
+  const auto p = physical( pos );
+  kinds[p]          = g.kind;
+  control_masks[p]  = g.controls;
+  polarity_masks[p] = g.polarity & g.controls;
+  targets1[p]       = g.target1;
+  targets2[p]       = g.target2;
+}
+
+void flat_circuit::insert_gate( unsigned pos, const flat_gate& g )
+{
+  assert( pos <= num_gates() );
+  assert( g.target1 < _lines && !( ( g.controls >> g.target1 ) & 1u ) );
+
+  if ( gap_size() == 0u )
+  {
+    grow();
+  }
+
+  move_gap( pos );
+  ++gap_begin;
+  set_gate( pos, g );
+}
+
+void flat_circuit::remove_gate_at( unsigned pos )
+{
+  assert( pos < num_gates() );
+
+  move_gap( pos );
+  ++gap_end;
+}
+
+void flat_circuit::append_toffoli( std::uint64_t controls, std::uint64_t polarity, unsigned target )
+{
+  insert_toffoli( num_gates(), controls, polarity, target );
+}
+
+void flat_circuit::insert_toffoli( unsigned pos, std::uint64_t controls, std::uint64_t polarity, unsigned target )
+{
+  insert_gate( pos, {flat_gate_kind::toffoli, controls, polarity, static_cast<std::uint8_t>( target ), 0u} );
+}
+
+void flat_circuit::append_fredkin( std::uint64_t controls, std::uint64_t polarity, unsigned target1, unsigned target2 )
+{
+  insert_fredkin( num_gates(), controls, polarity, target1, target2 );
+}
+
+void flat_circuit::insert_fredkin( unsigned pos, std::uint64_t controls, std::uint64_t polarity, unsigned target1, unsigned target2 )
+{
+  insert_gate( pos, {flat_gate_kind::fredkin, controls, polarity, static_cast<std::uint8_t>( target1 ), static_cast<std::uint8_t>( target2 )} );
+}
+
+void flat_circuit::clear()
+{
+  gap_begin = 0u;
+  gap_end   = kinds.size();
+}
+
+/* the gap starts at logical position pos afterwards */
+void flat_circuit::move_gap( unsigned pos )
+{
+  if ( pos == gap_begin ) { return; }
+
+  const auto gs = gap_size();
+
+  if ( pos < gap_begin )
+  {
+    /* elements [pos, gap_begin) move behind the gap */
+    const auto count = gap_begin - pos;
+    detail::move_block( kinds,          pos, pos + gs, count );
+    detail::move_block( control_masks,  pos, pos + gs, count );
+    detail::move_block( polarity_masks, pos, pos + gs, count );
+    detail::move_block( targets1,       pos, pos + gs, count );
+    detail::move_block( targets2,       pos, pos + gs, count );
+  }
+  else
+  {
+    /* elements [gap_end, pos + gs) move in front of the gap */
+    const auto count = pos - gap_begin;
+    detail::move_block( kinds,          gap_end, gap_begin, count );
+    detail::move_block( control_masks,  gap_end, gap_begin, count );
+    detail::move_block( polarity_masks, gap_end, gap_begin, count );
+    detail::move_block( targets1,       gap_end, gap_begin, count );
+    detail::move_block( targets2,       gap_end, gap_begin, count );
+  }
+
+  gap_begin = pos;
+  gap_end   = pos + gs;
+}
+
+void flat_circuit::grow()
+{
+  /* move the gap to the end, then enlarge the arrays */
+  move_gap( num_gates() );
+
+  const auto capacity = std::max( 16u, static_cast<unsigned>( kinds.size() ) * 2u );
+  kinds.resize( capacity );
+  control_masks.resize( capacity );
+  polarity_masks.resize( capacity );
+  targets1.resize( capacity );
+  targets2.resize( capacity );
+
+  gap_end = capacity;
+}
+
+}
+
+// Local Variables:
+// c-basic-offset: 2
+// eval: (c-set-offset 'substatement-open 0)
+// eval: (c-set-offset 'innamespace 0)
+// End:
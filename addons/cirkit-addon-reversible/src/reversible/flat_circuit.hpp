@@ -0,0 +1,126 @@
+/* CirKit: A circuit toolkit
+ * Copyright (C) 2009-2015  University of Bremen
+ * Copyright (C) 2015-2016  EPFL
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file flat_circuit.hpp
+ *
+ * @brief Flat gate storage for reversible circuits
+ *
+ * Gates are stored as structure of arrays: a small gate kind, control and
+ * polarity masks for up to 64 lines, and target indices.  The arrays are
+ * organized as gap buffer, such that inserting and removing gates at
+ * nearby positions (e.g., at the front or at a fixed position during
+ * synthesis) does not shift the whole circuit and no gate allocates
+ * memory on its own.
+ *
+ * Use flat_circuit as working representation in passes that create or
+ * modify many gates and convert to and from circuit at the boundaries.
+ *
+ * @author Mathias Soeken
+ * @since  2.3
+ */
+
+#ifndef FLAT_CIRCUIT_HPP
+#define FLAT_CIRCUIT_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include <reversible/circuit.hpp>
+
+namespace cirkit
+{
+
+enum class flat_gate_kind : std::uint8_t { toffoli, fredkin, peres };
+
+struct flat_gate
+{
+  flat_gate_kind kind;
+  std::uint64_t  controls;  /* bit i is set, if line i is a control */
+  std::uint64_t  polarity;  /* bit i is set, if control i is positive */
+  std::uint8_t   target1;
+  std::uint8_t   target2;   /* only for fredkin and peres gates */
+
+  inline bool operator==( const flat_gate& other ) const
+  {
+    return kind == other.kind && controls == other.controls && polarity == other.polarity &&
+           target1 == other.target1 && ( kind == flat_gate_kind::toffoli || target2 == other.target2 );
+  }
+};
+
+class flat_circuit
+{
+public:
+  explicit flat_circuit( unsigned lines = 0u, unsigned capacity = 0u );
+
+  /* requires at most 64 lines and only Toffoli, Fredkin, and Peres gates */
+  explicit flat_circuit( const circuit& circ );
+
+  static bool is_supported( const circuit& circ );
+
+  /* appends all gates to circ, sets the number of lines if circ is empty */
+  void to_circuit( circuit& circ ) const;
+
+  inline unsigned lines() const     { return _lines; }
+  inline unsigned num_gates() const { return kinds.size() - gap_size(); }
+
+  flat_gate operator[]( unsigned pos ) const;
+  void set_gate( unsigned pos, const flat_gate& g );
+
+  void insert_gate( unsigned pos, const flat_gate& g );
+  void remove_gate_at( unsigned pos );
+
+  inline void append_gate( const flat_gate& g )  { insert_gate( num_gates(), g ); }
+  inline void prepend_gate( const flat_gate& g ) { insert_gate( 0u, g ); }
+
+  void append_toffoli( std::uint64_t controls, std::uint64_t polarity, unsigned target );
+  void insert_toffoli( unsigned pos, std::uint64_t controls, std::uint64_t polarity, unsigned target );
+  void append_fredkin( std::uint64_t controls, std::uint64_t polarity, unsigned target1, unsigned target2 );
+  void insert_fredkin( unsigned pos, std::uint64_t controls, std::uint64_t polarity, unsigned target1, unsigned target2 );
+
+  void clear();
+
+private:
+  inline unsigned gap_size() const                 { return gap_end - gap_begin; }
+  inline unsigned physical( unsigned pos ) const   { return pos < gap_begin ? pos : pos + gap_size(); }
+
+  void move_gap( unsigned pos );
+  void grow();
+
+  unsigned                    _lines;
+
+  /* structure of arrays, the positions [gap_begin, gap_end) are unused */
+  std::vector<flat_gate_kind> kinds;
+  std::vector<std::uint64_t>  control_masks;
+  std::vector<std::uint64_t>  polarity_masks;
+  std::vector<std::uint8_t>   targets1;
+  std::vector<std::uint8_t>   targets2;
+
+  unsigned                    gap_begin = 0u;
+  unsigned                    gap_end   = 0u;
+};
+
+}
+
+#endif
+
+// Local Variables:
+// c-basic-offset: 2
+// eval: (c-set-offset 'substatement-open 0)
+// eval: (c-set-offset 'innamespace 0)
+// End:
@@ -18,10 +18,16 @@
 
 #include "circuit_to_truth_table.hpp"
 
+#include <cstdint>
+#include <stdexcept>
+
 #include <boost/format.hpp>
 
 #include <core/properties.hpp>
 #include <core/utils/bitset_utils.hpp>
+#include <core/utils/thread_pool.hpp>
+#include <core/utils/timer.hpp>
+#include <reversible/simulation/compiled_simulation.hpp>
 
 namespace cirkit
 {
@@ -69,6 +75,121 @@ namespace cirkit
     return true;
   }
 
+  /* words per line simulated at once in circuit_to_dense_permutation */
+  constexpr unsigned dense_permutation_block_words = 1024u;
+
+  /* value of the input column for pattern bits 0, ..., 5 within a word */
+  constexpr std::uint64_t counting_masks[] = {
+    0xAAAAAAAAAAAAAAAAull, 0xCCCCCCCCCCCCCCCCull, 0xF0F0F0F0F0F0F0F0ull,
+    0xFF00FF00FF00FF00ull, 0xFFFF0000FFFF0000ull, 0xFFFFFFFF00000000ull
+  };
+
+  std::vector<unsigned> circuit_to_dense_permutation( const circuit& circ, const properties::ptr& settings, const properties::ptr& statistics )
+  {
+    const auto num_threads = get( settings, "num_threads", 1u );
+
+    properties_timer t( statistics );
+
+    const auto n = circ.lines();
+    if ( n > 32u )
+    {
+      throw std::invalid_argument( boost::str( boost::format( "circuit_to_dense_permutation: circuit has %d lines, at most 32 are supported" ) % n ) );
+    }
+
+    const compiled_circuit cc( circ );
+
+    const auto num_patterns = std::uint64_t( 1u ) << n;
+    const auto num_words    = ( num_patterns + 63u ) >> 6u;
+    const auto num_blocks   = ( num_words + dense_permutation_block_words - 1u ) / dense_permutation_block_words;
+
+    std::vector<unsigned> perm( num_patterns, 0u );
+
+    /* line l holds bit n - 1 - l of the pattern index */
+    const auto simulate_block = [&]( std::vector<std::uint64_t>& values, std::uint64_t block ) {
+      const auto first = block * dense_permutation_block_words;
+      const auto bw    = static_cast<unsigned>( std::min<std::uint64_t>( num_words - first, dense_permutation_block_words ) );
+
+      for ( auto l = 0u; l < n; ++l )
+      {
+        const auto b = n - 1u - l;
+        auto* v = &values[l * bw];
+        for ( auto w = 0u; w < bw; ++w )
+        {
+          v[w] = b < 6u ? counting_masks[b] : ( ( ( first + w ) >> ( b - 6u ) ) & 1u ) ? ~0ull : 0ull;
+        }
+      }
+
+      cc.simulate( values.data(), bw );
+
+      const auto valid = num_patterns < 64u ? ( std::uint64_t( 1u ) << num_patterns ) - 1u : ~0ull;
+      for ( auto l = 0u; l < n; ++l )
+      {
+        const auto bit = 1u << ( n - 1u - l );
+        const auto* v = &values[l * bw];
+        for ( auto w = 0u; w < bw; ++w )
+        {
+          auto word = v[w] & valid;
+          auto* p   = &perm[( first + w ) << 6u];
+          while ( word )
+          {
+            p[lowest_bit( word )] |= bit;
+            word &= word - 1u;
+          }
+        }
+      }
+    };
+
+    const auto workers = static_cast<unsigned>( std::max<std::uint64_t>( 1u, std::min<std::uint64_t>( num_threads, num_blocks ) ) );
+    const auto worker = [&]( unsigned id ) {
+      std::vector<std::uint64_t> values( n * std::min<std::uint64_t>( num_words, dense_permutation_block_words ) );
+      for ( std::uint64_t block = id; block < num_blocks; block += workers )
+      {
+        simulate_block( values, block );
+      }
+    };
+
+    if ( workers == 1u )
+    {
+      worker( 0u );
+    }
+    else
+    {
+      thread_pool pool( workers );
+      for ( auto i = 0u; i < workers; ++i )
+      {
+        pool.enqueue( worker, i );
+      }
+    }
+
+    set( statistics, "patterns", num_patterns );
+
+    return perm;
+  }
+
+  bool circuit_to_truth_table( const circuit& circ, binary_truth_table& spec, const properties::ptr& settings, const properties::ptr& statistics )
+  {
+    if ( circ.lines() > 32u )
+    {
+      return false;
+    }
+
+    const auto perm = circuit_to_dense_permutation( circ, settings, statistics );
+
+    spec.clear();
+    for ( auto i = 0u; i < perm.size(); ++i )
+    {
+      spec.add_entry( number_to_truth_table_cube( i, circ.lines() ), number_to_truth_table_cube( perm[i], circ.lines() ) );
+    }
+
+    // metadata
+    spec.set_inputs( circ.inputs() );
+    spec.set_outputs( circ.outputs() );
+    spec.set_constants( circ.constants() );
+    spec.set_garbage( circ.garbage() );
+
+    return true;
+  }
+
 }
 
 // Local Variables:
@@ -28,10 +28,13 @@
 #ifndef CIRCUIT_TO_TRUTH_TABLE_HPP
 #define CIRCUIT_TO_TRUTH_TABLE_HPP
 
+#include <vector>
+
 #include <boost/dynamic_bitset.hpp>
 #include <boost/function.hpp>
 
 #include <core/functor.hpp>
+#include <core/properties.hpp>
 #include <reversible/circuit.hpp>
 #include <reversible/truth_table.hpp>
 
@@ -54,6 +57,42 @@ namespace cirkit
    */
   bool circuit_to_truth_table( const circuit& circ, binary_truth_table& spec, const functor<bool(boost::dynamic_bitset<>&, const circuit&, const boost::dynamic_bitset<>&)>& simulation );
 
+  /**
+   * @brief Computes the permutation of a circuit by exhaustive bit-sliced simulation
+   *
+   * The circuit is compiled once and all 2^n input patterns are simulated
+   * 64 per word, where the input columns are fixed counting patterns.
+   * Blocks of the input space are distributed over threads and the results
+   * are written directly into the permutation.  Entry i is the output for
+   * input i, the first line is the most significant bit (as in
+   * truth_table_to_permutation).  Throws std::invalid_argument if the
+   * circuit has more than 32 lines.
+   *
+   * Settings:
+   *   num_threads (unsigned) : number of threads (default: 1)
+   *
+   * Statistics:
+   *   runtime, patterns
+   *
+   * @since  2.3
+   */
+  std::vector<unsigned> circuit_to_dense_permutation( const circuit& circ,
+                                                      const properties::ptr& settings = properties::ptr(),
+                                                      const properties::ptr& statistics = properties::ptr() );
+
+  /**
+   * @brief Generates a truth table from a circuit using exhaustive bit-sliced simulation
+   *
+   * The truth table is built from circuit_to_dense_permutation, settings and
+   * statistics are passed to it.  The meta is copied.  Returns false
+   * without changing spec if the circuit has more than 32 lines.
+   *
+   * @since  2.3
+   */
+  bool circuit_to_truth_table( const circuit& circ, binary_truth_table& spec,
+                               const properties::ptr& settings = properties::ptr(),
+                               const properties::ptr& statistics = properties::ptr() );
+
 }
 
 #endif /* CIRCUIT_TO_TRUTH_TABLE_HPP */
@@ -29,6 +29,7 @@
 #define COPY_METADATA_HPP
 
 #include <reversible/circuit.hpp>
+#include <reversible/dense_truth_table.hpp>
 #include <reversible/truth_table.hpp>
 
 namespace cirkit
@@ -158,6 +159,19 @@ namespace cirkit
     circ.set_garbage( spec.garbage() );
   }
 
+  /**
+   * @brief Copies meta-data from a dense specification to a circuit
+   *
+   * @since  2.3
+   */
+  inline void copy_metadata( const dense_truth_table& spec, circuit& circ )
+  {
+    circ.set_inputs( spec.inputs() );
+    circ.set_outputs( spec.outputs() );
+    circ.set_constants( spec.constants() );
+    circ.set_garbage( spec.garbage() );
+  }
+
   /**
    * @brief Copies meta-data from a circuit to another circuit
    *
@@ -0,0 +1,106 @@
+/* CirKit: A circuit toolkit
+ * Copyright (C) 2009-2015  University of Bremen
+ * Copyright (C) 2015-2016  EPFL
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "create_random_circuit.hpp"
+
+#include <core/utils/bitset_utils.hpp>
+#include <reversible/target_tags.hpp>
+
+namespace cirkit
+{
+
+/******************************************************************************
+ * Types                                                                      *
+ ******************************************************************************/
+
+/******************************************************************************
+ * Private functions                                                          *
+ ******************************************************************************/
+
+/******************************************************************************
+ * Public functions                                                           *
+ ******************************************************************************/
+
+void create_random_gate( gate& g, unsigned lines, bool negative, std::default_random_engine& generator, bool all_types )
+{
+  std::uniform_int_distribution<unsigned> dist( 0u, lines - 1u );
+  std::uniform_int_distribution<unsigned> bdist( 0u, 1u );
+
+  const auto kind = all_types ? generator() % 8u : 7u;
+
+  auto controls = random_bitset( lines, generator );
+  auto target   = dist( generator );
+
+  /* Peres gate: single control and two targets */
+  if ( kind == 0u && lines >= 3u )
+  {
+    auto target2 = dist( generator );
+    while ( target2 == target ) { target2 = dist( generator ); }
+    auto control = dist( generator );
+    while ( control == target || control == target2 ) { control = dist( generator ); }
+
+    g.set_type( peres_tag() );
+    g.add_control( make_var( control ) );
+    g.add_target( target );
+    g.add_target( target2 );
+    return;
+  }
+
+  const auto fredkin = kind <= 2u && lines >= 2u;
+  if ( fredkin )
+  {
+    auto target2 = dist( generator );
+    while ( target2 == target ) { target2 = dist( generator ); }
+
+    g.set_type( fredkin_tag() );
+    g.add_target( target );
+    g.add_target( target2 );
+    controls.reset( target2 );
+  }
+  else
+  {
+    g.set_type( toffoli_tag() );
+    g.add_target( target );
+  }
+
+  controls.reset( target );
+  auto pos = controls.find_first();
+  while ( pos != controls.npos )
+  {
+    g.add_control( make_var( pos, negative && !fredkin ? ( bdist( generator ) == 1u ) : true ) );
+    pos = controls.find_next( pos );
+  }
+}
+
+circuit create_random_circuit( unsigned lines, unsigned gates, bool negative, std::default_random_engine& generator, bool all_types )
+{
+  circuit circ( lines );
+  for ( auto i = 0u; i < gates; ++i )
+  {
+    create_random_gate( circ.append_gate(), lines, negative, generator, all_types );
+  }
+  return circ;
+}
+
+}
+
+// Local Variables:
+// c-basic-offset: 2
+// eval: (c-set-offset 'substatement-open 0)
+// eval: (c-set-offset 'innamespace 0)
+// End:
@@ -0,0 +1,71 @@
+/* CirKit: A circuit toolkit
+ * Copyright (C) 2009-2015  University of Bremen
+ * Copyright (C) 2015-2016  EPFL
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file create_random_circuit.hpp
+ *
+ * @brief Random gates and circuits
+ *
+ * @author Mathias Soeken
+ * @since  2.3
+ */
+
+#ifndef CREATE_RANDOM_CIRCUIT_HPP
+#define CREATE_RANDOM_CIRCUIT_HPP
+
+#include <random>
+
+#include <reversible/circuit.hpp>
+#include <reversible/gate.hpp>
+
+namespace cirkit
+{
+
+/**
+ * @brief Turns g into a random gate on lines lines
+ *
+ * The gate is a Toffoli gate on a random target in which every other line is
+ * a control line with probability 1/2.  If negative is true, each control is
+ * negative with probability 1/2.
+ *
+ * If all_types is true, the gate is a Fredkin gate with probability 1/4 and a
+ * Peres gate with probability 1/8, provided that there are enough lines.
+ * Controls of Fredkin and Peres gates are always positive.
+ *
+ * @since  2.3
+ */
+void create_random_gate( gate& g, unsigned lines, bool negative, std::default_random_engine& generator, bool all_types = false );
+
+/**
+ * @brief Creates a circuit with gates random gates
+ *
+ * See create_random_gate for the distribution of the gates.
+ *
+ * @since  2.3
+ */
+circuit create_random_circuit( unsigned lines, unsigned gates, bool negative, std::default_random_engine& generator, bool all_types = false );
+
+}
+
+#endif
+
+// Local Variables:
+// c-basic-offset: 2
+// eval: (c-set-offset 'substatement-open 0)
+// eval: (c-set-offset 'innamespace 0)
+// End:
@@ -18,9 +18,20 @@
 
 #include "read_realization.hpp"
 
+#include <algorithm>
+#include <cstring>
 #include <fstream>
 #include <iostream>
+#include <iterator>
 #include <stack>
+#include <unordered_map>
+
+#ifndef __WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 #include <boost/algorithm/string/join.hpp>
 #include <boost/algorithm/string/trim.hpp>
@@ -31,6 +42,8 @@
 #include <boost/range/iterator_range.hpp>
 #include <boost/variant.hpp>
 
+#include <core/utils/timer.hpp>
+
 #include "revlib_parser.hpp"
 #include "print_circuit.hpp"
 #include "../target_tags.hpp"
@@ -208,12 +221,390 @@ namespace cirkit
     return revlib_parser( in, processor, rp_settings, error );
   }
 
+  ////////////////////////////// mapped files
+  /* read-only view of a whole file, it is mapped into memory if possible
+   * and otherwise read into a buffer */
+  class mapped_realization
+  {
+  public:
+    explicit mapped_realization( const std::string& filename )
+    {
+#ifndef __WIN32
+      fd = open( filename.c_str(), O_RDONLY );
+      if ( fd == -1 ) { return; }
+
+      struct stat st;
+      if ( fstat( fd, &st ) == 0 && st.st_size > 0 )
+      {
+        void* addr = mmap( 0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+        if ( addr != MAP_FAILED )
+        {
+          madvise( addr, st.st_size, MADV_SEQUENTIAL );
+          _data = static_cast<const char*>( addr );
+          _size = st.st_size;
+          _good = true;
+          return;
+        }
+      }
+#endif
+
+      std::ifstream is( filename.c_str(), std::ifstream::in | std::ifstream::binary );
+      if ( !is.good() ) { return; }
+
+      buffer.assign( std::istreambuf_iterator<char>( is ), std::istreambuf_iterator<char>() );
+      _data = buffer.data();
+      _size = buffer.size();
+      _good = true;
+    }
+
+    ~mapped_realization()
+    {
+#ifndef __WIN32
+      if ( _data && buffer.empty() )
+      {
+        munmap( const_cast<char*>( _data ), _size );
+      }
+      if ( fd != -1 )
+      {
+        close( fd );
+      }
+#endif
+    }
+
+    inline bool good() const        { return _good; }
+    inline const char* begin() const { return _data; }
+    inline const char* end() const   { return _data + _size; }
+    inline std::size_t size() const  { return _size; }
+
+  private:
+    int               fd = -1;
+    const char*       _data = 0;
+    std::size_t       _size = 0u;
+    bool              _good = false;
+    std::vector<char> buffer;
+  };
+
+  enum class mapped_read_result { success, failure, unsupported };
+
+  typedef std::pair<const char*, const char*> token_t;
+
+  inline bool is_space( char c )
+  {
+    return c == ' ' || c == '\t' || c == '\r';
+  }
+
+  inline bool parse_unsigned( const token_t& token, unsigned& value )
+  {
+    value = 0u;
+    for ( auto c = token.first; c != token.second; ++c )
+    {
+      if ( *c < '0' || *c > '9' ) { return false; }
+      value = 10u * value + ( *c - '0' );
+    }
+    return token.first != token.second;
+  }
+
+  /* adds a gate without module support, cf. circuit_processor::on_gate */
+  void append_mapped_gate( circuit& circ, const boost::any& target_type, const std::vector<variable>& line_indices )
+  {
+    gate& g = circ.append_gate();
+
+    auto num_targets = 1u;
+    if ( is_type<fredkin_tag>( target_type ) )
+    {
+      num_targets = 2u;
+    }
+    else if ( is_type<peres_tag>( target_type ) )
+    {
+      num_targets = 2u;
+    }
+
+    const auto num_controls = line_indices.size() - num_targets;
+    g.controls().reserve( num_controls );
+    for ( auto i = 0u; i < num_controls; ++i )
+    {
+      g.add_control( line_indices[i] );
+    }
+    for ( auto i = num_controls; i < line_indices.size(); ++i )
+    {
+      g.add_target( line_indices[i].line() );
+    }
+    g.set_type( target_type );
+  }
+
+  mapped_read_result read_mapped_realization( circuit& circ, const char* first, const char* last, const read_realization_settings& settings, std::string* error )
+  {
+    unsigned numvars = 0u;
+    std::unordered_map<std::string, unsigned> variable_indices;
+    std::unordered_map<std::string, boost::any> target_types;
+
+    /* reused for every line */
+    std::string key;
+    std::vector<token_t> tokens;
+    std::vector<variable> line_indices;
+    std::vector<unsigned> bus_lines;
+
+    const auto fail = [error]( const std::string& message ) -> mapped_read_result {
+      if ( error )
+      {
+        *error = message;
+      }
+      return mapped_read_result::failure;
+    };
+
+    const auto find_line = [&]( const char* name_first, const char* name_last, unsigned& line ) -> bool {
+      key.assign( name_first, name_last );
+      const auto it = variable_indices.find( key );
+      if ( it == variable_indices.end() ) { return false; }
+      line = it->second;
+      return true;
+    };
+
+    auto pos = first;
+    while ( pos < last )
+    {
+      const char* line_first = pos;
+      const char* line_last = static_cast<const char*>( std::memchr( pos, '\n', last - pos ) );
+      if ( !line_last )
+      {
+        line_last = last;
+      }
+      pos = line_last + 1;
+
+      /* comments, annotations are only supported by revlib_parser */
+      if ( const char* hash = static_cast<const char*>( std::memchr( line_first, '#', line_last - line_first ) ) )
+      {
+        if ( hash + 1 < line_last && hash[1] == '@' )
+        {
+          return mapped_read_result::unsupported;
+        }
+        line_last = hash;
+      }
+
+      tokens.clear();
+      for ( auto c = line_first; c != line_last; )
+      {
+        while ( c != line_last && is_space( *c ) ) { ++c; }
+        if ( c == line_last ) { break; }
+        const auto token_first = c;
+        while ( c != line_last && !is_space( *c ) ) { ++c; }
+        tokens.push_back( std::make_pair( token_first, c ) );
+      }
+
+      if ( tokens.empty() ) { continue; }
+
+      const auto& command = tokens.front();
+      const auto c0 = *command.first;
+
+      if ( c0 == '.' )
+      {
+        key.assign( command.first, command.second );
+
+        if ( key == ".version" )
+        {
+          continue;
+        }
+        else if ( key == ".numvars" )
+        {
+          if ( tokens.size() != 2u )
+          {
+            return fail( "Invalid number of parameters for .numvars command" );
+          }
+          if ( !parse_unsigned( tokens[1u], numvars ) )
+          {
+            return fail( "Invalid parameter for .numvars command" );
+          }
+          circ.set_lines( numvars );
+          continue;
+        }
+        else if ( key == ".variables" )
+        {
+          if ( tokens.size() - 1u != numvars )
+          {
+            return fail( "Variable count does not fit numvars" );
+          }
+          variable_indices.clear();
+          variable_indices.reserve( numvars );
+          for ( auto i = 1u; i < tokens.size(); ++i )
+          {
+            variable_indices.insert( std::make_pair( std::string( tokens[i].first, tokens[i].second ), i - 1u ) );
+          }
+          continue;
+        }
+        else if ( key == ".inputs" || key == ".outputs" )
+        {
+          const auto is_inputs = key == ".inputs";
+          std::vector<std::string> names;
+          if ( tokens.size() > 1u && !parse_string_list( std::string( tokens[1u].first, tokens.back().second ), names ) )
+          {
+            return fail( is_inputs ? "Cannot parse .input command" : "Cannot parse .output command" );
+          }
+          if ( names.size() != numvars )
+          {
+            return fail( is_inputs ? "Input count does not fit numvars" : "Output count does not fit numvars" );
+          }
+          if ( is_inputs )
+          {
+            circ.set_inputs( names );
+          }
+          else
+          {
+            circ.set_outputs( names );
+          }
+          continue;
+        }
+        else if ( key == ".constants" )
+        {
+          if ( tokens.size() != 2u || unsigned( tokens[1u].second - tokens[1u].first ) != numvars )
+          {
+            return fail( "Constant count does not fit numvars" );
+          }
+          std::vector<constant> constants( numvars );
+          std::transform( tokens[1u].first, tokens[1u].second, constants.begin(), []( char c ) {
+              return c == '-' ? constant() : constant( c == '1' );
+            } );
+          circ.set_constants( constants );
+          continue;
+        }
+        else if ( key == ".garbage" )
+        {
+          if ( tokens.size() != 2u || unsigned( tokens[1u].second - tokens[1u].first ) != numvars )
+          {
+            return fail( "Garbage count does not fit numvars" );
+          }
+          std::vector<bool> garbage( numvars );
+          std::transform( tokens[1u].first, tokens[1u].second, garbage.begin(), []( char c ) { return c == '1'; } );
+          circ.set_garbage( garbage );
+          continue;
+        }
+        else if ( key == ".inputbus" || key == ".outputbus" || key == ".state" )
+        {
+          const auto command_name = key;
+          if ( tokens.size() < 3u )
+          {
+            return fail( "Too few arguments in " + command_name + " command" );
+          }
+
+          /* the initial value of a state signal is not stored in the circuit */
+          auto num_lines = tokens.size() - 2u;
+          unsigned initial_value;
+          if ( command_name == ".state" && parse_unsigned( tokens.back(), initial_value ) )
+          {
+            if ( --num_lines == 0u )
+            {
+              return fail( "Too few arguments in .state command" );
+            }
+          }
+
+          bus_lines.resize( num_lines );
+          for ( auto i = 0u; i < num_lines; ++i )
+          {
+            if ( !find_line( tokens[i + 2u].first, tokens[i + 2u].second, bus_lines[i] ) )
+            {
+              return fail( "unknown variable: " + key );
+            }
+          }
+
+          const std::string name( tokens[1u].first, tokens[1u].second );
+          if ( command_name == ".inputbus" )
+          {
+            circ.inputbuses().add( name, bus_lines );
+          }
+          else if ( command_name == ".outputbus" )
+          {
+            circ.outputbuses().add( name, bus_lines );
+          }
+          else
+          {
+            circ.statesignals().add( name, bus_lines );
+          }
+          continue;
+        }
+        else if ( key == ".module" )
+        {
+          return mapped_read_result::unsupported;
+        }
+        else if ( key == ".begin" )
+        {
+          if ( tokens.size() != 1u )
+          {
+            return fail( "Wrong number of parameters for .begin command" );
+          }
+          if ( !settings.read_gates )
+          {
+            return mapped_read_result::success;
+          }
+
+          /* every remaining line is at most one gate */
+          circ.reserve( std::count( pos, last, '\n' ) + 1u );
+          continue;
+        }
+        else if ( key == ".end" )
+        {
+          if ( tokens.size() != 1u )
+          {
+            return fail( "Wrong number of parameters for .end command" );
+          }
+          return mapped_read_result::success;
+        }
+
+        /* other commands are gates, as in revlib_parser */
+      }
+      else if ( c0 == '0' || c0 == '1' || c0 == '-' )
+      {
+        /* truth table */
+        return mapped_read_result::unsupported;
+      }
+
+      /* gate, the gate type is resolved once per command */
+      key.assign( command.first, command.second );
+      auto it = target_types.find( key );
+      if ( it == target_types.end() )
+      {
+        const auto tag = settings.string_to_target_tag( key );
+        if ( !tag && error )
+        {
+          *error = "unknown gate command: " + key;
+        }
+        it = target_types.insert( std::make_pair( key, tag ? *tag : boost::any() ) ).first;
+      }
+
+      if ( tokens.size() == 1u )
+      {
+        return fail( "Gate without lines: " + key );
+      }
+
+      line_indices.clear();
+      for ( auto i = 1u; i < tokens.size(); ++i )
+      {
+        const auto polarity = *tokens[i].first != '-';
+        unsigned line;
+        if ( !find_line( tokens[i].first + ( polarity ? 0 : 1 ), tokens[i].second, line ) )
+        {
+          return fail( "unknown variable: " + key );
+        }
+        line_indices.push_back( make_var( line, polarity ) );
+      }
+
+      if ( ( is_type<fredkin_tag>( it->second ) && line_indices.size() < 2u ) ||
+           ( is_type<peres_tag>( it->second ) && line_indices.size() != 3u ) )
+      {
+        return fail( "Wrong number of lines for gate command: " + std::string( command.first, command.second ) );
+      }
+
+      append_mapped_gate( circ, it->second, line_indices );
+    }
+
+    return mapped_read_result::success;
+  }
+
   bool read_realization( circuit& circ, const std::string& filename, const read_realization_settings& settings, std::string* error )
   {
-    std::ifstream is;
-    is.open( filename.c_str(), std::ifstream::in );
+    properties_timer t( settings.statistics );
 
-    if ( !is.good() )
+    mapped_realization file( filename );
+
+    if ( !file.good() )
     {
       if ( error )
       {
@@ -222,13 +613,34 @@ namespace cirkit
       return false;
     }
 
-    boost::filesystem::path pfilename( filename );
-    circuit_processor processor( circ );
-    revlib_parser_settings rp_settings;
-    rp_settings.base_directory = pfilename.parent_path().string();
-    rp_settings.read_gates = settings.read_gates;
-    rp_settings.string_to_target_tag = settings.string_to_target_tag;
-    return revlib_parser( is, processor, rp_settings, error );
+    auto result = read_mapped_realization( circ, file.begin(), file.end(), settings, error );
+    const auto mapped = result != mapped_read_result::unsupported;
+
+    if ( !mapped )
+    {
+      circ = circuit();
+
+      std::ifstream is;
+      is.open( filename.c_str(), std::ifstream::in );
+
+      boost::filesystem::path pfilename( filename );
+      circuit_processor processor( circ );
+      revlib_parser_settings rp_settings;
+      rp_settings.base_directory = pfilename.parent_path().string();
+      rp_settings.read_gates = settings.read_gates;
+      rp_settings.string_to_target_tag = settings.string_to_target_tag;
+      result = revlib_parser( is, processor, rp_settings, error ) ? mapped_read_result::success : mapped_read_result::failure;
+    }
+
+    if ( settings.statistics )
+    {
+      const auto wall = t.elapsed().wall / 1000000000.0;
+      settings.statistics->set( "bytes", static_cast<unsigned long long>( file.size() ) );
+      settings.statistics->set( "mb_per_second", wall > 0.0 ? file.size() / ( 1000000.0 * wall ) : 0.0 );
+      settings.statistics->set( "mapped", mapped );
+    }
+
+    return result != mapped_read_result::failure;
   }
 
 }
@@ -31,6 +31,7 @@
 #include <iosfwd>
 #include <vector>
 
+#include <core/properties.hpp>
 #include <reversible/circuit.hpp>
 
 #include <reversible/io/revlib_processor.hpp>
@@ -104,6 +105,17 @@ namespace cirkit
   {
     bool read_gates = true;
     std::function<boost::optional<boost::any>(const std::string&)> string_to_target_tag = revlib_parser_string_to_target_tag;
+
+    /**
+     * @brief Statistics when reading from a file
+     *
+     * If set, read_realization(circuit&, const std::string&, const read_realization_settings&, std::string*)
+     * stores \b runtime, \b bytes, \b mb_per_second, and \b mapped, which
+     * is false if the file had to be read with revlib_parser.
+     *
+     * @since  2.3
+     */
+    properties::ptr statistics;
   };
 
   /**
@@ -127,9 +139,11 @@ namespace cirkit
   /**
    * @brief Read a circuit realization into a circuit from filename
    *
-   * This method construts a \b std::ifstream of the given \p filename
-   * and calls read_realization(circuit&, std::istream&, std::string*)
-   * with it.
+   * The file is mapped into memory and gate lines are added to the
+   * circuit directly, line names are only resolved once.  Files with
+   * modules, annotations, or truth tables are read with
+   * read_realization(circuit&, std::istream&, const read_realization_settings&, std::string*)
+   * instead.
    *
    * @section Example
    *
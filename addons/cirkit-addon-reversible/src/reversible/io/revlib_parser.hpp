@@ -31,6 +31,7 @@
 #include <functional>
 #include <iosfwd>
 #include <string>
+#include <vector>
 
 #include <boost/any.hpp>
 #include <boost/optional.hpp>
@@ -42,6 +43,9 @@ class revlib_processor;
 
 boost::optional<boost::any> revlib_parser_string_to_target_tag( const std::string& str );
 
+/* splits the arguments of .inputs and .outputs, names may be quoted */
+bool parse_string_list( const std::string& line, std::vector<std::string>& params );
+
 struct revlib_parser_settings
 {
   /**
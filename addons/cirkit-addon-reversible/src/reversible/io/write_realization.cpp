@@ -19,6 +19,7 @@
 #include "write_realization.hpp"
 
 #include <fstream>
+#include <typeinfo>
 
 #include <boost/algorithm/string/join.hpp>
 #include <boost/algorithm/string/replace.hpp>
@@ -29,6 +30,7 @@
 #include <boost/spirit/include/karma.hpp>
 
 #include <core/version.hpp>
+#include <core/utils/timer.hpp>
 #include <reversible/circuit.hpp>
 #include <reversible/target_tags.hpp>
 
@@ -53,19 +55,108 @@ namespace cirkit
     }
   };
 
-  struct line_to_variable
+  /* collects the output in a large buffer, which is written to the stream
+   * in blocks, integers are formatted by hand */
+  class realization_writer
   {
-    std::string operator()( const variable& v ) const
+  public:
+    explicit realization_writer( std::ostream& os ) : os( os )
     {
-      return boost::str( boost::format( "%sx%d" ) % ( v.polarity() ? "" : "-" ) % v.line() );
+      buffer.reserve( capacity + 4096u );
     }
 
-    std::string operator()( const unsigned& l ) const
+    ~realization_writer()
     {
-      return boost::str( boost::format( "x%d" ) % l );
+      flush();
     }
+
+    inline void put( char c )                   { buffer.push_back( c ); }
+    inline void write( const std::string& s )   { buffer.append( s ); }
+    inline void write( const char* s )          { buffer.append( s ); }
+
+    void write_unsigned( unsigned value )
+    {
+      char digits[10];
+      auto pos = digits + 10;
+      do
+      {
+        *--pos = '0' + value % 10u;
+        value /= 10u;
+      } while ( value );
+      buffer.append( pos, digits + 10 );
+    }
+
+    inline void write_line( unsigned line )
+    {
+      put( 'x' );
+      write_unsigned( line );
+    }
+
+    inline void write_variable( const variable& v )
+    {
+      if ( !v.polarity() )
+      {
+        put( '-' );
+      }
+      write_line( v.line() );
+    }
+
+    void end_line()
+    {
+      put( '\n' );
+      if ( buffer.size() >= capacity )
+      {
+        flush();
+      }
+    }
+
+    void flush()
+    {
+      os.write( buffer.data(), buffer.size() );
+      written += buffer.size();
+      buffer.clear();
+    }
+
+    inline unsigned long long bytes() const { return written + buffer.size(); }
+
+  private:
+    static constexpr std::size_t capacity = 1u << 20u;
+
+    std::ostream&      os;
+    std::string        buffer;
+    unsigned long long written = 0ull;
   };
 
+  void write_name_list( realization_writer& writer, const std::vector<std::string>& names )
+  {
+    for ( const auto& name : names )
+    {
+      const auto quoted = name.find( ' ' ) != std::string::npos;
+      writer.put( ' ' );
+      if ( quoted ) { writer.put( '"' ); }
+      writer.write( name );
+      if ( quoted ) { writer.put( '"' ); }
+    }
+    writer.end_line();
+  }
+
+  void write_bus( realization_writer& writer, const char* command, const std::string& name, const std::vector<unsigned>& lines )
+  {
+    writer.write( command );
+    writer.put( ' ' );
+    writer.write( name );
+    writer.put( ' ' );
+    for ( auto it = lines.begin(); it != lines.end(); ++it )
+    {
+      if ( it != lines.begin() )
+      {
+        writer.put( ' ' );
+      }
+      writer.write_line( *it );
+    }
+    writer.end_line();
+  }
+
   write_realization_settings::write_realization_settings()
     : header( boost::str( boost::format( "This file has been generated using RevKit %s (www.revkit.org)" ) % cirkit_version() ) )
   {
@@ -95,7 +186,7 @@ namespace cirkit
     }
   }
 
-  void write_realization( const circuit& circ, std::ostream& os, const write_realization_settings& settings )
+  void write_realization_header( realization_writer& writer, const circuit& circ, std::ostream& os, const write_realization_settings& settings )
   {
     unsigned oldsize = 0;
 
@@ -103,22 +194,21 @@ namespace cirkit
     {
       std::string header = settings.header;
       boost::algorithm::replace_all( header, "\n", "\n# " );
-      os << "# " << header << std::endl;
+      writer.write( "# " );
+      writer.write( header );
+      writer.end_line();
     }
 
     if ( !settings.version.empty() )
     {
-      os << ".version " << settings.version << std::endl;
+      writer.write( ".version " );
+      writer.write( settings.version );
+      writer.end_line();
     }
 
-    os << ".numvars " << circ.lines() << std::endl;
-
-    std::vector<std::string> variables( circ.lines() );
-
-    for ( unsigned i = 0u; i < circ.lines(); ++i )
-    {
-      variables[i] = boost::str( boost::format( "x%d" ) % i );
-    }
+    writer.write( ".numvars " );
+    writer.write_unsigned( circ.lines() );
+    writer.end_line();
 
     std::vector<std::string> _inputs( circ.inputs().begin(), circ.inputs().end() );
     oldsize = _inputs.size();
@@ -138,33 +228,19 @@ namespace cirkit
       _outputs[i] = boost::str( boost::format( "o%d" ) % i );
     }
 
-    os << ".variables " << boost::algorithm::join( variables, " " ) << std::endl;
-
-    namespace karma = boost::spirit::karma;
-    namespace ascii = boost::spirit::ascii;
-
-    os << ".inputs";
-    //std::ostream_iterator<char> outit( os );
-    //karma::generate_delimited( outit, *( karma::no_delimit['"' << karma::string] << '"' ), ascii::space, _inputs );
-
-    for ( const auto& _input : _inputs )
+    writer.write( ".variables" );
+    for ( unsigned i = 0u; i < circ.lines(); ++i )
     {
-      std::string quote = ( _input.find( " " ) != std::string::npos ) ? "\"" : "";
-      os << boost::format( " %s%s%s" ) % quote % _input % quote;
+      writer.put( ' ' );
+      writer.write_line( i );
     }
+    writer.end_line();
 
-    os << std::endl;
+    writer.write( ".inputs" );
+    write_name_list( writer, _inputs );
 
-    os << ".outputs";
-    //karma::generate_delimited( outit, *( karma::no_delimit['"' << karma::string] << '"' ), ascii::space, _outputs );
-
-    for ( const auto& _output : _outputs )
-    {
-      std::string quote = ( _output.find( " " ) != std::string::npos ) ? "\"" : "";
-      os << boost::format( " %s%s%s" ) % quote % _output % quote;
-    }
-
-    os << std::endl;
+    writer.write( ".outputs" );
+    write_name_list( writer, _outputs );
 
     std::string _constants( circ.lines(), '-' );
     std::transform( circ.constants().begin(), circ.constants().end(), _constants.begin(), constant_to_char() );
@@ -172,33 +248,34 @@ namespace cirkit
     std::string _garbage( circ.lines(), '-' );
     std::transform( circ.garbage().begin(), circ.garbage().end(), _garbage.begin(), garbage_to_char() );
 
-    os << ".constants " << _constants << std::endl
-       << ".garbage " << _garbage << std::endl;
+    writer.write( ".constants " );
+    writer.write( _constants );
+    writer.end_line();
+    writer.write( ".garbage " );
+    writer.write( _garbage );
+    writer.end_line();
 
     for ( const auto& bus : circ.inputbuses().buses() )
     {
-      std::vector<std::string> lines;
-      std::transform( bus.second.begin(), bus.second.end(), std::back_inserter( lines ), line_to_variable() );
-      os << ".inputbus " << bus.first << " " << boost::algorithm::join( lines, " " ) << std::endl;
+      write_bus( writer, ".inputbus", bus.first, bus.second );
     }
 
     for ( const auto& bus : circ.outputbuses().buses() )
     {
-      std::vector<std::string> lines;
-      std::transform( bus.second.begin(), bus.second.end(), std::back_inserter( lines ), line_to_variable() );
-      os << ".outputbus " << bus.first << " " << boost::algorithm::join( lines, " " ) << std::endl;
+      write_bus( writer, ".outputbus", bus.first, bus.second );
     }
 
     for ( const auto& bus : circ.statesignals().buses() )
     {
-      std::vector<std::string> lines;
-      std::transform( bus.second.begin(), bus.second.end(), std::back_inserter( lines ), line_to_variable() );
-      os << ".state " << bus.first << " " << boost::algorithm::join( lines, " " ) << std::endl;
+      write_bus( writer, ".state", bus.first, bus.second );
     }
 
     for ( const auto& module : circ.modules() )
     {
-      os << ".module " << module.first << std::endl;
+      writer.write( ".module " );
+      writer.write( module.first );
+      writer.end_line();
+      writer.flush();
 
       write_realization_settings module_settings;
       module_settings.version.clear();
@@ -206,37 +283,94 @@ namespace cirkit
       write_realization( *module.second, os, module_settings );
     }
 
-    os << ".begin" << std::endl;
+    writer.write( ".begin" );
+    writer.end_line();
+  }
 
-    std::string cmd;
+  /* writes the gate without annotations and line break, labels of the
+   * default settings are written directly */
+  void write_realization_gate( realization_writer& writer, const gate& g, const write_realization_settings& settings, bool default_labels )
+  {
+    if ( !default_labels )
+    {
+      writer.write( settings.type_label( g ) );
+    }
+    else if ( is_toffoli( g ) )
+    {
+      writer.put( 't' );
+      writer.write_unsigned( g.size() );
+    }
+    else if ( is_fredkin( g ) )
+    {
+      writer.put( 'f' );
+      writer.write_unsigned( g.size() );
+    }
+    else if ( is_peres( g ) )
+    {
+      writer.put( 'p' );
+    }
+    else if ( is_module( g ) )
+    {
+      writer.write( boost::any_cast<module_tag>( &g.type() )->name );
+    }
+    else
+    {
+      writer.write( "UNKNOWN" );
+    }
 
-    for ( const auto& g : circ )
+    for ( const auto& v : g.controls() )
+    {
+      writer.put( ' ' );
+      writer.write_variable( v );
+    }
+    for ( const auto& l : g.targets() )
     {
-      cmd = settings.type_label( g );
+      writer.put( ' ' );
+      writer.write_line( l );
+    }
+  }
 
-      std::vector<std::string> lines;
+  void write_realization( const circuit& circ, std::ostream& os, const write_realization_settings& settings )
+  {
+    properties_timer t( settings.statistics );
+
+    realization_writer writer( os );
+    write_realization_header( writer, circ, os, settings );
 
-      // Peres is special
-      boost::transform( g.controls(), std::back_inserter( lines ), line_to_variable() );
-      boost::transform( g.targets(), std::back_inserter( lines ), line_to_variable() );
+    const auto default_labels = typeid( settings ) == typeid( write_realization_settings );
 
-      os << cmd << " " << boost::algorithm::join( lines, " " );
+    for ( const auto& g : circ )
+    {
+      write_realization_gate( writer, g, settings, default_labels );
 
       boost::optional<const std::map<std::string, std::string>&> annotations = circ.annotations( g );
       if ( annotations )
       {
-        std::string sannotations;
+        writer.write( " #@" );
         for ( const auto& p : *annotations )
         {
-          sannotations += boost::str( boost::format( " %s=\"%s\"" ) % p.first % p.second );
+          writer.put( ' ' );
+          writer.write( p.first );
+          writer.write( "=\"" );
+          writer.write( p.second );
+          writer.put( '"' );
         }
-        os << " #@" << sannotations;
       }
 
-      os << std::endl;
+      writer.end_line();
     }
 
-    os << ".end" << std::endl;
+    writer.write( ".end" );
+    writer.end_line();
+    writer.flush();
+    os.flush();
+
+    if ( settings.statistics )
+    {
+      const auto wall = t.elapsed().wall / 1000000000.0;
+      settings.statistics->set( "bytes", writer.bytes() );
+      settings.statistics->set( "mb_per_second", wall > 0.0 ? writer.bytes() / ( 1000000.0 * wall ) : 0.0 );
+    }
   }
 
   bool write_realization( const circuit& circ, const std::string& filename, const write_realization_settings& settings, std::string* error )
@@ -260,6 +394,69 @@ namespace cirkit
     return true;
   }
 
+  realization_stream::realization_stream( std::ostream& os, const circuit& header, const write_realization_settings& settings )
+    : os( os ),
+      settings( settings ),
+      writer( new realization_writer( os ) ),
+      default_labels( typeid( settings ) == typeid( write_realization_settings ) )
+  {
+    write_realization_header( *writer, header, os, settings );
+  }
+
+  realization_stream::~realization_stream()
+  {
+    close();
+  }
+
+  void realization_stream::write_gate( const gate& g )
+  {
+    write_realization_gate( *writer, g, settings, default_labels );
+    writer->end_line();
+    ++_num_gates;
+  }
+
+  void realization_stream::write_toffoli( const gate::control_container& controls, unsigned target )
+  {
+    if ( !default_labels )
+    {
+      gate g;
+      g.controls() = controls;
+      g.add_target( target );
+      g.set_type( toffoli_tag() );
+      write_gate( g );
+      return;
+    }
+
+    writer->put( 't' );
+    writer->write_unsigned( controls.size() + 1u );
+    for ( const auto& v : controls )
+    {
+      writer->put( ' ' );
+      writer->write_variable( v );
+    }
+    writer->put( ' ' );
+    writer->write_line( target );
+    writer->end_line();
+    ++_num_gates;
+  }
+
+  void realization_stream::close()
+  {
+    if ( !writer ) { return; }
+
+    writer->write( ".end" );
+    writer->end_line();
+    _bytes = writer->bytes();
+    writer.reset();
+    os.flush();
+  }
+
+  unsigned long long realization_stream::bytes() const
+  {
+    return writer ? writer->bytes() : _bytes;
+  }
+
+
 }
 
 // Local Variables:
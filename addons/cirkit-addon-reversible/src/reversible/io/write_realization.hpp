@@ -29,8 +29,10 @@
 #define WRITE_REALIZATION_HPP
 
 #include <iosfwd>
+#include <memory>
 #include <string>
 
+#include <core/properties.hpp>
 #include <reversible/circuit.hpp>
 
 namespace cirkit
@@ -85,6 +87,16 @@ namespace cirkit
      */
     std::string header;
 
+    /**
+     * @brief Statistics
+     *
+     * If set, \b runtime, \b bytes, and \b mb_per_second are stored
+     * after writing the circuit.
+     *
+     * @since  2.3
+     */
+    properties::ptr statistics;
+
     virtual std::string type_label( const gate& g ) const;
   };
 
@@ -163,6 +175,41 @@ namespace cirkit
    */
   bool write_realization( const circuit& circ, const std::string& filename, const write_realization_settings& settings = write_realization_settings(), std::string* error = 0 );
 
+  class realization_writer;
+
+  /**
+   * @brief Writes a RevLib realization gate by gate
+   *
+   * The header is written on construction from the lines and the meta data
+   * of \p header, whose gates are ignored.  Gates are written as they are
+   * passed and are not kept in memory, which allows to write circuits that
+   * are too large to be stored.  The file is completed by close() or on
+   * destruction.  The settings must outlive the stream.
+   *
+   * @since  2.3
+   */
+  class realization_stream
+  {
+  public:
+    realization_stream( std::ostream& os, const circuit& header, const write_realization_settings& settings );
+    ~realization_stream();
+
+    void write_gate( const gate& g );
+    void write_toffoli( const gate::control_container& controls, unsigned target );
+    void close();
+
+    inline unsigned num_gates() const { return _num_gates; }
+    unsigned long long bytes() const;
+
+  private:
+    std::ostream&                       os;
+    const write_realization_settings&   settings;
+    std::unique_ptr<realization_writer> writer;
+    bool                                default_labels;
+    unsigned                            _num_gates = 0u;
+    unsigned long long                  _bytes = 0ull;
+  };
+
 }
 
 #endif /* WRITE_REALIZATION_HPP */
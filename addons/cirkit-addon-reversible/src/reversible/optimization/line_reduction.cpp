@@ -24,6 +24,9 @@
 #include <stdio.h>
 #include <unistd.h>
 
+#include <atomic>
+#include <cstdint>
+#include <future>
 #include <memory>
 
 #include <boost/assign/std/set.hpp>
@@ -33,6 +36,7 @@
 #include <boost/range/algorithm.hpp>
 #include <boost/range/algorithm_ext/iota.hpp>
 
+#include <core/utils/thread_pool.hpp>
 #include <core/utils/timer.hpp>
 
 #include <reversible/circuit.hpp>
@@ -45,6 +49,7 @@
 #include <reversible/io/write_realization.hpp>
 #include <reversible/io/read_realization.hpp>
 
+#include <reversible/simulation/compiled_simulation.hpp>
 #include <reversible/simulation/partial_simulation.hpp>
 #include <reversible/simulation/simple_simulation.hpp>
 #include <reversible/synthesis/embed_truth_table.hpp>
@@ -222,9 +227,10 @@ namespace cirkit
     return c.size();
   }
 
-  std::pair<circuit, std::vector<unsigned> > find_window_with_max_lines( const circuit& circ, unsigned end, unsigned max_lines )
+  /* start is set to the index of the first window gate in circ */
+  std::pair<circuit, std::vector<unsigned> > find_window_with_max_lines( const circuit& circ, unsigned end, unsigned max_lines, unsigned& start )
   {
-    unsigned start = end;
+    start = end;
 
     while ( num_non_empty_lines( circ, start, end - start + 1 ) <= max_lines && start > 0 ) {
       --start;
@@ -234,8 +240,9 @@ namespace cirkit
       ++start;
     }
 
-    std::vector<unsigned> filter;
-    find_non_empty_lines( circ.begin() + start, circ.begin() + end + 1, std::back_inserter( filter ) );
+    std::set<unsigned> lines;
+    find_non_empty_lines( circ.begin() + start, circ.begin() + end + 1, std::insert_iterator<std::set<unsigned> >( lines, lines.begin() ) );
+    std::vector<unsigned> filter( lines.begin(), lines.end() );
     circuit rcircuit;
     copy_circuit( subcircuit( circ, start, end + 1 ), rcircuit, filter );
     return std::make_pair( rcircuit, filter );
@@ -277,7 +284,7 @@ namespace cirkit
 
   /* returns a set of the function of the line, which is 0,1 if it is supposed to be the constant line,
      2 if it needs to be used afterwards, or -1 if it is not needed anymore. */
-  void garbage_to_ov( const circuit& circ, const circuit& window, const std::vector<unsigned>& line_mapping,
+  void garbage_to_ov( const circuit& circ, const circuit& window, unsigned window_offset, const std::vector<unsigned>& line_mapping,
                       unsigned garbage_line, std::vector<short>& ov, bool constant_value )
   {
     for ( unsigned i = 0u; i < window.lines(); ++i )
@@ -294,7 +301,7 @@ namespace cirkit
       }
       else
       {
-        if ( std::find_if( circ.begin() + window.offset() + window.num_gates(), circ.end(), has_control_or_target_at( mapped_line ) ) == circ.end() )
+        if ( std::find_if( circ.begin() + window_offset + window.num_gates(), circ.end(), has_control_or_target_at( mapped_line ) ) == circ.end() )
         {
           ov += -1;
         }
@@ -314,56 +321,53 @@ namespace cirkit
 
     std::map<binary_truth_table::cube_type, unsigned> output_assignments;
 
-    for ( unsigned long long i = 0ull; i < ( 1ull << window.lines() ); ++i )
+    // assignments are sorted, every one has to be simulated
+    for ( const auto& i : assignments )
     {
-      // output cube
-      if ( boost::find( assignments, i ) != assignments.end() ) // input has to be simulated
-      {
-        binary_truth_table::cube_type input_cube, output_cube;
+      binary_truth_table::cube_type input_cube, output_cube;
 
-        boost::dynamic_bitset<> simulation_input( window.lines(), i ), simulation_result;
-        if ( needs_simulation )
-        {
-          simulation( simulation_result, window, simulation_input );
-        }
+      boost::dynamic_bitset<> simulation_input( window.lines(), i ), simulation_result;
+      if ( needs_simulation )
+      {
+        simulation( simulation_result, window, simulation_input );
+      }
 
-        for ( std::vector<short>::const_iterator itOV = ov.begin(); itOV != ov.end(); ++itOV )
-        {
-          switch ( *itOV ) {
-          case -1:
-            break;
-          case 0:
-          case 1:
-            output_cube += constant( *itOV == 1 );
-            break;
-          case 2:
-          default:
-            output_cube += constant( simulation_result.test( itOV - ov.begin() ) );
-            break;
-          }
+      for ( std::vector<short>::const_iterator itOV = ov.begin(); itOV != ov.end(); ++itOV )
+      {
+        switch ( *itOV ) {
+        case -1:
+          break;
+        case 0:
+        case 1:
+          output_cube += constant( *itOV == 1 );
+          break;
+        case 2:
+        default:
+          output_cube += constant( simulation_result.test( itOV - ov.begin() ) );
+          break;
         }
+      }
 
-        // input cube
-        for ( unsigned j = 0u; j < window.lines(); ++j )
-        {
-          input_cube.push_back( i & ( 1u << j ) );
-        }
+      // input cube
+      for ( unsigned j = 0u; j < window.lines(); ++j )
+      {
+        input_cube.push_back( i & ( 1u << j ) );
+      }
 
-        window_spec.add_entry( input_cube, output_cube );
+      window_spec.add_entry( input_cube, output_cube );
 
-        if ( output_assignments.find( output_cube ) == output_assignments.end() )
-        {
-          output_assignments.insert( std::make_pair( output_cube, 1u ) );
-        }
-        else
+      if ( output_assignments.find( output_cube ) == output_assignments.end() )
+      {
+        output_assignments.insert( std::make_pair( output_cube, 1u ) );
+      }
+      else
+      {
+        if ( output_assignments[output_cube] >= ( 1u << num_dcs ) )
         {
-          if ( output_assignments[output_cube] >= ( 1u << num_dcs ) )
-          {
-            window_spec.clear();
-            return false;
-          }
-          ++output_assignments[output_cube];
+          window_spec.clear();
+          return false;
         }
+        ++output_assignments[output_cube];
       }
     }
 
@@ -466,6 +470,349 @@ namespace cirkit
     circ.set_garbage( garbage );
   }
 
+  //// prefix_simulation ////
+
+  /*
+   * Bit-sliced simulation of the circuit for all assignments to its
+   * non-constant lines.  The values of all lines are stored every interval
+   * gates, such that the values in front of a window are obtained by only
+   * simulating the gates from the closest checkpoint.  Checkpoints in front
+   * of a replaced window stay valid.  At most max_checkpoints are stored; if
+   * more are needed, every other one is dropped and the interval doubled.
+   */
+  class prefix_simulation
+  {
+  public:
+    prefix_simulation( const circuit& circ, unsigned num_vars, unsigned interval, unsigned long long max_checkpoints );
+
+    /* memory of one checkpoint in bytes */
+    static unsigned long long checkpoint_size( const circuit& circ, unsigned num_vars );
+
+    /* computes all checkpoints up to gate index offset */
+    void extend( const circuit& circ, unsigned offset );
+
+    /* sorted values of lines that occur at gate index offset, requires extend( circ, offset ) */
+    void assignments( const circuit& circ, unsigned offset, const std::vector<unsigned>& lines, std::vector<unsigned long long>& result ) const;
+
+    /* gates from offset on have been replaced and line has been removed */
+    void remove_line( unsigned offset, unsigned line );
+
+    inline unsigned long long simulated_gates() const { return _simulated_gates; }
+
+  private:
+    void thin_out();
+
+    unsigned num_words;
+    unsigned interval;
+    unsigned long long max_checkpoints;
+    std::vector<std::vector<std::uint64_t> > checkpoints;
+    mutable std::atomic<unsigned long long> _simulated_gates;
+  };
+
+  prefix_simulation::prefix_simulation( const circuit& circ, unsigned num_vars, unsigned interval, unsigned long long max_checkpoints )
+    : num_words( std::max( 1ull, ( 1ull << num_vars ) >> 6u ) ),
+      interval( std::max( 1u, interval ) ),
+      max_checkpoints( std::max( 2ull, max_checkpoints ) ),
+      _simulated_gates( 0ull )
+  {
+    static const std::uint64_t var_masks[] = {
+      0xaaaaaaaaaaaaaaaaull, 0xccccccccccccccccull, 0xf0f0f0f0f0f0f0f0ull,
+      0xff00ff00ff00ff00ull, 0xffff0000ffff0000ull, 0xffffffff00000000ull };
+
+    std::vector<std::uint64_t> values( circ.lines() * num_words, 0ull );
+
+    unsigned var = 0u;
+    for ( unsigned l = 0u; l < circ.lines(); ++l )
+    {
+      const constant& c = circ.constants().at( l );
+      for ( unsigned w = 0u; w < num_words; ++w )
+      {
+        if ( c )
+        {
+          values[l * num_words + w] = *c ? ~0ull : 0ull;
+        }
+        else
+        {
+          values[l * num_words + w] = var < 6u ? var_masks[var] : ( ( ( w >> ( var - 6u ) ) & 1u ) ? ~0ull : 0ull );
+        }
+      }
+
+      if ( !c )
+      {
+        ++var;
+      }
+    }
+
+    checkpoints.push_back( values );
+  }
+
+  unsigned long long prefix_simulation::checkpoint_size( const circuit& circ, unsigned num_vars )
+  {
+    return circ.lines() * std::max( 1ull, ( 1ull << num_vars ) >> 6u ) * sizeof( std::uint64_t );
+  }
+
+  void prefix_simulation::extend( const circuit& circ, unsigned offset )
+  {
+    while ( checkpoints.size() <= offset / interval )
+    {
+      if ( checkpoints.size() >= max_checkpoints )
+      {
+        thin_out();
+        continue;
+      }
+
+      const unsigned from = ( checkpoints.size() - 1u ) * interval;
+
+      std::vector<std::uint64_t> values( checkpoints.back() );
+      compiled_circuit( subcircuit( circ, from, from + interval ) ).simulate( values.data(), num_words );
+      _simulated_gates += interval;
+
+      checkpoints.push_back( values );
+    }
+  }
+
+  void prefix_simulation::assignments( const circuit& circ, unsigned offset, const std::vector<unsigned>& lines, std::vector<unsigned long long>& result ) const
+  {
+    assert( offset / interval < checkpoints.size() );
+
+    const unsigned from = ( offset / interval ) * interval;
+
+    std::vector<std::uint64_t> values( checkpoints[offset / interval] );
+    if ( offset > from )
+    {
+      compiled_circuit( subcircuit( circ, from, offset ) ).simulate( values.data(), num_words );
+      _simulated_gates += offset - from;
+    }
+
+    std::vector<char> seen( 1ull << lines.size(), 0 );
+    for ( unsigned w = 0u; w < num_words; ++w )
+    {
+      for ( unsigned b = 0u; b < 64u; ++b )
+      {
+        unsigned long long a = 0ull;
+        for ( unsigned pos = 0u; pos < lines.size(); ++pos )
+        {
+          a |= ( ( values[lines[pos] * num_words + w] >> b ) & 1ull ) << pos;
+        }
+        seen[a] = 1;
+      }
+    }
+
+    result.clear();
+    for ( unsigned long long a = 0ull; a < seen.size(); ++a )
+    {
+      if ( seen[a] )
+      {
+        result += a;
+      }
+    }
+  }
+
+  /* keeps the checkpoints at even positions, which are the ones for the doubled interval */
+  void prefix_simulation::thin_out()
+  {
+    for ( auto i = 1u; 2u * i < checkpoints.size(); ++i )
+    {
+      checkpoints[i].swap( checkpoints[2u * i] );
+    }
+    checkpoints.resize( ( checkpoints.size() + 1u ) / 2u );
+    interval *= 2u;
+  }
+
+  void prefix_simulation::remove_line( unsigned offset, unsigned line )
+  {
+    checkpoints.resize( std::min<std::size_t>( checkpoints.size(), offset / interval + 1u ) );
+
+    for ( auto& values : checkpoints )
+    {
+      values.erase( values.begin() + line * num_words, values.begin() + ( line + 1u ) * num_words );
+    }
+  }
+
+  //// window reduction ////
+
+  /* assignments of the window lines obtained by simulating the circuit in front of the window for each input */
+  void simulate_window_assignments( const circuit& circ, unsigned window_offset, const circuit& window, const std::vector<unsigned>& index_map,
+                                    std::vector<unsigned long long>& assignments )
+  {
+    properties::ptr ps_settings( new properties() );
+    ps_settings->set( "keep_full_output", true );
+
+    if ( window_offset == 0u ) // easy case: window starts on the left side
+    {
+      circuit zero;
+      copy_circuit( subcircuit( circ, 0u, 0u ), zero, index_map );
+
+      // non constant inputs
+      unsigned non_constant_lines = 0u;
+      std::vector<constant> zero_constants;
+      for ( std::vector<unsigned>::const_iterator itIndexMap = index_map.begin(); itIndexMap != index_map.end(); ++itIndexMap )
+      {
+        zero_constants += circ.constants().at( *itIndexMap );
+        if ( !circ.constants().at( *itIndexMap ) )
+        {
+          ++non_constant_lines;
+        }
+      }
+      circuit zero_copy( zero.lines() );
+      append_circuit( zero_copy, zero );
+      zero_copy.set_constants( zero_constants );
+
+      for ( unsigned long long input = 0ull; input < ( 1ull << non_constant_lines ); ++input )
+      {
+        boost::dynamic_bitset<> input_vec( non_constant_lines, input ), output_vec;
+        partial_simulation( output_vec, zero_copy, input_vec, ps_settings );
+
+        assignments += output_vec.to_ulong();
+      }
+    }
+    else
+    {
+      std::vector<unsigned> before_filter;
+      find_non_empty_lines( circ.begin(), circ.begin() + window_offset + window.num_gates(), std::back_inserter( before_filter ) );
+      std::sort( before_filter.begin(), before_filter.end() );
+      before_filter.resize( std::unique( before_filter.begin(), before_filter.end() ) - before_filter.begin() );
+
+      std::vector<constant> before_window_constants;
+      for ( const unsigned& line : before_filter )
+      {
+        before_window_constants.push_back( circ.constants().at( line ) );
+      }
+      unsigned window_vars = std::count( before_window_constants.begin(), before_window_constants.end(), constant() );
+
+      /* in this case the window starts in the beginning and we need the constant inputs */
+      circuit before_window_sub;
+      copy_circuit( subcircuit( circ, 0u, window_offset ), before_window_sub, before_filter );
+      circuit before_window( before_window_sub.lines() );
+      append_circuit( before_window, before_window_sub );
+      before_window.set_constants( before_window_constants );
+      before_window.set_garbage( std::vector<bool>( before_window.lines(), false ) );
+
+      for ( unsigned long long input = 0ull; input < ( 1ull << window_vars ); ++input )
+      {
+        boost::dynamic_bitset<> input_vec( window_vars, input );
+        boost::dynamic_bitset<> output;
+
+        partial_simulation( output, before_window, input_vec, ps_settings );
+
+        unsigned long long new_output = 0ull;
+
+        // go through each line in window
+        for ( unsigned long pos = 0; pos < index_map.size(); ++pos )
+        {
+          // line at pos
+          unsigned line_index = index_map.at( pos );
+
+          // this line relative in before_window
+          unsigned before_window_line_index = std::find( before_filter.begin(), before_filter.end(), line_index ) - before_filter.begin();
+
+          unsigned long long bit_at_before_window_line_index = output.test( before_window_line_index );
+
+          new_output |= ( bit_at_before_window_line_index << pos );
+        }
+
+        assignments += new_output;
+      }
+    }
+
+    boost::sort( assignments );
+    assignments.erase( std::unique( assignments.begin(), assignments.end() ), assignments.end() );
+  }
+
+  enum class window_status { not_tried, reduced, no_constant_line, max_window_lines, not_simulated, ambiguous_line, synthesis_failed };
+
+  struct window_replacement
+  {
+    unsigned offset;
+    unsigned length;
+    unsigned garbage_line;
+    unsigned constant_line;
+    circuit  gates;
+  };
+
+  /* tries to re-synthesize the window with at most max_lines lines that ends with the last control of garbage_line */
+  window_status reduce_window( const circuit& circ, unsigned garbage_line, unsigned last_control_position, unsigned max_lines, unsigned window_variables_threshold,
+                               const prefix_simulation* prefix, const simulation_func& simulation, window_synthesis_func& window_synthesis,
+                               window_replacement& replacement )
+  {
+    unsigned window_offset;
+    circuit window;
+    std::vector<unsigned> index_map;
+    std::tie( window, index_map ) = find_window_with_max_lines( circ, last_control_position, max_lines, window_offset );
+
+    /* find constant line */
+    unsigned constant_line = find_constant_line( circ, window_offset + window.num_gates() );
+    if ( constant_line == circ.lines() )
+    {
+      return window_status::no_constant_line;
+    }
+
+    if ( window_offset > 0u )
+    {
+      std::set<unsigned> before_filter;
+      find_non_empty_lines( circ.begin(), circ.begin() + window_offset + window.num_gates(), std::insert_iterator<std::set<unsigned> >( before_filter, before_filter.begin() ) );
+
+      /* determine the number of window variables (no constants) */
+      unsigned window_vars = boost::count_if( before_filter, [&circ]( unsigned line ) { return !circ.constants().at( line ); } );
+
+      if ( window_vars >= window_variables_threshold )
+      {
+        return window_status::max_window_lines;
+      }
+
+      if ( window.lines() <= 6 && window_vars >= 12 )
+      {
+        return window_status::not_simulated;
+      }
+    }
+
+    std::vector<unsigned long long> assignments;
+    if ( prefix )
+    {
+      prefix->assignments( circ, window_offset, index_map, assignments );
+    }
+    else
+    {
+      simulate_window_assignments( circ, window_offset, window, index_map, assignments );
+    }
+
+    std::vector<short> ov;
+    std::vector<unsigned> order;
+    garbage_to_ov( circ, window, window_offset, index_map, garbage_line, ov, *circ.constants().at( constant_line ) );
+    ov_to_order_vector( ov, order );
+
+    /* create specification */
+    binary_truth_table window_spec;
+    if ( !create_window_specification( window, window_spec, assignments, ov, simulation ) )
+    {
+      return window_status::ambiguous_line;
+    }
+
+    circuit new_window;
+    if ( !window_synthesis( new_window, window_spec, order ) )
+    {
+      return window_status::synthesis_failed;
+    }
+
+    replacement.offset        = window_offset;
+    replacement.length        = window.num_gates();
+    replacement.garbage_line  = garbage_line;
+    replacement.constant_line = constant_line;
+    replacement.gates         = circuit();
+    expand_circuit( new_window, replacement.gates, circ.lines(), index_map );
+
+    return window_status::reduced;
+  }
+
+  struct reduction_candidate
+  {
+    unsigned      garbage_line;
+    unsigned      last_control_position;
+    unsigned      max_lines;
+    unsigned      considered_windows;
+    window_status status = window_status::not_tried;
+  };
+
   bool line_reduction( circuit& circ, const circuit& base, properties::ptr settings, properties::ptr statistics )
   {
     /* settings */
@@ -474,6 +821,39 @@ namespace cirkit
     unsigned window_variables_threshold    = get<unsigned>( settings, "window_variables_threshold", 17u );
     simulation_func simulation             = get<simulation_func>( settings, "simulation", simple_simulation_func() );
     window_synthesis_func window_synthesis = get<window_synthesis_func>( settings, "window_synthesis", embed_and_synthesize() );
+    unsigned num_threads                   = get<unsigned>( settings, "num_threads", 1u );
+    window_synthesis_factory factory       = get<window_synthesis_factory>( settings, "window_synthesis_factory", window_synthesis_factory() );
+    unsigned checkpoint_interval           = get<unsigned>( settings, "checkpoint_interval", 32u );
+    unsigned long long max_checkpoint_memory = get<unsigned long long>( settings, "max_checkpoint_memory", 256ull << 20u );
+
+    /* custom functors cannot be shared among threads */
+    if ( settings && ( settings->has_key( "simulation" ) || ( !factory && settings->has_key( "window_synthesis" ) ) ) )
+    {
+      num_threads = 1u;
+    }
+    if ( !factory )
+    {
+      factory = []() { return window_synthesis_func( embed_and_synthesize() ); };
+    }
+    num_threads = std::max( 1u, num_threads );
+
+    std::vector<simulation_func>       simulations( 1u, simulation );
+    std::vector<window_synthesis_func> syntheses( 1u, window_synthesis );
+    for ( unsigned i = 1u; i < num_threads; ++i )
+    {
+      simulations.push_back( simple_simulation_func() );
+      syntheses.push_back( factory() );
+    }
+
+    /* a timeout forks the process, which is not safe while other threads run */
+    if ( boost::find_if( syntheses, []( const window_synthesis_func& f ) {
+          const auto* es = f.target<embed_and_synthesize>();
+          return es && es->timeout != 0u; } ) != syntheses.end() )
+    {
+      num_threads = 1u;
+      simulations.resize( 1u );
+      syntheses.resize( 1u );
+    }
 
     /* statistics */
     unsigned num_considered_windows   = 0u;
@@ -489,204 +869,147 @@ namespace cirkit
     std::vector<unsigned> original_lines( base.lines() );
     boost::iota( original_lines, 0u );
 
+    /* windows are simulated from the cached prefix, if all input patterns and two checkpoints fit */
+    std::shared_ptr<prefix_simulation> prefix;
+    unsigned num_vars = boost::count( circ.constants(), constant() );
+    if ( num_vars < std::min( window_variables_threshold, 21u ) )
+    {
+      const auto max_checkpoints = max_checkpoint_memory / prefix_simulation::checkpoint_size( circ, num_vars );
+      if ( max_checkpoints >= 2ull )
+      {
+        prefix = std::make_shared<prefix_simulation>( circ, num_vars, checkpoint_interval, max_checkpoints );
+      }
+    }
+
     std::vector<unsigned> lines_to_skip;
     unsigned max_lines = max_window_lines;
 
     while ( true )
     {
-      unsigned last_control_position;
-      unsigned garbage_line = find_best_garbage_line( circ, lines_to_skip, original_lines, last_control_position );
-
-      if ( garbage_line == circ.lines() )
-      {
-        break;
-      }
-
-      if ( statistics )
+      /* next candidates in the order of the sequential algorithm */
+      std::vector<reduction_candidate> candidates;
+      std::vector<unsigned> taken = lines_to_skip;
+      while ( candidates.size() < num_threads )
       {
-        ++num_considered_windows;
-      }
-
-      circuit window;
-      std::vector<unsigned> index_map;
-      std::tie( window, index_map ) = find_window_with_max_lines( circ, last_control_position, max_lines );
+        reduction_candidate c;
+        c.garbage_line = find_best_garbage_line( circ, taken, original_lines, c.last_control_position );
 
-      /* find constant line */
-      unsigned constant_line = find_constant_line( circ, window.offset() + window.num_gates() );
-      if ( constant_line == circ.lines() )
-      {
-        if ( statistics )
+        if ( c.garbage_line == circ.lines() )
         {
-          ++skipped_no_constant_line;
+          break;
         }
 
-        lines_to_skip += original_lines.at( garbage_line );
-        max_lines = max_window_lines;
-
-        continue;
+        /* a candidate is only tried if all previous ones are skipped */
+        c.max_lines = candidates.empty() ? max_lines : max_window_lines;
+        c.considered_windows = 0u;
+        candidates += c;
+        taken += original_lines.at( c.garbage_line );
       }
 
-      /* index_map */
-      std::vector<unsigned long long> assignments;
+      if ( candidates.empty() )
+      {
+        break;
+      }
 
-      if ( window.offset() == 0u ) // easy case: window starts on the left side
+      if ( prefix )
       {
-        circuit zero;
-        copy_circuit( subcircuit( circ, 0u, 0u ), zero, index_map );
+        prefix->extend( circ, boost::max_element( candidates, []( const reduction_candidate& c1, const reduction_candidate& c2 ) {
+              return c1.last_control_position < c2.last_control_position; } )->last_control_position );
+      }
+
+      std::vector<window_replacement> replacements( candidates.size() );
+      std::atomic<unsigned> next( 0u );
 
-        // non constant inputs
-        unsigned non_constant_lines = 0u;
-        std::vector<constant> zero_constants;
-        for ( std::vector<unsigned>::const_iterator itIndexMap = index_map.begin(); itIndexMap != index_map.end(); ++itIndexMap )
+      const auto worker = [&]( unsigned id ) {
+        while ( true )
         {
-          zero_constants += circ.constants().at( *itIndexMap );
-          if ( !circ.constants().at( *itIndexMap ) )
+          const auto i = next++;
+          if ( i >= candidates.size() ) { return; }
+
+          auto& c = candidates[i];
+          while ( true )
           {
-            ++non_constant_lines;
+            ++c.considered_windows;
+            c.status = reduce_window( circ, c.garbage_line, c.last_control_position, c.max_lines, window_variables_threshold,
+                                      prefix.get(), simulations[id], syntheses[id], replacements[i] );
+
+            if ( c.status != window_status::ambiguous_line || c.max_lines >= max_grow_up_window_lines )
+            {
+              break;
+            }
+            ++c.max_lines;
           }
         }
-        circuit zero_copy( zero.lines() );
-        append_circuit( zero_copy, zero );
-        zero_copy.set_constants( zero_constants );
+      };
 
-        properties::ptr ps_settings( new properties() );
-        ps_settings->set( "keep_full_output", true );
-
-        for ( unsigned long long input = 0ull; input < ( 1ull << non_constant_lines ); ++input )
-        {
-          boost::dynamic_bitset<> input_vec( non_constant_lines, input ), output_vec;
-          partial_simulation( output_vec, zero_copy, input_vec, ps_settings );
-
-          assignments += output_vec.to_ulong();
-        }
+      if ( num_threads == 1u )
+      {
+        worker( 0u );
       }
       else
       {
-        std::vector<unsigned> before_filter;
-        find_non_empty_lines( circ.begin(), circ.begin() + window.offset() + window.num_gates(), std::back_inserter( before_filter ) );
-        std::sort( before_filter.begin(), before_filter.end() );
-        before_filter.resize( std::unique( before_filter.begin(), before_filter.end() ) - before_filter.begin() );
-
-        /* determine the number of window variables (no constants) */
-        std::vector<constant> before_window_constants;
-        for ( const unsigned& line : before_filter )
-        {
-          before_window_constants.push_back( circ.constants().at( line ) );
-        }
-        unsigned window_vars = std::count( before_window_constants.begin(), before_window_constants.end(), constant() );
-
-        if ( window_vars >= window_variables_threshold )
+        /* exceptions of the workers are passed to the caller */
+        std::vector<std::future<void>> futures;
         {
-          if ( statistics )
+          thread_pool pool( num_threads );
+          for ( unsigned id = 0u; id < num_threads; ++id )
           {
-            ++skipped_max_window_lines;
+            futures.push_back( pool.enqueue( worker, id ) );
           }
-
-          lines_to_skip += original_lines[garbage_line];
-          max_lines = max_window_lines;
-          continue;
         }
+        for ( auto& f : futures )
+        {
+          f.get();
+        }
+      }
 
-        /* in this case the window starts in the beginning and we need the constant inputs */
-        circuit before_window_sub;
-        copy_circuit( subcircuit( circ, 0u, window.offset() ), before_window_sub, before_filter );
-        circuit before_window( before_window_sub.lines() );
-        append_circuit( before_window, before_window_sub );
-        before_window.set_constants( before_window_constants );
-        before_window.set_garbage( std::vector<bool>( before_window.lines(), false ) );
+      for ( unsigned i = 0u; i < candidates.size(); ++i )
+      {
+        const auto& c = candidates[i];
+        num_considered_windows += c.considered_windows;
 
-        if ( window.lines() > 6 || window_vars < 12 )
+        if ( c.status == window_status::reduced )
         {
-          properties::ptr ps_settings( new properties() );
-          ps_settings->set( "keep_full_output", true );
+          const auto& r = replacements[i];
 
-          for ( unsigned long long input = 0ull; input < ( 1ull << window_vars ); ++input )
+          for ( unsigned j = 0u; j < r.length; ++j )
           {
-            boost::dynamic_bitset<> input_vec( window_vars, input );
-            boost::dynamic_bitset<> output;
-
-            partial_simulation( output, before_window, input_vec, ps_settings );
-
-            unsigned long long new_output = 0ull;
-
-            // go through each line in window
-            for ( unsigned long pos = 0; pos < index_map.size(); ++pos )
-            {
-              // line at pos
-              unsigned line_index = index_map.at( pos );
-
-              // this line relative in before_window
-              unsigned before_window_line_index = std::find( before_filter.begin(), before_filter.end(), line_index ) - before_filter.begin();
-
-              unsigned bit_at_before_window_line_index = output.test( before_window_line_index );
-
-              new_output |= ( bit_at_before_window_line_index << pos );
-            }
-
-            assignments += new_output;
+            circ.remove_gate_at( r.offset );
           }
-        }
-        else
-        {
-          lines_to_skip += original_lines[garbage_line];
-          max_lines = max_window_lines;
-          continue;
-        }
-      }
+          insert_circuit( circ, r.offset, r.gates );
+          remove_line( circ, r.constant_line, r.garbage_line );
 
-      std::vector<short> ov;
-      std::vector<unsigned> order;
-      garbage_to_ov( circ, window, index_map, garbage_line, ov, *circ.constants().at( constant_line ) );
-      ov_to_order_vector( ov, order );
-
-      /* create specification */
-      binary_truth_table window_spec;
-      if ( !create_window_specification( window, window_spec, assignments, ov, simulation ) )
-      {
-        if ( max_lines < max_grow_up_window_lines )
-        {
-          ++max_lines;
-        }
-        else
-        {
-          if ( statistics )
+          if ( prefix )
           {
-            ++skipped_ambiguous_line;
+            prefix->remove_line( r.offset, r.constant_line );
           }
 
-          lines_to_skip += original_lines[garbage_line];
-          max_lines = max_window_lines;
+          /* later candidates refer to the old circuit */
+          max_lines = c.max_lines;
+          break;
         }
-        continue;
-      }
 
-      circuit new_window, new_window_expanded;
-
-      if ( !window_synthesis( new_window, window_spec, order ) )
-      {
-        if ( statistics )
+        switch ( c.status )
         {
+        case window_status::no_constant_line:
+          ++skipped_no_constant_line;
+          break;
+        case window_status::max_window_lines:
+          ++skipped_max_window_lines;
+          break;
+        case window_status::ambiguous_line:
+          ++skipped_ambiguous_line;
+          break;
+        case window_status::synthesis_failed:
           ++skipped_synthesis_failed;
+          break;
+        default:
+          break;
         }
-        lines_to_skip += original_lines.at( garbage_line );
-        max_lines = max_window_lines;
-        continue;
-      }
 
-      expand_circuit( new_window, new_window_expanded, circ.lines(), index_map );
-
-      // remember since we change the circuit
-      circuit window_copy( window.lines() );
-      append_circuit( window_copy, window );
-      unsigned window_length = window.num_gates();
-      unsigned window_offset = window.offset();
-
-      for ( unsigned i = 0u; i < window_length; ++i )
-      {
-        circ.remove_gate_at( window_offset );
+        lines_to_skip += original_lines.at( c.garbage_line );
+        max_lines = max_window_lines;
       }
-      insert_circuit( circ, window_offset, new_window_expanded );
-      remove_line( circ, constant_line, garbage_line );
     }
 
     if ( statistics )
@@ -696,6 +1019,7 @@ namespace cirkit
       statistics->set( "skipped_ambiguous_line", skipped_ambiguous_line );
       statistics->set( "skipped_no_constant_line", skipped_no_constant_line );
       statistics->set( "skipped_synthesis_failed", skipped_synthesis_failed );
+      statistics->set( "simulated_gates", prefix ? prefix->simulated_gates() : 0ull );
     }
 
     return true;
@@ -703,7 +1027,7 @@ namespace cirkit
 
   optimization_func line_reduction_func( properties::ptr settings, properties::ptr statistics )
   {
-    optimization_func f = [&settings, &statistics]( circuit& circ, const circuit& base ) {
+    optimization_func f = [settings, statistics]( circuit& circ, const circuit& base ) {
       return line_reduction( circ, base, settings, statistics );
     };
     f.init( settings, statistics );
@@ -28,6 +28,7 @@
 #ifndef LINE_REDUCTION_HPP
 #define LINE_REDUCTION_HPP
 
+#include <functional>
 #include <iostream>
 
 #include <core/properties.hpp>
@@ -51,6 +52,13 @@ namespace cirkit
    */
   typedef boost::function<bool(circuit&, binary_truth_table&, const std::vector<unsigned>& order)> window_synthesis_func;
 
+  /**
+   * @brief Creates window synthesis functors for the threads of revkit::line_reduction
+   *
+   * @since  2.3
+   */
+  typedef std::function<window_synthesis_func()> window_synthesis_factory;
+
   /**
    * @brief Concrete re-synthesis functor for the revkit::line_reduction algorithm
    *
@@ -95,6 +103,10 @@ namespace cirkit
      * The time is given in milliseconds. If time is 0u,
      * no timeout is used. The default value is 0u.
      *
+     * The synthesis runs in a forked process if a timeout is
+     * set, therefore revkit::line_reduction uses only one thread
+     * in this case.
+     *
      * @since  1.1
      */
     unsigned timeout;
@@ -169,6 +181,38 @@ namespace cirkit
    *   <tr>
    *     <td colspan="2" class="indexvalue">Functor used to re-synthesize the window. It only has to embed and synthesize the window. It is preferred to use \ref revkit::embed_and_synthesize "embed_and_synthesize", whereby the parameters can be adjusted to use different synthesis algorithms.</td>
    *   </tr>
+   *   <tr>
+   *     <td rowspan="2" class="indexvalue">num_threads</td>
+   *     <td class="indexvalue">unsigned</td>
+   *     <td class="indexvalue">1u</td>
+   *   </tr>
+   *   <tr>
+   *     <td colspan="2" class="indexvalue">If larger than 1, the windows of the next garbage lines are re-synthesized concurrently. The first reduced window in the order of the sequential algorithm is used, such that the result does not depend on the number of threads. Only one thread is used if a custom <i>simulation</i> is given or if a window synthesis functor is an \ref revkit::embed_and_synthesize "embed_and_synthesize" with a timeout.</td>
+   *   </tr>
+   *   <tr>
+   *     <td rowspan="2" class="indexvalue">window_synthesis_factory</td>
+   *     <td class="indexvalue">\ref revkit::window_synthesis_factory "window_synthesis_factory"</td>
+   *     <td class="indexvalue"><i>Empty functor</i></td>
+   *   </tr>
+   *   <tr>
+   *     <td colspan="2" class="indexvalue">Creates the window synthesis functors for the additional threads. If empty, \ref revkit::embed_and_synthesize "embed_and_synthesize()" is used. If empty and a custom <i>window_synthesis</i> is given, only one thread is used.</td>
+   *   </tr>
+   *   <tr>
+   *     <td rowspan="2" class="indexvalue">checkpoint_interval</td>
+   *     <td class="indexvalue">unsigned</td>
+   *     <td class="indexvalue">32u</td>
+   *   </tr>
+   *   <tr>
+   *     <td colspan="2" class="indexvalue">If the circuit has less than \em window_variables_threshold (at most 20) non-constant inputs, it is simulated bit-sliced for all input assignments and the values of all lines are stored every this many gates. The window inputs are then obtained by simulating from the closest stored position.</td>
+   *   </tr>
+   *   <tr>
+   *     <td rowspan="2" class="indexvalue">max_checkpoint_memory</td>
+   *     <td class="indexvalue">unsigned long long</td>
+   *     <td class="indexvalue">256ull << 20u</td>
+   *   </tr>
+   *   <tr>
+   *     <td colspan="2" class="indexvalue">Maximum number of bytes for the stored line values (see \em checkpoint_interval). If more positions are needed, every other one is dropped and the interval is doubled. If not even two positions fit, each window is simulated separately.</td>
+   *   </tr>
    * </table>
    * @param statistics <table border="0" width="100%">
    *   <tr>
@@ -206,6 +250,11 @@ namespace cirkit
    *     <td class="indexvalue">unsigned</td>
    *     <td class="indexvalue">Number of skipped windows in the case that the synthesis of the window failed.</td>
    *   </tr>
+   *   <tr>
+   *     <td class="indexvalue">simulated_gates</td>
+   *     <td class="indexvalue">unsigned long long</td>
+   *     <td class="indexvalue">Number of gates simulated bit-sliced to obtain the window inputs (see \em checkpoint_interval).</td>
+   *   </tr>
    * </table>
    * @return true on success
    *
@@ -18,14 +18,21 @@
 
 #include "simplify.hpp"
 
-#include <cmath>
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <vector>
 
 #include <boost/dynamic_bitset.hpp>
 
 #include <core/utils/bitset_utils.hpp>
 #include <core/utils/timer.hpp>
+#include <reversible/flat_circuit.hpp>
 #include <reversible/target_tags.hpp>
 #include <reversible/functions/add_gates.hpp>
+#include <reversible/functions/clear_circuit.hpp>
 #include <reversible/functions/copy_circuit.hpp>
 #include <reversible/functions/copy_metadata.hpp>
 #include <reversible/functions/reverse_circuit.hpp>
@@ -41,32 +48,6 @@ namespace cirkit
  * Private functions                                                          *
  ******************************************************************************/
 
-std::pair<boost::dynamic_bitset<>, boost::dynamic_bitset<>> control_mask( const gate::control_container& controls, unsigned n )
-{
-  boost::dynamic_bitset<> cs( n ), ps( n );
-
-  for ( const auto& c : controls )
-  {
-    assert( c.line() < n );
-
-    cs[c.line()] = 1;
-    ps[c.line()] = c.polarity();
-  }
-
-  return {cs, ps};
-}
-
-gate::control_container make_controls( const boost::dynamic_bitset<>& cs, const boost::dynamic_bitset<>& ps )
-{
-  gate::control_container controls;
-
-  foreach_bit( cs, [&controls, &ps]( unsigned pos ) {
-      controls.push_back( make_var( pos, ps[pos] ) );
-    } );
-
-  return controls;
-}
-
 circuit simplify_not_gates( const circuit& base )
 {
   circuit circ;
@@ -87,8 +68,9 @@ circuit simplify_not_gates( const circuit& base )
     }
     else if ( g.controls().size() == 1 && not_state[target] )
     {
-      /* merge stored not gate into CNOT with the same target */
-      append_cnot( circ, make_var( g.controls().front().line(), !g.controls().front().polarity() ), target );
+      /* merge stored not gate into CNOT with the same target, respect a stored not gate on the control */
+      const auto& c = g.controls().front();
+      append_cnot( circ, make_var( c.line(), c.polarity() == not_state[c.line()] ), target );
       not_state.flip( target );
     }
     else
@@ -113,74 +95,574 @@ circuit simplify_not_gates( const circuit& base )
   return circ;
 }
 
-circuit simplify_adjacent( const circuit& base )
+/* as above, with the NOT gates as line mask */
+flat_circuit simplify_not_gates( const flat_circuit& base )
 {
-  circuit circ;
-  circ.set_lines( base.lines() );
-  copy_metadata( base, circ );
+  flat_circuit circ( base.lines(), base.num_gates() );
 
-  auto pos = 0u;
+  std::uint64_t not_state = 0ull;
 
-  while ( pos < base.num_gates() )
+  for ( auto i = 0u; i < base.num_gates(); ++i )
   {
-    if ( pos + 1 == base.num_gates() )
+    const auto g = base[i];
+    assert( g.kind == flat_gate_kind::toffoli );
+    const auto target = 1ull << g.target1;
+
+    if ( !g.controls )
     {
-      /* last gate */
-      circ.append_gate() = base[pos];
-      break;
+      not_state ^= target;
+    }
+    else if ( !( g.controls & ( g.controls - 1ull ) ) && ( not_state & target ) )
+    {
+      circ.append_toffoli( g.controls, g.polarity ^ ~not_state, g.target1 );
+      not_state ^= target;
+    }
+    else
+    {
+      circ.append_toffoli( g.controls, g.polarity ^ not_state, g.target1 );
     }
+  }
+
+  for ( auto l = 0u; l < base.lines(); ++l )
+  {
+    if ( ( not_state >> l ) & 1u )
+    {
+      circ.append_toffoli( 0ull, 0ull, l );
+    }
+  }
 
-    const auto& g1 = base[pos];
-    const auto& g2 = base[pos + 1];
+  return circ;
+}
 
-    /* candidate for simplication */
-    if ( is_toffoli( g1 ) && is_toffoli( g2 ) && ( g1.targets().front() == g2.targets().front() ) && abs( static_cast<int>( g1.controls().size() ) - static_cast<int>( g2.controls().size() ) ) <= 1 )
+flat_circuit reverse_flat_circuit( const flat_circuit& base )
+{
+  flat_circuit circ( base.lines(), base.num_gates() );
+  for ( auto i = base.num_gates(); i > 0u; --i )
+  {
+    circ.append_gate( base[i - 1u] );
+  }
+  return circ;
+}
+
+/*
+ * Peephole index: every gate keeps one entry per line it touches, and the
+ * entries of all gates on the same line form a doubly linked list in gate
+ * order.  Entries of targets are additionally linked in a list per line,
+ * such that the last gate that changes a line is found in constant time.
+ *
+ * A Toffoli gate y is merged with an earlier gate x with the same target,
+ * if both commute with all gates in between.  This is the case if no gate
+ * in between has the common target as control, which is checked on the
+ * list of the target line, and no gate in between targets a control line,
+ * which is checked on the target lists.  Removed and rewritten gates put
+ * their neighbors on a worklist, since they may have been separated from
+ * a partner before.
+ */
+class peephole_simplifier
+{
+public:
+  peephole_simplifier( unsigned lines, unsigned expected_gates, unsigned search_depth )
+    : last( lines, none ),
+      last_target( lines, none ),
+      stamp( lines, 0u ),
+      polarity( lines, 0 ),
+      search_depth( search_depth )
+  {
+    for ( auto l = 0u; l < lines; ++l )
     {
-      boost::dynamic_bitset<> cs1, ps1, cs2, ps2;
+      line_of_hash[line_hash( l )] = l;
+    }
+
+    /* gates have three lines on average in most circuits */
+    gates.reserve( expected_gates );
+    entries.reserve( 3u * expected_gates );
+  }
+
+  void add_gate( const gate& g, unsigned index )
+  {
+    const auto toffoli = is_toffoli( g );
+
+    auto pg = start_gate( g.targets().front(), toffoli ? none : index );
+    for ( const auto& t : g.targets() )
+    {
+      entries.push_back( {t, true, true, true, none, none, none, none} );
+    }
+    for ( const auto& c : g.controls() )
+    {
+      /* other gates are treated as if they changed all their lines */
+      add_control( pg, c.line(), c.polarity(), !toffoli );
+    }
+    finish_gate( pg );
+  }
+
+  void add_gate( const flat_gate& g )
+  {
+    assert( g.kind == flat_gate_kind::toffoli );
+
+    auto pg = start_gate( g.target1, none );
+    entries.push_back( {g.target1, true, true, true, none, none, none, none} );
+    for ( auto l = 0u; l < stamp.size(); ++l )
+    {
+      if ( ( g.controls >> l ) & 1u )
+      {
+        add_control( pg, l, ( g.polarity >> l ) & 1u, false );
+      }
+    }
+    finish_gate( pg );
+  }
+
+  void write( circuit& circ, const circuit& base ) const
+  {
+    circ.reserve( num_gates );
+
+    for ( const auto& pg : gates )
+    {
+      if ( !pg.alive ) { continue; }
+
+      if ( pg.original != none )
+      {
+        circ.append_gate() = base[pg.original];
+        continue;
+      }
+
+      gate::control_container controls;
+      for ( auto e = pg.first + 1u; e < pg.first + pg.size; ++e )
+      {
+        if ( entries[e].alive )
+        {
+          controls.push_back( make_var( entries[e].line, entries[e].polarity ) );
+        }
+      }
+      append_toffoli( circ, controls, pg.target );
+    }
+  }
+
+  void write( flat_circuit& circ ) const
+  {
+    for ( const auto& pg : gates )
+    {
+      if ( !pg.alive ) { continue; }
+
+      std::uint64_t controls = 0ull, polarity = 0ull;
+      for ( auto e = pg.first + 1u; e < pg.first + pg.size; ++e )
+      {
+        if ( entries[e].alive )
+        {
+          controls |= 1ull << entries[e].line;
+          if ( entries[e].polarity )
+          {
+            polarity |= 1ull << entries[e].line;
+          }
+        }
+      }
+      circ.append_toffoli( controls, polarity, pg.target );
+    }
+  }
+
+  unsigned cancellations = 0u;
+  unsigned merges        = 0u;
+
+private:
+  static constexpr unsigned none = std::numeric_limits<unsigned>::max();
+
+  struct peephole_entry
+  {
+    unsigned line;
+    bool     polarity;    /* only for controls */
+    bool     target;
+    bool     alive;
+    unsigned prev;        /* previous gate on the line */
+    unsigned next;        /* next gate on the line */
+    unsigned prev_target; /* previous gate that targets the line, only for targets */
+    unsigned next_target;
+  };
+
+  struct peephole_gate
+  {
+    unsigned target;
+    unsigned first;    /* entries of Toffoli gates start with the target */
+    unsigned size;
+    unsigned original; /* index in base for all other gates */
+    bool     alive;
+
+    unsigned      num_controls;
+    std::uint64_t signature; /* XOR of the hashes of all control lines */
+  };
+
+  peephole_gate start_gate( unsigned target, unsigned original ) const
+  {
+    peephole_gate pg;
+    pg.target       = target;
+    pg.first        = entries.size();
+    pg.original     = original;
+    pg.alive        = true;
+    pg.num_controls = 0u;
+    pg.signature    = 0ull;
+    return pg;
+  }
+
+  void add_control( peephole_gate& pg, unsigned line, bool polarity, bool target )
+  {
+    entries.push_back( {line, polarity, target, true, none, none, none, none} );
+    ++pg.num_controls;
+    pg.signature ^= line_hash( line );
+  }
+
+  void finish_gate( peephole_gate& pg )
+  {
+    pg.size = entries.size() - pg.first;
+
+    gates.push_back( pg );
+    link( gates.size() - 1u );
+
+    worklist.push_back( gates.size() - 1u );
+    while ( !worklist.empty() )
+    {
+      const auto y = worklist.back();
+      worklist.pop_back();
+
+      if ( !gates[y].alive ) { continue; }
+
+      match m;
+      const auto x = find_partner( y, m );
+      if ( x != none )
+      {
+        merge( x, y, m );
+      }
+    }
+  }
+
+  enum class match_kind { cancel, remove_control, negate_control };
+
+  struct match
+  {
+    match_kind kind;
+    unsigned   gate;   /* gate that is kept */
+    unsigned   entry;  /* entry that is removed or negated */
+  };
+
+  static inline std::uint64_t line_hash( unsigned line )
+  {
+    std::uint64_t h = ( line + 1ull ) * 0x9e3779b97f4a7c15ull;
+    h = ( h ^ ( h >> 30u ) ) * 0xbf58476d1ce4e5b9ull;
+    h = ( h ^ ( h >> 27u ) ) * 0x94d049bb133111ebull;
+    return h ^ ( h >> 31u );
+  }
+
+  inline bool is_toffoli_gate( unsigned g ) const
+  {
+    return gates[g].original == none;
+  }
+
+  unsigned find_entry( unsigned g, unsigned line ) const
+  {
+    for ( auto e = gates[g].first; e < gates[g].first + gates[g].size; ++e )
+    {
+      if ( entries[e].alive && entries[e].line == line ) { return e; }
+    }
+    assert( false );
+    return none;
+  }
+
+  inline peephole_entry& entry_of( unsigned g, unsigned line )
+  {
+    return entries[find_entry( g, line )];
+  }
 
-      std::tie( cs1, ps1 ) = control_mask( g1.controls(), base.lines() );
-      std::tie( cs2, ps2 ) = control_mask( g2.controls(), base.lines() );
+  inline const peephole_entry& entry_of( unsigned g, unsigned line ) const
+  {
+    return entries[find_entry( g, line )];
+  }
 
-      const auto cdc = ( cs1 ^ cs2 ).count();
-      const auto pdc = ( ps1 ^ ps2 ).count();
+  /* last gate before pos that changes line, or none; pos if the search is too deep */
+  unsigned last_target_before( unsigned line, unsigned pos ) const
+  {
+    auto steps = 0u;
+    auto z = last_target[line];
+    while ( z != none && z >= pos )
+    {
+      if ( ++steps > search_depth ) { return pos; }
+      z = entry_of( z, line ).prev_target;
+    }
+    return z;
+  }
 
-      if ( cs1 == cs2 && ps1 == ps2 )
+  void link( unsigned g )
+  {
+    for ( auto e = gates[g].first; e < gates[g].first + gates[g].size; ++e )
+    {
+      const auto line = entries[e].line;
+      entries[e].prev = last[line];
+      if ( last[line] != none )
       {
-        /* same gate, remove */
-        pos += 2;
+        entry_of( last[line], line ).next = g;
       }
-      else if ( cs1 == cs2 && pdc == 1 )
+      last[line] = g;
+
+      if ( entries[e].target )
       {
-        /* remove one control */
-        const auto bit = ( ps1 ^ ps2 ).find_first();
-        assert( cs1[bit] );
-        cs1[bit] = 0;
+        entries[e].prev_target = last_target[line];
+        if ( last_target[line] != none )
+        {
+          entry_of( last_target[line], line ).next_target = g;
+        }
+        last_target[line] = g;
+      }
+    }
+    ++num_gates;
+  }
 
-        append_toffoli( circ, make_controls( cs1, ps1 ), g1.targets().front() );
+  void unlink( unsigned e )
+  {
+    const auto entry = entries[e];
+
+    if ( entry.prev != none )
+    {
+      entry_of( entry.prev, entry.line ).next = entry.next;
+    }
+    if ( entry.next != none )
+    {
+      entry_of( entry.next, entry.line ).prev = entry.prev;
+      worklist.push_back( entry.next );
+    }
+    else
+    {
+      last[entry.line] = entry.prev;
+    }
 
-        pos += 2;
+    if ( entry.target )
+    {
+      if ( entry.prev_target != none )
+      {
+        entry_of( entry.prev_target, entry.line ).next_target = entry.next_target;
+      }
+      if ( entry.next_target != none )
+      {
+        entry_of( entry.next_target, entry.line ).prev_target = entry.prev_target;
       }
-      else if ( cdc == 1 && pdc <= 1 && ( ( pdc == 0 ) || ( cs1 ^ cs2 ).find_first() == ( ps1 ^ ps2 ).find_first() ) )
+      else
       {
-        const auto bit = ( cs1 ^ cs2 ).find_first();
-        cs1[bit] = true;
-        ps1[bit] = pdc == 1 ? false : true;
+        last_target[entry.line] = entry.prev_target;
+      }
+    }
 
-        append_toffoli( circ, make_controls( cs1, ps1 ), g1.targets().front() );
+    entries[e].alive = false;
+  }
 
-        pos += 2;
+  void remove( unsigned g )
+  {
+    for ( auto e = gates[g].first; e < gates[g].first + gates[g].size; ++e )
+    {
+      if ( entries[e].alive )
+      {
+        unlink( e );
+      }
+    }
+    gates[g].alive = false;
+    --num_gates;
+  }
+
+  /* checks whether x (before y) can be merged with y, y's controls are marked */
+  bool match_gates( unsigned x, unsigned y, match& m ) const
+  {
+    /* control lines must be equal or differ in one line */
+    const auto nx = gates[x].num_controls, ny = gates[y].num_controls;
+    const auto d  = gates[x].signature ^ gates[y].signature;
+    if ( nx == ny ? d != 0ull : ( nx + 1u != ny && ny + 1u != nx ) || !line_of_hash.count( d ) )
+    {
+      return false;
+    }
+
+    auto same = 0u, flipped = 0u, only_x = 0u;
+    auto flipped_entry = none, only_x_entry = none;
+
+    for ( auto e = gates[x].first + 1u; e < gates[x].first + gates[x].size; ++e )
+    {
+      if ( !entries[e].alive ) { continue; }
+
+      const auto line = entries[e].line;
+      if ( stamp[line] != current_stamp )
+      {
+        ++only_x;
+        only_x_entry = e;
+      }
+      else if ( polarity[line] == entries[e].polarity )
+      {
+        ++same;
       }
       else
       {
-        circ.append_gate() = base[pos++];
+        ++flipped;
+        flipped_entry = e;
+      }
+    }
+
+    const auto only_y = ny - same - flipped;
+
+    if ( flipped == 0u && only_x == 0u && only_y == 0u )
+    {
+      m = {match_kind::cancel, y, none};
+    }
+    else if ( flipped == 1u && only_x == 0u && only_y == 0u )
+    {
+      /* both gates only differ in the polarity of one control */
+      m = {match_kind::remove_control, y, find_entry( y, entries[flipped_entry].line )};
+    }
+    else if ( flipped == 0u && only_x == 1u && only_y == 0u )
+    {
+      /* x has one additional control, which is negated; no gate in between may change it */
+      const auto z = last_target_before( entries[only_x_entry].line, y );
+      if ( z != none && z > x ) { return false; }
+
+      m = {match_kind::negate_control, x, only_x_entry};
+    }
+    else if ( flipped == 0u && only_x == 0u && only_y == 1u )
+    {
+      /* y has one additional control, which is negated */
+      for ( auto e = gates[y].first + 1u; e < gates[y].first + gates[y].size; ++e )
+      {
+        if ( entries[e].alive && !is_control( x, entries[e].line ) )
+        {
+          m = {match_kind::negate_control, y, e};
+        }
       }
     }
     else
     {
-      circ.append_gate() = base[pos++];
+      return false;
     }
+
+    return true;
   }
 
+  bool is_control( unsigned g, unsigned line ) const
+  {
+    for ( auto e = gates[g].first + 1u; e < gates[g].first + gates[g].size; ++e )
+    {
+      if ( entries[e].alive && entries[e].line == line ) { return true; }
+    }
+    return false;
+  }
+
+  /* returns an earlier gate that can be merged with y */
+  unsigned find_partner( unsigned y, match& m )
+  {
+    if ( !is_toffoli_gate( y ) ) { return none; }
+
+    const auto target = gates[y].target;
+
+    /* mark controls of y, partner must be after the last gate that changes one of them */
+    ++current_stamp;
+    auto barrier = 0u; /* position + 1 */
+    for ( auto e = gates[y].first + 1u; e < gates[y].first + gates[y].size; ++e )
+    {
+      if ( !entries[e].alive ) { continue; }
+
+      const auto line = entries[e].line;
+      stamp[line]    = current_stamp;
+      polarity[line] = entries[e].polarity;
+
+      const auto z = last_target_before( line, y );
+      if ( z != none )
+      {
+        barrier = std::max( barrier, z + 1u );
+      }
+    }
+
+    /* walk back on the target line, gates with the same target commute,
+     * gates with the target as control do not */
+    auto steps = 0u;
+    for ( auto x = entries[gates[y].first].prev; x != none && x >= barrier; x = entries[gates[x].first].prev )
+    {
+      if ( ++steps > search_depth || !is_toffoli_gate( x ) || gates[x].target != target ) { break; }
+
+      if ( match_gates( x, y, m ) )
+      {
+        return x;
+      }
+    }
+
+    return none;
+  }
+
+  void merge( unsigned x, unsigned y, const match& m )
+  {
+    switch ( m.kind )
+    {
+    case match_kind::cancel:
+      remove( x );
+      remove( y );
+      ++cancellations;
+      return;
+
+    case match_kind::remove_control:
+      unlink( m.entry );
+      --gates[m.gate].num_controls;
+      gates[m.gate].signature ^= line_hash( entries[m.entry].line );
+      break;
+
+    case match_kind::negate_control:
+      entries[m.entry].polarity = !entries[m.entry].polarity;
+      break;
+    }
+
+    remove( m.gate == x ? y : x );
+    worklist.push_back( m.gate );
+    ++merges;
+  }
+
+  std::vector<peephole_gate>  gates;
+  std::vector<peephole_entry> entries;
+  std::vector<unsigned>       last;        /* last gate on each line */
+  std::vector<unsigned>       last_target; /* last gate that changes each line */
+  std::vector<unsigned>       worklist;
+  unsigned                    num_gates = 0u;
+
+  /* marks controls of the gate that looks for a partner */
+  std::vector<unsigned>       stamp;
+  std::vector<char>           polarity;
+  unsigned                    current_stamp = 0u;
+
+  std::unordered_map<std::uint64_t, unsigned> line_of_hash;
+
+  unsigned                    search_depth;
+};
+
+constexpr unsigned peephole_simplifier::none;
+
+circuit simplify_peephole( const circuit& base, unsigned search_depth, unsigned& cancellations, unsigned& merges )
+{
+  circuit circ;
+  circ.set_lines( base.lines() );
+  copy_metadata( base, circ );
+
+  peephole_simplifier simplifier( base.lines(), base.num_gates(), search_depth );
+  for ( auto i = 0u; i < base.num_gates(); ++i )
+  {
+    simplifier.add_gate( base[i], i );
+  }
+  simplifier.write( circ, base );
+
+  cancellations += simplifier.cancellations;
+  merges        += simplifier.merges;
+
+  return circ;
+}
+
+flat_circuit simplify_peephole( const flat_circuit& base, unsigned search_depth, unsigned& cancellations, unsigned& merges )
+{
+  flat_circuit circ( base.lines(), base.num_gates() );
+
+  peephole_simplifier simplifier( base.lines(), base.num_gates(), search_depth );
+  for ( auto i = 0u; i < base.num_gates(); ++i )
+  {
+    simplifier.add_gate( base[i] );
+  }
+  simplifier.write( circ );
+
+  cancellations += simplifier.cancellations;
+  merges        += simplifier.merges;
+
   return circ;
 }
 
@@ -190,28 +672,55 @@ circuit simplify_adjacent( const circuit& base )
 
 bool simplify( circuit& circ, const circuit& base, properties::ptr settings, properties::ptr statistics )
 {
+  /* settings */
+  const auto search_depth = get( settings, "search_depth", 32u );
+
   /* timer */
   properties_timer t( statistics );
 
-  circuit tmp;
+  auto cancellations = 0u, merges = 0u;
+
+  if ( flat_circuit::is_supported( base ) )
+  {
+    /* circuits with up to 64 lines are simplified on the flat representation */
+    flat_circuit tmp( base );
 
-  tmp = simplify_not_gates( base );
-  tmp = simplify_adjacent( tmp );
+    tmp = simplify_not_gates( tmp );
+    tmp = simplify_peephole( tmp, search_depth, cancellations, merges );
 
-  reverse_circuit( tmp );
-  tmp = simplify_not_gates( tmp );
-  tmp = simplify_adjacent( tmp );
-  reverse_circuit( tmp );
+    tmp = reverse_flat_circuit( tmp );
+    tmp = simplify_not_gates( tmp );
+    tmp = simplify_peephole( tmp, search_depth, cancellations, merges );
+    tmp = reverse_flat_circuit( tmp );
 
-  copy_circuit( tmp, circ );
+    clear_circuit( circ );
+    tmp.to_circuit( circ );
+  }
+  else
+  {
+    circuit tmp;
+
+    tmp = simplify_not_gates( base );
+    tmp = simplify_peephole( tmp, search_depth, cancellations, merges );
+
+    reverse_circuit( tmp );
+    tmp = simplify_not_gates( tmp );
+    tmp = simplify_peephole( tmp, search_depth, cancellations, merges );
+    reverse_circuit( tmp );
+
+    copy_circuit( tmp, circ );
+  }
   copy_metadata( base, circ );
 
+  set( statistics, "cancellations", cancellations );
+  set( statistics, "merges", merges );
+
   return true;
 }
 
 optimization_func simplify( properties::ptr settings, properties::ptr statistics )
 {
-  optimization_func f = [&settings, &statistics]( circuit& circ, const circuit& base ) {
+  optimization_func f = [settings, statistics]( circuit& circ, const circuit& base ) {
     return simplify( circ, base, settings, statistics );
   };
   f.init( settings, statistics );
@@ -34,6 +34,23 @@
 namespace cirkit
 {
 
+/**
+ * @brief Removes and merges Toffoli gates
+ *
+ * NOT gates are moved into the controls of subsequent gates.  Afterwards,
+ * pairs of Toffoli gates with the same target are cancelled or merged
+ * into one gate, also if they are separated by gates they commute with.
+ * Both steps are applied in both directions of the circuit.
+ *
+ * Settings:
+ *   search_depth (32u): maximum number of gates that are skipped when
+ *                       looking for a partner gate
+ *
+ * Statistics:
+ *   runtime, cancellations, merges
+ *
+ * @since  2.3
+ */
 bool simplify( circuit& circ, const circuit& base, properties::ptr settings = properties::ptr(), properties::ptr statistics = properties::ptr() );
 
 optimization_func simplify( properties::ptr settings = std::make_shared<properties>(),
@@ -18,16 +18,22 @@
 
 #include "window_optimization.hpp"
 
+#include <atomic>
+#include <chrono>
+
+#include <core/utils/thread_pool.hpp>
 #include <core/utils/timer.hpp>
 
 #include <reversible/functions/add_circuit.hpp>
 #include <reversible/functions/circuit_to_truth_table.hpp>
 #include <reversible/functions/copy_circuit.hpp>
+#include <reversible/functions/copy_metadata.hpp>
 #include <reversible/functions/expand_circuit.hpp>
 #include <reversible/functions/find_lines.hpp>
 #include <reversible/io/print_circuit.hpp>
 #include <reversible/simulation/simple_simulation.hpp>
 #include <reversible/synthesis/transformation_based_synthesis.hpp>
+#include <reversible/utils/cost_tracker.hpp>
 
 namespace cirkit
 {
@@ -159,16 +165,242 @@ namespace cirkit
     return synthesis( new_window, spec );
   }
 
+  struct window_candidate
+  {
+    unsigned              from;
+    unsigned              to;
+    std::vector<unsigned> filter;
+  };
+
+  struct window_statistics
+  {
+    unsigned accepted  = 0u;
+    unsigned rejected  = 0u;
+    unsigned slow      = 0u;
+    unsigned rounds    = 0u;
+    unsigned batches   = 0u;
+  };
+
+  /* collects all windows of the current circuit, returns false if a window is not a sub-circuit */
+  bool collect_windows( std::vector<window_candidate>& windows, const circuit& circ, select_window_func& select_window )
+  {
+    windows.clear();
+
+    auto valid = true;
+    while ( true )
+    {
+      circuit s;
+      std::vector<unsigned> filter;
+      std::tie( s, filter ) = select_window( circ );
+
+      if ( s.num_gates() == 0 )
+      {
+        return valid;
+      }
+
+      /* only sub-circuits carry their position, continue to reset the selection */
+      valid = valid && s.is_subcircuit();
+      windows.push_back( {s.offset(), s.offset() + s.num_gates(), filter} );
+    }
+  }
+
+  /* replaces all windows in one pass, windows must be disjoint and sorted */
+  void splice_windows( circuit& circ, const std::vector<window_candidate>& windows, const std::vector<circuit>& replacements )
+  {
+    circuit result( circ.lines() );
+    copy_metadata( circ, result );
+
+    auto pos = 0u;
+    for ( auto i = 0u; i < windows.size(); ++i )
+    {
+      append_circuit( result, subcircuit( circ, pos, windows[i].from ) );
+
+      circuit window_expanded;
+      expand_circuit( replacements[i], window_expanded, circ.lines(), windows[i].filter );
+      append_circuit( result, window_expanded );
+
+      pos = windows[i].to;
+    }
+    append_circuit( result, subcircuit( circ, pos, circ.num_gates() ) );
+
+    circ = result;
+  }
+
+  /*
+   * Each round collects all windows of the current circuit.  Batches of
+   * disjoint windows are optimized concurrently, each thread with its own
+   * optimization functor.  If a batch improved the circuit, all accepted
+   * windows are spliced in and the next round starts; otherwise the next
+   * batch of the remaining windows is tried.  Stops if no window of a round
+   * is accepted.
+   *
+   * Returns false if the windows are not sub-circuits.
+   */
+  bool parallel_window_optimization( circuit& circ, select_window_func& select_window, const window_optimization_factory& factory,
+                                     const cost_function& cf, unsigned num_threads, double max_window_runtime, window_statistics& wstats )
+  {
+    std::vector<optimization_func> optimizations;
+    for ( auto i = 0u; i < num_threads; ++i )
+    {
+      optimizations.push_back( factory() );
+    }
+
+    std::vector<window_candidate> windows;
+    cost_tracker tracker( circ, cf );
+
+    while ( true )
+    {
+      if ( !collect_windows( windows, circ, select_window ) )
+      {
+        return false;
+      }
+
+      ++wstats.rounds;
+      auto improved = false;
+
+      while ( !windows.empty() && !improved )
+      {
+        /* greedily pick disjoint windows */
+        std::vector<window_candidate> batch, remaining;
+        for ( const auto& w : windows )
+        {
+          if ( batch.empty() || w.from >= batch.back().to )
+          {
+            batch.push_back( w );
+          }
+          else
+          {
+            remaining.push_back( w );
+          }
+        }
+        windows.swap( remaining );
+        ++wstats.batches;
+
+        std::vector<circuit> replacements( batch.size() );
+        std::vector<char>    accepted( batch.size(), 0 );
+        std::vector<char>    slow( batch.size(), 0 );
+        std::atomic<unsigned> next( 0u );
+
+        const auto worker = [&]( unsigned id ) {
+          while ( true )
+          {
+            const auto i = next++;
+            if ( i >= batch.size() ) { return; }
+
+            const circuit view = subcircuit( circ, batch[i].from, batch[i].to );
+            circuit filtered;
+            if ( !batch[i].filter.empty() )
+            {
+              copy_circuit( view, filtered, batch[i].filter );
+            }
+            const auto& old_window = batch[i].filter.empty() ? view : filtered;
+
+            const auto start = std::chrono::steady_clock::now();
+            const auto ok    = optimizations[id]( replacements[i], old_window );
+            const auto secs  = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+            if ( max_window_runtime > 0.0 && secs > max_window_runtime )
+            {
+              slow[i] = 1;
+            }
+            else
+            {
+              accepted[i] = ok && tracker.replacement_delta( batch[i].from, batch[i].to, replacements[i] ) < 0ll;
+            }
+          }
+        };
+
+        {
+          thread_pool pool( num_threads );
+          for ( auto id = 0u; id < num_threads; ++id )
+          {
+            pool.enqueue( worker, id );
+          }
+        }
+
+        std::vector<window_candidate> splice;
+        std::vector<circuit>          splice_circuits;
+        for ( auto i = 0u; i < batch.size(); ++i )
+        {
+          if ( accepted[i] )
+          {
+            ++wstats.accepted;
+            splice.push_back( batch[i] );
+            splice_circuits.push_back( replacements[i] );
+          }
+          else if ( slow[i] )
+          {
+            ++wstats.slow;
+          }
+          else
+          {
+            ++wstats.rejected;
+          }
+        }
+
+        if ( !splice.empty() )
+        {
+          splice_windows( circ, splice, splice_circuits );
+          tracker.refresh();
+          improved = true;
+        }
+      }
+
+      if ( !improved )
+      {
+        return true;
+      }
+    }
+  }
+
   bool window_optimization( circuit& circ, const circuit& base, properties::ptr settings, properties::ptr statistics )
   {
     select_window_func select_window = get<select_window_func>( settings, "select_window", shift_window_selection() );
     optimization_func  optimization  = get<optimization_func>( settings, "optimization", resynthesis_optimization() );
     cost_function cf = get<cost_function>( settings, "cost_function", costs_by_circuit_func( gate_costs() ) );
+    unsigned num_threads                = get<unsigned>( settings, "num_threads", 1u );
+    double max_window_runtime           = get<double>( settings, "max_window_runtime", 0.0 );
+    window_optimization_factory factory = get<window_optimization_factory>( settings, "optimization_factory", window_optimization_factory() );
+
+    /* a custom optimization function cannot be shared among threads */
+    if ( !factory && settings && settings->has_key( "optimization" ) )
+    {
+      num_threads = 1u;
+      factory = [&optimization]() { return optimization; };
+    }
+    if ( !factory )
+    {
+      factory = []() { return optimization_func( resynthesis_optimization() ); };
+    }
+    const auto batched = get<bool>( settings, "batched", num_threads > 1u );
 
     properties_timer t( statistics );
 
     copy_circuit( base, circ );
 
+    window_statistics wstats;
+    const auto report = [&]() {
+      set( statistics, "accepted_windows",  wstats.accepted );
+      set( statistics, "rejected_windows",  wstats.rejected );
+      set( statistics, "slow_windows",      wstats.slow );
+      set( statistics, "rounds",            wstats.rounds );
+      set( statistics, "batches",           wstats.batches );
+    };
+
+    if ( batched )
+    {
+      if ( parallel_window_optimization( circ, select_window, factory, cf, num_threads, max_window_runtime, wstats ) )
+      {
+        report();
+        return true;
+      }
+
+      /* windows without position, continue sequentially on the current circuit */
+      wstats = window_statistics();
+    }
+
+    cost_tracker tracker( circ, cf );
+
     while ( true )
     {
       /* select the window */
@@ -186,25 +418,23 @@ namespace cirkit
       circuit new_window;
       bool ok = optimization( new_window, s );
 
-      /* check if it is cheaper */
-      bool cheaper = ok && costs( new_window, cf ) < costs( s, cf );
+      /* check if it is cheaper, only sub-circuits can be looked up in the tracker */
+      unsigned s_size = s.num_gates(); // save in variable since we are changing its base
+      unsigned s_from = s.offset();
+      bool cheaper = ok && ( s.is_subcircuit() ? tracker.replacement_delta( s_from, s_from + s_size, new_window ) < 0ll
+                                               : costs( new_window, cf ) < costs( s, cf ) );
+
+      ++( cheaper ? wstats.accepted : wstats.rejected );
 
       if ( cheaper )
       {
-        /* remove old sub-circuit */
-        unsigned s_size = s.num_gates(); // save in variable since we are changing its base
-        unsigned s_from = s.offset();
-        for ( unsigned i = 0u; i < s_size; ++i )
-        {
-          circ.remove_gate_at( s_from );
-        }
-
-        circuit window_expanded;
-        expand_circuit( new_window, window_expanded, circ.lines(), filter );
-        insert_circuit( circ, s_from, window_expanded );
+        /* replace old sub-circuit */
+        tracker.replace_window( s_from, s_from + s_size, new_window, filter );
       }
     }
 
+    report();
+
     return true;
   }
 
@@ -43,6 +43,16 @@ namespace cirkit
 
   typedef std::tuple<circuit, std::vector<unsigned> > circuit_filter_pair;
 
+  /**
+   * @brief Creates an optimization functor for one window optimization thread
+   *
+   * Each call has to return an independent functor, such that windows can be
+   * optimized concurrently.
+   *
+   * @since  2.3
+   */
+  typedef std::function<optimization_func()> window_optimization_factory;
+
   /**
    * @brief Functor for selecting the windows
    *
@@ -253,6 +263,7 @@ namespace cirkit
    * and in case a window was found, the optimization approach using the \em optimization property is applied.
    *
    * The resulting new window is compared to the extracted one using the cost metric defined in the \em cost_function property.
+   * Gate costs are cached in a cost_tracker, such that only the gates of the new window are evaluated.
    *
    * @param circ Optimized circuit to be generated
    * @param base Original circuit
@@ -286,6 +297,38 @@ namespace cirkit
    *   <tr>
    *     <td colspan="2" class="indexvalue">Cost function to determine whether the optimized circuit is cheaper.</td>
    *   </tr>
+   *   <tr>
+   *     <td rowspan="2" class="indexvalue">num_threads</td>
+   *     <td class="indexvalue">unsigned</td>
+   *     <td class="indexvalue">1u</td>
+   *   </tr>
+   *   <tr>
+   *     <td colspan="2" class="indexvalue">Number of threads for the batched algorithm.</td>
+   *   </tr>
+   *   <tr>
+   *     <td rowspan="2" class="indexvalue">batched</td>
+   *     <td class="indexvalue">bool</td>
+   *     <td class="indexvalue"><i>num_threads</i> &gt; 1</td>
+   *   </tr>
+   *   <tr>
+   *     <td colspan="2" class="indexvalue">If true, batches of windows that do not share gates are optimized concurrently and all accepted windows are replaced in one pass. This is repeated until no window is accepted anymore. The result does not depend on <i>num_threads</i> unless <i>max_window_runtime</i> is set, but may differ from the sequential algorithm. Requires windows that are sub-circuits (as by \ref revkit::shift_window_selection "shift_window_selection"), otherwise the sequential algorithm is used.</td>
+   *   </tr>
+   *   <tr>
+   *     <td rowspan="2" class="indexvalue">optimization_factory</td>
+   *     <td class="indexvalue">\ref revkit::window_optimization_factory "window_optimization_factory"</td>
+   *     <td class="indexvalue"><i>Empty functor</i></td>
+   *   </tr>
+   *   <tr>
+   *     <td colspan="2" class="indexvalue">Creates the optimization functors for the threads. If empty, \ref revkit::resynthesis_optimization "resynthesis_optimization" is used. If empty and a custom <i>optimization</i> is given, only one thread is used.</td>
+   *   </tr>
+   *   <tr>
+   *     <td rowspan="2" class="indexvalue">max_window_runtime</td>
+   *     <td class="indexvalue">double</td>
+   *     <td class="indexvalue">0.0</td>
+   *   </tr>
+   *   <tr>
+   *     <td colspan="2" class="indexvalue">Maximum run-time in seconds of the optimization of one window in the batched algorithm (0 means no limit). The optimization is not interrupted; its result is discarded afterwards if it took longer, such that slow windows are not replaced.</td>
+   *   </tr>
    * </table>
    * @param statistics <table border="0" width="100%">
    *   <tr>
@@ -298,6 +341,31 @@ namespace cirkit
    *     <td class="indexvalue">double</td>
    *     <td class="indexvalue">Run-time consumed by the algorithm in CPU seconds.</td>
    *   </tr>
+   *   <tr>
+   *     <td class="indexvalue">accepted_windows</td>
+   *     <td class="indexvalue">unsigned</td>
+   *     <td class="indexvalue">Number of windows that were replaced.</td>
+   *   </tr>
+   *   <tr>
+   *     <td class="indexvalue">rejected_windows</td>
+   *     <td class="indexvalue">unsigned</td>
+   *     <td class="indexvalue">Number of windows for which no cheaper replacement was found.</td>
+   *   </tr>
+   *   <tr>
+   *     <td class="indexvalue">slow_windows</td>
+   *     <td class="indexvalue">unsigned</td>
+   *     <td class="indexvalue">Number of windows whose result was discarded because the optimization took longer than <i>max_window_runtime</i>.</td>
+   *   </tr>
+   *   <tr>
+   *     <td class="indexvalue">rounds</td>
+   *     <td class="indexvalue">unsigned</td>
+   *     <td class="indexvalue">Number of rounds (only in the batched algorithm).</td>
+   *   </tr>
+   *   <tr>
+   *     <td class="indexvalue">batches</td>
+   *     <td class="indexvalue">unsigned</td>
+   *     <td class="indexvalue">Number of batches of disjoint windows (only in the batched algorithm).</td>
+   *   </tr>
    * </table>
    * @return true on success
    *
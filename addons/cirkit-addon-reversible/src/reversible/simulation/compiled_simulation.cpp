@@ -0,0 +1,343 @@
+/* CirKit: A circuit toolkit
+ * Copyright (C) 2009-2015  University of Bremen
+ * Copyright (C) 2015-2016  EPFL
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "compiled_simulation.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+#include <boost/range/algorithm_ext/iota.hpp>
+
+#include <core/utils/timer.hpp>
+#include <reversible/gate.hpp>
+#include <reversible/target_tags.hpp>
+
+namespace cirkit
+{
+
+/******************************************************************************
+ * Types                                                                      *
+ ******************************************************************************/
+
+/* number of words per line that are simulated together, such that the
+ * values of all lines for one block fit into the cache */
+constexpr unsigned compiled_simulation_block_words = 256u;
+
+/******************************************************************************
+ * compiled_circuit                                                           *
+ ******************************************************************************/
+
+compiled_circuit::compiled_circuit( const circuit& circ )
+  : _lines( circ.lines() )
+{
+  std::vector<unsigned> line_map( circ.lines() );
+  boost::iota( line_map, 0u );
+
+  instructions.reserve( circ.num_gates() );
+  compile( circ, line_map, std::vector<unsigned>() );
+}
+
+void compiled_circuit::compile( const circuit& circ, const std::vector<unsigned>& line_map, const std::vector<unsigned>& extra_controls )
+{
+  for ( const auto& g : circ )
+  {
+    auto gate_controls = extra_controls;
+    for ( const auto& v : g.controls() )
+    {
+      gate_controls.push_back( ( line_map[v.line()] << 1u ) | ( v.polarity() ? 0u : 1u ) );
+    }
+
+    if ( is_toffoli( g ) )
+    {
+      add_instruction( instruction_kind::toffoli, gate_controls, line_map[g.targets().front()], 0u );
+    }
+    else if ( is_fredkin( g ) )
+    {
+      add_instruction( instruction_kind::fredkin, gate_controls, line_map[g.targets()[0u]], line_map[g.targets()[1u]] );
+    }
+    else if ( is_peres( g ) )
+    {
+      add_instruction( instruction_kind::peres, gate_controls, line_map[g.targets()[0u]], line_map[g.targets()[1u]] );
+    }
+    else if ( is_module( g ) )
+    {
+      /* inline the module, line i of the reference is the i-th target */
+      const auto* tag = boost::any_cast<module_tag>( &g.type() );
+
+      std::vector<unsigned> module_map;
+      for ( const auto& t : g.targets() )
+      {
+        module_map.push_back( line_map[t] );
+      }
+
+      compile( *tag->reference, module_map, gate_controls );
+    }
+    else
+    {
+      assert( false );
+    }
+  }
+}
+
+void compiled_circuit::add_instruction( instruction_kind kind, std::vector<unsigned> gate_controls, unsigned target1, unsigned target2 )
+{
+  /* sorted controls access the line values in order */
+  std::sort( gate_controls.begin(), gate_controls.end() );
+
+  instruction ins;
+  ins.kind          = kind;
+  ins.first_control = controls.size();
+  ins.num_controls  = gate_controls.size();
+  ins.target1       = target1;
+  ins.target2       = target2;
+  ins.control_mask  = 0ull;
+  ins.polarity_mask = 0ull;
+
+  for ( const auto& c : gate_controls )
+  {
+    controls.push_back( c );
+
+    if ( _lines <= 64u )
+    {
+      ins.control_mask |= 1ull << ( c >> 1u );
+      if ( !( c & 1u ) )
+      {
+        ins.polarity_mask |= 1ull << ( c >> 1u );
+      }
+    }
+  }
+
+  instructions.push_back( ins );
+}
+
+std::uint64_t compiled_circuit::simulate( std::uint64_t pattern ) const
+{
+  assert( _lines <= 64u );
+
+  for ( const auto& ins : instructions )
+  {
+    if ( ( pattern & ins.control_mask ) != ins.polarity_mask ) { continue; }
+
+    const auto t1 = 1ull << ins.target1;
+    const auto t2 = 1ull << ins.target2;
+
+    switch ( ins.kind )
+    {
+    case instruction_kind::toffoli:
+      pattern ^= t1;
+      break;
+
+    case instruction_kind::fredkin:
+      if ( !( pattern & t1 ) != !( pattern & t2 ) )
+      {
+        pattern ^= t1 | t2;
+      }
+      break;
+
+    case instruction_kind::peres:
+      if ( pattern & t1 )
+      {
+        pattern ^= t2;
+      }
+      pattern ^= t1;
+      break;
+    }
+  }
+
+  return pattern;
+}
+
+void compiled_circuit::simulate( boost::dynamic_bitset<>& pattern ) const
+{
+  assert( pattern.size() == _lines );
+
+  for ( const auto& ins : instructions )
+  {
+    auto active = true;
+    for ( auto c = ins.first_control; c < ins.first_control + ins.num_controls; ++c )
+    {
+      if ( pattern.test( controls[c] >> 1u ) == ( controls[c] & 1u ) )
+      {
+        active = false;
+        break;
+      }
+    }
+
+    if ( !active ) { continue; }
+
+    switch ( ins.kind )
+    {
+    case instruction_kind::toffoli:
+      pattern.flip( ins.target1 );
+      break;
+
+    case instruction_kind::fredkin:
+      {
+        const auto v1 = pattern.test( ins.target1 );
+        pattern.set( ins.target1, pattern.test( ins.target2 ) );
+        pattern.set( ins.target2, v1 );
+      }
+      break;
+
+    case instruction_kind::peres:
+      if ( pattern.test( ins.target1 ) )
+      {
+        pattern.flip( ins.target2 );
+      }
+      pattern.flip( ins.target1 );
+      break;
+    }
+  }
+}
+
+void compiled_circuit::simulate( std::uint64_t* values, unsigned num_words ) const
+{
+  std::vector<std::uint64_t> active( std::min( num_words, compiled_simulation_block_words ) );
+
+  for ( auto first = 0u; first < num_words; first += compiled_simulation_block_words )
+  {
+    const auto bw = std::min( num_words - first, compiled_simulation_block_words );
+    const auto line = [&]( unsigned l ) { return values + l * num_words + first; };
+
+    for ( const auto& ins : instructions )
+    {
+      std::fill( active.begin(), active.begin() + bw, ~0ull );
+      for ( auto c = ins.first_control; c < ins.first_control + ins.num_controls; ++c )
+      {
+        const auto* v = line( controls[c] >> 1u );
+        const auto  m = ( controls[c] & 1u ) ? ~0ull : 0ull;
+        for ( auto w = 0u; w < bw; ++w )
+        {
+          active[w] &= v[w] ^ m;
+        }
+      }
+
+      auto* t1 = line( ins.target1 );
+      auto* t2 = line( ins.target2 );
+
+      switch ( ins.kind )
+      {
+      case instruction_kind::toffoli:
+        for ( auto w = 0u; w < bw; ++w )
+        {
+          t1[w] ^= active[w];
+        }
+        break;
+
+      case instruction_kind::fredkin:
+        for ( auto w = 0u; w < bw; ++w )
+        {
+          const auto d = ( t1[w] ^ t2[w] ) & active[w];
+          t1[w] ^= d;
+          t2[w] ^= d;
+        }
+        break;
+
+      case instruction_kind::peres:
+        for ( auto w = 0u; w < bw; ++w )
+        {
+          t2[w] ^= t1[w] & active[w];
+          t1[w] ^= active[w];
+        }
+        break;
+      }
+    }
+  }
+}
+
+/******************************************************************************
+ * Public functions                                                           *
+ ******************************************************************************/
+
+bool compiled_simulation( boost::dynamic_bitset<>& output, const circuit& circ, const boost::dynamic_bitset<>& input,
+                          const properties::ptr& settings,
+                          const properties::ptr& statistics )
+{
+  properties_timer t( statistics );
+
+  output = input;
+  compiled_circuit( circ ).simulate( output );
+
+  return true;
+}
+
+bool compiled_simulation( std::vector<boost::dynamic_bitset<>>& outputs, const circuit& circ, const std::vector<boost::dynamic_bitset<>>& inputs,
+                          const properties::ptr& settings,
+                          const properties::ptr& statistics )
+{
+  properties_timer t( statistics );
+
+  const auto n         = circ.lines();
+  const auto num_words = ( static_cast<unsigned>( inputs.size() ) + 63u ) >> 6u;
+
+  std::shared_ptr<compiled_circuit> cc;
+  {
+    properties_timer t( statistics, "compile_runtime" );
+    cc = std::make_shared<compiled_circuit>( circ );
+  }
+
+  /* pack patterns */
+  std::vector<std::uint64_t> values( n * num_words, 0ull );
+  for ( auto i = 0u; i < inputs.size(); ++i )
+  {
+    assert( inputs[i].size() == n );
+
+    auto pos = inputs[i].find_first();
+    while ( pos != boost::dynamic_bitset<>::npos )
+    {
+      values[pos * num_words + ( i >> 6u )] |= 1ull << ( i & 63u );
+      pos = inputs[i].find_next( pos );
+    }
+  }
+
+  cc->simulate( values.data(), num_words );
+
+  /* unpack patterns */
+  outputs.assign( inputs.size(), boost::dynamic_bitset<>( n ) );
+  for ( auto l = 0u; l < n; ++l )
+  {
+    for ( auto i = 0u; i < inputs.size(); ++i )
+    {
+      if ( ( values[l * num_words + ( i >> 6u )] >> ( i & 63u ) ) & 1ull )
+      {
+        outputs[i].set( l );
+      }
+    }
+  }
+
+  set( statistics, "instructions", cc->num_instructions() );
+
+  return true;
+}
+
+simulation_func compiled_simulation_func( const properties::ptr& settings, const properties::ptr& statistics )
+{
+  simulation_func f = [settings, statistics]( boost::dynamic_bitset<>& output, const circuit& circ, const boost::dynamic_bitset<>& input ) {
+    return compiled_simulation( output, circ, input, settings, statistics );
+  };
+  f.init( settings, statistics );
+  return f;
+}
+
+}
+
+// Local Variables:
+// c-basic-offset: 2
+// eval: (c-set-offset 'substatement-open 0)
+// eval: (c-set-offset 'innamespace 0)
+// End:
@@ -0,0 +1,139 @@
+/* CirKit: A circuit toolkit
+ * Copyright (C) 2009-2015  University of Bremen
+ * Copyright (C) 2015-2016  EPFL
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file compiled_simulation.hpp
+ *
+ * @brief Bit-sliced simulation of compiled reversible circuits
+ *
+ * A circuit is lowered into a flat array of instructions, which only
+ * consist of control lines, polarities, and targets.  Gate types are
+ * resolved once during compilation and modules are inlined.  The
+ * instructions can then be applied to a single pattern or to 64 patterns
+ * per word at once, where each line holds one bit of every pattern
+ * (bit-sliced).
+ *
+ * @author Mathias Soeken
+ * @since  2.3
+ */
+
+#ifndef COMPILED_SIMULATION_HPP
+#define COMPILED_SIMULATION_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include <boost/dynamic_bitset.hpp>
+
+#include <core/properties.hpp>
+#include <reversible/circuit.hpp>
+#include <reversible/simulation/simulation.hpp>
+
+namespace cirkit
+{
+
+/******************************************************************************
+ * compiled_circuit                                                           *
+ ******************************************************************************/
+
+class compiled_circuit
+{
+public:
+  enum class instruction_kind : unsigned char { toffoli, fredkin, peres };
+
+  /* controls are stored as ( line << 1 ) | negative */
+  struct instruction
+  {
+    instruction_kind kind;
+    unsigned         first_control;
+    unsigned         num_controls;
+    unsigned         target1;
+    unsigned         target2;
+    std::uint64_t    control_mask;  /* only valid if lines() <= 64 */
+    std::uint64_t    polarity_mask; /* only valid if lines() <= 64 */
+  };
+
+  explicit compiled_circuit( const circuit& circ );
+
+  inline unsigned lines() const                                 { return _lines; }
+  inline unsigned num_instructions() const                      { return instructions.size(); }
+  inline const std::vector<instruction>& get_instructions() const { return instructions; }
+
+  /* single pattern, bit i is the value of line i (requires lines() <= 64) */
+  std::uint64_t simulate( std::uint64_t pattern ) const;
+
+  /* single pattern of arbitrary width */
+  void simulate( boost::dynamic_bitset<>& pattern ) const;
+
+  /* bit-sliced simulation: values contains num_words words for each line
+   * (line-major), bit j of word w of line l is the value of line l in
+   * pattern 64 * w + j */
+  void simulate( std::uint64_t* values, unsigned num_words ) const;
+
+private:
+  void compile( const circuit& circ, const std::vector<unsigned>& line_map, const std::vector<unsigned>& extra_controls );
+  void add_instruction( instruction_kind kind, std::vector<unsigned> controls, unsigned target1, unsigned target2 );
+
+  unsigned                 _lines;
+  std::vector<instruction> instructions;
+  std::vector<unsigned>    controls;
+};
+
+/******************************************************************************
+ * Functions                                                                  *
+ ******************************************************************************/
+
+/**
+ * @brief Simulates a single pattern with a compiled circuit
+ *
+ * Same interface as simple_simulation, the circuit is compiled for each call.
+ * Use compiled_circuit directly, or the multi-pattern version, when
+ * simulating many patterns.
+ *
+ * @since  2.3
+ */
+bool compiled_simulation( boost::dynamic_bitset<>& output, const circuit& circ, const boost::dynamic_bitset<>& input,
+                          const properties::ptr& settings = properties::ptr(),
+                          const properties::ptr& statistics = properties::ptr() );
+
+/**
+ * @brief Simulates many patterns with a compiled circuit
+ *
+ * The patterns are packed 64 per word and simulated in a bit-sliced way.
+ *
+ * Statistics:
+ *   runtime, compile_runtime, instructions
+ *
+ * @since  2.3
+ */
+bool compiled_simulation( std::vector<boost::dynamic_bitset<>>& outputs, const circuit& circ, const std::vector<boost::dynamic_bitset<>>& inputs,
+                          const properties::ptr& settings = properties::ptr(),
+                          const properties::ptr& statistics = properties::ptr() );
+
+simulation_func compiled_simulation_func( const properties::ptr& settings = std::make_shared<properties>(),
+                                          const properties::ptr& statistics = std::make_shared<properties>() );
+
+}
+
+#endif
+
+// Local Variables:
+// c-basic-offset: 2
+// eval: (c-set-offset 'substatement-open 0)
+// eval: (c-set-offset 'innamespace 0)
+// End:
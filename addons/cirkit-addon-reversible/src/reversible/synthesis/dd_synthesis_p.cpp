@@ -18,18 +18,20 @@
 
 #include "dd_synthesis_p.hpp"
 
+#include <algorithm>
+#include <fstream>
 #include <iostream>
-#include <map>
+#include <limits>
+#include <unordered_map>
 #include <vector>
 #include <memory>
 
 #include <boost/algorithm/string/classification.hpp>
-#include <boost/algorithm/string/join.hpp>
 #include <boost/algorithm/string/split.hpp>
 #include <boost/algorithm/string/trim.hpp>
 #include <boost/assign/std/vector.hpp>
 #include <boost/format.hpp>
-#include <boost/graph/graphviz.hpp>
+#include <boost/lexical_cast.hpp>
 #include <boost/optional.hpp>
 #include <boost/range/adaptor/map.hpp>
 #include <boost/range/algorithm.hpp>
@@ -43,7 +45,7 @@
 #include <core/io/read_pla_to_bdd.hpp>
 
 #include <reversible/circuit.hpp>
-#include <reversible/functions/add_gates.hpp>
+#include <reversible/target_tags.hpp>
 #include <reversible/functions/clear_circuit.hpp>
 
 namespace cirkit
@@ -54,123 +56,57 @@ namespace internal
 
   using namespace boost::assign;
 
-  typedef boost::graph_traits<dd>::vertex_descriptor dd_node;
-  typedef boost::graph_traits<dd>::edge_descriptor   dd_edge;
+  constexpr unsigned dd_no_line = std::numeric_limits<unsigned>::max();
 
-  struct vertex_drawer
+  unsigned dd_add_node( dd& graph, dd_node node )
   {
-    explicit vertex_drawer( const dd& graph ) : _graph ( graph ) {}
-
-    template<typename Vertex>
-    void operator()( std::ostream& os, const Vertex& v ) const
+    if ( !node.constant )
     {
-      if ( !boost::in_degree( v, _graph ) || !boost::out_degree( v, _graph ) )
-      {
-        std::string label;
-        if ( out_degree( v, _graph ) )
-        {
-          label = get_property( _graph, boost::graph_name ).labels.at( get( boost::vertex_name, _graph )[v].var );
-        }
-        else
-        {
-          label = boost::lexical_cast<std::string>( get( boost::vertex_name, _graph )[v].var );
-        }
-        os << "[shape=\"rectangle\",label=\"" << label << "\"]";
-      }
-      else
-      {
-        os << "[label=\""
-           << get_property( _graph, boost::graph_name ).labels.at( get( boost::vertex_name, _graph )[v].var )
-           << ":"
-           << get( boost::vertex_name, _graph )[v].dtl
-           << "\"]";
-      }
+      ++graph.nodes[node.low].fanout;
+      ++graph.nodes[node.high].fanout;
     }
-
-  private:
-    const dd& _graph;
-  };
-
-  struct edge_drawer
-  {
-  public:
-    explicit edge_drawer( const dd& graph ) : _graph( graph ) {}
-
-    template<typename Edge>
-    void operator()( std::ostream& os, const Edge& e ) const
-    {
-      dd_node source = boost::source( e, _graph );
-
-      std::vector<std::string> properties;
-      if ( e == *boost::out_edges( source, _graph ).first && in_degree( source, _graph ) )
-      {
-        properties += "style=dashed";
-      }
-      if ( get( boost::edge_name, _graph )[e].complemented )
-      {
-        properties += "color=red";
-      }
-
-      if ( properties.size() )
-      {
-        properties.front().insert( 0, "[" );
-        properties.back().append( "]" );
-      }
-
-      os << boost::algorithm::join( properties, "," );
-    }
-
-  private:
-    const dd& _graph;
-  };
-
-  void dd_to_dot( const dd& graph, const std::string& filename )
-  {
-    std::filebuf fb;
-    fb.open( filename.c_str(), std::ios::out );
-    std::ostream os( &fb );
-    boost::write_graphviz( os, graph, vertex_drawer( graph ), edge_drawer( graph ) );
-    fb.close();
+    graph.nodes.push_back( node );
+    return graph.nodes.size() - 1u;
   }
 
-  unsigned dd_node_var( const dd_node& node, const dd& graph )
+  void dd_add_root( dd& graph, unsigned node, bool complemented )
   {
-    return get( boost::vertex_name, graph )[node].var;
+    ++graph.nodes[node].fanout;
+    graph.roots += node;
+    graph.root_complemented += complemented;
   }
 
-  bool dd_node_is_constant( const dd_node& node, const dd& graph )
+  /* label of the output, which is at the end of the labels */
+  const std::string& dd_output_label( const dd& graph, unsigned output )
   {
-    return !out_degree( node, graph );
+    return graph.labels.at( graph.labels.size() - graph.roots.size() + output );
   }
 
-  dd_node dd_root_get_function_root( const dd_node& node, const dd& graph )
+  void dd_to_dot( const dd& graph, const std::string& filename )
   {
-    boost::graph_traits<dd>::in_edge_iterator itEdge, itEnd;
+    std::ofstream os( filename.c_str() );
 
-    for ( boost::tie( itEdge, itEnd ) = in_edges( node, graph ); itEdge != itEnd; ++itEdge )
+    os << "digraph G {" << std::endl;
+    for ( auto i = 0u; i < graph.nodes.size(); ++i )
     {
-      if ( in_degree( source( *itEdge, graph ), graph ) == 0 )
+      const auto& node = graph.nodes[i];
+      if ( node.constant )
+      {
+        os << "n" << i << "[shape=\"rectangle\",label=\"" << node.var << "\"];" << std::endl;
+      }
+      else
       {
-        return source( *itEdge, graph );
+        os << "n" << i << "[label=\"" << graph.labels.at( node.var ) << ":" << node.dtl << "\"];" << std::endl;
+        os << "n" << i << "->n" << node.low << "[style=dashed" << ( node.low_complemented ? ",color=red" : "" ) << "];" << std::endl;
+        os << "n" << i << "->n" << node.high << ( node.high_complemented ? "[color=red]" : "" ) << ";" << std::endl;
       }
     }
-
-    assert( false );
-  }
-
-  bool dd_root_is_complemented( const dd_node& node, const dd& graph )
-  {
-    return get( boost::edge_name, graph )[*out_edges( dd_root_get_function_root( node, graph ), graph ).first].complemented;
-  }
-
-  const std::vector<std::string>& dd_labels( const dd& graph )
-  {
-    return get_property( graph, boost::graph_name ).labels;
-  }
-
-  const std::vector<dd_node>& dd_roots( const dd& graph )
-  {
-    return get_property( graph, boost::graph_name ).roots;
+    for ( auto i = 0u; i < graph.roots.size(); ++i )
+    {
+      os << "o" << i << "[shape=\"rectangle\",label=\"" << dd_output_label( graph, i ) << "\"];" << std::endl;
+      os << "o" << i << "->n" << graph.roots[i] << ( graph.root_complemented[i] ? "[color=red]" : "" ) << ";" << std::endl;
+    }
+    os << "}" << std::endl;
   }
 
   ////////////////////////////////////////////////////////////////////////////////
@@ -213,54 +149,40 @@ namespace internal
     }
   }
 
-  dd_node dd_from_kfdd( dd& graph, dd_man* manager, utnode* node, std::map<utnode*, dd_node>& visited_map )
+  unsigned dd_from_kfdd( dd& graph, dd_man* manager, utnode* node, std::unordered_map<utnode*, unsigned>& visited_map )
   {
-    if ( visited_map.find( node ) != visited_map.end() )
+    const auto it = visited_map.find( node );
+    if ( it != visited_map.end() )
     {
-      return visited_map[node];
+      return it->second;
     }
 
-    dd_node v = boost::add_vertex( graph );
+    dd_node v;
 
     if ( !OKFDD_IsConstant( manager, node ) )
     {
-      dd_node low  = dd_from_kfdd( graph, manager, OKFDD_Regular( (m_and(node))->lo_p ), visited_map );
-      dd_node high = dd_from_kfdd( graph, manager, OKFDD_Regular( (m_and(node))->hi_p ), visited_map );
-
-      add_edge( v, low, graph );
-      dd_edge edge;
-      bool    ok;
-      boost::tie( edge, ok ) = add_edge( v, high, graph );
-      get( boost::edge_name, graph )[edge].complemented = OKFDD_IsComplement( (m_and(node))->hi_p );
-
-      get( boost::vertex_name, graph )[v].var = manager->OKFDD_Label( node ) - 1;
-      get( boost::vertex_name, graph )[v].dtl = (unsigned short)manager->OKFDD_PI_DTL_Table[manager->OKFDD_Label( node )];
+      v.constant          = false;
+      v.low               = dd_from_kfdd( graph, manager, OKFDD_Regular( (m_and(node))->lo_p ), visited_map );
+      v.high              = dd_from_kfdd( graph, manager, OKFDD_Regular( (m_and(node))->hi_p ), visited_map );
+      v.high_complemented = OKFDD_IsComplement( (m_and(node))->hi_p );
+      v.var               = manager->OKFDD_Label( node ) - 1;
+      v.dtl               = (unsigned short)manager->OKFDD_PI_DTL_Table[manager->OKFDD_Label( node )];
     }
     else
     {
-      get( boost::vertex_name, graph )[v].var = OKFDD_Value( manager, node );
+      v.var = OKFDD_Value( manager, node );
     }
 
-    visited_map[node] = v;
-
-    return v;
+    return visited_map[node] = dd_add_node( graph, v );
   }
 
   void dd_from_kfdd( dd& graph, dd_man* manager, const std::vector<utnode*>& nodes )
   {
-    std::map<utnode*, dd_node> visited_map;
+    std::unordered_map<utnode*, unsigned> visited_map;
 
-    for ( std::vector<utnode*>::const_iterator it = nodes.begin(); it != nodes.end(); ++it )
+    for ( auto* node : nodes )
     {
-      dd_node v = boost::add_vertex( graph );
-      bool ok;
-      dd_edge edge;
-      dd_node v2 = dd_from_kfdd( graph, manager, *it, visited_map );
-      boost::tie( edge, ok ) = add_edge( v, v2, graph );
-      get( boost::edge_name, graph )[edge].complemented = OKFDD_IsComplement( *it );
-
-      get( boost::vertex_name, graph )[v].var      = get_property( graph, boost::graph_name ).labels.size() - nodes.size() + ( it - nodes.begin() );
-      get_property( graph, boost::graph_name ).roots += v2;
+      dd_add_root( graph, dd_from_kfdd( graph, manager, node, visited_map ), OKFDD_IsComplement( node ) );
     }
   }
 
@@ -348,10 +270,10 @@ namespace internal
     boost::algorithm::trim( input_names );
     boost::algorithm::trim( output_names );
     boost::algorithm::split( labels, input_names, boost::is_any_of( " " ) );
-    get_property( graph, boost::graph_name ).ninputs = labels.size();
-    std::copy( labels.begin(), labels.end(), std::back_inserter( get_property( graph, boost::graph_name ).labels ) );
+    graph.ninputs = labels.size();
+    boost::push_back( graph.labels, labels );
     boost::algorithm::split( labels, output_names, boost::is_any_of( " " ) );
-    std::copy( labels.begin(), labels.end(), std::back_inserter( get_property( graph, boost::graph_name ).labels ) );
+    boost::push_back( graph.labels, labels );
 
     std::vector<utnode*> nodes;
     for ( unsigned i = 0; i < npo; ++i )
@@ -367,7 +289,7 @@ namespace internal
       *settings.node_count = dd_manager->OKFDD_Size_all();
       //*settings.node_count = dd_manager->OKFDD_Now_size_i;
       // TODO This fixes node counting
-      //*settings.node_count = boost::num_vertices( graph ) - 1u - ( get_property( graph, boost::graph_name ).labels.size() - get_property( graph, boost::graph_name ).ninputs );
+      //*settings.node_count = graph.nodes.size();
     }
   }
 
@@ -382,53 +304,39 @@ namespace internal
   {
   }
 
-  dd_node dd_from_bdd( dd& graph, DdNode* node, std::map<DdNode*, dd_node>& visited_map )
+  unsigned dd_from_bdd( dd& graph, DdNode* node, std::unordered_map<DdNode*, unsigned>& visited_map )
   {
-    if ( visited_map.find( node ) != visited_map.end() )
+    const auto it = visited_map.find( node );
+    if ( it != visited_map.end() )
     {
-      return visited_map[node];
+      return it->second;
     }
 
-    dd_node v = boost::add_vertex( graph );
+    dd_node v;
 
     if ( !cuddIsConstant( node ) )
     {
-      dd_node low  = dd_from_bdd( graph, Cudd_Regular( cuddE( node ) ), visited_map );
-      dd_node high = dd_from_bdd( graph, cuddT( node ), visited_map );
-
-      dd_edge edge;
-      bool    ok;
-      boost::tie( edge, ok ) = add_edge( v, low, graph );
-      get( boost::edge_name, graph )[edge].complemented = Cudd_IsComplement( cuddE( node ) );
-
-      add_edge( v, high, graph );
-
-      get( boost::vertex_name, graph )[v].var = node->index;
+      v.constant         = false;
+      v.low              = dd_from_bdd( graph, Cudd_Regular( cuddE( node ) ), visited_map );
+      v.low_complemented = Cudd_IsComplement( cuddE( node ) );
+      v.high             = dd_from_bdd( graph, cuddT( node ), visited_map );
+      v.var              = node->index;
     }
     else
     {
-      get( boost::vertex_name, graph )[v].var = cuddV( node );
+      v.var = cuddV( node );
     }
 
-    visited_map[node] = v;
-
-    return v;
+    return visited_map[node] = dd_add_node( graph, v );
   }
 
   void dd_from_bdd( dd& graph, const std::vector<DdNode*>& nodes )
   {
-    std::map<DdNode*, dd_node> visited_map;
-
-    for ( std::vector<DdNode*>::const_iterator it = nodes.begin(); it != nodes.end(); ++it ) {
-      dd_node v = boost::add_vertex( graph );
-      bool ok;
-      dd_edge edge;
-      dd_node v2 = dd_from_bdd( graph, Cudd_Regular( *it ), visited_map );
-      boost::tie( edge, ok ) = add_edge( v, v2, graph );
-      get( boost::edge_name, graph )[edge].complemented = Cudd_IsComplement( *it );
-
-      get( boost::vertex_name, graph )[v].var = get_property( graph, boost::graph_name ).labels.size() - nodes.size() + ( it - nodes.begin() );
-      get_property( graph, boost::graph_name ).roots += v2;
+    std::unordered_map<DdNode*, unsigned> visited_map;
+
+    for ( auto* node : nodes )
+    {
+      dd_add_root( graph, dd_from_bdd( graph, Cudd_Regular( node ), visited_map ), Cudd_IsComplement( node ) );
     }
   }
 
@@ -473,10 +381,10 @@ namespace internal
     std::vector<DdNode*> nodes;
     boost::push_back( nodes, bdd.outputs | map_values );
 
-    boost::push_back( get_property( graph, boost::graph_name ).labels, bdd.inputs | map_keys );
-    boost::push_back( get_property( graph, boost::graph_name ).labels, bdd.outputs | map_keys );
+    boost::push_back( graph.labels, bdd.inputs | map_keys );
+    boost::push_back( graph.labels, bdd.outputs | map_keys );
 
-    get_property( graph, boost::graph_name ).ninputs = bdd.inputs.size();
+    graph.ninputs = bdd.inputs.size();
 
     dd_from_bdd( graph, nodes );
   }
@@ -511,18 +419,17 @@ namespace internal
     }
 
     /* I/O */
-    auto& info = get_property( graph, boost::graph_name );
     for ( auto i = 0u; i < bdds.first.ReadSize(); ++i )
     {
-      info.labels.push_back( boost::str( boost::format( "i%d" ) % i ) );
+      graph.labels.push_back( boost::str( boost::format( "i%d" ) % i ) );
     }
 
     for ( auto i = 0u; i < bdds.second.size(); ++i )
     {
-      info.labels.push_back( boost::str( boost::format( "o%d" ) % i ) );
+      graph.labels.push_back( boost::str( boost::format( "o%d" ) % i ) );
     }
 
-    info.ninputs = bdds.first.ReadSize();
+    graph.ninputs = bdds.first.ReadSize();
 
     dd_from_bdd( graph, nodes );
   }
@@ -530,13 +437,23 @@ namespace internal
   ////////////////////////////////////////////////////////////////////////////////
   // DD Synthesis                                                               //
   ////////////////////////////////////////////////////////////////////////////////
+
+  /* gate of a node template, Toffoli gate with up to two positive controls */
+  struct template_gate
+  {
+    unsigned num_controls;
+    unsigned controls[2];
+    unsigned target;
+  };
+
   struct data
   {
     unsigned lines;
 
     std::vector<int> constantValue;
     std::vector<int> lineNeeded;
-    std::map<dd_node, unsigned> node2line;
+    std::vector<unsigned> node2line;
+    std::vector<template_gate> gates;
 
     unsigned up( unsigned cv )
     {
@@ -545,9 +462,13 @@ namespace internal
       constantValue += cv;
       return ret;
     }
+
+    inline void not_gate( unsigned target )                        { gates.push_back( {0u, {0u, 0u}, target} ); }
+    inline void cnot( unsigned control, unsigned target )          { gates.push_back( {1u, {control, 0u}, target} ); }
+    inline void toffoli( unsigned c1, unsigned c2, unsigned target ) { gates.push_back( {2u, {c1, c2}, target} ); }
   };
 
-  int reversible_generator( circuit& circ, data& d, unsigned index, unsigned dtl, int low, int high, bool low_complemented, bool high_complemented )
+  int reversible_generator( data& d, unsigned index, unsigned dtl, int low, int high, bool low_complemented, bool high_complemented )
   {
     if ( low >= 0 && high >= 0 )
     {
@@ -562,14 +483,14 @@ namespace internal
             {
               unsigned tmpLine = d.up( 0 );
 
-              append_cnot( circ, index, tmpLine );
-              append_cnot( circ, low, tmpLine );
+              d.cnot( index, tmpLine );
+              d.cnot( low, tmpLine );
 
               return tmpLine;
             }
             else
             {
-              append_cnot( circ, index, low );
+              d.cnot( index, low );
 
               return low;
             }
@@ -580,15 +501,15 @@ namespace internal
             {
               unsigned tmpLine = d.up( 1 );
 
-              append_cnot( circ, index, tmpLine );
-              append_cnot( circ, low, tmpLine );
+              d.cnot( index, tmpLine );
+              d.cnot( low, tmpLine );
 
               return tmpLine;
             }
             else
             {
-              append_cnot( circ, index, low );
-              append_not( circ, low );
+              d.cnot( index, low );
+              d.not_gate( low );
 
               return low;
             }
@@ -600,9 +521,9 @@ namespace internal
           {
             unsigned tmpLine = d.up( 0 );
 
-            append_toffoli( circ )( index, low )( tmpLine );
-            append_cnot( circ, index, tmpLine );
-            append_cnot( circ, low, tmpLine );
+            d.toffoli( index, low, tmpLine );
+            d.cnot( index, tmpLine );
+            d.cnot( low, tmpLine );
 
             return tmpLine;
           }
@@ -613,8 +534,8 @@ namespace internal
           {
             unsigned tmpLine = d.up( 0 );
 
-            append_toffoli( circ )( index, low )( tmpLine );
-            append_cnot( circ, low, tmpLine );
+            d.toffoli( index, low, tmpLine );
+            d.cnot( low, tmpLine );
 
             return tmpLine;
           }
@@ -625,8 +546,8 @@ namespace internal
           {
             unsigned tmpLine = d.up( 1 );
 
-            append_toffoli( circ )( index, low )( tmpLine );
-            append_cnot( circ, index, tmpLine );
+            d.toffoli( index, low, tmpLine );
+            d.cnot( index, tmpLine );
 
             return tmpLine;
           }
@@ -637,7 +558,7 @@ namespace internal
           {
             unsigned tmpLine = d.up( 0 );
 
-            append_toffoli( circ )( index, low )( tmpLine );
+            d.toffoli( index, low, tmpLine );
 
             return tmpLine;
           }
@@ -653,10 +574,10 @@ namespace internal
           {
             unsigned tmpLine = d.up( 0 );
 
-            append_cnot( circ, index, tmpLine );
-            append_cnot( circ, low, tmpLine );
-            append_toffoli( circ )( index, high )( tmpLine );
-            append_toffoli( circ )( index, low )( tmpLine );
+            d.cnot( index, tmpLine );
+            d.cnot( low, tmpLine );
+            d.toffoli( index, high, tmpLine );
+            d.toffoli( index, low, tmpLine );
 
             return tmpLine;
           }
@@ -664,10 +585,10 @@ namespace internal
           {
             unsigned tmpLine = d.up( 1 );
 
-            append_cnot( circ, index, tmpLine );
-            append_cnot( circ, low, tmpLine );
-            append_toffoli( circ )( index, high )( tmpLine );
-            append_toffoli( circ )( index, low )( tmpLine );
+            d.cnot( index, tmpLine );
+            d.cnot( low, tmpLine );
+            d.toffoli( index, high, tmpLine );
+            d.toffoli( index, low, tmpLine );
 
             return tmpLine;
           }
@@ -675,9 +596,9 @@ namespace internal
           {
             unsigned tmpLine = d.up( 0 );
 
-            append_cnot( circ, low, tmpLine );
-            append_toffoli( circ )( index, high )( tmpLine );
-            append_toffoli( circ )( index, low )( tmpLine );
+            d.cnot( low, tmpLine );
+            d.toffoli( index, high, tmpLine );
+            d.toffoli( index, low, tmpLine );
 
             return tmpLine;
           }
@@ -688,9 +609,9 @@ namespace internal
           {
             unsigned tmpLine = d.up( 0 );
 
-            append_toffoli( circ )( index, high )( tmpLine );
-            append_cnot( circ, low, tmpLine );
-            append_cnot( circ, index, tmpLine );
+            d.toffoli( index, high, tmpLine );
+            d.cnot( low, tmpLine );
+            d.cnot( index, tmpLine );
 
             return tmpLine;
           }
@@ -701,8 +622,8 @@ namespace internal
           {
             unsigned tmpLine = d.up( 0 );
 
-            append_toffoli( circ )( index, high )( tmpLine );
-            append_cnot( circ, low, tmpLine );
+            d.toffoli( index, high, tmpLine );
+            d.cnot( low, tmpLine );
 
             return tmpLine;
           }
@@ -713,10 +634,10 @@ namespace internal
           {
             unsigned tmpLine = d.up( 1 );
 
-            append_toffoli( circ )( index, high )( tmpLine );
-            append_cnot( circ, low, tmpLine );
-            append_cnot( circ, high, tmpLine );
-            append_cnot( circ, index, tmpLine );
+            d.toffoli( index, high, tmpLine );
+            d.cnot( low, tmpLine );
+            d.cnot( high, tmpLine );
+            d.cnot( index, tmpLine );
 
             return tmpLine;
           }
@@ -727,9 +648,9 @@ namespace internal
           {
             unsigned tmpLine = d.up( 0 );
 
-            append_toffoli( circ )( index, high )( tmpLine );
-            append_cnot( circ, low, tmpLine );
-            append_cnot( circ, high, tmpLine );
+            d.toffoli( index, high, tmpLine );
+            d.cnot( low, tmpLine );
+            d.cnot( high, tmpLine );
 
             return tmpLine;
           }
@@ -743,24 +664,24 @@ namespace internal
         case 0:
           if ( high_complemented )
           {
-            append_toffoli( circ )( index, low )( high );
-            append_cnot( circ, index, low );
-            append_toffoli( circ )( high, index )( low );
+            d.toffoli( index, low, high );
+            d.cnot( index, low );
+            d.toffoli( high, index, low );
 
             return low;
           }
           else if ( low_complemented )
           {
-            append_not( circ, low );
-            append_toffoli( circ )( low, index )( high );
-            append_toffoli( circ )( high, index )( low );
+            d.not_gate( low );
+            d.toffoli( low, index, high );
+            d.toffoli( high, index, low );
 
             return low;
           }
           else
           {
-            append_cnot( circ, low, high );
-            append_toffoli( circ )( high, index )( low );
+            d.cnot( low, high );
+            d.toffoli( high, index, low );
 
             return low;
           }
@@ -769,8 +690,8 @@ namespace internal
         case 1:
           if ( high_complemented )
           {
-            append_toffoli( circ )( index, high )( low );
-            append_cnot( circ, index, low );
+            d.toffoli( index, high, low );
+            d.cnot( index, low );
 
             return low;
           }
@@ -779,7 +700,7 @@ namespace internal
           }
           else
           {
-            append_toffoli( circ )( index, high )( low );
+            d.toffoli( index, high, low );
 
             return low;
           }
@@ -788,9 +709,9 @@ namespace internal
         case 2:
           if ( high_complemented )
           {
-            append_not( circ, high );
-            append_toffoli( circ )( index, high )( low );
-            append_cnot( circ, low, high );
+            d.not_gate( high );
+            d.toffoli( index, high, low );
+            d.cnot( low, high );
 
             return high;
           }
@@ -799,8 +720,8 @@ namespace internal
           }
           else
           {
-            append_toffoli( circ )( index, high )( low );
-            append_cnot( circ, low, high );
+            d.toffoli( index, high, low );
+            d.cnot( low, high );
 
             return high;
           }
@@ -817,7 +738,7 @@ namespace internal
         {
           unsigned tmpLine = d.up( 1 );
 
-          append_toffoli( circ )( index, high )( tmpLine );
+          d.toffoli( index, high, tmpLine );
 
           return tmpLine;
         }
@@ -828,8 +749,8 @@ namespace internal
         {
           unsigned tmpLine = d.up( 1 );
 
-          append_toffoli( circ )( index, high )( tmpLine );
-          append_cnot( circ, index, tmpLine );
+          d.toffoli( index, high, tmpLine );
+          d.cnot( index, tmpLine );
 
           return tmpLine;
         }
@@ -840,8 +761,8 @@ namespace internal
         {
           unsigned tmpLine = d.up( 1 );
 
-          append_toffoli( circ )( index, high )( tmpLine );
-          append_cnot( circ, index, tmpLine );
+          d.toffoli( index, high, tmpLine );
+          d.cnot( index, tmpLine );
 
           return tmpLine;
         }
@@ -852,7 +773,7 @@ namespace internal
         {
           unsigned tmpLine = d.up( 1 );
 
-          append_toffoli( circ )( index, high )( tmpLine );
+          d.toffoli( index, high, tmpLine );
 
           return tmpLine;
         }
@@ -863,9 +784,9 @@ namespace internal
         {
           unsigned tmpLine = d.up( 0 );
 
-          append_toffoli( circ )( index, high )( tmpLine );
-          append_cnot( circ, high, tmpLine );
-          append_cnot( circ, index, tmpLine );
+          d.toffoli( index, high, tmpLine );
+          d.cnot( high, tmpLine );
+          d.cnot( index, tmpLine );
 
           return tmpLine;
         }
@@ -876,8 +797,8 @@ namespace internal
         {
           unsigned tmpLine = d.up( 1 );
 
-          append_toffoli( circ )( index, high )( tmpLine );
-          append_cnot( circ, high, tmpLine );
+          d.toffoli( index, high, tmpLine );
+          d.cnot( high, tmpLine );
 
           return tmpLine;
         }
@@ -898,7 +819,7 @@ namespace internal
         {
           unsigned tmpLine = d.up( 0 );
 
-          append_toffoli( circ )( index, high )( tmpLine );
+          d.toffoli( index, high, tmpLine );
 
           return tmpLine;
         }
@@ -917,8 +838,8 @@ namespace internal
         {
           unsigned tmpLine = d.up( 1 );
 
-          append_toffoli( circ )( low, index )( tmpLine );
-          append_cnot( circ, low, tmpLine );
+          d.toffoli( low, index, tmpLine );
+          d.cnot( low, tmpLine );
 
           return tmpLine;
         }
@@ -926,9 +847,9 @@ namespace internal
         {
           unsigned tmpLine = d.up( 0 );
 
-          append_cnot( circ, index, tmpLine );
-          append_toffoli( circ )( low, index )( tmpLine );
-          append_cnot( circ, low, tmpLine );
+          d.cnot( index, tmpLine );
+          d.toffoli( low, index, tmpLine );
+          d.cnot( low, tmpLine );
 
           return tmpLine;
         }
@@ -945,8 +866,8 @@ namespace internal
         {
           unsigned tmpLine = d.up( 0 );
 
-          append_cnot( circ, low, tmpLine );
-          append_cnot( circ, index, tmpLine );
+          d.cnot( low, tmpLine );
+          d.cnot( index, tmpLine );
 
           return tmpLine;
         }
@@ -963,8 +884,8 @@ namespace internal
         {
           unsigned tmpLine = d.up( 1 );
 
-          append_cnot( circ, low, tmpLine );
-          append_cnot( circ, index, tmpLine );
+          d.cnot( low, tmpLine );
+          d.cnot( index, tmpLine );
 
           return tmpLine;
         }
@@ -983,9 +904,9 @@ namespace internal
         {
           unsigned tmpLine = d.up( 1 );
 
-          append_cnot( circ, index, tmpLine );
-          append_toffoli( circ )( low, index )( tmpLine );
-          append_cnot( circ, low, tmpLine );
+          d.cnot( index, tmpLine );
+          d.toffoli( low, index, tmpLine );
+          d.cnot( low, tmpLine );
 
           return tmpLine;
         }
@@ -993,8 +914,8 @@ namespace internal
         {
           unsigned tmpLine = d.up( 0 );
 
-          append_toffoli( circ )( low, index )( tmpLine );
-          append_cnot( circ, low, tmpLine );
+          d.toffoli( low, index, tmpLine );
+          d.cnot( low, tmpLine );
 
           return tmpLine;
         }
@@ -1012,7 +933,7 @@ namespace internal
         {
           unsigned tmpLine = d.up( 1 );
 
-          append_cnot( circ, index, tmpLine );
+          d.cnot( index, tmpLine );
 
           return tmpLine;
         }
@@ -1028,7 +949,7 @@ namespace internal
       assert( dtl == 0 );
       unsigned tmpLine = d.up( 1 );
 
-      append_cnot( circ, index, tmpLine );
+      d.cnot( index, tmpLine );
 
       return tmpLine;
     }
@@ -1044,28 +965,28 @@ namespace internal
     return -1;
   }
 
-  int node2line( const dd_node& node, const dd& graph, bool is_complemented, data& d )
+  int node2line( const dd& graph, unsigned node, bool is_complemented, data& d )
   {
+    const auto& n = graph.nodes[node];
     int line = -1;
 
-    if ( dd_node_is_constant( node, graph ) )
+    if ( n.constant )
     {
       if ( is_complemented )
       {
-        line = dd_node_var( node, graph ) == 1 ? -2 : -1;
+        line = n.var == 1 ? -2 : -1;
       }
       else
       {
-        line = dd_node_var( node, graph ) == 1 ? -1 : -2;
+        line = n.var == 1 ? -1 : -2;
       }
     }
     else
     {
-      std::map<dd_node, unsigned>::const_iterator it = d.node2line.find( node );
-      assert( it != d.node2line.end() );
-      assert( d.lineNeeded[it->second] > 0 || it->second < get_property( graph, boost::graph_name ).ninputs );
-      line = it->second;
-      if ( line >= (int)get_property( graph, boost::graph_name ).ninputs )
+      assert( d.node2line[node] != dd_no_line );
+      assert( d.lineNeeded[d.node2line[node]] > 0 || d.node2line[node] < graph.ninputs );
+      line = d.node2line[node];
+      if ( line >= (int)graph.ninputs )
       {
         --d.lineNeeded[line];
       }
@@ -1074,49 +995,42 @@ namespace internal
     return line;
   }
 
-  void dd_synthesis( circuit& circ, data& d, const dd_node& node, const dd& graph, boost::function<int(circuit&, data&, unsigned, unsigned short, int, int, bool, bool)> gate_inserter )
+  /* chooses the templates and lines of all nodes below node, the gates are
+   * only collected since this step is sequential by nature */
+  void dd_synthesis( data& d, const dd& graph, unsigned node )
   {
+    const auto& n = graph.nodes[node];
 
-    if ( dd_node_is_constant( node, graph ) )
+    if ( n.constant )
     {
       // should only happen, if PO is constant
-      unsigned tmpLine = d.lines;
-      ++d.lines;
-      d.lineNeeded += -1;
-      d.constantValue += (int)dd_node_var( node, graph );
-      d.node2line.insert( std::make_pair( node, tmpLine ) );
+      const auto line = d.up( n.var );
+      if ( d.node2line[node] == dd_no_line )
+      {
+        d.node2line[node] = line;
+      }
       return;
     }
 
-    if ( d.node2line.find( node ) != d.node2line.end() )
+    if ( d.node2line[node] != dd_no_line )
     {
       // already visited
       return;
     }
 
-    // get low and high
-    bool low_complemented, high_complemented;
-    dd_node lowNode, highNode;
-
-    boost::graph_traits<dd>::out_edge_iterator itEdge = out_edges( node, graph ).first;
-    low_complemented = get( boost::edge_name, graph )[*itEdge].complemented;
-    lowNode = target( *itEdge, graph );
-    ++itEdge;
-    high_complemented = get( boost::edge_name, graph )[*itEdge].complemented;
-    highNode = target( *itEdge, graph );
-
-    if ( !dd_node_is_constant( highNode, graph ) )
+    if ( !graph.nodes[n.high].constant )
     {
-      dd_synthesis( circ, d, highNode, graph, gate_inserter );
+      dd_synthesis( d, graph, n.high );
     }
-    if ( !dd_node_is_constant( lowNode, graph ) )
+    if ( !graph.nodes[n.low].constant )
     {
-      dd_synthesis( circ, d, lowNode, graph, gate_inserter );
+      dd_synthesis( d, graph, n.low );
     }
 
-    unsigned index = dd_node_var( node, graph );
-    int high       = node2line( highNode, graph, high_complemented, d );
-    int low        = node2line( lowNode, graph, low_complemented, d );
+    bool low_complemented  = n.low_complemented;
+    bool high_complemented = n.high_complemented;
+    int high               = node2line( graph, n.high, high_complemented, d );
+    int low                = node2line( graph, n.low, low_complemented, d );
 
     if ( high < 0 )
     {
@@ -1127,50 +1041,94 @@ namespace internal
       low_complemented = false;
     }
 
-    unsigned short dtl = get( boost::vertex_name, graph )[node].dtl;
-    int out            = gate_inserter( circ, d, index, dtl, low, high, low_complemented, high_complemented );
+    int out = reversible_generator( d, n.var, n.dtl, low, high, low_complemented, high_complemented );
 
     assert( out != -1 );
-    d.node2line.insert( std::make_pair( node, out ) );
+    d.node2line[node] = out;
     assert( (int)d.lineNeeded.size() > out );
 
-    d.lineNeeded[out] = in_degree( node, graph );
+    d.lineNeeded[out] = n.fanout;
+  }
 
+  void add_template_gates( circuit& circ, const std::vector<template_gate>& gates )
+  {
+    circ.reserve( circ.num_gates() + gates.size() );
+    for ( const auto& tg : gates )
+    {
+      auto& g = circ.append_gate();
+      for ( auto c = 0u; c < tg.num_controls; ++c )
+      {
+        g.add_control( make_var( tg.controls[c] ) );
+      }
+      g.add_target( tg.target );
+      g.set_type( toffoli_tag() );
+    }
   }
 
-  void dd_synthesis( circuit& circ, const dd& graph, boost::function<int(circuit&, data&, unsigned, unsigned short, int, int, bool, bool)> gate_inserter )
+  void dd_synthesis( circuit& circ, const dd& graph )
   {
     // empty circuit
     clear_circuit( circ );
 
     // get number of inputs
-    unsigned ninputs = get_property( graph, boost::graph_name ).ninputs;
+    unsigned ninputs = graph.ninputs;
 
     data d;
     d.lines = ninputs;
     d.constantValue.resize( d.lines, -1 );
     d.lineNeeded.resize( d.lines, -1 );
+    d.node2line.resize( graph.nodes.size(), dd_no_line );
 
     // recursion
-    for ( const unsigned& node_index : dd_roots( graph ) )
+    for ( const auto& node_index : graph.roots )
     {
-      dd_synthesis( circ, d, node_index, graph, gate_inserter );
+      dd_synthesis( d, graph, node_index );
+    }
+
+    // the first output of a node is realized on the node's line, further
+    // outputs of the same node are copied to a new constant line, since a
+    // line can only be labeled with one output and complemented once
+    std::vector<unsigned> output2line( graph.roots.size() );
+    std::vector<bool> node_has_output( graph.nodes.size(), false );
+    for ( auto i = 0u; i < graph.roots.size(); ++i )
+    {
+      const auto line = d.node2line[graph.roots[i]];
+      if ( !node_has_output[graph.roots[i]] )
+      {
+        node_has_output[graph.roots[i]] = true;
+        output2line[i] = line;
+        continue;
+      }
+
+      output2line[i] = d.up( 0 );
+      d.cnot( line, output2line[i] );
+      if ( graph.root_complemented[i] )
+      {
+        d.not_gate( output2line[i] );
+      }
     }
 
-    for ( const unsigned& node_index : dd_roots( graph ) )
+    std::fill( node_has_output.begin(), node_has_output.end(), false );
+    for ( auto i = 0u; i < graph.roots.size(); ++i )
     {
-      if ( dd_root_is_complemented( node_index, graph ) )
+      if ( !node_has_output[graph.roots[i]] )
       {
-        append_not( circ, d.node2line[node_index] );
+        node_has_output[graph.roots[i]] = true;
+        if ( graph.root_complemented[i] )
+        {
+          d.not_gate( output2line[i] );
+        }
       }
     }
 
+    add_template_gates( circ, d.gates );
+
     circ.set_lines( d.lines );
 
     // set inputs and constants
     std::vector<std::string> inputs( d.lines );
     std::vector<constant> constants( d.lines, constant() );
-    std::copy( dd_labels( graph ).begin(), dd_labels( graph ).begin() + ninputs, inputs.begin() );
+    std::copy( graph.labels.begin(), graph.labels.begin() + ninputs, inputs.begin() );
     std::transform( d.constantValue.begin() + ninputs, d.constantValue.end(), inputs.begin() + ninputs, []( int n ) { return boost::lexical_cast<std::string>( n ); } );
     std::transform( d.constantValue.begin() + ninputs, d.constantValue.end(), constants.begin() + ninputs, []( int n ) { return boost::lexical_cast<bool>( n ); } );
     circ.set_inputs( inputs );
@@ -1179,23 +1137,16 @@ namespace internal
     // set outputs and garbage
     std::vector<std::string> outputs( d.lines, "g" );
     std::vector<bool> garbage( d.lines, true );
-    for ( const unsigned& node_index : dd_roots( graph ) )
+    for ( auto i = 0u; i < graph.roots.size(); ++i )
     {
-      unsigned index = d.node2line[node_index];
-      outputs[index] = dd_labels( graph ).at( get( boost::vertex_name, graph )[dd_root_get_function_root( node_index, graph )].var );
-      garbage[index] = false;
+      outputs[output2line[i]] = dd_output_label( graph, i );
+      garbage[output2line[i]] = false;
     }
     circ.set_outputs( outputs );
     circ.set_garbage( garbage );
 
   }
 
-  void dd_synthesis( circuit& circ, const dd& graph )
-  {
-    dd_synthesis( circ, graph, &reversible_generator );
-  }
-
-
 }
 
 }
@@ -29,7 +29,8 @@
 #ifndef DD_SYNTHESIS_P_HPP
 #define DD_SYNTHESIS_P_HPP
 
-#include <boost/graph/adjacency_list.hpp>
+#include <string>
+#include <vector>
 
 #include <cudd.h>
 
@@ -48,38 +49,31 @@ namespace internal
     shannon, positive_davio, negative_davio
   };
 
-  struct node_properties
+  /* nodes are stored such that children precede their parents */
+  struct dd_node
   {
-    node_properties()
-      : var( 0 ),
-        dtl( shannon ) {}
-
-    unsigned       var;
-    unsigned short dtl;
-  };
-
-  struct edge_properties
-  {
-    edge_properties()
-      : complemented( false ) {}
-
-    bool complemented;
+    unsigned       var              = 0u;      /* variable, or value for constants */
+    unsigned short dtl              = shannon;
+    bool           constant         = true;
+    unsigned       low              = 0u;
+    unsigned       high             = 0u;
+    bool           low_complemented = false;
+    bool           high_complemented = false;
+    unsigned       fanout           = 0u;      /* references from nodes and outputs */
   };
 
-  struct graph_properties
+  struct dd
   {
-    graph_properties()
-      : ninputs( 0 ) {}
-
-    std::vector<std::size_t> roots;
+    std::vector<dd_node>     nodes;
+    std::vector<unsigned>    roots;
+    std::vector<bool>        root_complemented;
     std::vector<std::string> labels;
-    unsigned ninputs;
+    unsigned                 ninputs = 0u;
   };
 
-  typedef boost::adjacency_list<boost::vecS, boost::vecS, boost::bidirectionalS,
-                                boost::property<boost::vertex_name_t, node_properties>,
-                                boost::property<boost::edge_name_t, edge_properties>,
-                                boost::property<boost::graph_name_t, graph_properties> > dd;
+  /* adds a node and returns its index, children must be added before */
+  unsigned dd_add_node( dd& graph, dd_node node );
+  void dd_add_root( dd& graph, unsigned node, bool complemented );
 
   void dd_to_dot( const dd& graph, const std::string& filename );
 
@@ -111,6 +105,7 @@ namespace internal
   void dd_from_bdd( dd& graph, const std::string& filename, const dd_from_bdd_settings& settings = dd_from_bdd_settings() );
   void dd_from_bdd( dd& graph, bdd_function_t& bdds, const dd_from_bdd_settings& settings = dd_from_bdd_settings() );
 
+  /* outputs after the first one of a node are copied to constant lines */
   void dd_synthesis( circuit& circ, const dd& graph );
 
 }
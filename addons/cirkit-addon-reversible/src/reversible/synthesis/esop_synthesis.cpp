@@ -18,22 +18,29 @@
 
 #include "esop_synthesis.hpp"
 
+#include <fstream>
+#include <limits>
+#include <memory>
 #include <numeric>
 
 #include <boost/assign/std/set.hpp>
 #include <boost/assign/std/vector.hpp>
 #include <boost/range/algorithm.hpp>
+#include <boost/range/algorithm_ext/iota.hpp>
 #include <boost/range/irange.hpp>
 #include <boost/range/iterator_range.hpp>
 
 #include <core/functor.hpp>
+#include <core/utils/bitset_utils.hpp>
 #include <core/utils/range_utils.hpp>
 #include <core/utils/timer.hpp>
 
+#include <reversible/target_tags.hpp>
 #include <reversible/truth_table.hpp>
 #include <reversible/functions/add_gates.hpp>
 #include <reversible/functions/clear_circuit.hpp>
 #include <reversible/io/read_pla.hpp>
+#include <reversible/io/write_realization.hpp>
 
 using namespace boost::assign;
 
@@ -42,49 +49,142 @@ namespace cirkit
 
   typedef std::vector<std::pair<binary_truth_table::cube_type, binary_truth_table::cube_type> > cubes_type;
 
-  void no_reordering( std::vector<std::pair<binary_truth_table::cube_type, binary_truth_table::cube_type> >& cubes )
+  /* calls f( index ) for each set bit in a packed bit-vector */
+  template<typename Fn>
+  inline void foreach_packed_bit( const std::uint64_t* words, unsigned num_words, Fn&& f )
   {
+    for ( auto w = 0u; w < num_words; ++w )
+    {
+      for ( auto word = words[w]; word; word &= word - 1u )
+      {
+        f( ( w << 6u ) + lowest_bit( word ) );
+      }
+    }
   }
 
-  struct cube_cost_sum
+  /* number of lines whose polarity differs from the literals of the cube */
+  inline unsigned polarity_changes( const std::vector<std::uint64_t>& state, const esop_cubes& cubes, unsigned cube )
   {
-    explicit cube_cost_sum( unsigned var, bool _abs ) : var( var ), _abs( _abs ) {}
+    const auto* care = cubes.care( cube );
+    const auto* bits = cubes.bits( cube );
 
-    unsigned operator()( unsigned result, const cubes_type::value_type& cube ) const
+    auto changes = 0u;
+    for ( auto w = 0u; w < cubes.input_words(); ++w )
     {
-      return result + ( cube.first.at( var ) ? ( ( _abs || *cube.first.at( var ) ) ? 1 : -1 ) : 0 );
+      changes += bit_count( ( state[w] ^ bits[w] ) & care[w] );
     }
+    return changes;
+  }
 
-  private:
-    unsigned var;
-    bool _abs;
-  };
+  /* adapts the polarities to the literals of the cube */
+  inline void apply_polarities( std::vector<std::uint64_t>& state, const esop_cubes& cubes, unsigned cube )
+  {
+    const auto* care = cubes.care( cube );
+    const auto* bits = cubes.bits( cube );
+
+    for ( auto w = 0u; w < cubes.input_words(); ++w )
+    {
+      state[w] ^= ( state[w] ^ bits[w] ) & care[w];
+    }
+  }
 
-  struct cube_is_negative
+  esop_cubes pack_cubes( const cubes_type& cubes )
   {
-    explicit cube_is_negative( unsigned var ) : var( var ) {}
+    esop_cubes packed( cubes.front().first.size(), cubes.front().second.size() );
+    for ( const auto& cube : cubes )
+    {
+      packed.add_cube( cube.first, cube.second );
+    }
+    return packed;
+  }
 
-    bool operator()( const cubes_type::value_type& cube ) const
+  void permute_cubes( cubes_type& cubes, const std::vector<unsigned>& order )
+  {
+    cubes_type permuted;
+    permuted.reserve( cubes.size() );
+    for ( auto index : order )
     {
-      return !( cube.first.at( var ) && *cube.first.at( var ) );
+      permuted.push_back( std::move( cubes[index] ) );
     }
+    cubes.swap( permuted );
+  }
 
-  private:
-    unsigned var;
-  };
+  esop_cubes::esop_cubes( unsigned num_inputs, unsigned num_outputs )
+    : _num_inputs( num_inputs ),
+      _num_outputs( num_outputs ),
+      _input_words( ( num_inputs + 63u ) >> 6u ),
+      stride( 2u * _input_words + ( ( num_outputs + 63u ) >> 6u ) )
+  {
+  }
 
-  struct cube_sort
+  void esop_cubes::add_cube( const binary_truth_table::cube_type& in, const binary_truth_table::cube_type& out )
   {
-    explicit cube_sort( unsigned var ) : var( var ) {}
+    const auto first = words.size();
+    words.resize( first + stride, 0ull );
+
+    auto* care    = &words[first];
+    auto* bits    = care + _input_words;
+    auto* outputs = care + 2u * _input_words;
 
-    bool operator()( const cubes_type::value_type& cube1, const cubes_type::value_type& cube2 ) const
+    for ( auto i = 0u; i < _num_inputs; ++i )
     {
-      return !cube_is_negative( var )( cube1 ) && cube_is_negative( var)( cube2 );
+      if ( in[i] )
+      {
+        care[i >> 6u] |= 1ull << ( i & 63u );
+        if ( *in[i] )
+        {
+          bits[i >> 6u] |= 1ull << ( i & 63u );
+        }
+      }
     }
 
-  private:
-    unsigned var;
-  };
+    for ( auto o = 0u; o < _num_outputs; ++o )
+    {
+      if ( out[o] && *out[o] )
+      {
+        outputs[o >> 6u] |= 1ull << ( o & 63u );
+      }
+    }
+
+    ++_size;
+  }
+
+  binary_truth_table::cube_type esop_cubes::input_cube( unsigned cube ) const
+  {
+    binary_truth_table::cube_type in( _num_inputs );
+    for ( auto i = 0u; i < _num_inputs; ++i )
+    {
+      if ( has_literal( cube, i ) )
+      {
+        in[i] = polarity( cube, i );
+      }
+    }
+    return in;
+  }
+
+  binary_truth_table::cube_type esop_cubes::output_cube( unsigned cube ) const
+  {
+    binary_truth_table::cube_type out( _num_outputs );
+    for ( auto o = 0u; o < _num_outputs; ++o )
+    {
+      out[o] = has_output( cube, o );
+    }
+    return out;
+  }
+
+  void esop_cubes::permute( const std::vector<unsigned>& order )
+  {
+    std::vector<std::uint64_t> permuted( words.size() );
+    for ( auto i = 0u; i < order.size(); ++i )
+    {
+      std::copy( care( order[i] ), care( order[i] ) + stride, permuted.begin() + i * stride );
+    }
+    words.swap( permuted );
+  }
+
+  void no_reordering( std::vector<std::pair<binary_truth_table::cube_type, binary_truth_table::cube_type> >& cubes )
+  {
+  }
 
   weighted_reordering::weighted_reordering()
     : alpha( 0.5 ), beta( 0.5 ) {}
@@ -92,19 +192,30 @@ namespace cirkit
   weighted_reordering::weighted_reordering( float alpha, float beta )
     : alpha( alpha ), beta( beta ) {}
 
-  void weighted_reordering::reorder( cubes_type::iterator begin, cubes_type::iterator end, const std::vector<unsigned>& vars ) const
+  void weighted_reordering::reorder( const esop_cubes& cubes, std::vector<unsigned>::iterator begin, std::vector<unsigned>::iterator end, const std::vector<unsigned>& vars ) const
   {
     if ( begin == end || !vars.size() )
     {
       return;
     }
 
+    // count literals and positive literals of all variables in one pass
+    std::vector<unsigned> num_literals( cubes.num_inputs() ), num_positive( cubes.num_inputs() );
+    for ( auto it = begin; it != end; ++it )
+    {
+      const auto* bits = cubes.bits( *it );
+      foreach_packed_bit( cubes.care( *it ), cubes.input_words(), [&]( unsigned var ) {
+          ++num_literals[var];
+          num_positive[var] += ( bits[var >> 6u] >> ( var & 63u ) ) & 1u;
+        } );
+    }
+
     // find best var
     std::vector<float> costs_by_var;
     for ( unsigned var : vars )
     {
-      unsigned sum1 = std::accumulate( begin, end, 0u, cube_cost_sum( var, true ) );
-      unsigned sum2 = std::accumulate( begin, end, 0u, cube_cost_sum( var, false ) );
+      unsigned sum1 = num_literals[var];
+      unsigned sum2 = 2u * num_positive[var] - num_literals[var]; /* positive minus negative literals, modulo 2^32 */
 
       if ( sum1 == 0u )
       {
@@ -118,14 +229,29 @@ namespace cirkit
 
     // maximum
     unsigned max_var_index = std::max_element( costs_by_var.begin(), costs_by_var.end() ) - costs_by_var.begin();
-    std::sort( begin, end, cube_sort( vars.at( max_var_index ) ) );
-    cubes_type::iterator it = std::find_if( begin, end, cube_is_negative( vars.at( max_var_index ) ) );
+    const auto var = vars.at( max_var_index );
+    const auto is_positive = [&cubes, var]( unsigned cube ) { return cubes.has_literal( cube, var ) && cubes.polarity( cube, var ); };
+
+    std::sort( begin, end, [&is_positive]( unsigned cube1, unsigned cube2 ) { return is_positive( cube1 ) && !is_positive( cube2 ); } );
+    auto it = std::find_if_not( begin, end, is_positive );
 
     std::vector<unsigned> new_vars = vars;
     new_vars.erase( new_vars.begin() + max_var_index );
 
-    reorder( begin, it, new_vars );
-    reorder( it, end, new_vars );
+    reorder( cubes, begin, it, new_vars );
+    reorder( cubes, it, end, new_vars );
+  }
+
+  std::vector<unsigned> weighted_reordering::compute_order( const esop_cubes& cubes ) const
+  {
+    std::vector<unsigned> order( cubes.size() );
+    boost::iota( order, 0u );
+
+    std::vector<unsigned> vars( cubes.num_inputs() );
+    boost::iota( vars, 0u );
+
+    reorder( cubes, order.begin(), order.end(), vars );
+    return order;
   }
 
   void weighted_reordering::operator()( cubes_type& cubes ) const
@@ -135,20 +261,149 @@ namespace cirkit
       return;
     }
 
-    std::vector<unsigned> vars( cubes.at( 0 ).first.size() );
-    boost::copy( boost::irange( 0u, (unsigned)vars.size() ), vars.begin() );
+    permute_cubes( cubes, compute_order( pack_cubes( cubes ) ) );
+  }
 
-    reorder( cubes.begin(), cubes.end(), vars );
+  void weighted_reordering::operator()( esop_cubes& cubes ) const
+  {
+    cubes.permute( compute_order( cubes ) );
   }
 
+  gray_code_reordering::gray_code_reordering( unsigned window )
+    : window( window ) {}
+
+  std::vector<unsigned> gray_code_reordering::compute_order( const esop_cubes& cubes ) const
+  {
+    const auto num_cubes = cubes.size();
+    const auto iw        = cubes.input_words();
+
+    // Gray code rank of the literals, variable 0 is the most significant position
+    std::vector<std::uint64_t> ranks( num_cubes * iw );
+    for ( auto c = 0u; c < num_cubes; ++c )
+    {
+      auto parity = 0ull;
+      for ( auto w = 0u; w < iw; ++w )
+      {
+        auto x = cubes.care( c )[w] & cubes.bits( c )[w];
+        x ^= x << 1u;
+        x ^= x << 2u;
+        x ^= x << 4u;
+        x ^= x << 8u;
+        x ^= x << 16u;
+        x ^= x << 32u;
+        if ( parity ) { x = ~x; }
+        ranks[c * iw + w] = x;
+        parity = x >> 63u;
+      }
+    }
+
+    std::vector<unsigned> sorted( num_cubes );
+    boost::iota( sorted, 0u );
+    std::stable_sort( sorted.begin(), sorted.end(), [&ranks, iw]( unsigned c1, unsigned c2 ) {
+        for ( auto w = 0u; w < iw; ++w )
+        {
+          const auto d = ranks[c1 * iw + w] ^ ranks[c2 * iw + w];
+          if ( d )
+          {
+            return !( ( ranks[c1 * iw + w] >> lowest_bit( d ) ) & 1u );
+          }
+        }
+        return false;
+      } );
+
+    // greedy selection from a window of the remaining cubes in sorted order
+    const auto none = std::numeric_limits<unsigned>::max();
+    std::vector<unsigned> next( num_cubes ), prev( num_cubes );
+    for ( auto i = 0u; i < num_cubes; ++i )
+    {
+      next[i] = i + 1u < num_cubes ? i + 1u : none;
+      prev[i] = i > 0u ? i - 1u : none;
+    }
+    auto head = num_cubes ? 0u : none;
+
+    std::vector<std::uint64_t> state( iw, ~0ull );
+    std::vector<unsigned> order;
+    order.reserve( num_cubes );
+
+    while ( head != none )
+    {
+      auto best = head, best_changes = std::numeric_limits<unsigned>::max(), steps = 0u;
+      for ( auto i = head; i != none && steps < std::max( window, 1u ); i = next[i], ++steps )
+      {
+        const auto changes = polarity_changes( state, cubes, sorted[i] );
+        if ( changes < best_changes )
+        {
+          best         = i;
+          best_changes = changes;
+          if ( !changes ) { break; }
+        }
+      }
+
+      if ( prev[best] != none ) { next[prev[best]] = next[best]; } else { head = next[best]; }
+      if ( next[best] != none ) { prev[next[best]] = prev[best]; }
+
+      apply_polarities( state, cubes, sorted[best] );
+      order.push_back( sorted[best] );
+    }
+
+    return order;
+  }
+
+  void gray_code_reordering::operator()( cubes_type& cubes ) const
+  {
+    if ( !cubes.size() )
+    {
+      return;
+    }
+
+    permute_cubes( cubes, compute_order( pack_cubes( cubes ) ) );
+  }
+
+  void gray_code_reordering::operator()( esop_cubes& cubes ) const
+  {
+    cubes.permute( compute_order( cubes ) );
+  }
+
+  /* the gates are either added to the circuit or written to a stream */
+  class esop_cascade
+  {
+  public:
+    esop_cascade( circuit& circ, realization_stream* stream ) : circ( circ ), stream( stream ) {}
+
+    void add_toffoli( const gate::control_container& controls, unsigned target )
+    {
+      ++num_gates;
+
+      if ( stream )
+      {
+        stream->write_toffoli( controls, target );
+        return;
+      }
+
+      auto& g = circ.append_gate();
+      g.controls() = controls;
+      g.add_target( target );
+      g.set_type( toffoli_tag() );
+    }
+
+    unsigned num_gates = 0u;
+
+  private:
+    circuit&            circ;
+    realization_stream* stream;
+  };
+
   bool esop_synthesis( circuit& circ, const std::string& filename, properties::ptr settings, properties::ptr statistics )
   {
 
     // Settings parsing
     bool separate_polarities = get<bool>( settings, "separate_polarities", false );
     bool negative_control_lines = get<bool>( settings, "negative_control_lines", false );
+    bool packed = !settings || !settings->has_key( "reordering" );
     cube_reordering_func reordering = get<cube_reordering_func>( settings, "reordering", weighted_reordering() );
+    esop_cube_reordering_func packed_reordering = get<esop_cube_reordering_func>( settings, "packed_reordering", weighted_reordering() );
     std::string garbage_name = get<std::string>( settings, "garbage_name", "g" );
+    std::string stream_filename = get<std::string>( settings, "stream_filename", std::string() );
 
     if ( separate_polarities && negative_control_lines )
     {
@@ -193,155 +448,189 @@ namespace cirkit
     unsigned n = spec.num_inputs();
     clear_circuit( circ );
 
+    // pack cubes
+    esop_cubes cubes( n, spec.num_outputs() );
+    for ( binary_truth_table::const_iterator it = spec.begin(); it != spec.end(); ++it )
+    {
+      cubes.add_cube( binary_truth_table::cube_type( it->first.first, it->first.second ),
+                      binary_truth_table::cube_type( it->second.first, it->second.second ) );
+    }
+
+    // metadata
+    std::vector<std::string> inputs, outputs;
+    std::vector<constant> constants;
+    std::vector<bool> garbage;
+
     if ( separate_polarities )
     {
       circ.set_lines( n * 2 + spec.num_outputs() );
 
-      // metadata
-      std::vector<std::string> inputs( circ.lines() );
+      inputs.resize( circ.lines() );
       std::copy( spec.inputs().begin(), spec.inputs().end(), inputs.begin() );
       std::fill( inputs.begin() + n, inputs.begin() + 2 * n, "1" );
       std::fill( inputs.begin() + 2 * n, inputs.end(), "0" );
 
-      std::vector<std::string> outputs( circ.lines(), garbage_name );
+      outputs.resize( circ.lines(), garbage_name );
       std::vector<std::string> spec_outputs = spec.outputs();
       std::copy( spec_outputs.begin(), spec_outputs.end(), outputs.begin() + 2 * n );
 
-      std::vector<constant> constants( circ.lines() );
+      constants.resize( circ.lines() );
       std::fill( constants.begin(), constants.begin() + n, constant() );
       std::fill( constants.begin() + n, constants.begin() + 2 * n, constant( true ) );
       std::fill( constants.begin() + 2 * n, constants.end(), constant( false ) );
 
-      std::vector<bool> garbage( circ.lines(), false );
+      garbage.resize( circ.lines(), false );
       std::fill( garbage.begin(), garbage.begin() + 2 * n, true );
-
-      circ.set_inputs( inputs );
-      circ.set_outputs( outputs );
-      circ.set_constants( constants );
-      circ.set_garbage( garbage );
-
-      // apply inverter gates
-      for ( unsigned i = 0u; i < n; ++i )
-      {
-        append_cnot( circ, make_var( i ), n + i );
-      }
-
-      // apply gates
-      for ( binary_truth_table::const_iterator it = spec.begin(); it != spec.end(); ++it )
+    }
+    else
+    {
+      // smarter approach with reusing lines, only reorder with positive control lines
+      if ( !negative_control_lines )
       {
-        gate::control_container controls;
+        properties_timer t( statistics, "reordering_runtime" );
 
-        // iterate through input cube (bit by bit)
-        unsigned index = 0u;
-        for ( const auto& in_bit : boost::make_iterator_range( it->first ) )
+        if ( packed )
+        {
+          packed_reordering( cubes );
+        }
+        else
         {
-          if ( in_bit )
+          cubes_type unpacked;
+          for ( auto c = 0u; c < cubes.size(); ++c )
           {
-            controls += make_var( ( 1u - *in_bit ) * n + index ); // considers polarity to choose line
+            unpacked += std::make_pair( cubes.input_cube( c ), cubes.output_cube( c ) );
           }
-          ++index;
-        }
+          reordering( unpacked );
 
-        // iterate through output cube (bit by bit)
-        index = 0u;
-        for ( const auto& out_bit : boost::make_iterator_range( it->second ) )
-        {
-          if ( out_bit && *out_bit )
+          cubes = esop_cubes( n, spec.num_outputs() );
+          for ( const auto& cube : unpacked )
           {
-            append_toffoli( circ, controls, 2 * n + index );
+            cubes.add_cube( cube.first, cube.second );
           }
-          ++index;
         }
       }
-    }
-    else
-    {
-      // smarter approach with reusing lines
-      std::vector<std::pair<binary_truth_table::cube_type, binary_truth_table::cube_type> > cubes;
-      for ( binary_truth_table::const_iterator it = spec.begin(); it != spec.end(); ++it )
-      {
-        cubes += std::make_pair( binary_truth_table::cube_type( it->first.first, it->first.second ),
-                                 binary_truth_table::cube_type( it->second.first, it->second.second ) );
-      }
-
-      // only reorder with positive control lines
-      if ( !negative_control_lines )
-      {
-        reordering( cubes );
-      }
 
       circ.set_lines( n + spec.num_outputs() );
 
-      // metadata
-      std::vector<std::string> inputs( circ.lines() );
+      inputs.resize( circ.lines() );
       std::copy( spec.inputs().begin(), spec.inputs().end(), inputs.begin() );
       std::fill( inputs.begin() + n, inputs.end(), "0" );
 
-      std::vector<std::string> outputs( circ.lines(), garbage_name );
+      outputs.resize( circ.lines(), garbage_name );
       std::vector<std::string> spec_outputs = spec.outputs();
       std::copy( spec_outputs.begin(), spec_outputs.end(), outputs.begin() + n );
 
-      std::vector<constant> constants( circ.lines() );
+      constants.resize( circ.lines() );
       std::fill( constants.begin(), constants.begin() + n, constant() );
       std::fill( constants.begin() + n, constants.end(), constant( false ) );
 
-      std::vector<bool> garbage( circ.lines(), false );
+      garbage.resize( circ.lines(), false );
       std::fill( garbage.begin(), garbage.begin() + n, true );
+    }
 
-      circ.set_inputs( inputs );
-      circ.set_outputs( outputs );
-      circ.set_constants( constants );
-      circ.set_garbage( garbage );
+    circ.set_inputs( inputs );
+    circ.set_outputs( outputs );
+    circ.set_constants( constants );
+    circ.set_garbage( garbage );
 
-      // apply gates
-      std::vector<bool> polarity( n, true );
+    // output, gates are written directly in streaming mode
+    write_realization_settings stream_settings;
+    std::ofstream stream_file;
+    std::unique_ptr<realization_stream> stream;
 
-      for ( std::vector<std::pair<binary_truth_table::cube_type, binary_truth_table::cube_type> >::const_iterator it = cubes.begin(); it != cubes.end(); ++it )
+    if ( !stream_filename.empty() )
+    {
+      stream_file.open( stream_filename.c_str() );
+      if ( !stream_file )
       {
-        gate::control_container controls;
+        set_error_message( statistics, "Cannot open " + stream_filename );
+        return false;
+      }
+      stream.reset( new realization_stream( stream_file, circ, stream_settings ) );
+    }
+    else
+    {
+      // count gates to reserve the circuit
+      auto num_gates = separate_polarities ? n : 0u;
+      std::vector<std::uint64_t> state( cubes.input_words(), ~0ull );
+      for ( auto c = 0u; c < cubes.size(); ++c )
+      {
+        foreach_packed_bit( cubes.outputs( c ), ( spec.num_outputs() + 63u ) >> 6u, [&num_gates]( unsigned ) { ++num_gates; } );
 
-        // iterate through input cube (bit by bit)
-        unsigned index = 0u;
-        for ( const auto& in_bit : it->first )
+        if ( !separate_polarities && !negative_control_lines )
         {
-          if ( in_bit )
+          num_gates += polarity_changes( state, cubes, c );
+          apply_polarities( state, cubes, c );
+        }
+      }
+      circ.reserve( num_gates );
+    }
+
+    esop_cascade cascade( circ, stream.get() );
+    gate::control_container controls, no_controls;
+
+    if ( separate_polarities )
+    {
+      // apply inverter gates
+      for ( unsigned i = 0u; i < n; ++i )
+      {
+        controls.assign( 1u, make_var( i ) );
+        cascade.add_toffoli( controls, n + i );
+      }
+    }
+
+    // apply gates
+    std::vector<std::uint64_t> polarity( cubes.input_words(), ~0ull );
+
+    for ( auto c = 0u; c < cubes.size(); ++c )
+    {
+      controls.clear();
+
+      // iterate through the literals of the input cube
+      const auto* bits = cubes.bits( c );
+      foreach_packed_bit( cubes.care( c ), cubes.input_words(), [&]( unsigned index ) {
+          const auto in_bit = ( ( bits[index >> 6u] >> ( index & 63u ) ) & 1u ) == 1u;
+
+          if ( separate_polarities )
           {
-            if ( negative_control_lines )
-            {
-              controls += make_var( index, *in_bit );
-            }
-            else
+            controls += make_var( ( in_bit ? 0u : n ) + index ); // considers polarity to choose line
+          }
+          else if ( negative_control_lines )
+          {
+            controls += make_var( index, in_bit );
+          }
+          else
+          {
+            const auto mask = 1ull << ( index & 63u );
+            if ( ( ( polarity[index >> 6u] & mask ) != 0ull ) != in_bit )
             {
-              if ( polarity.at( index ) != *in_bit )
-              {
-                append_not( circ, index );
-                polarity.at( index ) = *in_bit;
-              }
-              controls += make_var( index );
+              cascade.add_toffoli( no_controls, index );
+              polarity[index >> 6u] ^= mask;
             }
+            controls += make_var( index );
           }
-          ++index;
-        }
+        } );
 
-        // iterate through output cube (bit by bit)
-        index = 0u;
-        for ( const auto& out_bit : it->second )
-        {
-          if ( out_bit && *out_bit )
-          {
-            append_toffoli( circ, controls, n + index );
-          }
-          ++index;
-        }
-      }
+      // iterate through the outputs of the cube
+      const auto offset = separate_polarities ? 2 * n : n;
+      foreach_packed_bit( cubes.outputs( c ), ( spec.num_outputs() + 63u ) >> 6u, [&]( unsigned index ) {
+          cascade.add_toffoli( controls, offset + index );
+        } );
     }
 
+    if ( stream )
+    {
+      stream->close();
+    }
+
+    set( statistics, "gates", cascade.num_gates );
+
     return true;
   }
 
   pla_blif_synthesis_func esop_synthesis_func( properties::ptr settings, properties::ptr statistics )
   {
-    pla_blif_synthesis_func f = [&settings, &statistics]( circuit& circ, const std::string& filename ) {
+    pla_blif_synthesis_func f = [settings, statistics]( circuit& circ, const std::string& filename ) {
       return esop_synthesis( circ, filename, settings, statistics );
     };
     f.init( settings, statistics );
@@ -28,6 +28,7 @@
 #ifndef ESOP_SYNTHESIS_HPP
 #define ESOP_SYNTHESIS_HPP
 
+#include <cstdint>
 #include <vector>
 
 #include <core/properties.hpp>
@@ -49,6 +50,63 @@ namespace cirkit
    */
   typedef boost::function<void(std::vector<std::pair<binary_truth_table::cube_type, binary_truth_table::cube_type> >&)> cube_reordering_func;
 
+  /**
+   * @brief ESOP cubes packed into words
+   *
+   * The literals of a cube are stored as two bit-vectors, \p care contains
+   * the variables that appear in the cube and \p bits their polarities.  A
+   * third bit-vector contains the outputs.  The vectors of all cubes are
+   * kept in a single array, such that cubes can be compared with word
+   * operations and reordered by moving words.
+   *
+   * @since  2.3
+   */
+  class esop_cubes
+  {
+  public:
+    esop_cubes( unsigned num_inputs, unsigned num_outputs );
+
+    /* output don't cares are treated as 0 */
+    void add_cube( const binary_truth_table::cube_type& in, const binary_truth_table::cube_type& out );
+
+    inline unsigned num_inputs() const  { return _num_inputs; }
+    inline unsigned num_outputs() const { return _num_outputs; }
+    inline unsigned input_words() const { return _input_words; }
+    inline unsigned size() const        { return _size; }
+
+    inline const std::uint64_t* care( unsigned cube ) const    { return words.data() + cube * stride; }
+    inline const std::uint64_t* bits( unsigned cube ) const    { return care( cube ) + _input_words; }
+    inline const std::uint64_t* outputs( unsigned cube ) const { return care( cube ) + 2u * _input_words; }
+
+    inline bool has_literal( unsigned cube, unsigned var ) const { return ( care( cube )[var >> 6u] >> ( var & 63u ) ) & 1u; }
+    inline bool polarity( unsigned cube, unsigned var ) const    { return ( bits( cube )[var >> 6u] >> ( var & 63u ) ) & 1u; }
+    inline bool has_output( unsigned cube, unsigned out ) const  { return ( outputs( cube )[out >> 6u] >> ( out & 63u ) ) & 1u; }
+
+    binary_truth_table::cube_type input_cube( unsigned cube ) const;
+    binary_truth_table::cube_type output_cube( unsigned cube ) const;
+
+    /* afterwards, cube i is the cube that was at position order[i] */
+    void permute( const std::vector<unsigned>& order );
+
+  private:
+    unsigned                   _num_inputs;
+    unsigned                   _num_outputs;
+    unsigned                   _input_words;
+    unsigned                   stride;
+    unsigned                   _size = 0u;
+    std::vector<std::uint64_t> words;
+  };
+
+  /**
+   * @brief Functor for cubes reordering on packed cubes
+   *
+   * Same as \ref revkit::cube_reordering_func "cube_reordering_func" but
+   * the cubes are reordered in their packed representation.
+   *
+   * @since  2.3
+   */
+  typedef boost::function<void(esop_cubes&)> esop_cube_reordering_func;
+
   /**
    * @brief Empty functor for \ref revkit::cube_reordering_func "cube_reordering_func"
    *
@@ -118,8 +176,72 @@ namespace cirkit
      */
     void operator()( std::vector<std::pair<binary_truth_table::cube_type, binary_truth_table::cube_type> >& cubes ) const;
 
+    /**
+     * @brief Functor operator implementation for packed cubes
+     *
+     * @param cubes Cubes to be reordered
+     *
+     * @since  2.3
+     */
+    void operator()( esop_cubes& cubes ) const;
+
   private:
-    void reorder( std::vector<std::pair<binary_truth_table::cube_type, binary_truth_table::cube_type> >::iterator begin, std::vector<std::pair<binary_truth_table::cube_type, binary_truth_table::cube_type> >::iterator end, const std::vector<unsigned>& vars ) const;
+    std::vector<unsigned> compute_order( const esop_cubes& cubes ) const;
+    void reorder( const esop_cubes& cubes, std::vector<unsigned>::iterator begin, std::vector<unsigned>::iterator end, const std::vector<unsigned>& vars ) const;
+  };
+
+  /**
+   * @brief Cubes reordering that greedily avoids polarity changes
+   *
+   * The cubes are first sorted by the Gray code rank of their literals,
+   * such that neighboring cubes tend to differ in few polarities.  Then,
+   * starting from positive polarities on all lines, the next cube is
+   * chosen among the first \p window remaining cubes as the one that
+   * requires the fewest NOT gates.  These costs are computed with
+   * popcount on the packed cubes.
+   *
+   * @since  2.3
+   */
+  struct gray_code_reordering
+  {
+    /**
+     * @brief Constructor
+     *
+     * @param window Number of candidates for the next cube
+     *
+     * @since  2.3
+     */
+    explicit gray_code_reordering( unsigned window = 64u );
+
+    /**
+     * @brief Number of candidates for the next cube
+     *
+     * Default value is \p 64
+     *
+     * @since  2.3
+     */
+    unsigned window;
+
+    /**
+     * @brief Functor operator implementation
+     *
+     * @param cubes Cubes to be reordered
+     *
+     * @since  2.3
+     */
+    void operator()( std::vector<std::pair<binary_truth_table::cube_type, binary_truth_table::cube_type> >& cubes ) const;
+
+    /**
+     * @brief Functor operator implementation for packed cubes
+     *
+     * @param cubes Cubes to be reordered
+     *
+     * @since  2.3
+     */
+    void operator()( esop_cubes& cubes ) const;
+
+  private:
+    std::vector<unsigned> compute_order( const esop_cubes& cubes ) const;
   };
 
   /**
@@ -164,7 +286,23 @@ namespace cirkit
    *     <td class="indexvalue">\ref revkit::weighted_reordering "weighted_reordering()"</td>
    *   </tr>
    *   <tr>
-   *     <td colspan="2" class="indexvalue">Function for reordering the cubes to obtain a better result by using less NOT gates.</td>
+   *     <td colspan="2" class="indexvalue">Function for reordering the cubes to obtain a better result by using less NOT gates. If not set, \em packed_reordering is used instead.</td>
+   *   </tr>
+   *   <tr>
+   *     <td rowspan="2" class="indexvalue">packed_reordering</td>
+   *     <td class="indexvalue">\ref revkit::esop_cube_reordering_func "esop_cube_reordering_func"</td>
+   *     <td class="indexvalue">\ref revkit::weighted_reordering "weighted_reordering()"</td>
+   *   </tr>
+   *   <tr>
+   *     <td colspan="2" class="indexvalue">Function for reordering the packed cubes, the same strategies as for \em reordering are available.</td>
+   *   </tr>
+   *   <tr>
+   *     <td rowspan="2" class="indexvalue">stream_filename</td>
+   *     <td class="indexvalue">std::string</td>
+   *     <td class="indexvalue">""</td>
+   *   </tr>
+   *   <tr>
+   *     <td colspan="2" class="indexvalue">If not empty, the gates are written to this RevLib realization file as they are generated instead of being added to \p circ, which only obtains the lines and their meta data.</td>
    *   </tr>
    *   <tr>
    *     <td rowspan="2" class="indexvalue">garbage_name</td>
@@ -186,6 +324,16 @@ namespace cirkit
    *     <td class="indexvalue">double</td>
    *     <td class="indexvalue">Run-time consumed by the algorithm in CPU seconds.</td>
    *   </tr>
+   *   <tr>
+   *     <td class="indexvalue">reordering_runtime</td>
+   *     <td class="indexvalue">double</td>
+   *     <td class="indexvalue">Run-time consumed by reordering the cubes.</td>
+   *   </tr>
+   *   <tr>
+   *     <td class="indexvalue">gates</td>
+   *     <td class="indexvalue">unsigned</td>
+   *     <td class="indexvalue">Number of generated gates, also in streaming mode.</td>
+   *   </tr>
    * </table>
    * @return true on success
    *
@@ -18,9 +18,14 @@
 
 #include "exact_synthesis.hpp"
 
+#include <atomic>
 #include <cmath>
 #include <fstream>
 #include <iostream>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <thread>
 #include <tuple>
 
 #include <boost/assign/std/vector.hpp>
@@ -32,10 +37,12 @@
 #include <boost/range/irange.hpp>
 #include <boost/range/iterator_range.hpp>
 
+#include <core/utils/thread_pool.hpp>
 #include <core/utils/timer.hpp>
 #include <formal/utils/z3_utils.hpp>
 
 #include <reversible/functions/fully_specified.hpp>
+#include <reversible/functions/add_circuit.hpp>
 #include <reversible/functions/add_gates.hpp>
 #include <reversible/functions/copy_metadata.hpp>
 
@@ -45,311 +52,273 @@ namespace cirkit
 {
 using namespace boost::assign;
 
+/* adds the constraints for gate i, which maps gate_values[i] to gate_values[i + 1] */
 using gate_constraint_fun = std::function<void( z3::context& ctx, z3::solver& solver,
-                                                circuit&, std::vector<std::vector<z3::expr>>& network,
-                                                std::vector<std::vector<z3::expr> >& gate_values, const binary_truth_table&,
-                                                unsigned k, unsigned n )>;
+                                                std::vector<std::vector<z3::expr>>& network,
+                                                std::vector<std::vector<z3::expr> >& gate_values,
+                                                unsigned i, unsigned n )>;
 
-using evaluation_fun = std::function<bool( z3::solver& solver, circuit& circ,
+/* extracts the first k gates from a model */
+using evaluation_fun = std::function<void( const z3::model& m, circuit& circ,
                                            std::vector<std::vector<z3::expr>>& network, unsigned k, unsigned n )>;
 
-void gate_constraints_original( z3::context& ctx, z3::solver& solver, circuit&,
+struct exact_synthesis_encoding
+{
+  gate_constraint_fun gate_constraints;
+  evaluation_fun      eval;
+};
+
+void gate_constraints_original( z3::context& ctx, z3::solver& solver,
                                 std::vector<std::vector<z3::expr> >& network,
                                 std::vector<std::vector<z3::expr> >& gate_values,
-                                const binary_truth_table& spec, unsigned k, unsigned n )
+                                unsigned i, unsigned n )
 {
   using boost::str;
   using boost::format;
 
-  auto rows = boost::distance( spec );
+  auto rows = gate_values[i].size();
 
   auto zero = ctx.bv_val(0, n);
   auto one = ctx.bv_val(1, n);
 
-  for ( auto i = 0u; i < k; ++i )
-  {
-    auto control = ctx.bv_const(str(format("control-%d") % i).c_str(), n);
-    auto target = ctx.bv_const(str(format("target-%d") % i).c_str(), n);
+  auto control = ctx.bv_const(str(format("control-%d") % i).c_str(), n);
+  auto target = ctx.bv_const(str(format("target-%d") % i).c_str(), n);
 
-    network += std::vector<z3::expr>{ control, target };
+  network += std::vector<z3::expr>{ control, target };
 
-    solver.add( (control | (one << target)) != control );
-    solver.add( z3::ule(target, ctx.bv_val(n, n)) );
+  solver.add( (control | (one << target)) != control );
+  solver.add( z3::ule(target, ctx.bv_val(n, n)) );
 
-    for ( auto j = 0u; j < rows; ++j )
-    {
-      auto hit = ctx.bool_const(str(format("hit-%d-%d") % i % j).c_str());
-      solver.add( hit == ((gate_values[i][j] & control) == control) );
-      solver.add(
-          gate_values[i + 1][j]
-          == (gate_values[i][j] ^ (ite(hit, one, zero) << target)));
-    }
+  for ( auto j = 0u; j < rows; ++j )
+  {
+    auto hit = ctx.bool_const(str(format("hit-%d-%d") % i % j).c_str());
+    solver.add( hit == ((gate_values[i][j] & control) == control) );
+    solver.add(
+        gate_values[i + 1][j]
+        == (gate_values[i][j] ^ (ite(hit, one, zero) << target)));
   }
 }
 
 void gate_constraints_negative_control( z3::context& ctx, z3::solver& solver,
-                                        circuit&, std::vector<std::vector<z3::expr> >& network,
+                                        std::vector<std::vector<z3::expr> >& network,
                                         std::vector<std::vector<z3::expr> >& gate_values,
-                                        const binary_truth_table& spec, unsigned k, unsigned n )
+                                        unsigned i, unsigned n )
 {
   using boost::str;
   using boost::format;
 
-  auto rows = boost::distance( spec );
+  auto rows = gate_values[i].size();
 
   auto zero = ctx.bv_val(0, n);
   auto one = ctx.bv_val(1, n);
-  for ( auto i = 0u; i < k; ++i )
-  {
-    auto control = ctx.bv_const(str(format("control-%d") % i).c_str(), n);
-    auto target = ctx.bv_const(str(format("target-%d") % i).c_str(), n);
-    auto polarity = ctx.bv_const(str(format("polarity-%d") % i).c_str(), n);
+  auto control = ctx.bv_const(str(format("control-%d") % i).c_str(), n);
+  auto target = ctx.bv_const(str(format("target-%d") % i).c_str(), n);
+  auto polarity = ctx.bv_const(str(format("polarity-%d") % i).c_str(), n);
 
-    network += std::vector<z3::expr>{ control, target, polarity };
+  network += std::vector<z3::expr>{ control, target, polarity };
 
-    solver.add( (control | (one << target)) != control );
-    solver.add( z3::ule(target, ctx.bv_val(n, n)) );
+  solver.add( (control | (one << target)) != control );
+  solver.add( z3::ule(target, ctx.bv_val(n, n)) );
 
-    for ( auto j = 0u; j < rows; ++j )
-    {
-      auto hit = ctx.bool_const(str(format("hit-%d-%d") % i % j).c_str());
-      solver.add(
-          hit == (((gate_values[i][j] ^ polarity) & control) == control));
-      solver.add(
-          gate_values[i + 1][j]
-          == (gate_values[i][j] ^ (ite(hit, one, zero) << target)));
-    }
+  for ( auto j = 0u; j < rows; ++j )
+  {
+    auto hit = ctx.bool_const(str(format("hit-%d-%d") % i % j).c_str());
+    solver.add(
+        hit == (((gate_values[i][j] ^ polarity) & control) == control));
+    solver.add(
+        gate_values[i + 1][j]
+        == (gate_values[i][j] ^ (ite(hit, one, zero) << target)));
   }
 }
 
 void gate_constraints_negative_control_multiple_target( z3::context& ctx,
-                                                        z3::solver& solver, circuit&, std::vector<std::vector<z3::expr> >& gates,
+                                                        z3::solver& solver, std::vector<std::vector<z3::expr> >& gates,
                                                         std::vector<std::vector<z3::expr> >& line_values,
-                                                        const binary_truth_table& spec, unsigned k, unsigned n )
+                                                        unsigned i, unsigned n )
 {
 
   using boost::str;
   using boost::format;
 
-  auto rows = boost::distance( spec );
+  auto rows = line_values[i].size();
 
   auto zero = ctx.bv_val(0, n);
   auto one = ctx.bv_val(1, n);
-  for ( auto i = 0u; i < k; ++i )
-  {
-    auto control = ctx.bv_const(str(format("control-%d") % i).c_str(), n);
-    auto target = ctx.bv_const(str(format("target-%d") % i).c_str(), n);
-    auto polarity = ctx.bv_const(str(format("polarity-%d") % i).c_str(), n);
+  auto control = ctx.bv_const(str(format("control-%d") % i).c_str(), n);
+  auto target = ctx.bv_const(str(format("target-%d") % i).c_str(), n);
+  auto polarity = ctx.bv_const(str(format("polarity-%d") % i).c_str(), n);
 
-    gates += std::vector<z3::expr>{ control, target, polarity };
+  gates += std::vector<z3::expr>{ control, target, polarity };
 
-    solver.add((control & target) == zero);
+  solver.add((control & target) == zero);
 
-    for ( auto j = 0u; j < rows; ++j )
-    {
-      auto hit = ctx.bool_const(str(format("hit-%d-%d") % i % j).c_str());
-      solver.add(
-          hit == (((line_values[i][j] ^ polarity) & control) == control));
-      solver.add(
-          line_values[i + 1][j]
-          == ite(hit, line_values[i][j] ^ target, line_values[i][j]));
-    }
+  for ( auto j = 0u; j < rows; ++j )
+  {
+    auto hit = ctx.bool_const(str(format("hit-%d-%d") % i % j).c_str());
+    solver.add(
+        hit == (((line_values[i][j] ^ polarity) & control) == control));
+    solver.add(
+        line_values[i + 1][j]
+        == ite(hit, line_values[i][j] ^ target, line_values[i][j]));
   }
 }
 
 void gate_constraints_multiple_target( z3::context& ctx, z3::solver& solver,
-                                       circuit&, std::vector<std::vector<z3::expr> >& network,
+                                       std::vector<std::vector<z3::expr> >& network,
                                        std::vector<std::vector<z3::expr> >& gate_values,
-                                       const binary_truth_table& spec, unsigned k, unsigned n )
+                                       unsigned i, unsigned n )
 {
   using boost::str;
   using boost::format;
 
-  auto rows = boost::distance( spec );
+  auto rows = gate_values[i].size();
 
   auto zero = ctx.bv_val(0, n);
   auto one = ctx.bv_val(1, n);
 
-  for ( auto i = 0u; i < k; ++i )
-  {
-    auto control = ctx.bv_const(str(format("control-%d") % i).c_str(), n);
-    auto target = ctx.bv_const(str(format("target-%d") % i).c_str(), n);
+  auto control = ctx.bv_const(str(format("control-%d") % i).c_str(), n);
+  auto target = ctx.bv_const(str(format("target-%d") % i).c_str(), n);
 
-    network += std::vector<z3::expr>{ control, target };
+  network += std::vector<z3::expr>{ control, target };
 
-    solver.add((control & target) == zero);
+  solver.add((control & target) == zero);
 
-    for ( auto j = 0u; j < rows; ++j )
-    {
-      auto hit = ctx.bool_const(str(format("hit-%d-%d") % i % j).c_str());
-      solver.add(hit == ((gate_values[i][j] & control) == control));
-      solver.add(
-          gate_values[i + 1][j]
-          == ite(hit, gate_values[i][j] ^ target, gate_values[i][j]));
-    }
+  for ( auto j = 0u; j < rows; ++j )
+  {
+    auto hit = ctx.bool_const(str(format("hit-%d-%d") % i % j).c_str());
+    solver.add(hit == ((gate_values[i][j] & control) == control));
+    solver.add(
+        gate_values[i + 1][j]
+        == ite(hit, gate_values[i][j] ^ target, gate_values[i][j]));
   }
 }
 
-bool eval_original(z3::solver& solver, circuit& circ,
+void eval_original(const z3::model& m, circuit& circ,
     std::vector<std::vector<z3::expr>>& network, unsigned k, unsigned n)
 {
-  if (solver.check() == z3::sat)
+  for (unsigned i : boost::irange(0u, k))
   {
-    z3::model m = solver.get_model();
-    for (unsigned i : boost::irange(0u, k))
-    {
-      auto eval_control = to_bitset(m.eval(network[i][0]));
-      auto eval_target = to_bitset(m.eval(network[i][1])).to_ulong();
+    auto eval_control = to_bitset(m.eval(network[i][0]));
+    auto eval_target = to_bitset(m.eval(network[i][1])).to_ulong();
 
-      gate::control_container controls;
-      for (unsigned j : boost::irange(0u, n))
+    gate::control_container controls;
+    for (unsigned j : boost::irange(0u, n))
+    {
+      if (eval_control.test(j))
       {
-        if (eval_control.test(j))
-        {
-          controls += make_var(j);
-        }
+        controls += make_var(j);
       }
-
-      append_toffoli(circ, controls, eval_target);
     }
-    return true;
-  } else
-  {
-    return false;
+
+    append_toffoli(circ, controls, eval_target);
   }
 }
 
-bool eval_multiple_target(z3::solver& solver, circuit& circ,
+void eval_multiple_target(const z3::model& m, circuit& circ,
     std::vector<std::vector<z3::expr>>& gates, unsigned k, unsigned n)
 {
-  if (solver.check() == z3::sat)
+
+  for (unsigned i : boost::irange(0u, k))
   {
-    z3::model m = solver.get_model();
+    auto eval_control = to_bitset(m.eval(gates[i][0]));
+    auto eval_target = to_bitset(m.eval(gates[i][1]));
 
-    for (unsigned i : boost::irange(0u, k))
+    gate::control_container controls;
+    for (unsigned j : boost::irange(0u, n))
     {
-      auto eval_control = to_bitset(m.eval(gates[i][0]));
-      auto eval_target = to_bitset(m.eval(gates[i][1]));
-
-      gate::control_container controls;
-      for (unsigned j : boost::irange(0u, n))
+      if (eval_control.test(j))
       {
-        if (eval_control.test(j))
-        {
-          controls += make_var(j);
-        }
-      }
-
-      gate::target_container targets;
-      for (unsigned j : boost::irange(0u, n))
-      {
-        if (eval_target.test(j))
-        {
-          targets += j;
-        }
+        controls += make_var(j);
       }
+    }
 
-      for ( const auto& target : targets )
+    gate::target_container targets;
+    for (unsigned j : boost::irange(0u, n))
+    {
+      if (eval_target.test(j))
       {
-        append_toffoli(circ, controls, target);
+        targets += j;
       }
     }
 
-    return true;
-  } else
-  {
-    return false;
+    for ( const auto& target : targets )
+    {
+      append_toffoli(circ, controls, target);
+    }
   }
 }
 
-bool eval_negative_control(z3::solver& solver, circuit& circ,
+void eval_negative_control(const z3::model& m, circuit& circ,
     std::vector<std::vector<z3::expr>>& gates, unsigned k, unsigned n)
 {
-  if (solver.check() == z3::sat)
+
+  for (unsigned i : boost::irange(0u, k))
   {
-    z3::model m = solver.get_model();
+    auto eval_control = to_bitset(m.eval(gates[i][0]));
+    auto eval_target = to_bitset(m.eval(gates[i][1])).to_ulong();
+    auto eval_polarity = to_bitset(m.eval(gates[i][2]));
 
-    for (unsigned i : boost::irange(0u, k))
+    gate::control_container controls;
+    for (unsigned j : boost::irange(0u, n))
     {
-      auto eval_control = to_bitset(m.eval(gates[i][0]));
-      auto eval_target = to_bitset(m.eval(gates[i][1])).to_ulong();
-      auto eval_polarity = to_bitset(m.eval(gates[i][2]));
-
-      gate::control_container controls;
-      for (unsigned j : boost::irange(0u, n))
+      if (eval_control.test(j))
       {
-        if (eval_control.test(j))
-        {
-          controls += make_var(j, !eval_polarity.test(j));
-        }
+        controls += make_var(j, !eval_polarity.test(j));
       }
-
-      append_toffoli(circ, controls, eval_target);
     }
 
-    return true;
-  } else
-  {
-    return false;
+    append_toffoli(circ, controls, eval_target);
   }
-
 }
 
-bool eval_negative_control_multiple_target(z3::solver& solver, circuit& circ,
+void eval_negative_control_multiple_target(const z3::model& m, circuit& circ,
     std::vector<std::vector<z3::expr>>& gates, unsigned k, unsigned n)
 {
-  if (solver.check() == z3::sat)
-  {
-    z3::model m = solver.get_model();
 
-    for (unsigned i : boost::irange(0u, k))
-    {
-      auto eval_control = to_bitset(m.eval(gates[i][0]));
-      auto eval_polarity = to_bitset(m.eval(gates[i][2]));
-      auto eval_target = to_bitset(m.eval(gates[i][1]));
+  for (unsigned i : boost::irange(0u, k))
+  {
+    auto eval_control = to_bitset(m.eval(gates[i][0]));
+    auto eval_polarity = to_bitset(m.eval(gates[i][2]));
+    auto eval_target = to_bitset(m.eval(gates[i][1]));
 
 //      std::cout << "control: " << eval_control << "\n";
 //      std::cout << "polarity: " << eval_polarity << "\n";
 //      std::cout << "target: " << eval_target << "\n";
 
 
-      gate::control_container controls;
-      for (unsigned j : boost::irange(0u, n))
+    gate::control_container controls;
+    for (unsigned j : boost::irange(0u, n))
+    {
+      if (eval_control.test(j))
       {
-        if (eval_control.test(j))
-        {
-          controls += make_var(j, !eval_polarity.test(j));
-        }
+        controls += make_var(j, !eval_polarity.test(j));
       }
+    }
 
-      gate::target_container targets;
-      for (unsigned j : boost::irange(0u, n))
+    gate::target_container targets;
+    for (unsigned j : boost::irange(0u, n))
+    {
+      if (eval_target.test(j))
       {
-        if (eval_target.test(j))
-        {
 //          std::cout <<"j: " <<  j << "\n";
-          targets += j;
-        }
-      }
-
-      for ( const auto& target : targets )
-      {
-        append_toffoli(circ, controls, target);
+        targets += j;
       }
     }
 
-    return true;
-  } else
-  {
-    return false;
+    for ( const auto& target : targets )
+    {
+      append_toffoli(circ, controls, target);
+    }
   }
 }
 
 void input_output_constraints(z3::context& ctx, z3::solver solver,
     const binary_truth_table& spec,
-    std::vector<std::vector<z3::expr> >& gate_values, unsigned k, unsigned n)
+    std::vector<std::vector<z3::expr> >& gate_values, unsigned k, unsigned n,
+    bool add_inputs = true, bool add_outputs = true)
 {
-// Constraints for inputs and outputs. This is
+// Constraints for inputs and outputs. Inputs are constrained once at
+// gate_values[0], outputs at gate_values[k] which differ for each depth.
   for (binary_truth_table::const_iterator iter = spec.begin();
       iter != spec.end(); ++iter)
   {
@@ -371,20 +340,60 @@ void input_output_constraints(z3::context& ctx, z3::solver solver,
     }
     unsigned pos = std::distance<binary_truth_table::const_iterator>(
         spec.begin(), iter);
-    solver.add(gate_values[0][pos] == ctx.bv_val((__uint64) in.to_ulong(), n));
-    solver.add(
-        (gate_values[k][pos] & ctx.bv_val((__uint64) mask.to_ulong(), n))
-            == ctx.bv_val((__uint64) out.to_ulong(), n));
+    if (add_inputs)
+    {
+      solver.add(gate_values[0][pos] == ctx.bv_val((__uint64) in.to_ulong(), n));
+    }
+    if (add_outputs)
+    {
+      solver.add(
+          (gate_values[k][pos] & ctx.bv_val((__uint64) mask.to_ulong(), n))
+              == ctx.bv_val((__uint64) out.to_ulong(), n));
+    }
   }
 }
 
-bool synth_len(circuit& circ, const binary_truth_table& spec,
-    properties::ptr settings, gate_constraint_fun gate_constraints,
-    evaluation_fun eval, unsigned gate_count)
+// this vector of vectores stores, for every gate (outer vector index), the
+// line values for each input pattern (inner vector index); this function adds
+// the values after the next gate
+void add_gate_values(z3::context& ctx,
+    std::vector<std::vector<z3::expr> >& gate_values, unsigned rows, unsigned n)
 {
   using boost::str;
   using boost::format;
 
+  const auto i = gate_values.size();
+  gate_values += std::vector<z3::expr>();
+  for (int j : boost::irange(0u, rows))
+  {
+    gate_values[i] += ctx.bv_const(
+        str(format("gate-value-%d-%d") % i % j).c_str(), n);
+  }
+}
+
+/******************************************************************************
+ * Portfolio                                                                  *
+ ******************************************************************************/
+
+// Shared state of the depth portfolio.  Each worker solves one depth in its
+// own context.  When depth k is satisfiable, all workers on larger depths are
+// interrupted.  Depths smaller than the best one are never interrupted, hence
+// the best depth is minimal when all workers have finished.
+struct exact_synthesis_portfolio
+{
+  std::mutex                      mutex;
+  std::atomic<unsigned>           next_depth{0u};
+  unsigned                        best_depth = std::numeric_limits<unsigned>::max();
+  circuit                         best_circuit;
+  std::map<unsigned, z3::context*> running;
+  unsigned                        interrupted = 0u;
+};
+
+// solves for exactly gate_count gates in a fresh context
+z3::check_result synth_len(circuit& circ, const binary_truth_table& spec,
+    const exact_synthesis_encoding& encoding, unsigned gate_count,
+    exact_synthesis_portfolio* portfolio = nullptr)
+{
   unsigned n = spec.num_inputs();
   unsigned rows = std::distance(spec.begin(), spec.end());
 
@@ -397,38 +406,174 @@ bool synth_len(circuit& circ, const binary_truth_table& spec,
   // In case of len 2, the first entry contains the controls, the second the targets
   // In case of len 3, the last entry contains the polarity of the controls
   std::vector<std::vector<z3::expr> > network;
+  std::vector<std::vector<z3::expr> > gate_values;
+
+  add_gate_values(ctx, gate_values, rows, n);
+  for (auto i : boost::irange(0u, gate_count))
+  {
+    add_gate_values(ctx, gate_values, rows, n);
+    encoding.gate_constraints(ctx, solver, network, gate_values, i, n);
+  }
+
+  input_output_constraints(ctx, solver, spec, gate_values, gate_count, n);
 
-  // this vector of vectores stores, for every input pattern (outer vector index), the
-  // line values after the k'th gate (inner vector index)
+  if (portfolio)
+  {
+    std::lock_guard<std::mutex> lock(portfolio->mutex);
+    if (gate_count > portfolio->best_depth)
+    {
+      return z3::unknown;
+    }
+    portfolio->running[gate_count] = &ctx;
+  }
+
+  const auto result = solver.check();
+
+  if (portfolio)
+  {
+    std::lock_guard<std::mutex> lock(portfolio->mutex);
+    portfolio->running.erase(gate_count);
+  }
+
+  if (result == z3::sat)
+  {
+    encoding.eval(solver.get_model(), circ, network, gate_count, n);
+  }
+
+  return result;
+}
+
+// increases the number of gates from 0 to max_depth in a single solver, the
+// output constraints are pushed and popped for each depth, everything else
+// including learnt lemmas is kept
+bool synth_incremental(circuit& circ, const binary_truth_table& spec,
+    const exact_synthesis_encoding& encoding, unsigned max_depth, bool verbose,
+    unsigned& depth)
+{
+  unsigned n = spec.num_inputs();
+  unsigned rows = std::distance(spec.begin(), spec.end());
+
+  z3::context ctx;
+  z3::solver solver(ctx);
+
+  std::vector<std::vector<z3::expr> > network;
   std::vector<std::vector<z3::expr> > gate_values;
 
-  // initialize the gate values
-  for (int i : boost::irange(0u, gate_count + 1u))
+  add_gate_values(ctx, gate_values, rows, n);
+  input_output_constraints(ctx, solver, spec, gate_values, 0u, n, true, false);
+
+  for (depth = 0u; ; ++depth)
   {
-    gate_values += std::vector<z3::expr>();
-    for (int j : boost::irange(0u, rows))
+    if ( verbose )
+    {
+      std::cout << "[i] check for depth " << depth << std::endl;
+    }
+
+    solver.push();
+    input_output_constraints(ctx, solver, spec, gate_values, depth, n, false, true);
+
+    if (solver.check() == z3::sat)
+    {
+      encoding.eval(solver.get_model(), circ, network, depth, n);
+      return true;
+    }
+
+    solver.pop();
+
+    if (depth == max_depth)
     {
-      gate_values[i] += ctx.bv_const(
-          str(format("gate-value-%d-%d") % i % j).c_str(), n);
+      return false;
     }
+
+    add_gate_values(ctx, gate_values, rows, n);
+    encoding.gate_constraints(ctx, solver, network, gate_values, depth, n);
   }
+}
 
-  input_output_constraints(ctx, solver, spec, gate_values, gate_count, n);
+bool synth_portfolio(circuit& circ, const binary_truth_table& spec,
+    const exact_synthesis_encoding& encoding, unsigned max_depth,
+    unsigned num_threads, bool verbose, unsigned& depth,
+    properties::ptr statistics)
+{
+  exact_synthesis_portfolio portfolio;
+
+  const auto worker = [&]() {
+    while (true)
+    {
+      const auto k = portfolio.next_depth++;
+      if (k > max_depth)
+      {
+        return;
+      }
+
+      {
+        std::lock_guard<std::mutex> lock(portfolio.mutex);
+        if (k > portfolio.best_depth)
+        {
+          return;
+        }
+      }
+
+      circuit local(spec.num_inputs());
+      const auto result = synth_len(local, spec, encoding, k, &portfolio);
+
+      std::lock_guard<std::mutex> lock(portfolio.mutex);
+      if ( verbose )
+      {
+        std::cout << boost::format("[i] depth %d is %s") % k % (result == z3::sat ? "SAT" : (result == z3::unsat ? "UNSAT" : "cancelled")) << std::endl;
+      }
+
+      if (result == z3::unknown)
+      {
+        ++portfolio.interrupted;
+      }
+      else if (result == z3::sat && k < portfolio.best_depth)
+      {
+        portfolio.best_depth = k;
+        portfolio.best_circuit = local;
 
-  gate_constraints(ctx, solver, circ, network, gate_values, spec, gate_count,
-      n);
+        // cancel all solvers on larger depths
+        for (const auto& p : portfolio.running)
+        {
+          if (p.first > k)
+          {
+            p.second->interrupt();
+          }
+        }
+      }
+    }
+  };
 
-  return eval(solver, circ, network, gate_count, n);
+  {
+    thread_pool pool(num_threads);
+    for (auto i = 0u; i < num_threads; ++i)
+    {
+      pool.enqueue(worker);
+    }
+  }
+
+  set(statistics, "interrupted", portfolio.interrupted);
+
+  if (portfolio.best_depth > max_depth)
+  {
+    return false;
+  }
 
+  depth = portfolio.best_depth;
+  append_circuit(circ, portfolio.best_circuit);
+  return true;
 }
 
 bool exact_synthesis(circuit& circ, const binary_truth_table& spec,
     properties::ptr settings, properties::ptr statistics)
 {
-  unsigned max_depth = get<unsigned>( settings, "max_depth", 20u );
-  bool     negative  = get<bool>(     settings, "negative",  false );
-  bool     multiple  = get<bool>(     settings, "multiple",  false );
-  bool     verbose   = get<bool>(     settings, "verbose",   false );
+  unsigned max_depth   = get<unsigned>( settings, "max_depth",   20u );
+  bool     negative    = get<bool>(     settings, "negative",    false );
+  bool     multiple    = get<bool>(     settings, "multiple",    false );
+  bool     incremental = get<bool>(     settings, "incremental", true );
+  bool     portfolio   = get<bool>(     settings, "portfolio",   false );
+  unsigned num_threads = get<unsigned>( settings, "num_threads", std::max( 1u, std::thread::hardware_concurrency() ) );
+  bool     verbose     = get<bool>(     settings, "verbose",     false );
 
   properties_timer t( statistics );
 
@@ -437,39 +582,48 @@ bool exact_synthesis(circuit& circ, const binary_truth_table& spec,
   unsigned gate_count = 0u;
   bool result = false;
 
-  gate_constraint_fun gate_constraints = &gate_constraints_original;
-  evaluation_fun eval = &eval_original;
+  exact_synthesis_encoding encoding{&gate_constraints_original, &eval_original};
 
   if (negative && multiple)
   {
-    gate_constraints = &gate_constraints_negative_control_multiple_target;
-    eval = &eval_negative_control_multiple_target;
+    encoding = {&gate_constraints_negative_control_multiple_target, &eval_negative_control_multiple_target};
   } else
   {
     if (negative)
     {
-      gate_constraints = &gate_constraints_negative_control;
-      eval = &eval_negative_control;
+      encoding = {&gate_constraints_negative_control, &eval_negative_control};
     }
     if (multiple)
     {
-      gate_constraints = &gate_constraints_multiple_target;
-      eval = &eval_multiple_target;
+      encoding = {&gate_constraints_multiple_target, &eval_multiple_target};
     }
   }
 
-  do
+  if (portfolio)
   {
-    if ( verbose )
+    result = synth_portfolio(circ, spec, encoding, max_depth, num_threads, verbose, gate_count, statistics);
+  }
+  else if (incremental)
+  {
+    result = synth_incremental(circ, spec, encoding, max_depth, verbose, gate_count);
+  }
+  else
+  {
+    z3::check_result r;
+    do
     {
-      std::cout << "[i] check for depth " << gate_count << std::endl;
-    }
-    result = synth_len(circ, spec, settings, gate_constraints, eval,
-        gate_count);
-  } while (!result && gate_count++ < max_depth);
+      if ( verbose )
+      {
+        std::cout << "[i] check for depth " << gate_count << std::endl;
+      }
+      r = synth_len(circ, spec, encoding, gate_count);
+    } while (r != z3::sat && gate_count++ < max_depth);
+    result = r == z3::sat;
+  }
 
   if (result)
   {
+    set(statistics, "depth", gate_count);
     copy_metadata(spec, circ);
   } else
   {
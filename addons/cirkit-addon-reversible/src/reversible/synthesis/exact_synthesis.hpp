@@ -59,6 +59,30 @@ namespace cirkit
    *   <tr>
    *     <td colspan="2" class="indexvalue">The maximal considered circuit depth.</td>
    *   </tr>
+   *   <tr>
+   *     <td rowspan="2" class="indexvalue">incremental</td>
+   *     <td class="indexvalue">bool</td>
+   *     <td class="indexvalue">true</td>
+   *   </tr>
+   *   <tr>
+   *     <td colspan="2" class="indexvalue">Use a single solver for all depths. Gates are added one after the other and only the output constraints are pushed and popped, such that learnt lemmas are kept between depths.</td>
+   *   </tr>
+   *   <tr>
+   *     <td rowspan="2" class="indexvalue">portfolio</td>
+   *     <td class="indexvalue">bool</td>
+   *     <td class="indexvalue">false</td>
+   *   </tr>
+   *   <tr>
+   *     <td colspan="2" class="indexvalue">Solve several depths concurrently, each in its own solver. Solvers on depths larger than a satisfiable one are interrupted.</td>
+   *   </tr>
+   *   <tr>
+   *     <td rowspan="2" class="indexvalue">num_threads</td>
+   *     <td class="indexvalue">unsigned</td>
+   *     <td class="indexvalue">hardware concurrency</td>
+   *   </tr>
+   *   <tr>
+   *     <td colspan="2" class="indexvalue">Number of threads in portfolio mode.</td>
+   *   </tr>
    * </table>
    * @param statistics <table border="0" width="100%">
    *   <tr>
@@ -71,6 +95,16 @@ namespace cirkit
    *     <td class="indexvalue">double</td>
    *     <td class="indexvalue">Run-time consumed by the algorithm in CPU seconds.</td>
    *   </tr>
+   *   <tr>
+   *     <td class="indexvalue">depth</td>
+   *     <td class="indexvalue">unsigned</td>
+   *     <td class="indexvalue">Number of gates in the minimal circuit.</td>
+   *   </tr>
+   *   <tr>
+   *     <td class="indexvalue">interrupted</td>
+   *     <td class="indexvalue">unsigned</td>
+   *     <td class="indexvalue">Number of cancelled solvers in portfolio mode.</td>
+   *   </tr>
    * </table>
    *
    * @return true if successful, false otherwise
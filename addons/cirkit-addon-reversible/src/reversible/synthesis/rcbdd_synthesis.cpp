@@ -580,6 +580,27 @@ struct rcbdd_synthesis_manager
     */
   }
 
+  /* makes var the identity, and records run-time and node count of the step */
+  void adjust_variable( unsigned var )
+  {
+    double runtime = 0.0;
+    {
+      increment_timer t( &runtime );
+
+      set_var(var);
+      only_left_gate_shortcut();
+      resolve_one_cycles();
+      resolve_two_cycles();
+      resolve_k_cycles();
+
+      create_toffoli_gates_with_exorcism(left_f, var, 0u);
+      create_toffoli_gates_with_exorcism(right_f, var, 1u);
+    }
+
+    step_runtimes += runtime;
+    step_node_counts += static_cast<unsigned long>( cf.manager().ReadNodeCount() );
+  }
+
   void default_synthesis()
   {
     for (unsigned var = 0; var < cf.num_vars(); ++var)
@@ -588,32 +609,18 @@ struct rcbdd_synthesis_manager
       {
         std::cout << "Adjust variable " << var << " / " << cf.num_vars() << std::endl;
       }
-      set_var(var);
-
       if ( synthesis_method == ResolveCycles )
       {
-        only_left_gate_shortcut();
-        resolve_one_cycles();
-        resolve_two_cycles();
-        resolve_k_cycles();
-
-        if ( false /*verbose*/ )
-        {
-          std::cout << "Target: " << _var << std::endl << " - left control function:" << std::endl;
-          left_f.PrintMinterm();
-          std::cout << " - right control function:" << std::endl;
-          right_f.PrintMinterm();
-        }
-
-        create_toffoli_gates_with_exorcism(left_f, var, 0u);
-        create_toffoli_gates_with_exorcism(right_f, var, 1u);
+        adjust_variable(var);
       }
       else if ( synthesis_method == TranspositionsX )
       {
+        set_var(var);
         //resolve_cycles_with_transpositions( resolve_x );
       }
       else if ( synthesis_method == TranspositionsY )
       {
+        set_var(var);
         //resolve_cycles_with_transpositions( resolve_y );
       }
     }
@@ -691,15 +698,8 @@ struct rcbdd_synthesis_manager
         total_control_lines = old_control_lines;
       }
 
-      set_var(best_line);
       // Synthesis with best_line
-      only_left_gate_shortcut();
-      resolve_one_cycles();
-      resolve_two_cycles();
-      resolve_k_cycles();
-
-      create_toffoli_gates_with_exorcism(left_f, best_line, 0u);
-      create_toffoli_gates_with_exorcism(right_f, best_line, 1u);
+      adjust_variable(best_line);
 
       list_lines.erase(std::remove(list_lines.begin(),list_lines.end(),best_line));
 
@@ -742,15 +742,8 @@ struct rcbdd_synthesis_manager
         }
       }
 
-      set_var(best_line);
       // Synthesis with best_line
-      only_left_gate_shortcut();
-      resolve_one_cycles();
-      resolve_two_cycles();
-      resolve_k_cycles();
-
-      create_toffoli_gates_with_exorcism(left_f, best_line, 0u);
-      create_toffoli_gates_with_exorcism(right_f, best_line, 1u);
+      adjust_variable(best_line);
 
       list_lines.erase(std::remove(list_lines.begin(),list_lines.end(),best_line));
 
@@ -783,6 +776,9 @@ struct rcbdd_synthesis_manager
   unsigned total_control_lines = 0u, total_toffoli_gates = 0u;
   unsigned long long access = 0ull;
   std::vector<int> node_count;
+
+  std::vector<double> step_runtimes;
+  std::vector<unsigned long> step_node_counts;
 };
 
 bool rcbdd_synthesis( circuit& circ, const rcbdd& cf, properties::ptr settings, properties::ptr statistics )
@@ -827,6 +823,8 @@ bool rcbdd_synthesis( circuit& circ, const rcbdd& cf, properties::ptr settings,
   {
     statistics->set( "access", mgr.access );
     statistics->set( "node_count", mgr.node_count );
+    statistics->set( "step_runtimes", mgr.step_runtimes );
+    statistics->set( "step_node_counts", mgr.step_node_counts );
   }
 
   return true;
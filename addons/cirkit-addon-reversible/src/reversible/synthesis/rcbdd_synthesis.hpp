@@ -46,6 +46,10 @@ enum SynthesisMethod {
 /**
  * @brief Embedding of an irreversible specification
  *
+ * Statistics:
+ *   runtime, access, node_count
+ *   step_runtimes, step_node_counts : run-time and live nodes after each variable
+ *
  * @since  2.0
  */
 bool rcbdd_synthesis( circuit& circ, const rcbdd& cf,
@@ -18,14 +18,164 @@
 
 #include "swop.hpp"
 
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <mutex>
+
+#include <boost/optional.hpp>
 #include <boost/range/algorithm.hpp>
 #include <boost/range/algorithm_ext/iota.hpp>
 
+#include <core/utils/thread_pool.hpp>
+
 #include "transformation_based_synthesis.hpp"
 
 namespace cirkit
 {
 
+  /* per-thread synthesis functions, each with its own copy of the specification */
+  struct swop_workers
+  {
+    std::vector<truth_table_synthesis_func> synths;
+    std::vector<binary_truth_table>         specs;
+    bool                                    gate_bound;
+
+    std::atomic<cost_t>                     best_costs;
+    std::atomic<unsigned long long>         evaluated{0ull};
+    std::atomic<unsigned long long>         pruned{0ull};
+  };
+
+  truth_table_synthesis_func swop_default_synthesis()
+  {
+    return transformation_based_synthesis_func( std::make_shared<properties>(), std::make_shared<properties>() );
+  }
+
+  /* when using gate costs, the best costs are an upper bound for the number of gates */
+  bool swop_uses_gate_costs( const cost_function& cf )
+  {
+    const auto* f = boost::get<costs_by_circuit_func>( &cf );
+    return f && f->target<gate_costs>();
+  }
+
+  void swop_update_best( std::atomic<cost_t>& best, cost_t c )
+  {
+    auto current = best.load();
+    while ( c < current && !best.compare_exchange_weak( current, c ) );
+  }
+
+  /* returns the costs, or nothing if synthesis failed or was pruned */
+  boost::optional<cost_t> swop_evaluate( swop_workers& workers, unsigned id, const std::vector<unsigned>& perm, const cost_function& cf )
+  {
+    auto& synth = workers.synths[id];
+    auto& spec  = workers.specs[id];
+
+    spec.set_permutation( perm );
+
+    const auto bound = workers.best_costs.load();
+    if ( workers.gate_bound && synth.settings() )
+    {
+      synth.settings()->set( "max_gates", bound < std::numeric_limits<unsigned>::max() ? static_cast<unsigned>( bound ) : 0u );
+    }
+
+    circuit tmp;
+    ++workers.evaluated;
+    if ( !synth( tmp, spec ) )
+    {
+      ++workers.pruned;
+      return boost::none;
+    }
+
+    const auto c = costs( tmp, cf );
+    swop_update_best( workers.best_costs, c );
+    return c;
+  }
+
+  /*
+   * Evaluates count candidates in parallel, where candidate(i, perm) writes
+   * the i-th permutation.  Returns the index and the costs of the first
+   * candidate with the smallest costs that are smaller than bound (or nothing).
+   */
+  boost::optional<std::pair<unsigned long long, cost_t>> swop_parallel( swop_workers& workers, unsigned long long count,
+                                                     const std::function<void( unsigned long long, std::vector<unsigned>& )>& candidate,
+                                                     const cost_function& cf, cost_t bound )
+  {
+    std::mutex mutex;
+    std::atomic<unsigned long long> next( 0ull );
+    boost::optional<unsigned long long> best_index;
+    auto best = bound;
+
+    const auto worker = [&]( unsigned id ) {
+      std::vector<unsigned> perm;
+      while ( true )
+      {
+        const auto i = next++;
+        if ( i >= count ) { return; }
+
+        candidate( i, perm );
+        const auto c = swop_evaluate( workers, id, perm, cf );
+
+        if ( c )
+        {
+          std::lock_guard<std::mutex> lock( mutex );
+          if ( *c < best || ( *c == best && best_index && i < *best_index ) )
+          {
+            best       = *c;
+            best_index = i;
+          }
+        }
+      }
+    };
+
+    {
+      thread_pool pool( workers.synths.size() );
+      for ( auto id = 0u; id < workers.synths.size(); ++id )
+      {
+        pool.enqueue( worker, id );
+      }
+    }
+
+    if ( !best_index )
+    {
+      return boost::none;
+    }
+    return std::make_pair( *best_index, best );
+  }
+
+  /* i-th permutation of n elements in lexicographic order */
+  void swop_unrank( unsigned long long i, unsigned n, std::vector<unsigned>& perm )
+  {
+    std::vector<unsigned> elements( n );
+    boost::iota( elements, 0u );
+
+    std::vector<unsigned long long> factorial( n + 1u, 1ull );
+    for ( auto k = 1u; k <= n; ++k ) { factorial[k] = factorial[k - 1u] * k; }
+
+    perm.clear();
+    for ( auto k = n; k > 0u; --k )
+    {
+      const auto j = i / factorial[k - 1u];
+      i %= factorial[k - 1u];
+      perm.push_back( elements[j] );
+      elements.erase( elements.begin() + j );
+    }
+  }
+
+  unsigned long long swop_rank( const std::vector<unsigned>& perm )
+  {
+    unsigned long long r = 0ull;
+    for ( auto k = 0u; k < perm.size(); ++k )
+    {
+      auto smaller = 0u;
+      for ( auto l = k + 1u; l < perm.size(); ++l )
+      {
+        if ( perm[l] < perm[k] ) { ++smaller; }
+      }
+      r = r * ( perm.size() - k ) + smaller;
+    }
+    return r;
+  }
+
   bool swop( circuit& circ, const binary_truth_table& spec,
              properties::ptr settings,
              properties::ptr statistics )
@@ -35,6 +185,14 @@ namespace cirkit
     truth_table_synthesis_func synth = get( settings, "synthesis",     truth_table_synthesis_func( transformation_based_synthesis_func() ) );
     cost_function cf                 = get( settings, "cost_function", cost_function( costs_by_circuit_func( gate_costs() ) ) );
     swop_step_func stepfunc          = get( settings, "stepfunc",      swop_step_func( swop_step_func() ) );
+    unsigned num_threads             = get( settings, "num_threads",   1u );
+    swop_synthesis_factory factory   = get( settings, "synthesis_factory", swop_synthesis_factory() );
+
+    /* a custom synthesis function cannot be shared among threads */
+    if ( !factory && settings && settings->has_key( "synthesis" ) )
+    {
+      num_threads = 1u;
+    }
 
     properties_timer t( statistics );
 
@@ -43,12 +201,62 @@ namespace cirkit
 
     clear_circuit( circ );
 
-    if ( exhaustive )
+    if ( !factory )
+    {
+      factory = swop_default_synthesis;
+    }
+
+    swop_workers workers;
+    workers.gate_bound = swop_uses_gate_costs( cf );
+    workers.best_costs = std::numeric_limits<cost_t>::max();
+    if ( num_threads > 1u && enable )
+    {
+      for ( auto i = 0u; i < num_threads; ++i )
+      {
+        workers.synths.push_back( factory() );
+        workers.specs.push_back( spec );
+      }
+    }
+
+    const auto wall_start = std::chrono::steady_clock::now();
+    const auto report = [&]() {
+      const auto seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - wall_start ).count();
+      set( statistics, "evaluated", static_cast<unsigned long long>( workers.evaluated ) );
+      set( statistics, "pruned", static_cast<unsigned long long>( workers.pruned ) );
+      set( statistics, "permutations_per_second", seconds > 0.0 ? workers.evaluated / seconds : 0.0 );
+    };
+
+    if ( exhaustive && !workers.synths.empty() )
+    {
+      const auto n     = spec2.num_outputs();
+      const auto first = swop_rank( spec2.permutation() );
+      auto total = 1ull;
+      for ( auto k = 2u; k <= n; ++k ) { total *= k; }
+
+      const auto best = swop_parallel( workers, total - first, [first, n]( unsigned long long i, std::vector<unsigned>& perm ) {
+          swop_unrank( first + i, n, perm );
+        }, cf, std::numeric_limits<cost_t>::max() );
+
+      if ( stepfunc )
+      {
+        for ( auto i = first; i < total; ++i ) { stepfunc(); }
+      }
+
+      if ( best )
+      {
+        std::vector<unsigned> perm;
+        swop_unrank( first + best->first, n, perm );
+        spec2.set_permutation( perm );
+        synth( circ, spec2 );
+      }
+    }
+    else if ( exhaustive )
     {
       do
       {
         circuit tmp;
         bool r = synth( tmp, spec2 );
+        ++workers.evaluated;
         if ( r && ( !circ.num_gates() || costs( tmp, cf ) < costs( circ, cf ) ) )
         {
           clear_circuit( circ );
@@ -61,6 +269,11 @@ namespace cirkit
         }
       } while ( enable && spec2.permute() );
     }
+
+    if ( exhaustive )
+    {
+      report();
+    }
     else
     {
       std::vector<unsigned> perm( spec2.num_outputs() );
@@ -79,8 +292,50 @@ namespace cirkit
 
           unsigned best_position = itCurrent - perm.begin();
 
+          if ( !workers.synths.empty() )
+          {
+            /* collect the candidates of this step and evaluate them in parallel */
+            std::vector<std::vector<unsigned>> candidates;
+            std::vector<unsigned> positions;
+
+            do
+            {
+              candidates.push_back( perm );
+              positions.push_back( itCurrent - perm.begin() );
+
+              itNext = std::find_if( itCurrent + 1, perm.end(), [&itCurrent]( unsigned j ) { return j > *itCurrent; } );
+              if ( itNext != perm.end() )
+              {
+                std::iter_swap( itCurrent, itNext );
+                itCurrent = itNext;
+              }
+            }
+            while ( itNext != perm.end() );
+
+            const auto best = swop_parallel( workers, candidates.size(), [&candidates]( unsigned long long i, std::vector<unsigned>& p ) {
+                p = candidates[i];
+              }, cf, min_costs == 0u ? std::numeric_limits<cost_t>::max() : min_costs );
+
+            if ( best )
+            {
+              min_costs     = best->second;
+              best_position = positions[best->first];
+              best_perm     = candidates[best->first];
+            }
+
+            if ( stepfunc )
+            {
+              for ( auto k = 0u; k < candidates.size(); ++k ) { stepfunc(); }
+            }
+
+            perm.erase( std::find( perm.begin(), perm.end(), i ) );
+            perm.insert( perm.begin() + best_position, i );
+            continue;
+          }
+
           do
           {
+            ++workers.evaluated;
             circuit tmp;
             spec2.set_permutation( perm );
             bool r = synth( tmp, spec2 );
@@ -118,6 +373,8 @@ namespace cirkit
       spec2.set_permutation( best_perm );
       bool r = synth( circ, spec2 );
 
+      report();
+
       if (!r)
       {
         set_error_message (statistics, synth.statistics()->get<std::string>("error"));
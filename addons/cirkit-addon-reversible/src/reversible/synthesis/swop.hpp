@@ -55,6 +55,19 @@ namespace cirkit
    */
   typedef std::function<void()> swop_step_func;
 
+  /**
+   * @brief Creates a synthesis function for one SWOP worker thread
+   *
+   * Each call has to return an independent functor with its own settings and
+   * statistics.  If the settings of the functor accept the \em max_gates
+   * setting (as \ref revkit::transformation_based_synthesis "transformation_based_synthesis"),
+   * it is set to the best costs found so far when using gate costs, such that
+   * synthesis of worse permutations is aborted early.
+   *
+   * @since  2.3
+   */
+  typedef std::function<truth_table_synthesis_func()> swop_synthesis_factory;
+
   /**
    * @brief SWOP Synthesis Approach
    *
@@ -126,6 +139,22 @@ namespace cirkit
    *   <tr>
    *     <td colspan="2" class="indexvalue">This functor is called after each iteration.</td>
    *   </tr>
+   *   <tr>
+   *     <td rowspan="2" class="indexvalue">num_threads</td>
+   *     <td class="indexvalue">unsigned</td>
+   *     <td class="indexvalue">1u</td>
+   *   </tr>
+   *   <tr>
+   *     <td colspan="2" class="indexvalue">Number of threads. If larger than 1, the permutations of each sifting step (or all permutations in exhaustive mode) are evaluated in parallel, each thread with its own copy of the specification. The result is the same as for the sequential version.</td>
+   *   </tr>
+   *   <tr>
+   *     <td rowspan="2" class="indexvalue">synthesis_factory</td>
+   *     <td class="indexvalue">\ref revkit::swop_synthesis_factory "swop_synthesis_factory"</td>
+   *     <td class="indexvalue"><i>Empty functor</i></td>
+   *   </tr>
+   *   <tr>
+   *     <td colspan="2" class="indexvalue">Creates the synthesis functions for the threads. If empty, transformation based synthesis is used. If empty and a custom <i>synthesis</i> is given, only one thread is used.</td>
+   *   </tr>
    * </table>
    * @param statistics <table border="0" width="100%">
    *   <tr>
@@ -138,6 +167,21 @@ namespace cirkit
    *     <td class="indexvalue">double</td>
    *     <td class="indexvalue">Run-time consumed by the algorithm in CPU seconds.</td>
    *   </tr>
+   *   <tr>
+   *     <td class="indexvalue">evaluated</td>
+   *     <td class="indexvalue">unsigned long long</td>
+   *     <td class="indexvalue">Number of synthesized permutations.</td>
+   *   </tr>
+   *   <tr>
+   *     <td class="indexvalue">pruned</td>
+   *     <td class="indexvalue">unsigned long long</td>
+   *     <td class="indexvalue">Number of permutations for which synthesis failed or was aborted by the cost bound (only with multiple threads).</td>
+   *   </tr>
+   *   <tr>
+   *     <td class="indexvalue">permutations_per_second</td>
+   *     <td class="indexvalue">double</td>
+   *     <td class="indexvalue">Evaluated permutations per second (wall time).</td>
+   *   </tr>
    * </table>
    * @return true on success
    *
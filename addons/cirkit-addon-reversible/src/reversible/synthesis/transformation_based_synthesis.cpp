@@ -18,19 +18,20 @@
 
 #include "transformation_based_synthesis.hpp"
 
+#include <cstdint>
+
 #include <boost/assign/std/vector.hpp>
-#include <boost/range/algorithm.hpp>
+#include <boost/dynamic_bitset.hpp>
 
 #include <core/utils/bitset_utils.hpp>
 #include <core/utils/range_utils.hpp>
 #include <core/utils/timer.hpp>
 #include <reversible/circuit.hpp>
+#include <reversible/dense_truth_table.hpp>
 #include <reversible/functions/add_gates.hpp>
 #include <reversible/functions/clear_circuit.hpp>
 #include <reversible/functions/copy_metadata.hpp>
 #include <reversible/functions/fully_specified.hpp>
-#include <reversible/io/print_circuit.hpp>
-#include <reversible/utils/truth_table_helpers.hpp>
 
 #include "synthesis_utils_p.hpp"
 
@@ -48,109 +49,121 @@ enum direction_t
   direction_back, direction_front
 };
 
-/******************************************************************************
- * Private functions                                                          *
- ******************************************************************************/
+/*
+ * The function is kept as a permutation f together with its inverse.  Bit b
+ * of a value corresponds to line bw - 1 - b.  Gates are not inserted into
+ * the circuit immediately, but collected in a buffer: gates at the front
+ * keep their order, gates at the back are added in reverse order.
+ */
+struct tbs_gate
+{
+  bool          fredkin;
+  std::uint32_t controls;
+  unsigned      target1;
+  unsigned      target2;
+};
 
-/* returns true if all bits have been checked and false if while loop was broken */
-bool foreach_bit( const boost::dynamic_bitset<>& bits, std::function<bool(boost::dynamic_bitset<>::size_type)> func )
+class tbs_state
 {
-  auto bpos = bits.find_first();
-  while ( bpos != boost::dynamic_bitset<>::npos )
+public:
+  tbs_state( const std::vector<unsigned>& perm, unsigned bw )
+    : bw( bw ),
+      f( perm.begin(), perm.end() ),
+      inv( perm.size() )
   {
-    if ( !func( bpos ) ) return false;
-    bpos = bits.find_next( bpos );
+    for ( auto x = 0u; x < f.size(); ++x )
+    {
+      inv[f[x]] = x;
+    }
   }
-  return true;
-}
 
-gate::control_container get_control_lines_from_mask( const boost::dynamic_bitset<>& mask )
-{
-  gate::control_container controls;
-  boost::dynamic_bitset<>::size_type pos = mask.find_first();
-  while ( pos != boost::dynamic_bitset<>::npos )
+  void apply_toffoli( std::uint32_t controls, unsigned target, direction_t dir )
   {
-    controls += make_var( mask.size() - 1u - pos );
-    pos = mask.find_next( pos );
+    const std::uint32_t t = 1u << target;
+    apply( controls, 0u, t, dir );
+    ( dir == direction_back ? back : front ).push_back( {false, controls, target, 0u} );
   }
-  return controls;
-}
-
-bitset_pair_vector_t& sort_truth_table( bitset_pair_vector_t& tt )
-{
-  typedef bitset_pair_vector_t::value_type value_type;
-  return boost::sort( tt, []( const value_type& p1, const value_type& p2 ) { return p1.first < p2.first; } );
-}
-
-unsigned hamming_distance( const std::pair<boost::dynamic_bitset<>, boost::dynamic_bitset<>>& p )
-{
-  return ( p.first ^ p.second ).count();
-}
 
-void basic_first_step( circuit& circ, bitset_pair_vector_t& tt )
-{
-  boost::dynamic_bitset<>::size_type bpos = tt[0].second.find_first();
-
-  while ( bpos != boost::dynamic_bitset<>::npos )
+  void apply_fredkin( std::uint32_t controls, unsigned t1, unsigned t2, direction_t dir )
   {
-    prepend_not( circ, circ.lines() - 1u - bpos );
-    for ( auto& p : tt )
-    {
-      p.second.flip( bpos );
-    }
-    bpos = tt[0].second.find_next( bpos );
+    const std::uint32_t m1 = 1u << t1, m2 = 1u << t2;
+    apply( controls | m1, m2, m1 | m2, dir );
+    ( dir == direction_back ? back : front ).push_back( {true, controls, t1, t2} );
   }
-}
 
-void insert_toffoli_gate( circuit& circ, unsigned& pos, boost::dynamic_bitset<> controls, unsigned target, bitset_pair_vector_t& tt, direction_t dir )
-{
-  insert_toffoli( circ, pos, get_control_lines_from_mask( controls ), circ.lines() - 1u - target );
-
-  for ( auto& p : tt )
+  unsigned                   bw;
+  std::vector<std::uint32_t> f;
+  std::vector<std::uint32_t> inv;
+  std::vector<tbs_gate>      front;
+  std::vector<tbs_gate>      back;
+
+private:
+  /*
+   * Swaps all pairs ( y, y ^ flip ), where y contains all bits of ones and
+   * none of the bits of zeros.  Only the values affected by the gate are
+   * enumerated, i.e., 2^(bw - |ones| - |zeros|) pairs.
+   */
+  void apply( std::uint32_t ones, std::uint32_t zeros, std::uint32_t flip, direction_t dir )
   {
-    auto& bits = ( dir == direction_back ) ? p.second : p.first;
-    if ( ( bits & controls ) == controls )
+    const std::uint32_t all  = bw == 32u ? ~0u : ( ( 1u << bw ) - 1u );
+    const std::uint32_t free = all & ~( ones | zeros | flip );
+    auto& a = ( dir == direction_back ) ? inv : f;
+    auto& b = ( dir == direction_back ) ? f : inv;
+
+    std::uint32_t sub = 0u;
+    do
     {
-      bits.flip( target );
-    }
+      const auto y1 = ones | sub;
+      const auto y2 = y1 ^ flip;
+
+      std::swap( a[y1], a[y2] );
+      b[a[y1]] = y1;
+      b[a[y2]] = y2;
+
+      sub = ( sub - free ) & free;
+    } while ( sub );
   }
+};
+
+/******************************************************************************
+ * Private functions                                                          *
+ ******************************************************************************/
 
-  if ( dir == direction_front )
+/* calls func for each set bit in ascending order */
+template<typename Fn>
+void foreach_set_bit( std::uint32_t bits, Fn&& func )
+{
+  while ( bits )
   {
-    ++pos;
-    tt = sort_truth_table( tt );
+    func( lowest_bit( bits ) );
+    bits &= bits - 1u;
   }
 }
 
-void insert_fredkin_gate( circuit& circ, unsigned& pos, boost::dynamic_bitset<> controls, unsigned t1, unsigned t2, bitset_pair_vector_t& tt, direction_t dir )
+gate::control_container get_control_lines_from_mask( std::uint32_t mask, unsigned bw )
 {
-  insert_fredkin( circ, pos, get_control_lines_from_mask( controls ), circ.lines() - 1u - t1, circ.lines() - 1u - t2 );
-
-  for ( auto& p : tt )
-  {
-    auto& bits = ( dir == direction_back ) ? p.second : p.first;
-    if ( ( bits & controls ) == controls )
-    {
-      bool tmp = bits[t1]; bits[t1] = bits[t2]; bits[t2] = tmp;
-    }
-  }
+  gate::control_container controls;
+  foreach_set_bit( mask, [&]( unsigned pos ) {
+      controls += make_var( bw - 1u - pos );
+    } );
+  return controls;
+}
 
-  if ( dir == direction_front )
-  {
-    ++pos;
-    tt = sort_truth_table( tt );
-  }
+void basic_first_step( tbs_state& state )
+{
+  foreach_set_bit( state.f[0u], [&]( unsigned bpos ) {
+      state.apply_toffoli( 0u, bpos, direction_back );
+    } );
 }
 
-void adjust_line( circuit& circ, unsigned& pos, bitset_pair_vector_t& tt, unsigned line, direction_t dir, bool try_fredkin, bool fredkin_lookback )
+void adjust_line( tbs_state& state, unsigned line, direction_t dir, bool try_fredkin, bool fredkin_lookback )
 {
-  unsigned bw = circ.lines();
+  const auto input  = line;
+  const auto output = state.f[line];
 
-  auto input = tt[line].first;
-  auto output = tt[line].second;
-  auto p = ( input ^ output ) & ( dir == direction_back ? input : output );
-  auto q = ( input ^ output ) & ( dir == direction_back ? output : input );
-  auto mask = dir == direction_back ? output : input;
+  std::uint32_t p    = ( input ^ output ) & ( dir == direction_back ? input : output );
+  std::uint32_t q    = ( input ^ output ) & ( dir == direction_back ? output : input );
+  std::uint32_t mask = dir == direction_back ? output : input;
 
   /* fredkin */
   if ( try_fredkin )
@@ -161,80 +174,82 @@ void adjust_line( circuit& circ, unsigned& pos, bitset_pair_vector_t& tt, unsign
     {
       found = false;
 
-      auto b1 = p.find_first();
-      while ( b1 != boost::dynamic_bitset<>::npos )
+      for ( auto b1 = 0u; b1 < state.bw && !found; ++b1 )
       {
-        auto b2 = q.find_first();
-        while ( b2 != boost::dynamic_bitset<>::npos )
+        if ( !( ( p >> b1 ) & 1u ) ) { continue; }
+
+        for ( auto b2 = 0u; b2 < state.bw; ++b2 )
         {
-          auto mask_copy = mask;
-          mask_copy.reset( b1 );
-          mask_copy.reset( b2 );
+          if ( !( ( q >> b2 ) & 1u ) ) { continue; }
 
-          auto mask_compare = ( dir == direction_back ) ? input : output;
+          const std::uint32_t mask_copy    = mask & ~( ( 1u << b1 ) | ( 1u << b2 ) );
+          const std::uint32_t mask_compare = ( dir == direction_back ) ? input : output;
           bool mask_valid = mask_copy > mask_compare;
 
           if ( !mask_valid && fredkin_lookback ) /* try harder */
           {
             mask_valid = true;
-            boost::dynamic_bitset<> current( bw );
+            std::uint32_t current = 0u;
             do {
-              if ( ( mask_copy & current ) == mask_copy && ( current[b1] != current[b2] ) )
+              if ( ( mask_copy & current ) == mask_copy && ( ( current >> b1 ) & 1u ) != ( ( current >> b2 ) & 1u ) )
               {
                 mask_valid = false;
                 break;
               }
-              inc( current );
+              ++current;
             } while ( current != mask_compare );
           }
 
           if ( mask_valid )
           {
-            //std::cout << "[i] insert fred on " << b1 << " and " << b2 << " with mask = " << mask_copy << std::endl;
-            insert_fredkin_gate( circ, pos, mask_copy, b1, b2, tt, dir );
-            p.reset( b1 );
-            q.reset( b2 );
-            mask.set( b1 );
-            mask.reset( b2 );
+            state.apply_fredkin( mask_copy, b1, b2, dir );
+            p    &= ~( 1u << b1 );
+            q    &= ~( 1u << b2 );
+            mask |= 1u << b1;
+            mask &= ~( 1u << b2 );
             found = true;
             break;
           }
-          b2 = q.find_next( b2 );
         }
-
-        if ( found ) break;
-        b1 = p.find_next( b1 );
       }
-    } while ( found);
+    } while ( found );
   }
 
   /* change 0 -> 1 */
-  auto bpos = p.find_first();
-  while ( bpos != boost::dynamic_bitset<>::npos )
-  {
-    insert_toffoli_gate( circ, pos, mask, bpos, tt, dir );
-    mask.set( bpos );
-    bpos = p.find_next( bpos );
-  }
+  foreach_set_bit( p, [&]( unsigned bpos ) {
+      state.apply_toffoli( mask, bpos, dir );
+      mask |= 1u << bpos;
+    } );
 
   /* change 1 -> 0 */
-  bpos = q.find_first();
-  while ( bpos != boost::dynamic_bitset<>::npos )
+  foreach_set_bit( q, [&]( unsigned bpos ) {
+      mask &= ~( 1u << bpos );
+      state.apply_toffoli( mask, bpos, dir );
+    } );
+}
+
+void append_tbs_gate( circuit& circ, const tbs_gate& g )
+{
+  const auto bw = circ.lines();
+
+  if ( g.fredkin )
   {
-    mask.reset( bpos );
-    insert_toffoli_gate( circ, pos, mask, bpos, tt, dir );
-    bpos = q.find_next( bpos );
+    append_fredkin( circ, get_control_lines_from_mask( g.controls, bw ), bw - 1u - g.target1, bw - 1u - g.target2 );
+  }
+  else
+  {
+    append_toffoli( circ, get_control_lines_from_mask( g.controls, bw ), bw - 1u - g.target1 );
   }
 }
 
-void print_current_state( unsigned index, const circuit& circ, const bitset_pair_vector_t& tt )
+void print_current_state( unsigned index, const tbs_state& state )
 {
   std::cout << "[i] state at index " << index << std::endl;
-  std::cout << "[i] current circuit: " << std::endl << circ << std::endl;
+  std::cout << "[i] gates: " << state.front.size() << " front, " << state.back.size() << " back" << std::endl;
   std::cout << "[i] current spec: " << std::endl;
-  for ( auto p : tt )
+  for ( auto x = 0u; x < state.f.size(); ++x )
   {
-    std::cout << p.first << " |-> " << p.second << std::endl;
+    std::cout << boost::dynamic_bitset<>( state.bw, x ) << " |-> " << boost::dynamic_bitset<>( state.bw, state.f[x] ) << std::endl;
   }
   std::cout << std::endl;
 }
@@ -246,11 +261,27 @@ void print_current_state( unsigned index, const circuit& circ, const bitset_pair
 bool transformation_based_synthesis( circuit& circ, const binary_truth_table& spec,
                                      properties::ptr settings,
                                      properties::ptr statistics )
+{
+  /* truth table has to be fully specified */
+  if ( !fully_specified( spec ) )
+  {
+    clear_circuit( circ );
+    set_error_message( statistics, "truth table `spec` is not fully specified." );
+    return false;
+  }
+
+  return transformation_based_synthesis( circ, dense_truth_table( spec ), settings, statistics );
+}
+
+bool transformation_based_synthesis( circuit& circ, const dense_truth_table& spec,
+                                     properties::ptr settings,
+                                     properties::ptr statistics )
 {
   /* Settings */
   const auto bidirectional    = get( settings, "bidirectional",    true  );
   const auto fredkin          = get( settings, "fredkin",          false );
   const auto fredkin_lookback = get( settings, "fredkin_lookback", false );
+  const auto max_gates        = get( settings, "max_gates",        0u    );
   const auto verbose          = get( settings, "verbose",          false );
 
   /* Warning */
@@ -265,61 +296,54 @@ bool transformation_based_synthesis( circuit& circ, const binary_truth_table& sp
   clear_circuit( circ );
 
   /* truth table has to be fully specified */
-  if ( !fully_specified( spec ) )
+  if ( !spec.is_fully_specified() || spec.num_inputs() == 0u || spec.num_inputs() != spec.num_outputs() )
   {
     set_error_message( statistics, "truth table `spec` is not fully specified." );
     return false;
   }
 
-  /* truth table to bitsets */
-  bitset_pair_vector_t tt = truth_table_to_bitset_pair_vector( spec );
-  sort_truth_table( tt );
-
   const auto bw = spec.num_outputs();
   circ.set_lines( bw );
 
   /* copy metadata */
   copy_metadata( spec, circ );
 
+  tbs_state state( spec.to_permutation(), bw );
+
   /* Step 1 */
   if ( !bidirectional )
   {
     if ( verbose )
     {
-      print_current_state( 0u, circ, tt );
+      print_current_state( 0u, state );
     }
 
-    basic_first_step( circ, tt );
+    basic_first_step( state );
   }
 
   /* Step 2 */
   const auto start_index = bidirectional ? 0u : 1u;
-  auto pos = 0u;
-
-  direction_t dir = direction_back;
-  auto index = 0u;
 
-  for ( unsigned i = start_index; i < tt.size(); ++i )
+  for ( unsigned i = start_index; i < state.f.size(); ++i )
   {
     if ( verbose )
     {
-      print_current_state( i, circ, tt );
+      print_current_state( i, state );
     }
 
-    if ( tt[i].first == tt[i].second )
+    if ( state.f[i] == i )
     {
       continue;
     }
 
-    dir = direction_back;
-    index = i;
+    auto dir   = direction_back;
+    auto index = i;
     if ( bidirectional )
     {
-      typedef bitset_pair_vector_t::value_type value_type;
-      const auto other_index = boost::find_if( tt, [&tt, &i]( const value_type& p ) { return p.second == tt[i].first; } ) - tt.begin();
-      if ( hamming_distance( tt[other_index] ) < hamming_distance( tt[i] ) )
+      const auto other_index = state.inv[i];
+      if ( bit_count( other_index ^ i ) < bit_count( i ^ state.f[i] ) )
       {
-        dir = direction_front;
+        dir   = direction_front;
         index = other_index;
       }
     }
@@ -328,7 +352,23 @@ bool transformation_based_synthesis( circuit& circ, const binary_truth_table& sp
     {
       std::cout << "[i] adjust line: " << index << std::endl;
     }
-    adjust_line( circ, pos, tt, index, dir, fredkin, fredkin_lookback );
+    adjust_line( state, index, dir, fredkin, fredkin_lookback );
+
+    if ( max_gates && state.front.size() + state.back.size() > max_gates )
+    {
+      set_error_message( statistics, "number of gates exceeds max_gates." );
+      return false;
+    }
+  }
+
+  /* emit gates */
+  for ( const auto& g : state.front )
+  {
+    append_tbs_gate( circ, g );
+  }
+  for ( auto it = state.back.rbegin(); it != state.back.rend(); ++it )
+  {
+    append_tbs_gate( circ, *it );
   }
 
   return true;
@@ -337,7 +377,7 @@ bool transformation_based_synthesis( circuit& circ, const binary_truth_table& sp
 truth_table_synthesis_func transformation_based_synthesis_func( properties::ptr settings,
                                                                 properties::ptr statistics )
 {
-  truth_table_synthesis_func f = [&settings, &statistics]( circuit& circ, const binary_truth_table& spec ) {
+  truth_table_synthesis_func f = [settings, statistics]( circuit& circ, const binary_truth_table& spec ) {
     return transformation_based_synthesis( circ, spec, settings, statistics );
   };
   f.init( settings, statistics );
@@ -30,6 +30,7 @@
 
 #include <core/properties.hpp>
 #include <reversible/circuit.hpp>
+#include <reversible/dense_truth_table.hpp>
 #include <reversible/truth_table.hpp>
 
 #include <reversible/synthesis/synthesis.hpp>
@@ -58,6 +59,14 @@ namespace cirkit
    *   <tr>
    *     <td colspan="2" class="indexvalue">Use the bidirectional approach as described in [\ref MMD03].</td>
    *   </tr>
+   *   <tr>
+   *     <td rowspan="2" class="indexvalue">max_gates</td>
+   *     <td class="indexvalue">unsigned</td>
+   *     <td class="indexvalue">0u</td>
+   *   </tr>
+   *   <tr>
+   *     <td colspan="2" class="indexvalue">If not 0, synthesis is aborted (and fails) as soon as the circuit has more gates. Used by \ref revkit::swop "swop" to prune permutations.</td>
+   *   </tr>
    * </table>
    * @param statistics <table border="0" width="100%">
    *   <tr>
@@ -80,6 +89,20 @@ namespace cirkit
                                        properties::ptr settings = properties::ptr(),
                                        properties::ptr statistics = properties::ptr() );
 
+  /**
+   * @brief Transformation Based Synthesis on a dense permutation
+   *
+   * Same algorithm and settings as the version above.  The function is kept
+   * as permutation array together with its inverse, each gate only swaps
+   * the affected pairs of both arrays, and gates are collected in a buffer
+   * which is turned into the circuit at the end.
+   *
+   * @since  2.3
+   */
+  bool transformation_based_synthesis( circuit& circ, const dense_truth_table& spec,
+                                       properties::ptr settings = properties::ptr(),
+                                       properties::ptr statistics = properties::ptr() );
+
   /**
    * @brief Functor for the \ref revkit::transformation_based_synthesis "transformation_based_synthesis" algorithm
    *
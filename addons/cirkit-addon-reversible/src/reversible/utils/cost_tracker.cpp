@@ -0,0 +1,238 @@
+/* CirKit: A circuit toolkit
+ * Copyright (C) 2009-2015  University of Bremen
+ * Copyright (C) 2015-2016  EPFL
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cost_tracker.hpp"
+
+#include <cassert>
+#include <numeric>
+
+#include <reversible/functions/add_circuit.hpp>
+#include <reversible/functions/expand_circuit.hpp>
+
+namespace cirkit
+{
+
+/******************************************************************************
+ * Public functions                                                           *
+ ******************************************************************************/
+
+cost_tracker::cost_tracker( circuit& circ, const cost_function& f )
+  : circ( circ ),
+    f( f )
+{
+  if ( const auto* gf = boost::get<costs_by_gate_func>( &f ) )
+  {
+    kind      = cost_kind::per_gate;
+    gate_func = *gf;
+  }
+  else
+  {
+    const auto& cf = boost::get<costs_by_circuit_func>( f );
+    if ( cf.target<gate_costs>() )
+    {
+      kind = cost_kind::gate_count;
+    }
+    else if ( cf.target<line_costs>() )
+    {
+      kind = cost_kind::line_count;
+    }
+    else
+    {
+      kind = cost_kind::whole_circuit;
+    }
+  }
+
+  refresh();
+}
+
+cost_t cost_tracker::total() const
+{
+  switch ( kind )
+  {
+  case cost_kind::per_gate:
+  case cost_kind::gate_count:
+    return sum;
+
+  case cost_kind::line_count:
+    return circ.lines();
+
+  case cost_kind::whole_circuit:
+  default:
+    if ( dirty )
+    {
+      circuit_costs = costs( circ, f );
+      dirty = false;
+    }
+    return circuit_costs;
+  }
+}
+
+cost_t cost_tracker::gate_cost( unsigned pos ) const
+{
+  assert( kind == cost_kind::per_gate || kind == cost_kind::gate_count );
+  return cached[pos];
+}
+
+cost_t cost_tracker::window_costs( unsigned from, unsigned to ) const
+{
+  switch ( kind )
+  {
+  case cost_kind::per_gate:
+  case cost_kind::gate_count:
+    return std::accumulate( cached.begin() + from, cached.begin() + to, 0ull );
+
+  case cost_kind::line_count:
+    return circ.lines();
+
+  case cost_kind::whole_circuit:
+  default:
+    return costs( subcircuit( circ, from, to ), f );
+  }
+}
+
+long long cost_tracker::replacement_delta( unsigned from, unsigned to, const circuit& replacement ) const
+{
+  switch ( kind )
+  {
+  case cost_kind::per_gate:
+  case cost_kind::gate_count:
+    {
+      /* costs do not depend on which lines are used, the replacement
+       * gates are evaluated as if they were part of the circuit */
+      cost_t new_costs = 0ull;
+      for ( const auto& g : replacement )
+      {
+        new_costs += evaluate( g );
+      }
+      return static_cast<long long>( new_costs ) - static_cast<long long>( window_costs( from, to ) );
+    }
+
+  case cost_kind::line_count:
+    return 0ll;
+
+  case cost_kind::whole_circuit:
+  default:
+    return static_cast<long long>( costs( replacement, f ) ) - static_cast<long long>( window_costs( from, to ) );
+  }
+}
+
+gate& cost_tracker::insert_gate( unsigned pos, const gate& g )
+{
+  auto& new_gate = circ.insert_gate( pos );
+  new_gate = g;
+
+  cached.insert( cached.begin() + pos, 0ull );
+  sum += cache( pos );
+  dirty = true;
+
+  return new_gate;
+}
+
+void cost_tracker::remove_gate_at( unsigned pos )
+{
+  circ.remove_gate_at( pos );
+
+  sum -= cached[pos];
+  cached.erase( cached.begin() + pos );
+  dirty = true;
+}
+
+void cost_tracker::replace_gate( unsigned pos, const gate& g )
+{
+  circ[pos] = g;
+  update( pos );
+}
+
+void cost_tracker::replace_window( unsigned from, unsigned to, const circuit& replacement, const std::vector<unsigned>& filter )
+{
+  for ( auto pos = from; pos < to; ++pos )
+  {
+    circ.remove_gate_at( from );
+  }
+
+  circuit expanded;
+  expand_circuit( replacement, expanded, circ.lines(), filter );
+  insert_circuit( circ, from, expanded );
+
+  sum -= std::accumulate( cached.begin() + from, cached.begin() + to, 0ull );
+  cached.erase( cached.begin() + from, cached.begin() + to );
+  cached.insert( cached.begin() + from, expanded.num_gates(), 0ull );
+  for ( auto pos = from; pos < from + expanded.num_gates(); ++pos )
+  {
+    sum += cache( pos );
+  }
+  dirty = true;
+}
+
+void cost_tracker::update( unsigned pos )
+{
+  sum -= cached[pos];
+  sum += cache( pos );
+  dirty = true;
+}
+
+void cost_tracker::refresh()
+{
+  cached.assign( circ.num_gates(), 0ull );
+  sum = 0ull;
+
+  for ( auto pos = 0u; pos < circ.num_gates(); ++pos )
+  {
+    sum += cache( pos );
+  }
+  dirty = true;
+}
+
+/******************************************************************************
+ * Private functions                                                          *
+ ******************************************************************************/
+
+cost_t cost_tracker::evaluate( const gate& g ) const
+{
+  switch ( kind )
+  {
+  case cost_kind::per_gate:
+    return costs( g, circ.lines(), gate_func );
+
+  case cost_kind::gate_count:
+    /* as gate_costs, a module gate counts as one gate */
+    return 1ull;
+
+  case cost_kind::line_count:
+  case cost_kind::whole_circuit:
+  default:
+    return 0ull;
+  }
+}
+
+cost_t cost_tracker::cache( unsigned pos )
+{
+  if ( kind == cost_kind::per_gate || kind == cost_kind::gate_count )
+  {
+    ++evaluations;
+  }
+  return cached[pos] = evaluate( circ[pos] );
+}
+
+}
+
+// Local Variables:
+// c-basic-offset: 2
+// eval: (c-set-offset 'substatement-open 0)
+// eval: (c-set-offset 'innamespace 0)
+// End:
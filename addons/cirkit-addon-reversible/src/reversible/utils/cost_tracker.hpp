@@ -0,0 +1,123 @@
+/* CirKit: A circuit toolkit
+ * Copyright (C) 2009-2015  University of Bremen
+ * Copyright (C) 2015-2016  EPFL
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file cost_tracker.hpp
+ *
+ * @brief Incremental costs of a circuit under local changes
+ *
+ * The tracker is attached to a circuit and caches the costs of each gate.
+ * Gates are inserted, removed, and replaced through the tracker such that
+ * the total costs are updated from the changed gates only.  The costs of
+ * replacing a window can be evaluated without changing or copying the
+ * circuit.
+ *
+ * @author Mathias Soeken
+ * @since  2.3
+ */
+
+#ifndef COST_TRACKER_HPP
+#define COST_TRACKER_HPP
+
+#include <vector>
+
+#include <reversible/circuit.hpp>
+#include <reversible/utils/costs.hpp>
+
+namespace cirkit
+{
+
+/**
+ * @brief Caches the costs of each gate of a circuit
+ *
+ * Gate-based cost functions are evaluated once per gate.  gate_costs and
+ * line_costs are recognized and tracked in the same way, where a module
+ * gate counts as one gate as in costs() of a sub-circuit (costs() of a
+ * circuit with modules flattens it first).  For other
+ * circuit-based cost functions the total is re-computed on demand and
+ * replacement_delta compares the cost of the old and the new window.
+ *
+ * Changes to the circuit that bypass the tracker must be announced with
+ * update() or refresh().
+ *
+ * @since  2.3
+ */
+class cost_tracker
+{
+public:
+  cost_tracker( circuit& circ, const cost_function& f );
+
+  /* costs of the whole circuit */
+  cost_t total() const;
+
+  /* costs of the gate at pos, resp. of the gates in [from, to) */
+  cost_t gate_cost( unsigned pos ) const;
+  cost_t window_costs( unsigned from, unsigned to ) const;
+
+  /* change of the total costs if the gates in [from, to) were replaced by
+   * the gates of replacement, neither circuit is changed; safe to call
+   * concurrently as long as the circuit is not modified */
+  long long replacement_delta( unsigned from, unsigned to, const circuit& replacement ) const;
+
+  /* modifications */
+  gate& insert_gate( unsigned pos, const gate& g );
+  void remove_gate_at( unsigned pos );
+  void replace_gate( unsigned pos, const gate& g );
+
+  /* replaces the gates in [from, to) by replacement, whose lines are mapped
+   * to the circuit by filter as in expand_circuit */
+  void replace_window( unsigned from, unsigned to, const circuit& replacement, const std::vector<unsigned>& filter = std::vector<unsigned>() );
+
+  /* the gate at pos has been changed directly */
+  void update( unsigned pos );
+
+  /* the circuit has been changed directly */
+  void refresh();
+
+  /* number of evaluated gates, to compare against full cost calculations */
+  inline unsigned long long num_evaluations() const { return evaluations; }
+
+private:
+  enum class cost_kind { per_gate, gate_count, line_count, whole_circuit };
+
+  cost_t evaluate( const gate& g ) const;
+  cost_t cache( unsigned pos );
+
+  circuit&            circ;
+  cost_function       f;
+  costs_by_gate_func  gate_func;
+  cost_kind           kind;
+
+  std::vector<cost_t> cached;
+  cost_t              sum = 0ull;
+
+  mutable bool        dirty = true;
+  mutable cost_t      circuit_costs = 0ull;
+
+  unsigned long long  evaluations = 0ull;
+};
+
+}
+
+#endif
+
+// Local Variables:
+// c-basic-offset: 2
+// eval: (c-set-offset 'substatement-open 0)
+// eval: (c-set-offset 'innamespace 0)
+// End:
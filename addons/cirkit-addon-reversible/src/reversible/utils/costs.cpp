@@ -147,15 +147,7 @@ namespace cirkit
       cost_t sum = 0ull;
       for ( const auto& g : circ )
       {
-        // respect modules
-        if ( is_module( g ) )
-        {
-          sum += costs( *boost::any_cast<module_tag>( g.type() ).reference.get(), f );
-        }
-        else
-        {
-          ( circ.lines() == g.controls().size() + 1 ) ? sum += f( g, circ.lines() + 1 ) : sum += f( g, circ.lines() ) ;
-        }
+        sum += costs( g, circ.lines(), f );
       }
       return sum;
     }
@@ -169,6 +161,19 @@ namespace cirkit
     return boost::apply_visitor( costs_visitor( circ ), f );
   }
 
+  cost_t costs( const gate& g, unsigned lines, const costs_by_gate_func& f )
+  {
+    // respect modules
+    if ( is_module( g ) )
+    {
+      return costs( *boost::any_cast<module_tag>( g.type() ).reference.get(), f );
+    }
+    else
+    {
+      return ( lines == g.controls().size() + 1 ) ? f( g, lines + 1 ) : f( g, lines );
+    }
+  }
+
 }
 
 // Local Variables:
@@ -245,6 +245,23 @@ namespace cirkit
    */
   cost_t costs( const circuit& circ, const cost_function& f );
 
+  /**
+   * @brief Calculates the costs of a single gate
+   *
+   * Costs of gate \p g in a circuit with \p lines lines, as
+   * they are summed up by costs(const circuit&, const cost_function&).
+   * Module gates are evaluated by the costs of their reference.
+   *
+   * @param g Gate
+   * @param lines Number of lines in the circuit that contains \p g
+   * @param f Cost function
+   *
+   * @return The costs for the gate
+   *
+   * @since  2.3
+   */
+  cost_t costs( const gate& g, unsigned lines, const costs_by_gate_func& f );
+
 }
 
 #endif /* COSTS_HPP */
@@ -28,7 +28,6 @@
 
 #include <core/utils/range_utils.hpp>
 #include <reversible/functions/circuit_to_truth_table.hpp>
-#include <reversible/simulation/simple_simulation.hpp>
 
 using namespace boost::assign;
 using boost::adaptors::transformed;
@@ -54,9 +53,7 @@ permutation_t truth_table_to_permutation( const binary_truth_table& spec )
 
 permutation_t circuit_to_permutation( const circuit& circ )
 {
-  binary_truth_table spec;
-  circuit_to_truth_table( circ, spec, simple_simulation_func() );
-  return truth_table_to_permutation( spec );
+  return circuit_to_dense_permutation( circ );
 }
 
 cycles_t permutation_to_cycles( const permutation_t& perm, bool sort )
@@ -86,6 +86,36 @@ bitset_pair_vector_t truth_table_to_bitset_pair_vector( const binary_truth_table
   return vec;
 }
 
+bitset_vector_t truth_table_to_bitset_vector( const dense_truth_table& spec )
+{
+  assert( spec.is_fully_specified() && spec.words_per_row() == 1u );
+
+  bitset_vector_t vec;
+  vec.reserve( spec.num_rows() );
+
+  for ( std::uint64_t row = 0u; row < spec.num_rows(); ++row )
+  {
+    vec += boost::dynamic_bitset<>( spec.num_inputs(), spec.output_word( row ) );
+  }
+
+  return vec;
+}
+
+bitset_pair_vector_t truth_table_to_bitset_pair_vector( const dense_truth_table& spec )
+{
+  assert( spec.is_fully_specified() && spec.words_per_row() == 1u );
+
+  bitset_pair_vector_t vec;
+  vec.reserve( spec.num_rows() );
+
+  for ( std::uint64_t row = 0u; row < spec.num_rows(); ++row )
+  {
+    vec += std::make_pair( boost::dynamic_bitset<>( spec.num_inputs(), row ), boost::dynamic_bitset<>( spec.num_inputs(), spec.output_word( row ) ) );
+  }
+
+  return vec;
+}
+
 }
 
 // Local Variables:
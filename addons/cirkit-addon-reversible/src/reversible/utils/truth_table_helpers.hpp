@@ -32,6 +32,7 @@
 
 #include <boost/dynamic_bitset.hpp>
 
+#include <reversible/dense_truth_table.hpp>
 #include <reversible/truth_table.hpp>
 
 namespace cirkit
@@ -49,6 +50,11 @@ bitset_vector_t truth_table_to_bitset_vector( const binary_truth_table& spec );
 
 bitset_pair_vector_t truth_table_to_bitset_pair_vector( const binary_truth_table& spec );
 
+/* dense versions, require a fully specified function */
+bitset_vector_t truth_table_to_bitset_vector( const dense_truth_table& spec );
+
+bitset_pair_vector_t truth_table_to_bitset_pair_vector( const dense_truth_table& spec );
+
 }
 
 #endif
@@ -0,0 +1,190 @@
+/* CirKit: A circuit toolkit
+ * Copyright (C) 2009-2015  University of Bremen
+ * Copyright (C) 2015-2016  EPFL
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "batch_equivalence_check.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <random>
+
+#include <core/utils/thread_pool.hpp>
+#include <core/utils/timer.hpp>
+#include <reversible/simulation/compiled_simulation.hpp>
+#include <reversible/verification/xorsat_equivalence_check.hpp>
+
+namespace cirkit
+{
+
+/******************************************************************************
+ * Private functions                                                          *
+ ******************************************************************************/
+
+/* runs worker on num_threads threads, the workers take their work from a
+ * shared counter; exceptions of the workers are passed to the caller */
+void run_batch_workers( unsigned num_threads, const std::function<void()>& worker )
+{
+  if ( num_threads < 2u )
+  {
+    worker();
+    return;
+  }
+
+  std::vector<std::future<void>> futures;
+  {
+    thread_pool pool( num_threads );
+    for ( auto i = 0u; i < num_threads; ++i )
+    {
+      futures.push_back( pool.enqueue( worker ) );
+    }
+  }
+
+  for ( auto& f : futures )
+  {
+    f.get();
+  }
+}
+
+inline double batch_wall_seconds( const boost::timer::cpu_timer& t )
+{
+  return t.elapsed().wall / 1000000000.0;
+}
+
+/******************************************************************************
+ * Public functions                                                           *
+ ******************************************************************************/
+
+std::vector<batch_equivalence_result> batch_equivalence_check( const circuit& reference, const std::vector<circuit>& candidates,
+                                                               const properties::ptr& settings,
+                                                               const properties::ptr& statistics )
+{
+  /* settings */
+  const auto sim_words   = get( settings, "sim_words",   16u );
+  const auto seed        = get( settings, "seed",        0u );
+  const auto num_threads = get( settings, "num_threads", 1u );
+
+  /* timing */
+  properties_timer t( statistics );
+
+  std::vector<batch_equivalence_result> results( candidates.size() );
+
+  /* simulation, the reference is simulated once */
+  std::vector<unsigned> survivors;
+  auto mismatches = 0u;
+  {
+    properties_timer t( statistics, "sim_runtime" );
+
+    std::vector<std::uint64_t> patterns( reference.lines() * sim_words );
+    std::mt19937_64 generator( seed );
+    for ( auto& w : patterns )
+    {
+      w = generator();
+    }
+
+    auto expected = patterns;
+    if ( sim_words )
+    {
+      compiled_circuit( reference ).simulate( expected.data(), sim_words );
+    }
+
+    std::atomic<unsigned> next( 0u );
+    run_batch_workers( num_threads, [&]() {
+        std::vector<std::uint64_t> values;
+        unsigned i;
+        while ( ( i = next++ ) < candidates.size() )
+        {
+          boost::timer::cpu_timer ct;
+
+          if ( candidates[i].lines() != reference.lines() )
+          {
+            results[i].status = batch_equivalence_status::different_lines;
+          }
+          else if ( sim_words )
+          {
+            values = patterns;
+            compiled_circuit( candidates[i] ).simulate( values.data(), sim_words );
+            if ( values != expected )
+            {
+              results[i].status = batch_equivalence_status::simulation_mismatch;
+            }
+          }
+
+          results[i].runtime += batch_wall_seconds( ct );
+        }
+      } );
+
+    for ( auto i = 0u; i < candidates.size(); ++i )
+    {
+      if ( results[i].status == batch_equivalence_status::unchecked )
+      {
+        survivors.push_back( i );
+      }
+      else if ( results[i].status == batch_equivalence_status::simulation_mismatch )
+      {
+        ++mismatches;
+      }
+    }
+  }
+
+  /* proofs, each thread encodes the reference once */
+  std::atomic<unsigned> sat_calls( 0u );
+  {
+    properties_timer t( statistics, "proof_runtime" );
+
+    std::atomic<unsigned> next( 0u );
+    run_batch_workers( std::min<unsigned>( num_threads, survivors.size() ), [&]() {
+        std::unique_ptr<xorsat_equivalence_checker> checker;
+        unsigned i;
+        while ( ( i = next++ ) < survivors.size() )
+        {
+          boost::timer::cpu_timer ct;
+
+          if ( !checker )
+          {
+            checker.reset( new xorsat_equivalence_checker( reference ) );
+          }
+
+          auto& result = results[survivors[i]];
+          result.status = checker->check( candidates[survivors[i]] ) ? batch_equivalence_status::equivalent : batch_equivalence_status::not_equivalent;
+
+          result.runtime += batch_wall_seconds( ct );
+        }
+
+        if ( checker )
+        {
+          sat_calls += checker->num_sat_calls();
+        }
+      } );
+  }
+
+  set( statistics, "simulation_mismatches", mismatches );
+  set( statistics, "sat_calls", sat_calls.load() );
+
+  return results;
+}
+
+}
+
+// Local Variables:
+// c-basic-offset: 2
+// eval: (c-set-offset 'substatement-open 0)
+// eval: (c-set-offset 'innamespace 0)
+// End:
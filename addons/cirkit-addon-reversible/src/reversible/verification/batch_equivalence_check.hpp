@@ -0,0 +1,93 @@
+/* CirKit: A circuit toolkit
+ * Copyright (C) 2009-2015  University of Bremen
+ * Copyright (C) 2015-2016  EPFL
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file batch_equivalence_check.hpp
+ *
+ * @brief Equivalence check of many circuits against one reference
+ *
+ * The reference is simulated once on random patterns with the bit-sliced
+ * compiled simulation, and every candidate is compared to these values
+ * first.  Candidates that survive the simulation are proven with the XOR
+ * SAT equivalence checker, where each thread encodes the reference once
+ * and checks all its candidates incrementally.
+ *
+ * @author Mathias Soeken
+ * @since  2.3
+ */
+
+#ifndef BATCH_EQUIVALENCE_CHECK_HPP
+#define BATCH_EQUIVALENCE_CHECK_HPP
+
+#include <vector>
+
+#include <core/properties.hpp>
+#include <reversible/circuit.hpp>
+
+namespace cirkit
+{
+
+enum class batch_equivalence_status
+{
+  unchecked,
+  equivalent,
+  not_equivalent,        /* proven by the SAT solver (or by elimination) */
+  simulation_mismatch,   /* refuted by random simulation */
+  different_lines
+};
+
+struct batch_equivalence_result
+{
+  batch_equivalence_status status  = batch_equivalence_status::unchecked;
+  double                   runtime = 0.0; /* simulation and proof, in wall seconds */
+
+  inline bool equivalent() const { return status == batch_equivalence_status::equivalent; }
+};
+
+/**
+ * @brief Checks each candidate for equivalence to reference
+ *
+ * Circuits may only contain Toffoli, Fredkin, and Peres gates.  The result
+ * for candidate i is at position i and does not depend on the number of
+ * threads.  Exceptions thrown while checking a candidate are passed to the
+ * caller.
+ *
+ * Settings:
+ *   sim_words   (unsigned) : 64-bit words of random patterns per line, 0
+ *                            disables the simulation (default: 16u)
+ *   seed        (unsigned) : seed for the random patterns (default: 0u)
+ *   num_threads (unsigned) : threads for simulation and proofs (default: 1u)
+ *
+ * Statistics:
+ *   runtime, sim_runtime, proof_runtime, simulation_mismatches, sat_calls
+ *
+ * @since  2.3
+ */
+std::vector<batch_equivalence_result> batch_equivalence_check( const circuit& reference, const std::vector<circuit>& candidates,
+                                                               const properties::ptr& settings = properties::ptr(),
+                                                               const properties::ptr& statistics = properties::ptr() );
+
+}
+
+#endif
+
+// Local Variables:
+// c-basic-offset: 2
+// eval: (c-set-offset 'substatement-open 0)
+// eval: (c-set-offset 'innamespace 0)
+// End:
@@ -18,13 +18,19 @@
 
 #include "xorsat_equivalence_check.hpp"
 
+#include <algorithm>
+#include <cassert>
 #include <fstream>
+#include <iterator>
+#include <map>
 
 #include <boost/format.hpp>
 #include <boost/range/algorithm_ext/iota.hpp>
 
 #include <core/utils/system_utils.hpp>
 #include <core/utils/timer.hpp>
+#include <formal/sat/minisat.hpp>
+#include <formal/sat/operations/logic.hpp>
 #include <reversible/target_tags.hpp>
 #include <reversible/functions/add_circuit.hpp>
 #include <reversible/functions/reverse_circuit.hpp>
@@ -36,6 +42,281 @@ namespace cirkit
  * Types                                                                      *
  ******************************************************************************/
 
+/* XOR of SAT variables (sorted) and a constant */
+struct xor_sum
+{
+  std::vector<int> vars;
+  bool             constant = false;
+
+  xor_sum() {}
+  xor_sum( int var ) : vars( 1u, var ) {}
+
+  xor_sum& operator^=( const xor_sum& other )
+  {
+    std::vector<int> result;
+    std::set_symmetric_difference( vars.begin(), vars.end(), other.vars.begin(), other.vars.end(), std::back_inserter( result ) );
+    vars.swap( result );
+    constant ^= other.constant;
+    return *this;
+  }
+
+  inline bool is_constant() const { return vars.empty(); }
+};
+
+/* 0 is the constant false */
+inline xor_sum literal_to_sum( int lit )
+{
+  xor_sum sum;
+  if ( lit != 0 )
+  {
+    sum.vars.push_back( abs( lit ) );
+    sum.constant = lit < 0;
+  }
+  return sum;
+}
+
+class xorsat_equivalence_checker::priv
+{
+public:
+  explicit priv( unsigned lines )
+    : lines( lines ),
+      solver( make_solver<minisat_solver>() ),
+      next_var( lines + 1 )
+  {
+    solver_gen_model( solver, false );
+  }
+
+  std::vector<xor_sum> lower( const circuit& circ );
+  bool check( std::vector<xor_sum> values, const std::vector<xor_sum>& values2, const properties::ptr& statistics );
+
+private:
+  int literal( const xor_sum& sum );
+  int and_literal( std::vector<int> lits );
+  bool active_literals( const gate& g, const std::vector<xor_sum>& values, std::vector<int>& lits, xor_sum& single );
+
+public:
+  unsigned                        lines;
+  minisat_solver                  solver;
+  int                             next_var;
+
+  /* hashed encodings, kept across checks */
+  std::map<std::vector<int>, int> xor_hash;
+  std::map<std::vector<int>, int> and_hash;
+
+  /* lowered reference, if given */
+  bool                            has_reference = false;
+  std::vector<xor_sum>            reference;
+
+  unsigned                        num_checks = 0u;
+  unsigned                        num_sat_calls = 0u;
+};
+
+/* returns a literal that is equal to the XOR sum, requires non-constant sums */
+int xorsat_equivalence_checker::priv::literal( const xor_sum& sum )
+{
+  assert( !sum.is_constant() );
+
+  auto lit = sum.vars.front();
+  std::vector<int> prefix( 1u, lit );
+
+  for ( auto i = 1u; i < sum.vars.size(); ++i )
+  {
+    prefix.push_back( sum.vars[i] );
+
+    const auto it = xor_hash.find( prefix );
+    if ( it != xor_hash.end() )
+    {
+      lit = it->second;
+    }
+    else
+    {
+      const auto v = next_var++;
+      logic_xor( solver, lit, sum.vars[i], v );
+      xor_hash.insert( {prefix, v} );
+      lit = v;
+    }
+  }
+
+  return sum.constant ? -lit : lit;
+}
+
+/* returns a literal that is equal to the AND of lits, 0 if it is constant false */
+int xorsat_equivalence_checker::priv::and_literal( std::vector<int> lits )
+{
+  std::sort( lits.begin(), lits.end(), []( int a, int b ) { return abs( a ) < abs( b ) || ( abs( a ) == abs( b ) && a < b ); } );
+  lits.erase( std::unique( lits.begin(), lits.end() ), lits.end() );
+
+  for ( auto i = 1u; i < lits.size(); ++i )
+  {
+    if ( lits[i - 1u] == -lits[i] ) { return 0; }
+  }
+
+  if ( lits.size() == 1u ) { return lits.front(); }
+
+  const auto it = and_hash.find( lits );
+  if ( it != and_hash.end() )
+  {
+    return it->second;
+  }
+
+  const auto v = next_var++;
+  logic_and( solver, lits, v );
+  and_hash.insert( {lits, v} );
+  return v;
+}
+
+/* collects the literals of the non-constant controls of g, returns false if
+ * g is never active; if there is exactly one such control, its sum is stored
+ * in single such that the gate remains linear */
+bool xorsat_equivalence_checker::priv::active_literals( const gate& g, const std::vector<xor_sum>& values, std::vector<int>& lits, xor_sum& single )
+{
+  std::vector<xor_sum> sums;
+
+  for ( const auto& c : g.controls() )
+  {
+    auto sum = values[c.line()];
+    sum.constant ^= !c.polarity();
+
+    if ( sum.is_constant() )
+    {
+      if ( !sum.constant ) { return false; }
+    }
+    else
+    {
+      sums.push_back( sum );
+    }
+  }
+
+  if ( sums.size() == 1u )
+  {
+    single = sums.front();
+  }
+  else if ( sums.empty() )
+  {
+    single = xor_sum();
+    single.constant = true;
+  }
+  else
+  {
+    for ( const auto& sum : sums )
+    {
+      lits.push_back( literal( sum ) );
+    }
+  }
+
+  return true;
+}
+
+/* symbolic simulation, the value of each line is an XOR sum over the inputs
+ * and the AND outputs */
+std::vector<xor_sum> xorsat_equivalence_checker::priv::lower( const circuit& circ )
+{
+  std::vector<xor_sum> values;
+  for ( auto i = 1u; i <= lines; ++i )
+  {
+    values.push_back( xor_sum( i ) );
+  }
+
+  for ( const auto& g : circ )
+  {
+    std::vector<int> lits;
+    xor_sum active;
+
+    if ( !active_literals( g, values, lits, active ) ) { continue; }
+
+    /* returns the AND of the gate activation and sum, if lits is empty, the
+     * activation is given by the XOR sum active */
+    const auto and_with = [&]( const xor_sum& sum ) -> xor_sum {
+      if ( lits.empty() && active.is_constant() ) { return sum; }
+      if ( sum.is_constant() && !sum.constant ) { return sum; }
+      if ( sum.is_constant() && lits.empty() ) { return active; }
+
+      auto all = lits;
+      if ( all.empty() ) { all.push_back( literal( active ) ); }
+      if ( !sum.is_constant() ) { all.push_back( literal( sum ) ); }
+      return literal_to_sum( and_literal( all ) );
+    };
+
+    xor_sum one;
+    one.constant = true;
+
+    if ( is_toffoli( g ) )
+    {
+      values[g.targets().front()] ^= and_with( one );
+    }
+    else if ( is_fredkin( g ) )
+    {
+      const auto t1 = g.targets()[0u];
+      const auto t2 = g.targets()[1u];
+
+      auto diff = values[t1];
+      diff ^= values[t2];
+      diff = and_with( diff );
+
+      values[t1] ^= diff;
+      values[t2] ^= diff;
+    }
+    else if ( is_peres( g ) )
+    {
+      const auto t1 = g.targets()[0u];
+      const auto t2 = g.targets()[1u];
+
+      values[t2] ^= and_with( values[t1] );
+      values[t1] ^= and_with( one );
+    }
+    else
+    {
+      assert( false );
+    }
+  }
+
+  return values;
+}
+
+bool xorsat_equivalence_checker::priv::check( std::vector<xor_sum> values, const std::vector<xor_sum>& values2, const properties::ptr& statistics )
+{
+  ++num_checks;
+
+  std::vector<int> diffs;
+  auto result = true;
+  for ( auto i = 0u; i < lines; ++i )
+  {
+    values[i] ^= values2[i];
+
+    if ( values[i].is_constant() )
+    {
+      if ( values[i].constant ) { result = false; break; }
+    }
+    else
+    {
+      diffs.push_back( literal( values[i] ) );
+    }
+  }
+
+  set( statistics, "solved_by_elimination", !result || diffs.empty() );
+
+  if ( !result || diffs.empty() )
+  {
+    return result;
+  }
+
+  /* miter output, activated by a fresh variable and retired afterwards */
+  const auto act = next_var++;
+  diffs.insert( diffs.begin(), -act );
+  add_clause( solver )( diffs );
+
+  ++num_sat_calls;
+  solver_execution_statistics sat_stats;
+  result = !solve( solver, sat_stats, {act} );
+  add_clause( solver )( {-act} );
+
+  set( statistics, "sat_runtime", sat_stats.runtime );
+  set( statistics, "sat_vars", sat_stats.num_vars );
+  set( statistics, "sat_clauses", sat_stats.num_clauses );
+
+  return result;
+}
+
 /******************************************************************************
  * Private functions                                                          *
  ******************************************************************************/
@@ -124,6 +405,76 @@ bool solve_identity_miter( const std::string& filename )
   }
 }
 
+/******************************************************************************
+ * xorsat_equivalence_checker                                                 *
+ ******************************************************************************/
+
+xorsat_equivalence_checker::xorsat_equivalence_checker( unsigned lines )
+  : d( std::make_shared<priv>( lines ) )
+{
+}
+
+xorsat_equivalence_checker::xorsat_equivalence_checker( const circuit& reference )
+  : d( std::make_shared<priv>( reference.lines() ) )
+{
+  d->reference     = d->lower( reference );
+  d->has_reference = true;
+}
+
+bool xorsat_equivalence_checker::check( const circuit& circ1, const circuit& circ2,
+                                        const properties::ptr& statistics )
+{
+  assert( circ1.lines() == d->lines && circ2.lines() == d->lines );
+
+  properties_timer t( statistics );
+
+  const auto and_before = d->and_hash.size();
+  const auto xor_before = d->xor_hash.size();
+
+  const auto values1 = d->lower( circ1 );
+  const auto values2 = d->lower( circ2 );
+  const auto result = d->check( values1, values2, statistics );
+
+  set( statistics, "and_gates", static_cast<unsigned>( d->and_hash.size() - and_before ) );
+  set( statistics, "xor_sums", static_cast<unsigned>( d->xor_hash.size() - xor_before ) );
+
+  return result;
+}
+
+bool xorsat_equivalence_checker::check( const circuit& circ,
+                                        const properties::ptr& statistics )
+{
+  assert( d->has_reference && circ.lines() == d->lines );
+
+  properties_timer t( statistics );
+
+  const auto and_before = d->and_hash.size();
+  const auto xor_before = d->xor_hash.size();
+
+  const auto values = d->lower( circ );
+  const auto result = d->check( d->reference, values, statistics );
+
+  set( statistics, "and_gates", static_cast<unsigned>( d->and_hash.size() - and_before ) );
+  set( statistics, "xor_sums", static_cast<unsigned>( d->xor_hash.size() - xor_before ) );
+
+  return result;
+}
+
+unsigned xorsat_equivalence_checker::lines() const
+{
+  return d->lines;
+}
+
+unsigned xorsat_equivalence_checker::num_checks() const
+{
+  return d->num_checks;
+}
+
+unsigned xorsat_equivalence_checker::num_sat_calls() const
+{
+  return d->num_sat_calls;
+}
+
 /******************************************************************************
  * Public functions                                                           *
  ******************************************************************************/
@@ -133,11 +484,8 @@ bool xorsat_equivalence_check( const circuit& circ1, const circuit& circ2,
                                const properties::ptr& statistics )
 {
   /* settings */
-  const auto tmpname = get( settings, "tmpname", std::string( "/tmp/test.cnf" ) );
-  const auto verbose = get( settings, "verbose", false );
-
-  /* timing */
-  properties_timer t( statistics );
+  const auto external = get( settings, "external", false );
+  const auto tmpname  = get( settings, "tmpname", std::string( "/tmp/test.cnf" ) );
 
   if ( circ1.lines() != circ2.lines() )
   {
@@ -145,6 +493,14 @@ bool xorsat_equivalence_check( const circuit& circ1, const circuit& circ2,
     return false;
   }
 
+  if ( !external )
+  {
+    return xorsat_equivalence_checker( circ1.lines() ).check( circ1, circ2, statistics );
+  }
+
+  /* timing */
+  properties_timer t( statistics );
+
   const auto id_circ = create_identity_miter( circ1, circ2 );
 
   write_to_dimacs( id_circ, tmpname );
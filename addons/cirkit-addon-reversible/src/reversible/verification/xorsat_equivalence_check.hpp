@@ -23,6 +23,14 @@
  *
  * Based on [L.G. Amaru, P.-E. Gaillardon, R. Wille, and G. De Micheli, DATE 2016]
  *
+ * Both circuits are lowered into a miter with shared inputs.  The linear
+ * part of the circuits (NOT and CNOT gates, and targets of all gates) is
+ * kept as XOR equations over the inputs and the AND outputs of gates with
+ * more than one control, and eliminated by substitution (Gaussian
+ * elimination on a triangular system).  Only the remaining AND gates and
+ * XOR sums that are used as controls or outputs are encoded as clauses and
+ * solved with an embedded CDCL solver.
+ *
  * @author Mathias Soeken
  * @since  2.3
  */
@@ -30,12 +38,63 @@
 #ifndef XORSAT_EQUIVALENCE_CHECK_HPP
 #define XORSAT_EQUIVALENCE_CHECK_HPP
 
+#include <memory>
+
 #include <core/properties.hpp>
 #include <reversible/circuit.hpp>
 
 namespace cirkit
 {
 
+/**
+ * @brief Incremental equivalence checker for circuits on the same lines
+ *
+ * One solver instance is kept for all checks.  The inputs are shared, and
+ * the encodings of AND gates and XOR sums are hashed and kept in the
+ * solver, such that subsequent checks reuse variables, clauses, and learnt
+ * clauses, e.g., when many circuits are compared to the same reference.
+ * Only the miter output clause is activated per check.
+ */
+class xorsat_equivalence_checker
+{
+public:
+  explicit xorsat_equivalence_checker( unsigned lines );
+
+  /* the reference is encoded once and used by check( circ ) */
+  explicit xorsat_equivalence_checker( const circuit& reference );
+
+  /* circuits may only contain Toffoli, Fredkin, and Peres gates
+   *
+   * Statistics:
+   *   runtime, sat_runtime, solved_by_elimination, and_gates, xor_sums, sat_vars, sat_clauses
+   */
+  bool check( const circuit& circ1, const circuit& circ2,
+              const properties::ptr& statistics = properties::ptr() );
+
+  /* compares against the reference of the constructor */
+  bool check( const circuit& circ,
+              const properties::ptr& statistics = properties::ptr() );
+
+  unsigned lines() const;
+  unsigned num_checks() const;
+  unsigned num_sat_calls() const;
+
+private:
+  class priv;
+  std::shared_ptr<priv> d;
+};
+
+/**
+ * @brief Equivalence check using XOR SAT
+ *
+ * Settings:
+ *   external (bool)        : write the miter to a DIMACS file with XOR clauses and
+ *                            call cryptominisat4 instead of the embedded solver (default: false)
+ *   tmpname  (std::string) : filename for the external solver (default: /tmp/test.cnf)
+ *
+ * Statistics:
+ *   runtime, and the statistics of xorsat_equivalence_checker::check
+ */
 bool xorsat_equivalence_check( const circuit& circ1, const circuit& circ2,
                                const properties::ptr& settings = properties::ptr(),
                                const properties::ptr& statistics = properties::ptr() );
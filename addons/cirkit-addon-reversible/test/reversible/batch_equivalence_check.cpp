@@ -0,0 +1,115 @@
+/* CirKit: A circuit toolkit
+ * Copyright (C) 2009-2015  University of Bremen
+ * Copyright (C) 2015-2016  EPFL
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE batch_equivalence_check
+
+#include <random>
+
+#include <boost/test/included/unit_test.hpp>
+
+#include <reversible/circuit.hpp>
+#include <reversible/functions/circuit_to_truth_table.hpp>
+#include <reversible/functions/create_random_circuit.hpp>
+#include <reversible/verification/batch_equivalence_check.hpp>
+#include <reversible/verification/xorsat_equivalence_check.hpp>
+
+using namespace cirkit;
+
+BOOST_AUTO_TEST_CASE(reference_checker)
+{
+  std::default_random_engine generator( 42u );
+
+  circuit reference( 5u );
+  for ( auto i = 0u; i < 15u; ++i )
+  {
+    create_random_gate( reference.append_gate(), reference.lines(), true, generator, true );
+  }
+  const auto expected = circuit_to_dense_permutation( reference );
+
+  xorsat_equivalence_checker checker( reference );
+
+  for ( auto i = 0u; i < 20u; ++i )
+  {
+    circuit circ = reference;
+    create_random_gate( circ.insert_gate( generator() % ( circ.num_gates() + 1u ) ), circ.lines(), true, generator, true );
+
+    BOOST_CHECK( checker.check( circ ) == ( circuit_to_dense_permutation( circ ) == expected ) );
+  }
+}
+
+BOOST_AUTO_TEST_CASE(batch)
+{
+  std::default_random_engine generator( 42u );
+
+  circuit reference( 6u );
+  for ( auto i = 0u; i < 20u; ++i )
+  {
+    create_random_gate( reference.append_gate(), reference.lines(), true, generator, true );
+  }
+  const auto expected = circuit_to_dense_permutation( reference );
+
+  std::vector<circuit> candidates;
+  for ( auto i = 0u; i < 30u; ++i )
+  {
+    /* a gate and its inverse (Peres gates are not self-inverse) */
+    circuit circ = reference;
+    const auto pos = generator() % ( circ.num_gates() + 1u );
+    create_random_gate( circ.insert_gate( pos ), circ.lines(), true, generator );
+    const auto g = circ[pos];
+    circ.insert_gate( pos ) = g;
+    candidates.push_back( circ );
+
+    /* a single additional gate */
+    create_random_gate( circ.insert_gate( generator() % ( circ.num_gates() + 1u ) ), circ.lines(), true, generator, true );
+    candidates.push_back( circ );
+  }
+  candidates.push_back( circuit( 5u ) );
+
+  for ( auto sim_words : {0u, 16u} )
+  {
+    for ( auto threads : {1u, 4u} )
+    {
+      auto settings = std::make_shared<properties>();
+      settings->set( "sim_words", sim_words );
+      settings->set( "num_threads", threads );
+      auto statistics = std::make_shared<properties>();
+
+      const auto results = batch_equivalence_check( reference, candidates, settings, statistics );
+
+      BOOST_REQUIRE( results.size() == candidates.size() );
+      for ( auto i = 0u; i + 1u < candidates.size(); ++i )
+      {
+        BOOST_CHECK( results[i].status != batch_equivalence_status::unchecked );
+        BOOST_CHECK( results[i].equivalent() == ( circuit_to_dense_permutation( candidates[i] ) == expected ) );
+      }
+      BOOST_CHECK( results.back().status == batch_equivalence_status::different_lines );
+
+      if ( sim_words == 0u )
+      {
+        BOOST_CHECK( statistics->get<unsigned>( "simulation_mismatches" ) == 0u );
+      }
+    }
+  }
+}
+
+// Local Variables:
+// c-basic-offset: 2
+// eval: (c-set-offset 'substatement-open 0)
+// eval: (c-set-offset 'innamespace 0)
+// End:
@@ -23,6 +23,7 @@
 #include <boost/test/included/unit_test.hpp>
 
 #include <reversible/circuit.hpp>
+#include <reversible/flat_circuit.hpp>
 #include <reversible/target_tags.hpp>
 #include <reversible/functions/add_gates.hpp>
 
@@ -63,6 +64,49 @@ BOOST_AUTO_TEST_CASE(simple)
   BOOST_CHECK( i == 4u );
 }
 
+BOOST_AUTO_TEST_CASE(flat)
+{
+  using namespace cirkit;
+
+  flat_circuit fc( 3u );
+  fc.append_toffoli( 3ull, 3ull, 2u );
+  fc.append_toffoli( 1ull, 0ull, 1u );
+  fc.prepend_gate( {flat_gate_kind::toffoli, 0ull, 0ull, 0u, 0u} );
+  fc.insert_fredkin( 2u, 1ull, 1ull, 1u, 2u );
+
+  BOOST_CHECK( fc.num_gates() == 4u );
+  BOOST_CHECK( fc[0u].controls == 0ull && fc[0u].target1 == 0u );
+  BOOST_CHECK( fc[1u].controls == 3ull && fc[1u].target1 == 2u );
+  BOOST_CHECK( fc[2u].kind == flat_gate_kind::fredkin && fc[2u].target2 == 2u );
+  BOOST_CHECK( fc[3u].polarity == 0ull && fc[3u].target1 == 1u );
+
+  /* alternating insertions at the front and in the middle move the gap */
+  for ( auto i = 0u; i < 100u; ++i )
+  {
+    fc.insert_toffoli( ( i % 2u ) ? 0u : fc.num_gates() / 2u, 4ull, 4ull, i % 2u );
+  }
+  BOOST_CHECK( fc.num_gates() == 104u );
+
+  for ( auto pos = 0u; pos < fc.num_gates(); )
+  {
+    if ( fc[pos].controls == 4ull ) { fc.remove_gate_at( pos ); } else { ++pos; }
+  }
+  BOOST_CHECK( fc.num_gates() == 4u );
+
+  /* round trip */
+  circuit circ;
+  fc.to_circuit( circ );
+  BOOST_CHECK( circ.lines() == 3u && circ.num_gates() == 4u );
+  BOOST_CHECK( is_fredkin( circ[2u] ) );
+
+  flat_circuit fc2( circ );
+  BOOST_CHECK( fc2.num_gates() == 4u );
+  for ( auto i = 0u; i < 4u; ++i )
+  {
+    BOOST_CHECK( fc[i] == fc2[i] );
+  }
+}
+
 // Local Variables:
 // c-basic-offset: 2
 // eval: (c-set-offset 'substatement-open 0)
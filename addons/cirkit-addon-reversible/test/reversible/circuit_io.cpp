@@ -22,6 +22,8 @@
 #include <boost/test/included/unit_test.hpp>
 #include <boost/test/output_test_stream.hpp>
 
+#include <sstream>
+
 #include <reversible/circuit.hpp>
 #include <reversible/functions/add_gates.hpp>
 #include <reversible/io/print_circuit.hpp>
@@ -61,6 +63,38 @@ BOOST_AUTO_TEST_CASE(simple)
   write_verilog( circ, "/tmp/test.v" );
 }
 
+BOOST_AUTO_TEST_CASE(mapped_round_trip)
+{
+  using namespace cirkit;
+
+  circuit circ( 5u ), circ2;
+  circ.inputbuses().add( "a", std::vector<unsigned>( { 0u, 1u } ) );
+
+  for ( auto i = 0u; i < 1000u; ++i )
+  {
+    append_toffoli( circ )( make_var( i % 5u, i % 2u ), make_var( ( i + 1u ) % 5u ) )( ( i + 2u ) % 5u );
+    append_fredkin( circ )( make_var( ( i + 3u ) % 5u, false ) )( i % 5u, ( i + 4u ) % 5u );
+    append_peres( circ, make_var( i % 5u ), ( i + 1u ) % 5u, ( i + 2u ) % 5u );
+  }
+
+  write_realization_settings ws;
+  ws.statistics = std::make_shared<properties>();
+  write_realization( circ, "/tmp/test_mapped.real", ws );
+
+  read_realization_settings rs;
+  rs.statistics = std::make_shared<properties>();
+  BOOST_CHECK( read_realization( circ2, "/tmp/test_mapped.real", rs ) );
+  BOOST_CHECK( rs.statistics->get<bool>( "mapped" ) );
+  BOOST_CHECK_EQUAL( rs.statistics->get<unsigned long long>( "bytes" ), ws.statistics->get<unsigned long long>( "bytes" ) );
+  BOOST_CHECK_EQUAL( circ2.num_gates(), circ.num_gates() );
+  BOOST_CHECK_EQUAL( circ2.inputbuses().buses().size(), 1u );
+
+  std::ostringstream os, os2;
+  write_realization( circ, os );
+  write_realization( circ2, os2 );
+  BOOST_CHECK_EQUAL( os.str(), os2.str() );
+}
+
 // Local Variables:
 // c-basic-offset: 2
 // eval: (c-set-offset 'substatement-open 0)
@@ -0,0 +1,104 @@
+/* CirKit: A circuit toolkit
+ * Copyright (C) 2009-2015  University of Bremen
+ * Copyright (C) 2015-2016  EPFL
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE compiled_simulation
+
+#include <random>
+#include <stdexcept>
+
+#include <boost/test/included/unit_test.hpp>
+
+#include <reversible/circuit.hpp>
+#include <reversible/functions/create_random_circuit.hpp>
+#include <reversible/functions/circuit_to_truth_table.hpp>
+#include <reversible/simulation/compiled_simulation.hpp>
+#include <reversible/simulation/simple_simulation.hpp>
+#include <reversible/utils/permutation.hpp>
+
+using namespace cirkit;
+
+BOOST_AUTO_TEST_CASE(simple)
+{
+  std::default_random_engine generator( 42u );
+
+  for ( auto lines : {3u, 5u, 8u, 70u} )
+  {
+    const auto circ = create_random_circuit( lines, 40u, true, generator, true );
+    const compiled_circuit cc( circ );
+
+    std::vector<boost::dynamic_bitset<>> inputs, outputs;
+    for ( auto i = 0u; i < 200u; ++i )
+    {
+      boost::dynamic_bitset<> input( lines );
+      for ( auto l = 0u; l < lines; ++l )
+      {
+        input[l] = ( generator() & 1u ) == 1u;
+      }
+      inputs.push_back( input );
+    }
+
+    compiled_simulation( outputs, circ, inputs );
+
+    for ( auto i = 0u; i < inputs.size(); ++i )
+    {
+      boost::dynamic_bitset<> expected, single;
+      simple_simulation( expected, circ, inputs[i] );
+      compiled_simulation( single, circ, inputs[i] );
+
+      BOOST_CHECK( outputs[i] == expected );
+      BOOST_CHECK( single == expected );
+
+      if ( lines <= 64u )
+      {
+        BOOST_CHECK( cc.simulate( inputs[i].to_ulong() ) == expected.to_ulong() );
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(dense_permutation)
+{
+  std::default_random_engine generator( 42u );
+
+  for ( auto lines = 1u; lines <= 13u; lines += 3u )
+  {
+    const auto circ = create_random_circuit( std::max( lines, 3u ), 30u, true, generator, true );
+
+    binary_truth_table spec;
+    circuit_to_truth_table( circ, spec, simple_simulation_func() );
+    const auto expected = truth_table_to_permutation( spec );
+
+    auto settings = std::make_shared<properties>();
+    BOOST_CHECK( circuit_to_dense_permutation( circ, settings ) == expected );
+
+    settings->set( "num_threads", 4u );
+    BOOST_CHECK( circuit_to_dense_permutation( circ, settings ) == expected );
+  }
+
+  /* too many lines for a permutation of unsigned values */
+  const circuit wide( 33u );
+  binary_truth_table spec;
+  BOOST_CHECK_THROW( circuit_to_dense_permutation( wide ), std::invalid_argument );
+  BOOST_CHECK( !circuit_to_truth_table( wide, spec ) );
+}
+
+// Local Variables:
+// c-basic-offset: 2
+// eval: (c-set-offset 'substatement-open 0)
+// eval: (c-set-offset 'innamespace 0)
+// End:
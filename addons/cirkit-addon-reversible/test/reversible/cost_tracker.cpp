@@ -0,0 +1,105 @@
+/* CirKit: A circuit toolkit
+ * Copyright (C) 2009-2015  University of Bremen
+ * Copyright (C) 2015-2016  EPFL
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE cost_tracker
+
+#include <random>
+
+#include <boost/test/included/unit_test.hpp>
+
+#include <reversible/circuit.hpp>
+#include <reversible/functions/add_gates.hpp>
+#include <reversible/functions/create_random_circuit.hpp>
+#include <reversible/utils/cost_tracker.hpp>
+#include <reversible/utils/costs.hpp>
+
+using namespace cirkit;
+
+BOOST_AUTO_TEST_CASE(incremental_costs)
+{
+  std::default_random_engine generator( 42 );
+
+  const std::vector<cost_function> functions = { costs_by_circuit_func( gate_costs() ),
+                                                 costs_by_circuit_func( line_costs() ),
+                                                 costs_by_gate_func( transistor_costs() ),
+                                                 costs_by_gate_func( sk2013_quantum_costs() ),
+                                                 costs_by_gate_func( ncv_quantum_costs() ) };
+
+  for ( const auto& cf : functions )
+  {
+    auto circ = create_random_circuit( 6u, 50u, true, generator );
+    cost_tracker tracker( circ, cf );
+    BOOST_CHECK_EQUAL( tracker.total(), costs( circ, cf ) );
+
+    for ( auto round = 0u; round < 20u; ++round )
+    {
+      const auto window = create_random_circuit( 6u, round % 4u, true, generator );
+      const auto from   = static_cast<unsigned>( generator() % circ.num_gates() );
+      const auto to     = std::min( from + round % 5u, circ.num_gates() );
+
+      const auto before = tracker.total();
+      const auto delta  = tracker.replacement_delta( from, to, window );
+
+      tracker.replace_window( from, to, window );
+      BOOST_CHECK_EQUAL( tracker.total(), costs( circ, cf ) );
+      BOOST_CHECK_EQUAL( static_cast<long long>( tracker.total() ) - static_cast<long long>( before ), delta );
+
+      tracker.insert_gate( from, window.num_gates() ? window[0u] : circ[0u] );
+      tracker.remove_gate_at( circ.num_gates() - 1u );
+      BOOST_CHECK_EQUAL( tracker.total(), costs( circ, cf ) );
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(module_gates)
+{
+  circuit inner( 2u );
+  append_cnot( inner, 0u, 1u );
+  append_not( inner, 0u );
+  append_cnot( inner, 1u, 0u );
+
+  circuit circ( 3u );
+  circ.add_module( "inner", inner );
+  append_not( circ, 2u );
+  append_module( circ, "inner", gate::control_container(), {0u, 1u} );
+  append_module( circ, "inner", gate::control_container(), {1u, 2u} );
+
+  const cost_function cf = costs_by_circuit_func( gate_costs() );
+  cost_tracker tracker( circ, cf );
+
+  /* module gates count as one gate, as in the sub-circuits compared by window_optimization */
+  BOOST_CHECK_EQUAL( tracker.total(), 3ull );
+  BOOST_CHECK_EQUAL( tracker.window_costs( 0u, 3u ), costs( subcircuit( circ, 0u, 3u ), cf ) );
+  BOOST_CHECK_EQUAL( tracker.window_costs( 1u, 2u ), costs( subcircuit( circ, 1u, 2u ), cf ) );
+
+  /* replacing the module gate by its two gates makes the circuit more expensive */
+  circuit replacement( 3u );
+  append_cnot( replacement, 0u, 1u );
+  append_not( replacement, 0u );
+  BOOST_CHECK_EQUAL( tracker.replacement_delta( 1u, 2u, replacement ), 1ll );
+
+  tracker.replace_window( 1u, 2u, replacement );
+  BOOST_CHECK_EQUAL( tracker.total(), 4ull );
+  BOOST_CHECK_EQUAL( tracker.total(), circ.num_gates() );
+}
+
+// Local Variables:
+// c-basic-offset: 2
+// eval: (c-set-offset 'substatement-open 0)
+// eval: (c-set-offset 'innamespace 0)
+// End:
@@ -0,0 +1,230 @@
+/* CirKit: A circuit toolkit
+ * Copyright (C) 2009-2015  University of Bremen
+ * Copyright (C) 2015-2016  EPFL
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE dd_synthesis
+
+#include <random>
+#include <set>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <boost/dynamic_bitset.hpp>
+#include <boost/test/included/unit_test.hpp>
+
+#include <reversible/circuit.hpp>
+#include <reversible/simulation/simple_simulation.hpp>
+#include <reversible/synthesis/dd_synthesis_p.hpp>
+
+using namespace cirkit;
+using namespace cirkit::internal;
+
+/* BDD with complemented low edges, as created by dd_from_bdd */
+unsigned add_bdd_node( dd& graph, unsigned var, unsigned low, bool low_complemented, unsigned high )
+{
+  dd_node node;
+  node.var              = var;
+  node.constant         = false;
+  node.low              = low;
+  node.high             = high;
+  node.low_complemented = low_complemented;
+  return dd_add_node( graph, node );
+}
+
+bool evaluate( const dd& graph, unsigned index, unsigned assignment )
+{
+  const auto& node = graph.nodes[index];
+  if ( node.constant )
+  {
+    return node.var;
+  }
+  return ( ( assignment >> node.var ) & 1u ) ? evaluate( graph, node.high, assignment ) != node.high_complemented
+                                             : evaluate( graph, node.low, assignment ) != node.low_complemented;
+}
+
+/* compares every output of circ to the DD on all input assignments */
+bool realizes( const circuit& circ, const dd& graph )
+{
+  for ( auto assignment = 0u; assignment < ( 1u << graph.ninputs ); ++assignment )
+  {
+    boost::dynamic_bitset<> input( circ.lines() ), output;
+    for ( auto l = 0u; l < circ.lines(); ++l )
+    {
+      input[l] = l < graph.ninputs ? ( ( assignment >> l ) & 1u ) : *circ.constants()[l];
+    }
+    simple_simulation( output, circ, input );
+
+    for ( auto i = 0u; i < graph.roots.size(); ++i )
+    {
+      const auto& label = graph.labels[graph.ninputs + i];
+      const auto expected = evaluate( graph, graph.roots[i], assignment ) != graph.root_complemented[i];
+
+      auto found = 0u;
+      for ( auto l = 0u; l < circ.lines(); ++l )
+      {
+        if ( !circ.garbage()[l] && circ.outputs()[l] == label )
+        {
+          ++found;
+          if ( output[l] != expected ) { return false; }
+        }
+      }
+      if ( found != 1u ) { return false; }
+    }
+  }
+  return true;
+}
+
+std::vector<std::pair<std::vector<unsigned>, unsigned>> gate_list( const circuit& circ )
+{
+  std::vector<std::pair<std::vector<unsigned>, unsigned>> gates;
+  for ( const auto& g : circ )
+  {
+    std::vector<unsigned> controls;
+    for ( const auto& c : g.controls() )
+    {
+      controls.push_back( c.line() );
+    }
+    gates.push_back( {controls, g.targets().front()} );
+  }
+  return gates;
+}
+
+/*
+ * .i 2
+ * .o 4
+ * 00 0001
+ * 01 0111
+ * 10 0111
+ * 11 1010
+ *
+ * The outputs are a AND b, a XOR b, a OR b, and a NAND b.  The first and
+ * the last output share a node.
+ */
+dd small_pla()
+{
+  dd graph;
+  graph.ninputs = 2u;
+  graph.labels  = {"a", "b", "and", "xor", "or", "nand"};
+
+  dd_node one;
+  one.var = 1u;
+  const auto c1 = dd_add_node( graph, one );
+
+  const auto b     = add_bdd_node( graph, 1u, c1, true, c1 );
+  const auto f_and = add_bdd_node( graph, 0u, c1, true, b );
+  const auto f_xnr = add_bdd_node( graph, 0u, b, true, b );
+  const auto f_or  = add_bdd_node( graph, 0u, b, false, c1 );
+
+  dd_add_root( graph, f_and, false );
+  dd_add_root( graph, f_xnr, true );
+  dd_add_root( graph, f_or, false );
+  dd_add_root( graph, f_and, true );
+
+  return graph;
+}
+
+dd random_bdd( unsigned num_vars, unsigned nodes_per_var, unsigned num_outputs, std::mt19937& generator )
+{
+  dd graph;
+  graph.ninputs = num_vars;
+  for ( auto v = 0u; v < num_vars; ++v )
+  {
+    graph.labels.push_back( "i" + std::to_string( v ) );
+  }
+
+  dd_node one;
+  one.var = 1u;
+  std::vector<unsigned> nodes = {dd_add_node( graph, one )};
+
+  /* reduced and without duplicates, from the last variable to the first */
+  std::set<std::tuple<unsigned, unsigned, bool>> unique;
+  for ( auto v = num_vars; v-- > 0u; )
+  {
+    std::vector<unsigned> level;
+    for ( auto k = 0u; k < 3u * nodes_per_var && level.size() < nodes_per_var; ++k )
+    {
+      const auto low  = nodes[generator() % nodes.size()];
+      const auto high = nodes[generator() % nodes.size()];
+      const bool low_complemented = generator() & 1u;
+
+      if ( low == high && !low_complemented ) { continue; }
+      if ( !unique.insert( std::make_tuple( low, high, low_complemented ) ).second ) { continue; }
+
+      level.push_back( add_bdd_node( graph, v, low, low_complemented, high ) );
+    }
+    nodes.insert( nodes.end(), level.begin(), level.end() );
+  }
+
+  for ( auto i = 0u; i < num_outputs; ++i )
+  {
+    dd_add_root( graph, nodes[nodes.size() - 1u - generator() % 4u], generator() & 1u );
+  }
+  for ( auto i = 1u; i < graph.nodes.size(); ++i )
+  {
+    if ( graph.nodes[i].fanout == 0u )
+    {
+      dd_add_root( graph, i, generator() & 1u );
+    }
+  }
+  for ( auto i = 0u; i < graph.roots.size(); ++i )
+  {
+    graph.labels.push_back( "o" + std::to_string( i ) );
+  }
+
+  return graph;
+}
+
+BOOST_AUTO_TEST_CASE(golden)
+{
+  const auto graph = small_pla();
+
+  circuit circ;
+  dd_synthesis( circ, graph );
+
+  BOOST_CHECK( realizes( circ, graph ) );
+
+  /* the NAND output is copied from the AND line and negated */
+  const std::vector<std::pair<std::vector<unsigned>, unsigned>> expected = {
+    {{0u, 1u}, 2u}, {{0u}, 3u}, {{1u}, 3u}, {{0u}, 4u}, {{1u, 0u}, 4u}, {{1u}, 4u},
+    {{2u}, 5u}, {{}, 5u}, {{}, 3u}
+  };
+  BOOST_CHECK( circ.lines() == 6u );
+  BOOST_CHECK( circ.outputs() == std::vector<std::string>( {"g", "g", "and", "xor", "or", "nand"} ) );
+  BOOST_CHECK( gate_list( circ ) == expected );
+}
+
+BOOST_AUTO_TEST_CASE(shared_outputs)
+{
+  std::mt19937 generator( 42u );
+
+  for ( auto i = 0u; i < 20u; ++i )
+  {
+    const auto graph = random_bdd( 6u, 1u + i % 3u, 4u, generator );
+
+    circuit circ;
+    dd_synthesis( circ, graph );
+    BOOST_CHECK( realizes( circ, graph ) );
+  }
+}
+
+// Local Variables:
+// c-basic-offset: 2
+// eval: (c-set-offset 'substatement-open 0)
+// eval: (c-set-offset 'innamespace 0)
+// End:
@@ -19,10 +19,16 @@
 #define BOOST_TEST_DYN_LINK
 #define BOOST_TEST_MODULE esop_synthesis
 
+#include <fstream>
+#include <iterator>
+#include <sstream>
+
 #include <boost/test/included/unit_test.hpp>
 
 #include <reversible/circuit.hpp>
 #include <reversible/io/print_circuit.hpp>
+#include <reversible/io/write_realization.hpp>
+#include <reversible/simulation/compiled_simulation.hpp>
 #include <reversible/synthesis/esop_synthesis.hpp>
 
 BOOST_AUTO_TEST_CASE(simple)
@@ -37,6 +43,66 @@ BOOST_AUTO_TEST_CASE(simple)
   print_circuit( circ );
 }
 
+BOOST_AUTO_TEST_CASE(packed_cubes)
+{
+  using namespace cirkit;
+
+  /* reordering on packed cubes and on cube vectors give the same circuit */
+  circuit circ1, circ2, circ3;
+  properties::ptr settings1( new properties );
+  esop_synthesis( circ1, "../test/example.esop", settings1 );
+
+  properties::ptr settings2( new properties );
+  settings2->set( "reordering", cube_reordering_func( weighted_reordering() ) );
+  esop_synthesis( circ2, "../test/example.esop", settings2 );
+
+  std::stringstream real1, real2;
+  write_realization( circ1, real1 );
+  write_realization( circ2, real2 );
+  BOOST_CHECK_EQUAL( real1.str(), real2.str() );
+
+  /* Gray code reordering computes the same function on the non-garbage lines */
+  properties::ptr settings3( new properties );
+  settings3->set( "packed_reordering", esop_cube_reordering_func( gray_code_reordering() ) );
+  esop_synthesis( circ3, "../test/example.esop", settings3 );
+
+  auto num_inputs = 0u;
+  for ( const auto& c : circ1.constants() )
+  {
+    if ( !c ) { ++num_inputs; }
+  }
+
+  const compiled_circuit cc1( circ1 ), cc3( circ3 );
+  const auto mask = ( ( 1ull << circ1.lines() ) - 1ull ) & ~( ( 1ull << num_inputs ) - 1ull );
+  for ( auto pattern = 0ull; pattern < ( 1ull << num_inputs ); ++pattern )
+  {
+    BOOST_CHECK_EQUAL( cc1.simulate( pattern ) & mask, cc3.simulate( pattern ) & mask );
+  }
+}
+
+BOOST_AUTO_TEST_CASE(streaming)
+{
+  using namespace cirkit;
+
+  circuit circ, header;
+  properties::ptr settings( new properties );
+  esop_synthesis( circ, "../test/example.esop", settings );
+
+  properties::ptr statistics( new properties );
+  settings->set( "stream_filename", std::string( "/tmp/test_esop_stream.real" ) );
+  esop_synthesis( header, "../test/example.esop", settings, statistics );
+
+  BOOST_CHECK_EQUAL( header.num_gates(), 0u );
+  BOOST_CHECK_EQUAL( statistics->get<unsigned>( "gates" ), circ.num_gates() );
+
+  std::stringstream expected;
+  write_realization( circ, expected );
+
+  std::ifstream is( "/tmp/test_esop_stream.real" );
+  const std::string streamed( ( std::istreambuf_iterator<char>( is ) ), std::istreambuf_iterator<char>() );
+  BOOST_CHECK_EQUAL( streamed, expected.str() );
+}
+
 // Local Variables:
 // c-basic-offset: 2
 // eval: (c-set-offset 'substatement-open 0)
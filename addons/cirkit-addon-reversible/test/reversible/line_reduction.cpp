@@ -0,0 +1,204 @@
+/* CirKit: A circuit toolkit
+ * Copyright (C) 2009-2015  University of Bremen
+ * Copyright (C) 2015-2016  EPFL
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE line_reduction
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <boost/dynamic_bitset.hpp>
+#include <boost/range/algorithm.hpp>
+#include <boost/test/included/unit_test.hpp>
+
+#include <reversible/circuit.hpp>
+#include <reversible/functions/add_gates.hpp>
+#include <reversible/optimization/line_reduction.hpp>
+#include <reversible/simulation/simple_simulation.hpp>
+
+using namespace cirkit;
+
+/*
+ * Seven inputs, a garbage line g, and an output line f, both constant 0.
+ * The window that ends with the last control of g has at most six lines
+ * and starts at gate 3, such that g can be used for f afterwards.  Copies
+ * use separate lines, the names of copy k end in k.
+ */
+circuit create_circuit( unsigned copies = 1u )
+{
+  circuit circ( 9u * copies );
+
+  std::vector<std::string> inputs, outputs;
+  std::vector<constant> constants;
+  std::vector<bool> garbage;
+  for ( auto k = 0u; k < copies; ++k )
+  {
+    const auto suffix = copies == 1u ? std::string() : std::to_string( k );
+    for ( auto i = 0u; i < 7u; ++i )
+    {
+      inputs.push_back( "i" + std::to_string( i ) + suffix );
+      outputs.push_back( "i" + std::to_string( i ) + suffix );
+      constants.push_back( constant() );
+      garbage.push_back( false );
+    }
+    inputs.insert( inputs.end(), {"0", "0"} );
+    outputs.insert( outputs.end(), {"g" + suffix, "f" + suffix} );
+    constants.insert( constants.end(), {false, false} );
+    garbage.insert( garbage.end(), {true, false} );
+  }
+  circ.set_inputs( inputs );
+  circ.set_outputs( outputs );
+  circ.set_constants( constants );
+  circ.set_garbage( garbage );
+
+  for ( auto k = 0u; k < copies; ++k )
+  {
+    const auto o = 9u * k;
+
+    append_toffoli( circ, {make_var( o + 3u ), make_var( o + 4u )}, o + 5u );
+    append_toffoli( circ, {make_var( o + 5u ), make_var( o + 6u )}, o + 3u );
+    append_cnot( circ, make_var( o + 6u ), o + 4u );
+
+    /* window */
+    append_cnot( circ, make_var( o + 0u ), o + 3u );
+    append_cnot( circ, make_var( o + 4u ), o + 1u );
+    append_cnot( circ, make_var( o + 1u ), o + 2u );
+    append_toffoli( circ, {make_var( o + 0u ), make_var( o + 1u )}, o + 7u );
+    append_cnot( circ, make_var( o + 7u ), o + 2u );
+
+    append_cnot( circ, make_var( o + 0u ), o + 8u );
+    append_toffoli( circ, {make_var( o + 1u ), make_var( o + 2u )}, o + 8u );
+  }
+
+  return circ;
+}
+
+/* values of the non-garbage outputs by name */
+std::map<std::string, bool> simulate_outputs( const circuit& circ, unsigned assignment )
+{
+  boost::dynamic_bitset<> input( circ.lines() ), output;
+  auto var = 0u;
+  for ( auto l = 0u; l < circ.lines(); ++l )
+  {
+    input[l] = circ.constants()[l] ? *circ.constants()[l] : ( ( assignment >> var++ ) & 1u );
+  }
+  simple_simulation( output, circ, input );
+
+  std::map<std::string, bool> values;
+  for ( auto l = 0u; l < circ.lines(); ++l )
+  {
+    if ( !circ.garbage()[l] )
+    {
+      values[circ.outputs()[l]] = output[l];
+    }
+  }
+  return values;
+}
+
+bool same_outputs( const circuit& c1, const circuit& c2 )
+{
+  const auto num_vars = boost::count( c1.constants(), constant() );
+  for ( auto assignment = 0u; assignment < ( 1u << num_vars ); ++assignment )
+  {
+    if ( simulate_outputs( c1, assignment ) != simulate_outputs( c2, assignment ) ) { return false; }
+  }
+  return true;
+}
+
+BOOST_AUTO_TEST_CASE(window_offset)
+{
+  const auto base = create_circuit();
+
+  circuit circ;
+  auto statistics = std::make_shared<properties>();
+  line_reduction( circ, base, properties::ptr(), statistics );
+
+  BOOST_CHECK_EQUAL( circ.lines(), 8u );
+  BOOST_CHECK( same_outputs( base, circ ) );
+  BOOST_CHECK( statistics->get<unsigned long long>( "simulated_gates" ) > 0ull );
+
+  /* the gates in front of the window are kept */
+  for ( auto i = 0u; i < 3u; ++i )
+  {
+    BOOST_CHECK( circ[i].controls() == base[i].controls() );
+    BOOST_CHECK( circ[i].targets() == base[i].targets() );
+  }
+}
+
+BOOST_AUTO_TEST_CASE(checkpoint_memory)
+{
+  const auto base = create_circuit();
+
+  circuit expected;
+  line_reduction( expected, base );
+
+  /* room for two checkpoints of nine lines and two words, and for none */
+  for ( auto memory : {2ull * 9u * 2u * 8u, 8ull} )
+  {
+    auto settings = std::make_shared<properties>();
+    settings->set( "checkpoint_interval", 1u );
+    settings->set( "max_checkpoint_memory", memory );
+    auto statistics = std::make_shared<properties>();
+
+    circuit circ;
+    line_reduction( circ, base, settings, statistics );
+
+    BOOST_CHECK_EQUAL( circ.lines(), expected.lines() );
+    BOOST_CHECK_EQUAL( circ.num_gates(), expected.num_gates() );
+    BOOST_CHECK( same_outputs( base, circ ) );
+    BOOST_CHECK_EQUAL( statistics->get<unsigned long long>( "simulated_gates" ) > 0ull, memory != 8ull );
+  }
+}
+
+BOOST_AUTO_TEST_CASE(threads)
+{
+  const auto base = create_circuit( 2u );
+
+  circuit expected;
+  line_reduction( expected, base );
+
+  BOOST_CHECK( expected.lines() < base.lines() );
+  BOOST_CHECK( same_outputs( base, expected ) );
+
+  for ( auto num_threads : {2u, 4u} )
+  {
+    auto settings = std::make_shared<properties>();
+    settings->set( "num_threads", num_threads );
+
+    circuit circ;
+    line_reduction( circ, base, settings );
+
+    BOOST_CHECK( circ.lines() == expected.lines() );
+    BOOST_CHECK( circ.inputs() == expected.inputs() );
+    BOOST_CHECK( circ.outputs() == expected.outputs() );
+    BOOST_CHECK( circ.garbage() == expected.garbage() );
+    BOOST_REQUIRE_EQUAL( circ.num_gates(), expected.num_gates() );
+    for ( auto i = 0u; i < circ.num_gates(); ++i )
+    {
+      BOOST_CHECK( circ[i].controls() == expected[i].controls() );
+      BOOST_CHECK( circ[i].targets() == expected[i].targets() );
+    }
+  }
+}
+
+// Local Variables:
+// c-basic-offset: 2
+// eval: (c-set-offset 'substatement-open 0)
+// eval: (c-set-offset 'innamespace 0)
+// End:
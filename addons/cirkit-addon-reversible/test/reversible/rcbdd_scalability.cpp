@@ -152,6 +152,30 @@ BOOST_AUTO_TEST_CASE(simple)
   }
 }
 
+BOOST_AUTO_TEST_CASE(step_statistics)
+{
+  /* bitwise xor with n = 3 */
+  rcbdd cf;
+  cf.initialize_manager();
+  cf.create_variables( 6u );
+
+  BDD chi = cf.manager().bddOne();
+  for ( unsigned i = 0u; i < 3u; ++i )
+  {
+    chi &= cf.y(i).Xnor( cf.x(i) );
+    chi &= cf.y(3u + i).Xnor( cf.x(i) ^ cf.x(3u + i) );
+  }
+  cf.set_chi( chi );
+
+  circuit circ;
+  properties::ptr settings( new properties );
+  properties::ptr statistics( new properties );
+  rcbdd_synthesis( circ, cf, settings, statistics );
+
+  BOOST_CHECK( statistics->get<std::vector<double>>( "step_runtimes" ).size() == 6u );
+  BOOST_CHECK( statistics->get<std::vector<unsigned long>>( "step_node_counts" ).size() == 6u );
+}
+
 // Local Variables:
 // c-basic-offset: 2
 // eval: (c-set-offset 'substatement-open 0)
@@ -0,0 +1,107 @@
+/* CirKit: A circuit toolkit
+ * Copyright (C) 2009-2015  University of Bremen
+ * Copyright (C) 2015-2016  EPFL
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE simplify
+
+#include <random>
+
+#include <boost/test/included/unit_test.hpp>
+
+#include <reversible/circuit.hpp>
+#include <reversible/functions/add_gates.hpp>
+#include <reversible/functions/create_random_circuit.hpp>
+#include <reversible/optimization/simplify.hpp>
+#include <reversible/simulation/compiled_simulation.hpp>
+
+using namespace cirkit;
+
+bool equivalent( const circuit& c1, const circuit& c2 )
+{
+  const compiled_circuit cc1( c1 ), cc2( c2 );
+  for ( auto pattern = 0ull; pattern < ( 1ull << c1.lines() ); ++pattern )
+  {
+    if ( cc1.simulate( pattern ) != cc2.simulate( pattern ) ) { return false; }
+  }
+  return true;
+}
+
+BOOST_AUTO_TEST_CASE(cancel_across_commuting_gates)
+{
+  circuit circ( 4u );
+  append_toffoli( circ, {make_var( 0u ), make_var( 1u )}, 3u );
+  append_cnot( circ, make_var( 0u ), 2u );
+  append_toffoli( circ, {make_var( 1u ), make_var( 2u, false )}, 3u );
+  append_toffoli( circ, {make_var( 1u ), make_var( 0u )}, 3u );
+
+  circuit simp;
+  auto statistics = std::make_shared<properties>();
+  simplify( simp, circ, properties::ptr(), statistics );
+
+  BOOST_CHECK_EQUAL( simp.num_gates(), 2u );
+  BOOST_CHECK_EQUAL( statistics->get<unsigned>( "cancellations" ), 1u );
+  BOOST_CHECK( equivalent( circ, simp ) );
+}
+
+BOOST_AUTO_TEST_CASE(random_circuits)
+{
+  std::default_random_engine generator( 42 );
+
+  for ( auto i = 0u; i < 200u; ++i )
+  {
+    const auto circ = create_random_circuit( 5u, 10u + i % 40u, true, generator );
+
+    circuit simp;
+    simplify( simp, circ );
+
+    BOOST_CHECK( simp.num_gates() <= circ.num_gates() );
+    BOOST_CHECK( equivalent( circ, simp ) );
+  }
+}
+
+BOOST_AUTO_TEST_CASE(wide_circuits)
+{
+  std::default_random_engine generator( 42 );
+
+  for ( auto i = 0u; i < 50u; ++i )
+  {
+    const auto circ = create_random_circuit( 5u, 10u + i % 40u, true, generator );
+
+    /* more than 64 lines are not simplified on the flat representation */
+    auto wide = circ;
+    wide.set_lines( 70u );
+
+    circuit simp, simp_wide;
+    auto statistics = std::make_shared<properties>(), statistics_wide = std::make_shared<properties>();
+    simplify( simp, circ, properties::ptr(), statistics );
+    simplify( simp_wide, wide, properties::ptr(), statistics_wide );
+
+    BOOST_CHECK_EQUAL( simp_wide.lines(), 70u );
+    BOOST_CHECK_EQUAL( simp_wide.num_gates(), simp.num_gates() );
+    BOOST_CHECK_EQUAL( statistics_wide->get<unsigned>( "cancellations" ), statistics->get<unsigned>( "cancellations" ) );
+    BOOST_CHECK_EQUAL( statistics_wide->get<unsigned>( "merges" ), statistics->get<unsigned>( "merges" ) );
+
+    simp_wide.set_lines( 5u );
+    BOOST_CHECK( equivalent( simp, simp_wide ) );
+  }
+}
+
+// Local Variables:
+// c-basic-offset: 2
+// eval: (c-set-offset 'substatement-open 0)
+// eval: (c-set-offset 'innamespace 0)
+// End:
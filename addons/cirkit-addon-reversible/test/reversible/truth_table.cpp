@@ -22,6 +22,7 @@
 #include <boost/test/included/unit_test.hpp>
 #include <boost/test/output_test_stream.hpp>
 
+#include <reversible/dense_truth_table.hpp>
 #include <reversible/truth_table.hpp>
 #include <reversible/utils/truth_table_helpers.hpp>
 
@@ -57,6 +58,53 @@ BOOST_AUTO_TEST_CASE(simple)
   }
 }
 
+BOOST_AUTO_TEST_CASE(dense)
+{
+  using boost::test_tools::output_test_stream;
+
+  using namespace cirkit;
+
+  /* fully specified */
+  binary_truth_table spec;
+
+  spec.add_entry( number_to_truth_table_cube( 0u, 2u ), number_to_truth_table_cube( 0u, 2u ) );
+  spec.add_entry( number_to_truth_table_cube( 1u, 2u ), number_to_truth_table_cube( 1u, 2u ) );
+  spec.add_entry( number_to_truth_table_cube( 2u, 2u ), number_to_truth_table_cube( 3u, 2u ) );
+  spec.add_entry( number_to_truth_table_cube( 3u, 2u ), number_to_truth_table_cube( 2u, 2u ) );
+
+  dense_truth_table dense( spec );
+  BOOST_CHECK( dense.is_fully_specified() );
+  BOOST_CHECK( dense.to_permutation() == std::vector<unsigned>( {0u, 1u, 3u, 2u} ) );
+  BOOST_CHECK( truth_table_to_bitset_vector( dense ) == truth_table_to_bitset_vector( spec ) );
+
+  output_test_stream output;
+  output << dense;
+  BOOST_CHECK( output.is_equal( "00 00\n01 01\n10 11\n11 10\n" ) );
+
+  output << dense.to_truth_table();
+  BOOST_CHECK( output.is_equal( "00 00\n01 01\n10 11\n11 10\n" ) );
+
+  /* incompletely specified, with don't cares in inputs and outputs */
+  binary_truth_table pla;
+  binary_truth_table::cube_type in1 = {true, boost::none}, out1 = {true, boost::none};
+  binary_truth_table::cube_type in2 = {false, false},      out2 = {false, true};
+  pla.add_entry( in1, out1 );
+  pla.add_entry( in2, out2 );
+
+  dense_truth_table dense_pla( pla );
+  BOOST_CHECK( !dense_pla.is_fully_specified() );
+  BOOST_CHECK( !dense_pla.is_specified( 1u ) );
+  BOOST_CHECK( !dense_pla.get( 2u, 1u ) );
+
+  output << dense_pla;
+  BOOST_CHECK( output.is_equal( "00 01\n10 1-\n11 1-\n" ) );
+
+  dense_pla.set( 1u, 0u, false );
+  dense_pla.set( 1u, 1u, true );
+  output << dense_pla;
+  BOOST_CHECK( output.is_equal( "00 01\n01 01\n10 1-\n11 1-\n" ) );
+}
+
 // Local Variables:
 // c-basic-offset: 2
 // eval: (c-set-offset 'substatement-open 0)
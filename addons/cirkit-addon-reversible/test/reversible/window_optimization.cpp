@@ -0,0 +1,87 @@
+/* CirKit: A circuit toolkit
+ * Copyright (C) 2009-2015  University of Bremen
+ * Copyright (C) 2015-2016  EPFL
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE window_optimization
+
+#include <random>
+
+#include <boost/test/included/unit_test.hpp>
+
+#include <reversible/circuit.hpp>
+#include <reversible/functions/circuit_to_truth_table.hpp>
+#include <reversible/functions/create_random_circuit.hpp>
+#include <reversible/optimization/window_optimization.hpp>
+
+using namespace cirkit;
+
+bool same_gates( const circuit& c1, const circuit& c2 )
+{
+  if ( c1.num_gates() != c2.num_gates() ) { return false; }
+
+  for ( auto i = 0u; i < c1.num_gates(); ++i )
+  {
+    if ( c1[i].controls() != c2[i].controls() || c1[i].targets() != c2[i].targets() ) { return false; }
+  }
+  return true;
+}
+
+BOOST_AUTO_TEST_CASE(threads)
+{
+  std::default_random_engine generator( 42u );
+
+  for ( auto i = 0u; i < 3u; ++i )
+  {
+    const auto base     = create_random_circuit( 4u, 200u, true, generator );
+    const auto expected = circuit_to_dense_permutation( base );
+
+    circuit sequential;
+    window_optimization( sequential, base );
+
+    BOOST_CHECK( circuit_to_dense_permutation( sequential ) == expected );
+    BOOST_CHECK( sequential.num_gates() < base.num_gates() );
+
+    /* batched with one thread, and batched by default with four threads */
+    circuit circs[2u];
+    for ( auto num_threads : {1u, 4u} )
+    {
+      auto settings = std::make_shared<properties>();
+      settings->set( "num_threads", num_threads );
+      if ( num_threads == 1u )
+      {
+        settings->set( "batched", true );
+      }
+      auto statistics = std::make_shared<properties>();
+
+      auto& circ = circs[num_threads == 1u ? 0u : 1u];
+      window_optimization( circ, base, settings, statistics );
+
+      BOOST_CHECK( circuit_to_dense_permutation( circ ) == expected );
+      BOOST_CHECK( circ.num_gates() < base.num_gates() );
+      BOOST_CHECK( statistics->get<unsigned>( "rounds" ) > 0u );
+    }
+
+    BOOST_CHECK( same_gates( circs[0u], circs[1u] ) );
+  }
+}
+
+// Local Variables:
+// c-basic-offset: 2
+// eval: (c-set-offset 'substatement-open 0)
+// eval: (c-set-offset 'innamespace 0)
+// End:
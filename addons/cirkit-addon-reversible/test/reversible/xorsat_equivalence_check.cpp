@@ -0,0 +1,73 @@
+/* CirKit: A circuit toolkit
+ * Copyright (C) 2009-2015  University of Bremen
+ * Copyright (C) 2015-2016  EPFL
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE xorsat_equivalence_check
+
+#include <random>
+
+#include <boost/test/included/unit_test.hpp>
+
+#include <reversible/circuit.hpp>
+#include <reversible/functions/circuit_to_truth_table.hpp>
+#include <reversible/functions/create_random_circuit.hpp>
+#include <reversible/verification/xorsat_equivalence_check.hpp>
+
+using namespace cirkit;
+
+BOOST_AUTO_TEST_CASE(simple)
+{
+  std::default_random_engine generator( 42u );
+
+  xorsat_equivalence_checker checker( 5u );
+
+  circuit reference( 5u );
+  for ( auto i = 0u; i < 15u; ++i )
+  {
+    create_random_gate( reference.append_gate(), reference.lines(), true, generator, true );
+  }
+  const auto expected = circuit_to_dense_permutation( reference );
+
+  for ( auto i = 0u; i < 20u; ++i )
+  {
+    /* a gate and its inverse (Peres gates are not self-inverse) */
+    circuit circ = reference;
+    const auto pos = generator() % ( circ.num_gates() + 1u );
+    create_random_gate( circ.insert_gate( pos ), circ.lines(), true, generator );
+    const auto g = circ[pos];
+    circ.insert_gate( pos ) = g;
+
+    BOOST_CHECK( checker.check( reference, circ ) );
+    BOOST_CHECK( xorsat_equivalence_check( circ, reference ) );
+
+    /* a single additional gate */
+    create_random_gate( circ.insert_gate( generator() % ( circ.num_gates() + 1u ) ), circ.lines(), true, generator, true );
+
+    const auto equivalent = circuit_to_dense_permutation( circ ) == expected;
+    BOOST_CHECK( checker.check( reference, circ ) == equivalent );
+    BOOST_CHECK( xorsat_equivalence_check( circ, reference ) == equivalent );
+  }
+
+  BOOST_CHECK( checker.num_checks() == 40u );
+}
+
+// Local Variables:
+// c-basic-offset: 2
+// eval: (c-set-offset 'substatement-open 0)
+// eval: (c-set-offset 'innamespace 0)
+// End:
@@ -19,10 +19,13 @@
 #include "lad2.hpp"
 
 #include <algorithm>
+#include <atomic>
 #include <deque>
 #include <fstream>
 #include <functional>
 #include <iostream>
+#include <memory>
+#include <mutex>
 #include <unordered_set>
 #include <vector>
 #include <stack>
@@ -34,11 +37,13 @@
 #include <boost/range/algorithm.hpp>
 #include <boost/range/algorithm_ext/push_back.hpp>
 #include <boost/range/counting_range.hpp>
+#include <boost/range/numeric.hpp>
 #include <boost/timer/timer.hpp>
 
 #include <core/utils/bitset_utils.hpp>
 #include <core/utils/range_utils.hpp>
 #include <core/utils/string_utils.hpp>
+#include <core/utils/thread_pool.hpp>
 #include <core/utils/timer.hpp>
 
 #include <classical/aig.hpp>
@@ -165,7 +170,8 @@ lad2_domain::lad2_domain( const simulation_graph_wrapper& gp, const simulation_g
   global_matching_t.resize( gt.size(), -1 );
   nb_val.resize( gp.size(), 0 );
   first_val.resize( gp.size() );
-  pos_in_val.resize( gp.size(), vec_int_t( gt.size() ) );
+  target_size = gt.size();
+  pos_in_val.resize( gp.size() * gt.size() );
   marked_to_filter.resize( gp.size(), true );
   to_filter.resize( gp.size() );
 
@@ -180,14 +186,14 @@ lad2_domain::lad2_domain( const simulation_graph_wrapper& gp, const simulation_g
     {
       if ( !compatible_vertices( u, v, gp, gt, simulation_signatures, functional_support_constraints ) ) /* v not in D[u] */
       {
-        pos_in_val[u][v] = first_val[u] + gt.size();
+        pos( u, v ) = first_val[u] + gt.size();
       }
       else /* v in D[u] */
       {
         matching.reserve( u, v, gp.degree( u ) );
         val += v;
         nb_val[u]++;
-        pos_in_val[u][v] = val_size++;
+        pos( u, v ) = val_size++;
       }
     }
   }
@@ -274,9 +280,10 @@ void lad2_domain::dump( const std::string& filename )
   os << "nbVal: " << any_join( nb_val, " " ) << std::endl
      << "firstVal: " << any_join( first_val, " " ) << std::endl
      << "val: " << any_join( boost::make_iterator_range( val.begin(), val.begin() + first_val.back() + nb_val.back() ), " " ) << std::endl;
-  for ( const auto& p : pos_in_val )
+  for ( auto u = 0u; u < nb_val.size(); ++u )
   {
-    os << "posInVal[]: " << any_join( p, " " ) << std::endl;
+    const auto begin = pos_in_val.begin() + u * target_size;
+    os << "posInVal[]: " << any_join( boost::make_iterator_range( begin, begin + target_size ), " " ) << std::endl;
   }
   // for ( const auto& p : first_match )
   // {
@@ -308,8 +315,10 @@ struct lad2_manager
                 const std::vector<unsigned>& types,
                 bool functional, bool support_edges, const boost::optional<unsigned>& simulation_signatures,
                 const std::string& texlogname, bool verbose )
-    : gp( pattern, types, support_edges, simulation_signatures ),
-      gt( target, types, support_edges, simulation_signatures ),
+    : pattern_graph( std::make_shared<simulation_graph_wrapper>( pattern, types, support_edges, simulation_signatures ) ),
+      target_graph( std::make_shared<simulation_graph_wrapper>( target, types, support_edges, simulation_signatures ) ),
+      gp( *pattern_graph ),
+      gt( *target_graph ),
       d( gp, gt, simulation_signatures, functional ),
       verbose( verbose ),
       num( gt.size() ),
@@ -349,6 +358,23 @@ struct lad2_manager
 #endif
   }
 
+  /* worker for the parallel search, shares the graphs and copies the current domain */
+  explicit lad2_manager( const lad2_manager& root )
+    : pattern_graph( root.pattern_graph ),
+      target_graph( root.target_graph ),
+      gp( *pattern_graph ),
+      gt( *target_graph ),
+      d( root.d ),
+      verbose( false ),
+      num( gt.size() ),
+      num_inv( gt.size() ),
+      nb_comp( gp.size() ),
+      first_comp( gp.size() ),
+      matched_with_u( gp.size() ),
+      on_filter( root.on_filter )
+  {
+  }
+
   ~lad2_manager()
   {
 #ifdef LAD_TEX_LOGGER
@@ -428,14 +454,40 @@ struct lad2_manager
   bool check_lad( int u, int v );
   bool filter();
   bool solve( unsigned& nb_sol, std::vector<unsigned>& mapping );
+  bool prepare();
   bool start_lad( std::vector<unsigned>& mapping );
 
+  /* parallel search */
+  using decision_t = std::pair<int, int>;
+  using path_t     = std::vector<decision_t>;
+
+  void collect_tasks( unsigned depth, path_t& path, std::vector<path_t>& tasks, unsigned& nb_sol, std::vector<unsigned>& mapping );
+  bool solve_task( const path_t& path, unsigned& nb_sol, std::vector<unsigned>& mapping );
+
+  inline bool stopped() const
+  {
+    return stop && stop->load( std::memory_order_relaxed );
+  }
+
+  inline void restore_state( unsigned state, const vec_int_t& global_matching )
+  {
+    d.restore_state( state );
+    boost::fill( d.global_matching_t, -1 );
+    for ( const auto& u : gp.vertices() )
+    {
+      d.global_matching_p[u] = global_matching[u];
+      d.global_matching_t[global_matching[u]] = u;
+    }
+  }
+
   void list_target_image( std::ostream& os );
   std::tuple<unsigned, unsigned, unsigned> target_image_size();
   void list_with_names( std::ostream& os, bool only_inputs = true );
 
-  simulation_graph_wrapper gp;
-  simulation_graph_wrapper gt;
+  std::shared_ptr<const simulation_graph_wrapper> pattern_graph;
+  std::shared_ptr<const simulation_graph_wrapper> target_graph;
+  const simulation_graph_wrapper& gp;
+  const simulation_graph_wrapper& gt;
   lad2_domain d;
   bool verbose;
 
@@ -451,6 +503,9 @@ struct lad2_manager
   domain_hook_t on_before_first_branch;
   domain_hook_t on_filter;
 
+  /* set by another worker, if a solution has been found */
+  const std::atomic<bool>* stop = nullptr;
+
   /* statistics */
   boost::timer::cpu_timer timer;
 #ifdef LAD_TEX_LOGGER /* because of comma in type */
@@ -773,13 +828,13 @@ bool lad2_manager::remove_all_values_but_one( int u, int v )
     d.add_to_filter( j, gp.size() );
   }
 
-  int old_pos = d.pos_in_val[u][v];
+  int old_pos = d.pos( u, v );
   int new_pos = d.first_val[u];
   d.val[old_pos] = d.val[new_pos];
   d.val[new_pos] = v;
-  d.pos_in_val[u][d.val[new_pos]] = new_pos;
-  d.pos_in_val[u][d.val[old_pos]] = old_pos;
-  d.nb_val[u] = 1;
+  d.pos( u, d.val[new_pos] ) = new_pos;
+  d.pos( u, d.val[old_pos] ) = old_pos;
+  d.set_nb_val( u, 1 );
   if ( d.global_matching_p[u] != v )
   {
     d.global_matching_t[d.global_matching_p[u]] = -1;
@@ -795,13 +850,13 @@ bool lad2_manager::remove_value( int u, int v )
   {
     d.add_to_filter( j, gp.size() );
   }
-  int old_pos = d.pos_in_val[u][v];
-  d.nb_val[u]--;
+  int old_pos = d.pos( u, v );
+  d.set_nb_val( u, d.nb_val[u] - 1 );
   int new_pos = d.first_val[u] + d.nb_val[u];
   d.val[old_pos] = d.val[new_pos];
   d.val[new_pos] = v;
-  d.pos_in_val[u][d.val[old_pos]] = old_pos;
-  d.pos_in_val[u][d.val[new_pos]] = new_pos;
+  d.pos( u, d.val[old_pos] ) = old_pos;
+  d.pos( u, d.val[new_pos] ) = new_pos;
   if ( d.global_matching_p[u] == v )
   {
     d.global_matching_p[u] = -1;
@@ -1087,7 +1142,6 @@ bool lad2_manager::filter()
 bool lad2_manager::solve( unsigned& nb_sol, std::vector<unsigned>& mapping )
 {
   int v, min_dom, i;
-  vec_int_t nb_val( gp.size() );
   vec_int_t global_matching( gp.size() );
 
   if ( !filter() )
@@ -1108,8 +1162,7 @@ bool lad2_manager::solve( unsigned& nb_sol, std::vector<unsigned>& mapping )
   min_dom = -1;
   for ( const auto& u : gp.vertices() )
   {
-    nb_val[u] = d.nb_val[u];
-    if ( nb_val[u] > 1 && ( min_dom < 0 || nb_val[u] < nb_val[min_dom] ) )
+    if ( d.nb_val[u] > 1 && ( min_dom < 0 || d.nb_val[u] < d.nb_val[min_dom] ) )
     {
       min_dom = u;
     }
@@ -1138,7 +1191,9 @@ bool lad2_manager::solve( unsigned& nb_sol, std::vector<unsigned>& mapping )
     return true;
   }
 
-  vec_int_t val( d.nb_val[min_dom] );
+  const auto nb_val = d.nb_val[min_dom];
+  const auto state  = d.save_state();
+  vec_int_t val( nb_val );
   boost::copy( d.get( min_dom ), val.begin() );
 
   if ( num_branches == 0u )
@@ -1156,7 +1211,7 @@ bool lad2_manager::solve( unsigned& nb_sol, std::vector<unsigned>& mapping )
     }
   }
 
-  for ( i = 0; i < nb_val[min_dom] && nb_sol == 0; ++i )
+  for ( i = 0; i < nb_val && nb_sol == 0 && !stopped(); ++i )
   {
     v = val[i];
     num_branches++;
@@ -1185,19 +1240,12 @@ bool lad2_manager::solve( unsigned& nb_sol, std::vector<unsigned>& mapping )
     {
       std::cout << format( "End of branch %d=%d" ) % min_dom % v << std::endl;
     }
-    boost::fill( d.global_matching_t, -1 );
-    // TODO use boost::copy
-    for ( const auto& u : gp.vertices() )
-    {
-      d.nb_val[u] = nb_val[u];
-      d.global_matching_p[u] = global_matching[u];
-      d.global_matching_t[global_matching[u]] = u;
-    }
+    restore_state( state, global_matching );
   }
   return true;
 }
 
-bool lad2_manager::start_lad( std::vector<unsigned>& mapping )
+bool lad2_manager::prepare()
 {
   if ( !update_matching( gp.size(), gt.size(), d.nb_val, d.first_val, d.val, d.global_matching_p ) )
   {
@@ -1219,7 +1267,12 @@ bool lad2_manager::start_lad( std::vector<unsigned>& mapping )
       to_match.push( u );
     }
   }
-  if ( !match_vertices( to_match ) )
+  return match_vertices( to_match );
+}
+
+bool lad2_manager::start_lad( std::vector<unsigned>& mapping )
+{
+  if ( !prepare() )
   {
     return false;
   }
@@ -1229,6 +1282,91 @@ bool lad2_manager::start_lad( std::vector<unsigned>& mapping )
   return nb_sol > 0u;
 }
 
+/*
+ * Explores the branching levels as solve() does, but instead of solving
+ * the subtrees at the given depth, the decisions leading to them are
+ * collected.  Assumes that the domain is filtered.
+ */
+void lad2_manager::collect_tasks( unsigned depth, path_t& path, std::vector<path_t>& tasks, unsigned& nb_sol, std::vector<unsigned>& mapping )
+{
+  auto min_dom = -1;
+  for ( const auto& u : gp.vertices() )
+  {
+    if ( d.nb_val[u] > 1 && ( min_dom < 0 || d.nb_val[u] < d.nb_val[min_dom] ) )
+    {
+      min_dom = u;
+    }
+  }
+
+  if ( min_dom == -1 )
+  {
+    ++nb_sol;
+    mapping.resize( gp.size() );
+    for ( const auto& u : gp.vertices() )
+    {
+      mapping[u] = d.val[d.first_val[u]];
+    }
+    return;
+  }
+
+  if ( path.size() == depth )
+  {
+    tasks.push_back( path );
+    return;
+  }
+
+  vec_int_t global_matching( d.global_matching_p.begin(), d.global_matching_p.begin() + gp.size() );
+  const auto state = d.save_state();
+  vec_int_t val( d.nb_val[min_dom] );
+  boost::copy( d.get( min_dom ), val.begin() );
+
+  for ( auto v : val )
+  {
+    if ( nb_sol ) { break; }
+
+    ++num_branches;
+    path.push_back( {min_dom, v} );
+    if ( remove_all_values_but_one( min_dom, v ) && match_vertex( min_dom ) && filter() )
+    {
+      collect_tasks( depth, path, tasks, nb_sol, mapping );
+    }
+    d.reset_to_filter( gp.size() );
+    path.pop_back();
+    restore_state( state, global_matching );
+  }
+}
+
+/*
+ * Replays the decisions of a task on the domain and solves the remaining
+ * subtree.  Afterwards the domain is restored, such that the next task can
+ * be solved on the same copy.
+ */
+bool lad2_manager::solve_task( const path_t& path, unsigned& nb_sol, std::vector<unsigned>& mapping )
+{
+  vec_int_t global_matching( d.global_matching_p.begin(), d.global_matching_p.begin() + gp.size() );
+  const auto state = d.save_state();
+
+  auto consistent = true;
+  for ( const auto& decision : path )
+  {
+    if ( !remove_all_values_but_one( decision.first, decision.second ) || !match_vertex( decision.first ) || !filter() )
+    {
+      consistent = false;
+      break;
+    }
+  }
+
+  if ( consistent )
+  {
+    solve( nb_sol, mapping );
+  }
+
+  d.reset_to_filter( gp.size() );
+  restore_state( state, global_matching );
+
+  return nb_sol > 0u;
+}
+
 void lad2_manager::list_target_image( std::ostream& os )
 {
   using namespace std::placeholders;
@@ -1303,6 +1441,8 @@ bool directed_lad2_from_aig( std::vector<unsigned>& mapping, const aig_graph& ta
   const auto on_filter                = get( settings, "on_filter",                domain_hook_t() );
   const auto on_before_first_branch   = get( settings, "on_before_first_branch",   domain_hook_t() );
   const auto texlogname               = get( settings, "texlogname",               std::string( "/tmp/log.tex" ) );
+  const auto num_threads              = get( settings, "num_threads",              1u );
+  const auto split_depth              = get( settings, "split_depth",              1u );
 
   /* Timer */
   properties_timer t( statistics );
@@ -1310,13 +1450,91 @@ bool directed_lad2_from_aig( std::vector<unsigned>& mapping, const aig_graph& ta
   lad2_manager mgr( target, pattern, types, functional, support_edges, simulation_signatures, texlogname, false /*verbose*/ );
   mgr.on_before_first_branch = on_before_first_branch;
   mgr.on_filter              = on_filter;
-  auto result = mgr.start_lad( mapping );
 
-  set( statistics, "num_branches", mgr.num_branches );
   set( statistics, "pattern_vertices", mgr.gp.size() );
   set( statistics, "target_vertices", mgr.gt.size() );
 
-  return result;
+  if ( num_threads <= 1u )
+  {
+    auto result = mgr.start_lad( mapping );
+    set( statistics, "num_branches", mgr.num_branches );
+    return result;
+  }
+
+  /* parallel search: filter the root, split the first levels into tasks */
+  if ( !mgr.prepare() || !mgr.filter() )
+  {
+    set( statistics, "num_branches", mgr.num_branches );
+    return false;
+  }
+
+  if ( (bool)on_before_first_branch && (*on_before_first_branch)( mgr.d ) )
+  {
+    set( statistics, "num_branches", mgr.num_branches );
+    return false;
+  }
+
+  /* workers copy the domain before the root explores the first levels */
+  std::vector<std::unique_ptr<lad2_manager>> workers;
+  for ( auto i = 0u; i < num_threads; ++i )
+  {
+    workers.emplace_back( new lad2_manager( mgr ) );
+  }
+
+  unsigned nb_sol = 0u;
+  lad2_manager::path_t path;
+  std::vector<lad2_manager::path_t> tasks;
+  mgr.collect_tasks( split_depth, path, tasks, nb_sol, mapping );
+
+  std::atomic<bool>     found( nb_sol > 0u );
+  std::atomic<unsigned> next_task( 0u );
+  std::mutex            mapping_mutex;
+
+  std::vector<unsigned> worker_tasks( num_threads, 0u ), worker_branches( num_threads, 0u );
+  std::vector<double>   worker_runtimes( num_threads, 0.0 );
+
+  auto worker = [&]( unsigned id ) {
+    increment_timer t( &worker_runtimes[id] );
+    auto& w = *workers[id];
+    w.stop = &found;
+
+    unsigned task;
+    while ( !found && ( task = next_task++ ) < tasks.size() )
+    {
+      unsigned w_nb_sol = 0u;
+      std::vector<unsigned> w_mapping;
+      ++worker_tasks[id];
+
+      if ( w.solve_task( tasks[task], w_nb_sol, w_mapping ) )
+      {
+        std::lock_guard<std::mutex> lock( mapping_mutex );
+        if ( !found )
+        {
+          mapping = w_mapping;
+          found = true;
+        }
+      }
+    }
+
+    worker_branches[id] = w.num_branches;
+  };
+
+  if ( !found )
+  {
+    thread_pool pool( num_threads );
+    for ( auto i = 0u; i < num_threads; ++i )
+    {
+      pool.enqueue( worker, i );
+    }
+  }
+
+  set( statistics, "num_branches", mgr.num_branches + boost::accumulate( worker_branches, 0u ) );
+  set( statistics, "num_tasks", static_cast<unsigned>( tasks.size() ) );
+  set( statistics, "worker_tasks", worker_tasks );
+  set( statistics, "worker_branches", worker_branches );
+  set( statistics, "worker_runtimes", worker_runtimes );
+
+  return found;
 }
 
 aig_graph shrink_block( const aig_graph& block, const aig_graph& component, const std::vector<unsigned>& types,
@@ -88,7 +88,8 @@ struct lad2_domain
   std::vector<int> nb_val;
   std::vector<int> first_val;
   std::vector<int> val;
-  std::vector<std::vector<int>> pos_in_val;
+  std::vector<int> pos_in_val; /* row-major, |V_P| x |V_T| */
+  int target_size;
   lad_matching matching;
   int next_out_to_filter;
   int last_in_to_filter;
@@ -156,14 +157,43 @@ struct lad2_domain
     to_filter[last_in_to_filter] = u;
   }
 
+  inline int& pos( int u, int v )
+  {
+    return pos_in_val[u * target_size + v];
+  }
+
   inline bool is_in_domain( int u, int v ) const
   {
-    return pos_in_val[u][v] < first_val[u] + nb_val[u];
+    return pos_in_val[u * target_size + v] < first_val[u] + nb_val[u];
+  }
+
+  /* domain sizes are changed through the trail, such that they can be restored when backtracking */
+  inline void set_nb_val( int u, int n )
+  {
+    nb_val_trail.emplace_back( u, nb_val[u] );
+    nb_val[u] = n;
+  }
+
+  inline unsigned save_state() const
+  {
+    return nb_val_trail.size();
+  }
+
+  inline void restore_state( unsigned state )
+  {
+    while ( nb_val_trail.size() > state )
+    {
+      nb_val[nb_val_trail.back().first] = nb_val_trail.back().second;
+      nb_val_trail.pop_back();
+    }
   }
 
   bool augmenting_path( int u, int nbv );
 
   void dump( const std::string& filename );
+
+private:
+  std::vector<std::pair<int, int>> nb_val_trail;
 };
 
 using domain_func_t = std::function<bool(lad2_domain&)>;
@@ -173,6 +203,19 @@ using domain_hook_t = boost::optional<domain_func_t>;
  * Functions                                                                  *
  ******************************************************************************/
 
+/**
+ * Settings:
+ *   num_threads (unsigned) : if larger than 1, the first branching levels are
+ *                            split into tasks, which are solved in parallel
+ *                            (default: 1)
+ *   split_depth (unsigned) : number of branching levels explored before
+ *                            splitting (default: 1)
+ *
+ * In parallel mode, the on_filter hook is called from the worker threads.
+ *
+ * Statistics (parallel mode):
+ *   num_tasks, worker_tasks, worker_branches, worker_runtimes
+ */
 bool directed_lad2_from_aig( std::vector<unsigned>& mapping, const aig_graph& target, const aig_graph& pattern, const std::vector<unsigned>& types,
                              const properties::ptr& settings = properties::ptr(),
                              const properties::ptr& statistics = properties::ptr() );
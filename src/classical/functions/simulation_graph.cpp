@@ -18,7 +18,10 @@
 
 #include "simulation_graph.hpp"
 
+#include <algorithm>
+#include <cstdint>
 #include <fstream>
+#include <thread>
 
 #include <boost/assign/std/vector.hpp>
 #include <boost/format.hpp>
@@ -27,23 +30,146 @@
 #include <boost/range/algorithm.hpp>
 #include <boost/range/algorithm_ext/iota.hpp>
 #include <boost/range/algorithm_ext/push_back.hpp>
-#include <boost/range/combine.hpp>
 #include <boost/range/counting_range.hpp>
 #include <boost/range/iterator_range.hpp>
 
 #include <core/io/write_graph_file.hpp>
+#include <core/utils/bitset_utils.hpp>
 #include <core/utils/combinations.hpp>
 #include <core/utils/range_utils.hpp>
 #include <core/utils/string_utils.hpp>
-#include <classical/functions/simulate_aig.hpp>
+#include <core/utils/thread_pool.hpp>
+#include <core/utils/timer.hpp>
 #include <classical/functions/aig_support.hpp>
 #include <classical/utils/aig_utils.hpp>
+#include <classical/utils/flat_aig.hpp>
 
 using namespace boost::assign;
 
 namespace cirkit
 {
 
+/******************************************************************************
+ * Types                                                                      *
+ ******************************************************************************/
+
+/******************************************************************************
+ * Private functions                                                          *
+ ******************************************************************************/
+
+/* words per batch in simulate_flat_aig, such that the values of all nodes for one batch stay small */
+constexpr unsigned simulation_batch_words = 64u;
+
+/*
+ * Simulates the words [first, last) of all vectors, inputs contains
+ * num_words words for each primary input (input-major), result num_words
+ * words for each primary output (output-major)
+ */
+void simulate_flat_aig_batch( const flat_aig& flat, const std::vector<std::uint64_t>& inputs, std::vector<std::uint64_t>& result,
+                              std::vector<std::uint64_t>& values, unsigned num_words, unsigned first, unsigned last )
+{
+  const auto bw = last - first;
+
+  for ( auto i = 0u; i < flat.num_pis; ++i )
+  {
+    std::copy( inputs.begin() + i * num_words + first, inputs.begin() + i * num_words + last, values.begin() + ( i + 1u ) * bw );
+  }
+
+  flat.simulate( values, bw );
+
+  for ( auto j = 0u; j < flat.outputs.size(); ++j )
+  {
+    const auto* v = &values[( flat.outputs[j] >> 1u ) * bw];
+    const auto m = ( flat.outputs[j] & 1u ) ? ~0ull : 0ull;
+    auto* r = &result[j * num_words + first];
+
+    for ( auto w = 0u; w < bw; ++w )
+    {
+      r[w] = v[w] ^ m;
+    }
+  }
+}
+
+/* word-parallel simulation in batches, which are distributed over threads */
+std::vector<std::uint64_t> simulate_flat_aig( const flat_aig& flat, const std::vector<std::uint64_t>& inputs, unsigned num_words, unsigned num_threads )
+{
+  std::vector<std::uint64_t> result( flat.outputs.size() * num_words );
+
+  const auto num_batches = ( num_words + simulation_batch_words - 1u ) / simulation_batch_words;
+  num_threads = std::max( 1u, std::min( num_threads, num_batches ) );
+
+  const auto worker = [&]( unsigned id ) {
+    std::vector<std::uint64_t> values( flat.size() * simulation_batch_words );
+    for ( auto batch = id; batch < num_batches; batch += num_threads )
+    {
+      simulate_flat_aig_batch( flat, inputs, result, values, num_words, batch * simulation_batch_words,
+                               std::min( num_words, ( batch + 1u ) * simulation_batch_words ) );
+    }
+  };
+
+  if ( num_threads == 1u )
+  {
+    worker( 0u );
+  }
+  else
+  {
+    thread_pool pool( num_threads );
+    for ( auto i = 0u; i < num_threads; ++i )
+    {
+      pool.enqueue( worker, i );
+    }
+  }
+
+  return result;
+}
+
+inline unsigned simulation_num_words( unsigned num_vectors )
+{
+  return ( num_vectors + 63u ) >> 6u;
+}
+
+/* packs the simulation vectors into words, input-major */
+std::vector<std::uint64_t> pack_simulation_vectors( const std::vector<boost::dynamic_bitset<>>& sim_vectors, unsigned n )
+{
+  const auto num_words = simulation_num_words( sim_vectors.size() );
+  std::vector<std::uint64_t> words( n * num_words, 0ull );
+
+  for ( auto it : index( sim_vectors ) )
+  {
+    foreach_bit( it.value, [&]( unsigned pos ) {
+        words[pos * num_words + ( it.index >> 6u )] |= 1ull << ( it.index & 63u );
+      } );
+  }
+
+  return words;
+}
+
+/* number of set bits in the positions [first, last) */
+unsigned count_ones( const std::uint64_t* words, unsigned first, unsigned last )
+{
+  auto count = 0u;
+
+  while ( first < last )
+  {
+    const auto w    = first >> 6u;
+    const auto from = first & 63u;
+    const auto to   = std::min( last - ( w << 6u ), 64u );
+    auto       word = words[w] >> from;
+    if ( to - from < 64u )
+    {
+      word &= ( 1ull << ( to - from ) ) - 1ull;
+    }
+    count += bit_count( word );
+    first = ( w << 6u ) + to;
+  }
+
+  return count;
+}
+
+/******************************************************************************
+ * Public functions                                                           *
+ ******************************************************************************/
+
 simulation_graph create_simulation_graph( const aig_graph& aig, const std::vector<boost::dynamic_bitset<>>& sim_vectors,
                                           const properties::ptr& settings, const properties::ptr& statistics )
 {
@@ -61,6 +187,7 @@ simulation_graph create_simulation_graph( const aig_graph& aig, const std::vecto
   const auto support_edges         = get( settings, "support_edges",         false );
   const auto simulation_signatures = get( settings, "simulation_signatures", boost::optional<unsigned>() );
   const auto annotate_simvectors   = get( settings, "annotate_simvectors",   false );
+  const auto num_threads           = get( settings, "num_threads",           1u );
 
   if ( support_edges && !support )
   {
@@ -104,14 +231,8 @@ simulation_graph create_simulation_graph( const aig_graph& aig, const std::vecto
   }
 
   /* simulate */
-  word_assignment_simulator::aig_name_value_map map( info.inputs.size() );
-  const auto sim_vectors_t = transpose( sim_vectors );
-  for ( const auto& p : boost::combine( info.inputs, sim_vectors_t ) )
-  {
-    map.insert( {info.node_names.at( boost::get<0>( p ) ), boost::get<1>( p )} );
-  }
-
-  const auto results = simulate_aig( aig, word_assignment_simulator( map ) );
+  const auto num_words = simulation_num_words( sim_vectors.size() );
+  const auto results   = simulate_flat_aig( flat_aig( aig ), pack_simulation_vectors( sim_vectors, n ), num_words, num_threads );
 
   /* prepare annotation of simvectors */
   std::vector<boost::dynamic_bitset<>> results_t;
@@ -124,17 +245,26 @@ simulation_graph create_simulation_graph( const aig_graph& aig, const std::vecto
   /* create edges */
   for ( auto j = 0u; j < m; ++j )
   {
-    const auto& ovalue = results.at( info.outputs[j].first );
-    for ( auto i = 0u; i < sim_vectors.size(); ++i )
+    const auto* ovalue = &results[j * num_words];
+    for ( auto w = 0u; w < num_words; ++w )
     {
-      if ( ovalue[i] )
+      auto word = ovalue[w];
+      if ( w + 1u == num_words && ( sim_vectors.size() & 63u ) )
       {
-        add_edge_func( n + i, n + sim_vectors.size() + j );
+        word &= ( 1ull << ( sim_vectors.size() & 63u ) ) - 1ull;
       }
 
-      if ( annotate_simvectors )
+      while ( word )
       {
-        results_t[i][j] = ovalue[i];
+        const auto i = ( w << 6u ) + lowest_bit( word );
+        word &= word - 1ull;
+
+        add_edge_func( n + i, n + sim_vectors.size() + j );
+
+        if ( annotate_simvectors )
+        {
+          results_t[i][j] = true;
+        }
       }
     }
   }
@@ -210,7 +340,7 @@ simulation_graph create_simulation_graph( const aig_graph& aig, const std::vecto
   {
     const auto& vertex_simulation_signatures = boost::get( boost::vertex_simulation_signature, g );
 
-    const auto signatures = compute_simulation_signatures( aig, *simulation_signatures );
+    const auto signatures = compute_simulation_signatures( aig, *simulation_signatures, num_threads );
     for ( const auto& s : index( signatures ) )
     {
       vertex_simulation_signatures[n + sim_vectors.size() + s.index] = s.value;
@@ -360,49 +490,67 @@ simulation_graph create_simulation_graph( const aig_graph& aig, const std::vecto
   return graph;
 }
 
-std::vector<simulation_signature_t::value_type> compute_simulation_signatures( const aig_graph& aig, unsigned maxk )
+std::vector<simulation_signature_t::value_type> compute_simulation_signatures( const aig_graph& aig, unsigned maxk, unsigned num_threads )
 {
   std::vector<simulation_signature_t::value_type> vec;
 
   const auto& info      = aig_info( aig );
-  const auto  n         = info.inputs.size();
+  const auto  n         = static_cast<unsigned>( info.inputs.size() );
   const auto  num_types = ( maxk + 1u ) << 1u;
 
-  std::vector<unsigned> types( num_types );
-  boost::iota( types, 0u );
-
-  word_assignment_simulator::aig_name_value_map map( n );
-  std::vector<unsigned> partition, offset( num_types );
-  const auto all_sim_vectors   = create_simulation_vectors( n, types, &partition );
-  const auto all_sim_vectors_t = transpose( all_sim_vectors );
-
-  assert( partition.size() == num_types );
-  offset[0] = 0;
-  for ( auto i = 1u; i < partition.size(); ++i )
+  /* offsets of the types 0c, 0h, 1c, 1h, ... */
+  std::vector<unsigned> offset( num_types + 1u, 0u );
+  for ( auto i = 0u; i < num_types; ++i )
   {
-    offset[i] = offset[i - 1] + partition[i - 1];
+    offset[i + 1u] = offset[i] + boost::unofficial::count_each_combination( i / 2u, n - i / 2u );
   }
 
-  for ( const auto& p : boost::combine( info.inputs, all_sim_vectors_t ) )
+  /* pack the vectors directly into words without creating them */
+  const auto num_words = simulation_num_words( offset.back() );
+  std::vector<std::uint64_t> words( n * num_words, 0ull );
+  std::vector<unsigned> numbers( n );
+  boost::iota( numbers, 0u );
+
+  auto pos = 0u;
+  for ( auto i = 0u; i < num_types; ++i )
   {
-    map.insert( {info.node_names.at( boost::get<0>( p ) ), boost::get<1>( p )} );
+    const auto k   = i / 2u;
+    const auto hot = ( i % 2u == 1u );
+
+    boost::unofficial::for_each_combination( numbers.begin(), numbers.begin() + k, numbers.end(),
+                                             [&]( std::vector<unsigned>::const_iterator first,
+                                                  std::vector<unsigned>::const_iterator last )
+                                             {
+                                               const auto w   = pos >> 6u;
+                                               const auto bit = 1ull << ( pos & 63u );
+
+                                               if ( !hot )
+                                               {
+                                                 for ( auto x = 0u; x < n; ++x )
+                                                 {
+                                                   words[x * num_words + w] |= bit;
+                                                 }
+                                               }
+
+                                               while ( first != last )
+                                               {
+                                                 words[*first * num_words + w] ^= bit;
+                                                 ++first;
+                                               }
+
+                                               ++pos;
+                                               return false;
+                                             } );
   }
 
-  const auto results = simulate_aig( aig, word_assignment_simulator( map ) );
+  const auto results = simulate_flat_aig( flat_aig( aig ), words, num_words, num_threads );
 
-  for ( const auto& output : info.outputs )
+  for ( auto j = 0u; j < info.outputs.size(); ++j )
   {
-    const auto& ovalue = results.at( output.first );
     std::vector<unsigned> signature( num_types );
-    for ( auto i = 0u; i < partition.size(); ++i )
+    for ( auto i = 0u; i < num_types; ++i )
     {
-      signature[i] = 0u;
-      auto pos = ( i == 0u ) ? ovalue.find_first() : ovalue.find_next( offset[i] - 1u );
-      while ( pos < offset[i] + partition[i] && pos != boost::dynamic_bitset<>::npos )
-      {
-        ++signature[i];
-        pos = ovalue.find_next( pos );
-      }
+      signature[i] = count_ones( &results[j * num_words], offset[i], offset[i + 1u] );
     }
 
     vec += signature;
@@ -423,6 +571,7 @@ inline simulation_graph create_simulation_graph_wrapper( const aig_graph& aig, c
   settings->set( "support_edges", support_edges );
   settings->set( "simulation_signatures", simulation_signatures );
   settings->set( "annotate_simvectors", true );
+  settings->set( "num_threads", std::max( 1u, std::thread::hardware_concurrency() ) );
 
   return create_simulation_graph( aig, types, settings );
 }
@@ -433,14 +582,7 @@ simulation_graph_wrapper::simulation_graph_wrapper( const aig_graph& g,
                                                     const boost::optional<unsigned>& simulation_signatures )
   : aig( g ),
     info( aig_info( g ) ),
-    graph( create_simulation_graph_wrapper( g, types, support_edges, simulation_signatures ) ),
-#ifdef FAST_EDGE_ACCESS
-    vedge_label( boost::num_vertices( graph ), std::vector<int>( boost::num_vertices( graph ), 0 ) ),
-    vedge_direction( boost::num_vertices( graph ), std::vector<int>( boost::num_vertices( graph ), 0 ) )
-#else
-    vedge_label( boost::num_vertices( graph ) ),
-    vedge_direction( boost::num_vertices( graph ) )
-#endif
+    graph( create_simulation_graph_wrapper( g, types, support_edges, simulation_signatures ) )
 {
   vertex_label                = boost::get( boost::vertex_label, graph );
   vertex_in_degree            = boost::get( boost::vertex_in_degree, graph );
@@ -450,22 +592,49 @@ simulation_graph_wrapper::simulation_graph_wrapper( const aig_graph& g,
   vertex_sim_vectors          = boost::get( boost::vertex_simulation_vector, graph );
   medge_label                 = boost::get( boost::edge_label, graph );
 
-  /* fill labels */
+  /* compressed sparse rows, each edge is stored for both endpoints */
+  const auto n = size();
+  adjacency_offsets.resize( n + 1u, 0u );
   for ( const auto& e : edges() )
   {
-    const auto& src = boost::source( e, graph );
-    const auto& tgt = boost::target( e, graph );
+    ++adjacency_offsets[boost::source( e, graph ) + 1u];
+    ++adjacency_offsets[boost::target( e, graph ) + 1u];
+  }
+  for ( auto u = 0u; u < n; ++u )
+  {
+    adjacency_offsets[u + 1u] += adjacency_offsets[u];
+  }
 
-#ifdef FAST_EDGE_ACCESS
-    vedge_label[src][tgt] = vedge_label[tgt][src] = medge_label[e];
-    vedge_direction[src][tgt] = 1;
-    vedge_direction[tgt][src] = 2;
-#else
-    vedge_label[src].insert( {tgt, medge_label[e]} );
-    vedge_label[tgt].insert( {src, medge_label[e]} );
-    vedge_direction[src].insert( {tgt, 1} );
-    vedge_direction[tgt].insert( {src, 1} );
-#endif
+  std::vector<std::pair<unsigned, unsigned>> entries( adjacency_offsets.back() );
+  auto fill = adjacency_offsets;
+  for ( const auto& e : edges() )
+  {
+    const unsigned src = boost::source( e, graph );
+    const unsigned tgt = boost::target( e, graph );
+    const auto label = medge_label[e] << 4u;
+
+    entries[fill[src]++] = {tgt, label | 1u};
+    entries[fill[tgt]++] = {src, label | 2u};
+  }
+
+  adjacency.resize( entries.size() );
+  edge_attributes.resize( entries.size() );
+  for ( auto u = 0u; u < n; ++u )
+  {
+    const auto begin = adjacency_offsets[u], end = adjacency_offsets[u + 1u];
+    std::sort( entries.begin() + begin, entries.begin() + end,
+               []( const std::pair<unsigned, unsigned>& a, const std::pair<unsigned, unsigned>& b ) { return a.first < b.first; } );
+
+    for ( auto pos = begin; pos < end; ++pos )
+    {
+      adjacency[pos]       = entries[pos].first;
+      edge_attributes[pos] = entries[pos].second;
+
+      if ( end - begin > hash_degree )
+      {
+        edge_lookup.insert( {( static_cast<std::uint64_t>( u ) << 32u ) | entries[pos].first, pos} );
+      }
+    }
   }
 }
 
@@ -495,15 +664,14 @@ void simulation_graph_wrapper::fill_neighbor_degree_sequence_all( unsigned u, st
 
 void simulation_graph_wrapper::add_edge_kinds()
 {
-  vedge_kind.resize( num_outputs() );
-
   const auto& edge_kind = boost::get( boost::edge_kind, graph );
 
   for ( const auto& out : output_indexes() )
   {
     for ( const auto& e : out_edges( out ) )
     {
-      vedge_kind[output_index( out )][input_index( boost::target( e, graph ) )] = edge_kind[e];
+      const auto pos = edge_position( out, boost::target( e, graph ) );
+      edge_attributes[pos] = ( edge_attributes[pos] & ~12u ) | ( static_cast<unsigned>( edge_kind[e] ) << 2u );
     }
   }
 }
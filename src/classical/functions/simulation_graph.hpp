@@ -28,6 +28,9 @@
 #ifndef SIMULATION_GRAPH_HPP
 #define SIMULATION_GRAPH_HPP
 
+#include <algorithm>
+#include <cstdint>
+#include <limits>
 #include <memory>
 #include <unordered_map>
 #include <vector>
@@ -140,6 +143,9 @@ using simulation_edge                      = edge_t<simulation_graph>;
 
 /**
  * This function does not assign labels
+ *
+ * Settings:
+ *   num_threads (unsigned) : number of threads for the word-parallel simulation (default: 1)
  */
 simulation_graph create_simulation_graph( const aig_graph& aig, const std::vector<boost::dynamic_bitset<>>& sim_vectors,
                                           const properties::ptr& settings = properties::ptr(),
@@ -159,23 +165,27 @@ simulation_graph create_simulation_graph( const aig_graph& aig, const std::vecto
                                           const properties::ptr& settings = properties::ptr(),
                                           const properties::ptr& statistics = properties::ptr() );
 
-std::vector<simulation_signature_t::value_type> compute_simulation_signatures( const aig_graph& aig, unsigned maxk = 2u );
+/**
+ * Simulation is word-parallel, i.e., 64 vectors are packed into one word,
+ * and distributed over num_threads threads for large inputs.
+ */
+std::vector<simulation_signature_t::value_type> compute_simulation_signatures( const aig_graph& aig, unsigned maxk = 2u, unsigned num_threads = 1u );
 
 /******************************************************************************
  * simulation_graph_wrapper                                                   *
  ******************************************************************************/
 /**
- * If FAST_EDGE_ACCESS is defined, edge directions and edge labels are stored
- * in an adjacency matrix, which increases performance but also memory usage.
+ * Adjacencies are stored in a compressed sparse row layout with sorted
+ * neighbors.  Each entry packs the edge direction (2 bits), the unateness
+ * kind (2 bits), and the edge label.  Edges are looked up by binary search
+ * in the neighbors, or by a hash table for vertices of high degree.
  */
-#define FAST_EDGE_ACCESS
-
 class simulation_graph_wrapper
 {
 public:
   using vertex_range_t    = boost::iterator_range<boost::graph_traits<simulation_graph>::vertex_iterator>;
   using edge_range_t      = boost::iterator_range<boost::graph_traits<simulation_graph>::edge_iterator>;
-  using adjacency_range_t = boost::iterator_range<boost::graph_traits<simulation_graph>::adjacency_iterator>;
+  using adjacency_range_t = boost::iterator_range<std::vector<unsigned>::const_iterator>;
   using out_edge_range_t  = boost::iterator_range<boost::graph_traits<simulation_graph>::out_edge_iterator>;
   using index_range_t     = boost::iterator_range<boost::counting_iterator<unsigned>>;
 
@@ -192,13 +202,13 @@ public:
   inline unsigned num_outputs() const                                    { return boost::get_property( graph, boost::graph_meta ).num_outputs; }
 
   inline unsigned size() const                                           { return boost::num_vertices( graph ); }
-  inline unsigned degree( unsigned u ) const                             { return boost::out_degree( u, graph ); }
+  inline unsigned degree( unsigned u ) const                             { return adjacency_offsets[u + 1u] - adjacency_offsets[u]; }
   inline unsigned in_degree( unsigned u ) const                          { return vertex_in_degree[u]; }
   inline unsigned out_degree( unsigned u ) const                         { return vertex_out_degree[u]; }
-  inline boost::dynamic_bitset<> support( unsigned u ) const             { return vertex_support[u]; }
+  inline const boost::dynamic_bitset<>& support( unsigned u ) const      { return vertex_support[u]; }
   inline unsigned label( unsigned u ) const                              { return vertex_label[u]; }
-  inline simulation_signature_t simulation_signature( unsigned u ) const { return vertex_simulation_signature[u]; }
-  inline boost::dynamic_bitset<> simvector( unsigned u ) const           { return vertex_sim_vectors[u]; }
+  inline const simulation_signature_t& simulation_signature( unsigned u ) const { return vertex_simulation_signature[u]; }
+  inline const boost::dynamic_bitset<>& simvector( unsigned u ) const    { return vertex_sim_vectors[u]; }
   inline std::string name( unsigned u ) const
   {
     if ( u < num_inputs() ) { return empty_default( info.node_names.at( info.inputs[u] ), boost::str( boost::format( "i%d" ) % u ) ); }
@@ -212,7 +222,7 @@ public:
 
   inline vertex_range_t    vertices() const              { return boost::make_iterator_range( boost::vertices( graph ) ); }
   inline edge_range_t      edges() const                 { return boost::make_iterator_range( boost::edges( graph ) ); }
-  inline adjacency_range_t adjacent( unsigned u ) const  { return boost::make_iterator_range( boost::adjacent_vertices( u, graph ) ); }
+  inline adjacency_range_t adjacent( unsigned u ) const  { return boost::make_iterator_range( adjacency.begin() + adjacency_offsets[u], adjacency.begin() + adjacency_offsets[u + 1u] ); }
   inline out_edge_range_t  out_edges( unsigned u ) const { return boost::make_iterator_range( boost::out_edges( u, graph ) ); }
 
   inline unsigned input_index( unsigned u )  const { return u; }
@@ -237,28 +247,22 @@ public:
 
   inline unsigned edge_direction( unsigned u, unsigned v ) const
   {
-#ifdef FAST_EDGE_ACCESS
-    return vedge_direction[u][v];
-#else
-    const auto it = vedge_direction[u].find( v );
-    return ( it == vedge_direction[u].end() ) ? 0u : it->second;
-#endif
+    const auto pos = edge_position( u, v );
+    return ( pos == no_edge ) ? 0u : ( edge_attributes[pos] & 3u );
   }
 
   inline unsigned edge_label( unsigned u, unsigned v ) const
   {
-#ifdef FAST_EDGE_ACCESS
-    return vedge_label[u][v];
-#else
-    const auto it = vedge_label[u].find( v );
-    return ( it == vedge_label[u].end() ) ? 0u : it->second;
-#endif
+    const auto pos = edge_position( u, v );
+    return ( pos == no_edge ) ? 0u : ( edge_attributes[pos] >> 4u );
   }
 
+  /* u is an output index and v is an input index, requires add_edge_kinds */
   inline unate_kind edge_kind( unsigned u, unsigned v ) const
   {
-    const auto it = vedge_kind[u].find( v );
-    return it->second;
+    const auto pos = edge_position( num_inputs() + num_vectors() + u, v );
+    assert( pos != no_edge );
+    return static_cast<unate_kind>( ( edge_attributes[pos] >> 2u ) & 3u );
   }
 
   void write_dot( const std::string& filename ) const;
@@ -276,15 +280,31 @@ protected:
   boost::property_map<simulation_graph, boost::vertex_simulation_vector_t>::type    vertex_sim_vectors;
   boost::property_map<simulation_graph, boost::edge_label_t>::type                  medge_label;
 
-#ifdef FAST_EDGE_ACCESS
-  std::vector<std::vector<int>>                                                     vedge_label;
-  std::vector<std::vector<int>>                                                     vedge_direction;
-#else
-  /* there is no other way right now to efficiently handle this */
-  std::vector<std::unordered_map<unsigned, unsigned>>                               vedge_label;
-  std::vector<std::unordered_map<unsigned, unsigned>>                               vedge_direction;
-#endif
-  std::vector<std::unordered_map<unsigned, unate_kind>>                             vedge_kind;
+private:
+  static constexpr unsigned no_edge = std::numeric_limits<unsigned>::max();
+
+  /* vertices with more neighbors use edge_lookup instead of binary search */
+  static constexpr unsigned hash_degree = 64u;
+
+  inline unsigned edge_position( unsigned u, unsigned v ) const
+  {
+    const auto begin = adjacency.begin() + adjacency_offsets[u];
+    const auto end   = adjacency.begin() + adjacency_offsets[u + 1u];
+
+    if ( end - begin > hash_degree )
+    {
+      const auto it = edge_lookup.find( ( static_cast<std::uint64_t>( u ) << 32u ) | v );
+      return ( it == edge_lookup.end() ) ? no_edge : it->second;
+    }
+
+    const auto it = std::lower_bound( begin, end, v );
+    return ( it == end || *it != v ) ? no_edge : std::distance( adjacency.begin(), it );
+  }
+
+  std::vector<unsigned>                                                             adjacency_offsets;
+  std::vector<unsigned>                                                             adjacency;
+  std::vector<unsigned>                                                             edge_attributes;
+  std::unordered_map<std::uint64_t, unsigned>                                       edge_lookup;
 };
 
 bool compatible_simulation_signatures( const simulation_graph_wrapper& pg, const simulation_graph_wrapper& tg,
@@ -18,11 +18,15 @@
 
 #include "cnf_manager.hpp"
 
+#include <algorithm>
+
+#include <boost/dynamic_bitset.hpp>
 #include <boost/format.hpp>
 
 #include <core/utils/bitset_utils.hpp>
 #include <core/utils/timer.hpp>
 #include <classical/functions/isop.hpp>
+#include <classical/functions/npn_canonization.hpp>
 
 namespace cirkit
 {
@@ -35,46 +39,147 @@ namespace cirkit
  * Private functions                                                          *
  ******************************************************************************/
 
+unsigned cover_literal_count( const std::vector<int>& cover, unsigned num_vars )
+{
+  auto count = 0u;
+  for ( auto c : cover )
+  {
+    for ( auto x = 0u; x < num_vars; ++x )
+    {
+      if ( ( c >> ( x << 1 ) ) & 3 )
+      {
+        ++count;
+      }
+    }
+  }
+  return count;
+}
+
+inline int cover_swap_bits( int c, unsigned p, unsigned q )
+{
+  const auto bp = ( c >> p ) & 1, bq = ( c >> q ) & 1;
+  return bp == bq ? c : c ^ ( ( 1 << p ) | ( 1 << q ) );
+}
+
+/* applies the transformation of tt_from_npn to a cover of npn */
+std::vector<int> cover_from_npn( const std::vector<int>& npn, const boost::dynamic_bitset<>& phase, std::vector<unsigned> perm )
+{
+  const auto n = perm.size();
+  auto cover = npn;
+
+  /* permute inputs */
+  for ( auto i = 0u; i < n; ++i )
+  {
+    if ( perm[i] == i ) continue;
+
+    const auto pos = std::distance( perm.begin(), std::find( perm.begin(), perm.end(), i ) );
+    for ( auto& c : cover )
+    {
+      c = cover_swap_bits( cover_swap_bits( c, i << 1, pos << 1 ), ( i << 1 ) + 1, ( pos << 1 ) + 1 );
+    }
+    std::swap( perm[i], perm[pos] );
+  }
+
+  /* invert inputs */
+  for ( auto i = 0u; i < n; ++i )
+  {
+    if ( phase.test( i ) )
+    {
+      for ( auto& c : cover ) { c = cover_swap_bits( c, i << 1, ( i << 1 ) + 1 ); }
+    }
+  }
+
+  /* invert output */
+  if ( phase.test( n ) )
+  {
+    for ( auto& c : cover ) { c = cover_swap_bits( c, n << 1, ( n << 1 ) + 1 ); }
+  }
+
+  return cover;
+}
+
 /******************************************************************************
  * Public functions                                                           *
  ******************************************************************************/
 
-cnf_manager::vertex_range_t cnf_manager::compute( const tt& func, unsigned* literal_count )
+cnf_manager::cnf_manager( unsigned capacity, bool npn_keys, unsigned num_stripes )
+  : npn_keys( npn_keys )
 {
-  const auto key = to_string( func );
-  const auto it = hash.find( key );
+  /* capacity is per stripe */
+  const auto stripes_count = std::max( num_stripes, 1u );
+  this->capacity = capacity ? ( capacity + stripes_count - 1u ) / stripes_count : 0u;
 
-  unsigned begin = 0u, end = 0u, count = 0u;
+  for ( auto i = 0u; i < stripes_count; ++i )
+  {
+    stripes.emplace_back( new stripe_t() );
+  }
+}
 
-  if ( it != hash.end() )
+cnf_manager::cover_t cnf_manager::compute( const tt& func, unsigned* literal_count )
+{
+  auto representative = func;
+  boost::dynamic_bitset<> phase;
+  std::vector<unsigned> perm;
+
+  if ( npn_keys )
   {
-    ++cache_hit;
-    begin = std::get<0>( it->second );
-    end   = std::get<1>( it->second );
-    count = std::get<2>( it->second );
+    representative = npn_canonization( func, phase, perm );
   }
-  else
+
+  key_t key;
+  key.reserve( func.num_blocks() + 1u );
+  boost::to_block_range( representative, std::back_inserter( key ) );
+  key.push_back( representative.size() );
+
+  auto& stripe = *stripes[hash<key_t>()( key ) % stripes.size()];
+
+  cover_t cover;
+  auto count = 0u;
+
   {
-    ++cache_miss;
-    increment_timer t( &runtime );
-    begin = covers.size();
-    tt_cnf( func, covers );
-    end = covers.size();
-
-    /* count literals */
-    const auto num_vars = tt_num_vars( func );
-    for ( auto i = begin; i < end; ++i )
+    std::lock_guard<std::mutex> lock( stripe.mutex );
+    const auto it = stripe.table.find( key );
+
+    if ( it != stripe.table.end() )
+    {
+      ++stripe.cache_hit;
+      stripe.lru.splice( stripe.lru.begin(), stripe.lru, it->second );
+      cover = it->second->cover;
+      count = it->second->literal_count;
+    }
+    else
+    {
+      ++stripe.cache_miss;
+    }
+  }
+
+  if ( !cover )
+  {
+    /* compute without holding the lock, another thread may insert the same key meanwhile */
+    double runtime = 0.0;
+    {
+      increment_timer t( &runtime );
+      auto new_cover = std::make_shared<std::vector<int>>();
+      tt_cnf( representative, *new_cover );
+      count = cover_literal_count( *new_cover, tt_num_vars( representative ) );
+      cover = new_cover;
+    }
+
+    std::lock_guard<std::mutex> lock( stripe.mutex );
+    stripe.runtime += runtime;
+
+    if ( !stripe.table.count( key ) )
     {
-      for ( auto x = 0u; x < num_vars; ++x )
+      stripe.lru.push_front( entry_t{key, cover, count} );
+      stripe.table.insert( {std::move( key ), stripe.lru.begin()} );
+
+      if ( capacity && stripe.lru.size() > capacity )
       {
-        if ( ( covers[i] >> ( x << 1 ) ) & 3 )
-        {
-          ++count;
-        }
+        stripe.table.erase( stripe.lru.back().key );
+        stripe.lru.pop_back();
+        ++stripe.evictions;
       }
     }
-
-    hash[key] = std::make_tuple( begin, end, count );
   }
 
   if ( literal_count )
@@ -82,12 +187,45 @@ cnf_manager::vertex_range_t cnf_manager::compute( const tt& func, unsigned* lite
     *literal_count = count;
   }
 
-  return boost::make_iterator_range( covers.begin() + begin, covers.begin() + end );
+  if ( npn_keys )
+  {
+    return std::make_shared<std::vector<int>>( cover_from_npn( *cover, phase, perm ) );
+  }
+  else
+  {
+    return cover;
+  }
+}
+
+void cnf_manager::clear()
+{
+  for ( auto& stripe : stripes )
+  {
+    std::lock_guard<std::mutex> lock( stripe->mutex );
+    stripe->lru.clear();
+    stripe->table.clear();
+  }
 }
 
 void cnf_manager::print_statistics( std::ostream& os ) const
 {
-  os << boost::format( "[i] CNF manager: size = %d   cache hits = %d   cache misses = %d   run-time = %.2f secs" ) % hash.size() % cache_hit % cache_miss % runtime << std::endl;
+  auto size = 0u;
+  unsigned long cache_hit = 0ul, cache_miss = 0ul, evictions = 0ul;
+  auto runtime = 0.0;
+
+  for ( const auto& stripe : stripes )
+  {
+    std::lock_guard<std::mutex> lock( stripe->mutex );
+    size       += stripe->lru.size();
+    cache_hit  += stripe->cache_hit;
+    cache_miss += stripe->cache_miss;
+    evictions  += stripe->evictions;
+    runtime    += stripe->runtime;
+  }
+
+  os << boost::format( "[i] CNF manager: size = %d   cache hits = %d   cache misses = %d   evictions = %d   hit rate = %.2f%%   run-time = %.2f secs" )
+        % size % cache_hit % cache_miss % evictions
+        % ( cache_hit + cache_miss ? ( 100.0 * cache_hit ) / ( cache_hit + cache_miss ) : 0.0 ) % runtime << std::endl;
 }
 
 }
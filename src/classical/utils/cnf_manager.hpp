@@ -29,37 +29,71 @@
 #define CNF_MANAGER_HPP
 
 #include <iostream>
+#include <list>
+#include <memory>
+#include <mutex>
 #include <unordered_map>
 #include <vector>
 
-#include <boost/range/iterator_range.hpp>
-
+#include <core/utils/hash_utils.hpp>
 #include <classical/utils/truth_table_utils.hpp>
 
 namespace cirkit
 {
 
+/**
+ * @brief Cache for irredundant CNF covers of truth tables
+ *
+ * Covers are keyed on the words of the truth table.  With NPN keys, the
+ * cover of a canonical representative is shared among all functions of an
+ * NPN class and transformed back on each hit.  The cache is divided into
+ * lock-protected stripes such that several encoders can share it, each
+ * stripe evicts its least recently used covers if a capacity is given.
+ *
+ * Each element of a cover encodes one clause, two bits per variable and two
+ * bits for the function output, as computed by tt_cnf.
+ */
 class cnf_manager
 {
 public:
-  using vertex_range_t = boost::iterator_range<std::vector<int>::const_iterator>;
+  using cover_t = std::shared_ptr<const std::vector<int>>;
 
-public:
-  vertex_range_t compute( const tt& func, unsigned* literal_count = nullptr );
+  /* capacity = 0 means unbounded */
+  explicit cnf_manager( unsigned capacity = 0u, bool npn_keys = false, unsigned num_stripes = 16u );
+
+  cover_t compute( const tt& func, unsigned* literal_count = nullptr );
 
+  void clear();
   void print_statistics( std::ostream& os = std::cout ) const;
 
 private:
-  /* maps str repr of tt to tuple of start and (exclusive) end index in `covers', and the literal count */
-  using hash_t = std::unordered_map<std::string, std::tuple<unsigned, unsigned, unsigned>>;
+  using key_t = std::vector<tt::block_type>;
+
+  struct entry_t
+  {
+    key_t    key;
+    cover_t  cover;
+    unsigned literal_count;
+  };
+
+  struct stripe_t
+  {
+    std::mutex mutex;
+
+    /* most recently used entries first */
+    std::list<entry_t>                                                   lru;
+    std::unordered_map<key_t, std::list<entry_t>::iterator, hash<key_t>> table;
 
-  std::vector<int> covers;
-  hash_t           hash;
+    /* statistics */
+    double        runtime    = 0.0;
+    unsigned long cache_hit  = 0;
+    unsigned long cache_miss = 0;
+    unsigned long evictions  = 0;
+  };
 
-  /* statistics */
-  double        runtime    = 0.0;
-  unsigned long cache_hit  = 0;
-  unsigned long cache_miss = 0;
+  unsigned                               capacity;
+  bool                                   npn_keys;
+  std::vector<std::unique_ptr<stripe_t>> stripes;
 };
 
 }
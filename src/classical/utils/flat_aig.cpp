@@ -0,0 +1,169 @@
+/* CirKit: A circuit toolkit
+ * Copyright (C) 2009-2015  University of Bremen
+ * Copyright (C) 2015-2016  EPFL
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "flat_aig.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+#include <boost/graph/topological_sort.hpp>
+
+#include <core/utils/range_utils.hpp>
+#include <classical/utils/aig_utils.hpp>
+
+namespace cirkit
+{
+
+/******************************************************************************
+ * Types                                                                      *
+ ******************************************************************************/
+
+/******************************************************************************
+ * Private functions                                                          *
+ ******************************************************************************/
+
+/******************************************************************************
+ * Public functions                                                           *
+ ******************************************************************************/
+
+flat_aig::flat_aig( unsigned num_pis, bool strash )
+  : num_pis( num_pis ),
+    fanin0( num_pis + 1u, 0u ),
+    fanin1( num_pis + 1u, 0u ),
+    strash( strash )
+{
+}
+
+flat_aig::flat_aig( const aig_graph& aig )
+  : flat_aig( aig_info( aig ).inputs.size() )
+{
+  outputs = add_aig( aig );
+}
+
+unsigned flat_aig::create_and( unsigned a, unsigned b )
+{
+  if ( !strash )
+  {
+    fanin0.push_back( a );
+    fanin1.push_back( b );
+    return ( size() - 1u ) << 1u;
+  }
+
+  if ( a > b ) { std::swap( a, b ); }
+
+  if ( a == 0u )         { return 0u; }
+  if ( a == 1u )         { return b; }
+  if ( a == b )          { return a; }
+  if ( ( a ^ 1u ) == b ) { return 0u; }
+
+  const auto key = ( static_cast<std::uint64_t>( a ) << 32u ) | b;
+  const auto it = hash.find( key );
+  if ( it != hash.end() )
+  {
+    return it->second;
+  }
+
+  const auto lit = size() << 1u;
+  fanin0.push_back( a );
+  fanin1.push_back( b );
+  hash.insert( {key, lit} );
+  return lit;
+}
+
+std::vector<unsigned> flat_aig::add_aig( const aig_graph& aig )
+{
+  const auto& info = aig_info( aig );
+
+  assert( info.inputs.size() == num_pis );
+  assert( info.cis.empty() );
+
+  std::vector<unsigned> node_to_lit( boost::num_vertices( aig ), 0u );
+  for ( const auto& input : index( info.inputs ) )
+  {
+    node_to_lit[input.value] = ( input.index + 1u ) << 1u;
+  }
+
+  std::vector<aig_node> topsort( boost::num_vertices( aig ) );
+  boost::topological_sort( aig, topsort.begin() );
+
+  for ( const auto& node : topsort )
+  {
+    if ( !boost::out_degree( node, aig ) ) { continue; }
+
+    const auto children = get_children( aig, node );
+    assert( children.size() == 2u );
+
+    node_to_lit[node] = create_and( node_to_lit[children[0u].node] ^ children[0u].complemented,
+                                    node_to_lit[children[1u].node] ^ children[1u].complemented );
+  }
+
+  std::vector<unsigned> lits;
+  for ( const auto& output : info.outputs )
+  {
+    lits.push_back( node_to_lit[output.first.node] ^ output.first.complemented );
+  }
+  return lits;
+}
+
+boost::dynamic_bitset<> flat_aig::cone( unsigned lit ) const
+{
+  boost::dynamic_bitset<> mark( size() );
+  mark.set( lit >> 1u );
+
+  for ( auto n = lit >> 1u; n > num_pis; --n )
+  {
+    if ( !mark[n] ) { continue; }
+    mark.set( fanin0[n] >> 1u );
+    mark.set( fanin1[n] >> 1u );
+  }
+
+  return mark;
+}
+
+void flat_aig::simulate( std::vector<std::uint64_t>& values, unsigned num_words ) const
+{
+  std::fill( values.begin(), values.begin() + num_words, 0ull );
+
+  for ( auto n = num_pis + 1u; n < size(); ++n )
+  {
+    const auto* v0 = &values[( fanin0[n] >> 1u ) * num_words];
+    const auto* v1 = &values[( fanin1[n] >> 1u ) * num_words];
+    const auto m0 = ( fanin0[n] & 1u ) ? ~0ull : 0ull;
+    const auto m1 = ( fanin1[n] & 1u ) ? ~0ull : 0ull;
+    auto* v = &values[n * num_words];
+
+    for ( auto w = 0u; w < num_words; ++w )
+    {
+      v[w] = ( v0[w] ^ m0 ) & ( v1[w] ^ m1 );
+    }
+  }
+}
+
+unsigned long flat_aig::memory() const
+{
+  return ( fanin0.capacity() + fanin1.capacity() + outputs.capacity() ) * sizeof( unsigned ) +
+         hash.size() * ( sizeof( std::uint64_t ) + sizeof( unsigned ) + sizeof( void* ) );
+}
+
+}
+
+// Local Variables:
+// c-basic-offset: 2
+// eval: (c-set-offset 'substatement-open 0)
+// eval: (c-set-offset 'innamespace 0)
+// End:
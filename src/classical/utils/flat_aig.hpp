@@ -0,0 +1,95 @@
+/* CirKit: A circuit toolkit
+ * Copyright (C) 2009-2015  University of Bremen
+ * Copyright (C) 2015-2016  EPFL
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file flat_aig.hpp
+ *
+ * @brief Flat array representation of an AIG
+ *
+ * @author Mathias Soeken
+ * @since  2.3
+ */
+
+#ifndef FLAT_AIG_HPP
+#define FLAT_AIG_HPP
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include <boost/dynamic_bitset.hpp>
+
+#include <classical/aig.hpp>
+
+namespace cirkit
+{
+
+/**
+ * @brief AIG in two fanin arrays
+ *
+ * Node 0 is the constant, nodes 1, ..., n are the primary inputs and all
+ * following nodes are AND gates in topological order.  A literal is
+ * ( node << 1 ) | complemented, such that literal 0 is constant false.
+ *
+ * With structural hashing, create_and simplifies trivial AND gates and
+ * reuses existing ones, otherwise each call appends a new node.
+ */
+class flat_aig
+{
+public:
+  explicit flat_aig( unsigned num_pis, bool strash = false );
+
+  /* copies aig without structural hashing, outputs contains its outputs */
+  explicit flat_aig( const aig_graph& aig );
+
+  inline unsigned size() const { return fanin0.size(); }
+  inline bool is_and( unsigned node ) const { return node > num_pis; }
+
+  unsigned create_and( unsigned a, unsigned b );
+
+  /* adds aig on top of the primary inputs, returns the literals of its outputs */
+  std::vector<unsigned> add_aig( const aig_graph& aig );
+
+  /* marks the transitive fanin of a literal */
+  boost::dynamic_bitset<> cone( unsigned lit ) const;
+
+  /* simulates num_words words per node, values are stored node-major and must contain the PI values */
+  void simulate( std::vector<std::uint64_t>& values, unsigned num_words ) const;
+
+  unsigned long memory() const;
+
+public:
+  unsigned              num_pis;
+  std::vector<unsigned> fanin0;
+  std::vector<unsigned> fanin1;
+  std::vector<unsigned> outputs;
+
+private:
+  bool                                        strash;
+  std::unordered_map<std::uint64_t, unsigned> hash;
+};
+
+}
+
+#endif
+
+// Local Variables:
+// c-basic-offset: 2
+// eval: (c-set-offset 'substatement-open 0)
+// eval: (c-set-offset 'innamespace 0)
+// End:
@@ -30,6 +30,7 @@
 #define BITSET_UTILS_HPP
 
 #include <algorithm>
+#include <cstdint>
 #include <iostream>
 #include <random>
 #include <vector>
@@ -96,6 +97,29 @@ IntType to_multiprecision( const boost::dynamic_bitset<>& bs )
 
 std::string to_string( const boost::dynamic_bitset<>& b );
 
+/* number of set bits in a word */
+inline unsigned bit_count( std::uint64_t word )
+{
+#ifdef __GNUC__
+  return __builtin_popcountll( word );
+#else
+  word = word - ( ( word >> 1u ) & 0x5555555555555555ull );
+  word = ( word & 0x3333333333333333ull ) + ( ( word >> 2u ) & 0x3333333333333333ull );
+  word = ( word + ( word >> 4u ) ) & 0x0F0F0F0F0F0F0F0Full;
+  return static_cast<unsigned>( ( word * 0x0101010101010101ull ) >> 56u );
+#endif
+}
+
+/* index of the least significant set bit, word must not be 0 */
+inline unsigned lowest_bit( std::uint64_t word )
+{
+#ifdef __GNUC__
+  return __builtin_ctzll( word );
+#else
+  return bit_count( ( word & ( ~word + 1u ) ) - 1u );
+#endif
+}
+
 }
 
 #endif